@@ -0,0 +1,757 @@
+// Throughput benchmarks for the public Matrix/Vector operations.
+//
+// Every operation is swept over a range of sizes. For each size the benchmark reports the best and
+// median time per call, the arithmetic rate (GFLOP/s) and the memory traffic rate (GB/s, counting
+// each operand read and each result written once). Results print as a table, or as JSON or CSV
+// for scripts; --compare checks a run against a saved JSON baseline and fails on regressions.
+//
+// Usage: benchmark [--filter substring] [--sizes n,n,...] [--min-time seconds] [--repeat count]
+//                  [--threads count] [--isa scalar|sse2|avx2|avx512] [--format table|json|csv]
+//                  [--output file] [--compare baseline.json] [--tolerance fraction]
+
+#include "kalo_algebra.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef KALO_ALGEBRA_BUILD_TYPE
+#define KALO_ALGEBRA_BUILD_TYPE "unknown"
+#endif
+
+namespace
+{
+    struct Options
+    {
+        std::string filter;
+        std::vector<int> sizes; // empty: each benchmark's own sweep
+        double minTime = 0.2;
+        int repeat = 5;
+        std::string format = "table";
+        std::string output;
+        std::string compare;
+        double tolerance = 0.10;
+    };
+
+    struct Result
+    {
+        std::string name;
+        int size;
+        int iterations;
+        double bestSeconds;
+        double medianSeconds;
+        double flops; // per call
+        double bytes; // per call
+
+        double gflops() const { return flops / bestSeconds / 1e9; }
+        double gbps() const { return bytes / bestSeconds / 1e9; }
+    };
+
+    // Runs body once to warm up, then at least `repeat` times and for at least `minTime` seconds
+    Result measure(const Options &options, const std::string &name, int size, double flops, double bytes,
+                   const std::function<void()> &body)
+    {
+        using Clock = std::chrono::steady_clock;
+        body();
+        std::vector<double> samples;
+        const Clock::time_point start = Clock::now();
+        while (static_cast<int>(samples.size()) < options.repeat ||
+               std::chrono::duration<double>(Clock::now() - start).count() < options.minTime)
+        {
+            const Clock::time_point before = Clock::now();
+            body();
+            samples.push_back(std::chrono::duration<double>(Clock::now() - before).count());
+        }
+        std::sort(samples.begin(), samples.end());
+        return Result{name, size, static_cast<int>(samples.size()), samples.front(), samples[samples.size() / 2], flops, bytes};
+    }
+
+    // One benchmark: a name, its default size sweep and a function running it at one size
+    struct Benchmark
+    {
+        std::string name;
+        std::vector<int> sizes;
+        std::function<Result(const Options &, int)> run;
+    };
+
+    const std::vector<int> matrixSizes = {64, 128, 256, 512, 1024, 2048};
+    const std::vector<int> productSizes = {64, 128, 256, 512, 1024};
+    const std::vector<int> tallSizes = {1 << 12, 1 << 14, 1 << 16, 1 << 18};
+    const std::vector<int> vectorSizes = {1 << 10, 1 << 14, 1 << 18, 1 << 22};
+    const std::vector<int> temporarySizes = {8, 16, 32, 64, 128};
+
+    // Keeps results observable so the optimizer cannot drop the work
+    volatile double sink;
+
+    std::vector<Benchmark> benchmarks()
+    {
+        const double word = sizeof(double);
+        std::vector<Benchmark> list;
+
+        // Matrix operations on n x n operands
+        list.push_back({"matrix_multiply", productSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0), b = Matrix::random(n, n, -1.0, 1.0);
+                            const double nn = static_cast<double>(n) * n;
+                            return measure(o, "matrix_multiply", n, 2.0 * nn * n, 3.0 * nn * word, [&]
+                                           { Matrix c = a * b; sink = c.getElement(0, 0); });
+                        }});
+        list.push_back({"gemm", productSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0), b = Matrix::random(n, n, -1.0, 1.0), c(n, n);
+                            const double nn = static_cast<double>(n) * n;
+                            return measure(o, "gemm", n, 2.0 * nn * n + 2.0 * nn, 4.0 * nn * word, [&]
+                                           { gemm(1.0, a, b, 0.5, c); });
+                        }});
+        list.push_back({"gemm_float", productSizes, [=](const Options &o, int n)
+                        {
+                            FloatMatrix a = FloatMatrix::random(n, n, -1.0f, 1.0f), b = FloatMatrix::random(n, n, -1.0f, 1.0f), c(n, n);
+                            const double nn = static_cast<double>(n) * n;
+                            return measure(o, "gemm_float", n, 2.0 * nn * n + 2.0 * nn, 4.0 * nn * sizeof(float), [&]
+                                           { gemm(1.0f, a, b, 0.5f, c); });
+                        }});
+        list.push_back({"gemm_complex", productSizes, [=](const Options &o, int n)
+                        {
+                            // A complex multiply-add is 8 real flops
+                            ComplexMatrix a = ComplexMatrix::random(n, n, -1.0, 1.0), b = ComplexMatrix::random(n, n, -1.0, 1.0), c(n, n);
+                            const double nn = static_cast<double>(n) * n;
+                            const std::complex<double> alpha(1.0, 0.0), beta(0.5, 0.0);
+                            return measure(o, "gemm_complex", n, 8.0 * nn * n + 8.0 * nn, 8.0 * nn * word, [&]
+                                           { gemm(alpha, a, b, beta, c); });
+                        }});
+        list.push_back({"matrix_transpose_multiply", productSizes, [=](const Options &o, int n)
+                        {
+                            // A^T * B straight from the lazy transpose, no copy of A
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0), b = Matrix::random(n, n, -1.0, 1.0), c(n, n);
+                            const double nn = static_cast<double>(n) * n;
+                            return measure(o, "matrix_transpose_multiply", n, 2.0 * nn * n, 3.0 * nn * word, [&]
+                                           { gemm(1.0, a.t(), b, 0.0, c); });
+                        }});
+        list.push_back({"syrk", productSizes, [=](const Options &o, int n)
+                        {
+                            // X^T * X: half the multiply-adds of the general product
+                            Matrix x = Matrix::random(n, n, -1.0, 1.0), c(n, n);
+                            const double nn = static_cast<double>(n) * n;
+                            return measure(o, "syrk", n, nn * n, 2.0 * nn * word, [&]
+                                           { syrk(1.0, x.t(), 0.0, c); });
+                        }});
+        list.push_back({"matrix_transpose", matrixSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0);
+                            return measure(o, "matrix_transpose", n, 0.0, 2.0 * n * n * word, [&]
+                                           { Matrix t = a.transpose(); sink = t.getElement(0, 0); });
+                        }});
+        list.push_back({"matrix_transpose_in_place", matrixSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0);
+                            return measure(o, "matrix_transpose_in_place", n, 0.0, 2.0 * n * n * word, [&]
+                                           { a.transposeInPlace(); });
+                        }});
+        list.push_back({"matrix_add", matrixSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0), b = Matrix::random(n, n, -1.0, 1.0), c(n, n);
+                            return measure(o, "matrix_add", n, 1.0 * n * n, 3.0 * n * n * word, [&]
+                                           { c = a + b; });
+                        }});
+        list.push_back({"matrix_scale", matrixSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0), c(n, n);
+                            return measure(o, "matrix_scale", n, 1.0 * n * n, 2.0 * n * n * word, [&]
+                                           { c = a * 1.5; });
+                        }});
+        list.push_back({"matrix_fused_expression", matrixSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0), b = Matrix::random(n, n, -1.0, 1.0);
+                            Matrix c = Matrix::random(n, n, -1.0, 1.0), d(n, n);
+                            return measure(o, "matrix_fused_expression", n, 3.0 * n * n, 4.0 * n * n * word, [&]
+                                           { d = a + b * 2.0 - c; });
+                        }});
+        list.push_back({"matrix_axpy", matrixSizes, [=](const Options &o, int n)
+                        {
+                            Matrix x = Matrix::random(n, n, -1.0, 1.0), y = Matrix::random(n, n, -1.0, 1.0);
+                            return measure(o, "matrix_axpy", n, 2.0 * n * n, 3.0 * n * n * word, [&]
+                                           { axpy(1e-9, x, y); });
+                        }});
+        list.push_back({"matrix_random", matrixSizes, [=](const Options &o, int n)
+                        { return measure(o, "matrix_random", n, 0.0, 1.0 * n * n * word, [&]
+                                         { Matrix r = Matrix::random(n, n, -1.0, 1.0); sink = r.getElement(0, 0); }); }});
+        list.push_back({"random_fill_uniform", matrixSizes, [=](const Options &o, int n)
+                        {
+                            Matrix r(n, n);
+                            KaloAlgebra::RandomGenerator generator(1);
+                            return measure(o, "random_fill_uniform", n, 0.0, 1.0 * n * n * word, [&]
+                                           { generator.fillUniform(r.view(), -1.0, 1.0); sink = r.getElement(0, 0); });
+                        }});
+        list.push_back({"random_fill_normal", matrixSizes, [=](const Options &o, int n)
+                        {
+                            Matrix r(n, n);
+                            KaloAlgebra::RandomGenerator generator(1);
+                            return measure(o, "random_fill_normal", n, 0.0, 1.0 * n * n * word, [&]
+                                           { generator.fillNormal(r.view(), 0.0, 1.0); sink = r.getElement(0, 0); });
+                        }});
+
+        // Decompositions of a well-conditioned n x n matrix
+        list.push_back({"lu_factor", productSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0) + Matrix::identity(n) * static_cast<double>(n);
+                            const double nn = static_cast<double>(n) * n;
+                            return measure(o, "lu_factor", n, 2.0 / 3.0 * nn * n, 2.0 * nn * word, [&]
+                                           { LUDecomposition lu(a); sink = lu.determinant(); });
+                        }});
+        list.push_back({"lu_solve", matrixSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0) + Matrix::identity(n) * static_cast<double>(n);
+                            LUDecomposition lu(a);
+                            Vector b = Vector::random(n, -1.0, 1.0);
+                            return measure(o, "lu_solve", n, 2.0 * n * n, (1.0 * n * n + 2.0 * n) * word, [&]
+                                           { Vector x = b; lu.solveInPlace(x); sink = x.getElement(0); });
+                        }});
+
+        list.push_back({"cholesky_factor", productSizes, [=](const Options &o, int n)
+                        {
+                            Matrix g = Matrix::random(n, n, -1.0, 1.0);
+                            Matrix a = g * g.transpose() + Matrix::identity(n) * static_cast<double>(n);
+                            const double nn = static_cast<double>(n) * n;
+                            return measure(o, "cholesky_factor", n, nn * n / 3.0, 2.0 * nn * word, [&]
+                                           { CholeskyDecomposition llt(a); sink = llt.getInfo(); });
+                        }});
+
+        list.push_back({"qr_factor", productSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0);
+                            const double nn = static_cast<double>(n) * n;
+                            return measure(o, "qr_factor", n, 4.0 / 3.0 * nn * n, 2.0 * nn * word, [&]
+                                           { QRDecomposition qr(a); sink = qr.isFullRank(); });
+                        }});
+        // Symmetric eigenproblems: every eigenpair, and the 10 leading ones as in PCA
+        list.push_back({"symmetric_eigen", productSizes, [=](const Options &o, int n)
+                        {
+                            Matrix g = Matrix::random(n, n, -1.0, 1.0);
+                            Matrix a = g + g.transpose();
+                            const double nn = static_cast<double>(n) * n;
+                            return measure(o, "symmetric_eigen", n, 4.0 / 3.0 * nn * n + 2.0 * nn * n, 2.0 * nn * word, [&]
+                                           { SymmetricEigenDecomposition eigen(a); sink = eigen.getEigenvalues().getElement(0); });
+                        }});
+        list.push_back({"symmetric_eigen_top10", productSizes, [=](const Options &o, int n)
+                        {
+                            Matrix g = Matrix::random(n, n, -1.0, 1.0);
+                            Matrix a = g + g.transpose();
+                            const int count = std::min(n, 10);
+                            const double nn = static_cast<double>(n) * n;
+                            return measure(o, "symmetric_eigen_top10", n, 4.0 / 3.0 * nn * n + 2.0 * nn * count, (nn + 1.0 * n * count) * word, [&]
+                                           { SymmetricEigenDecomposition eigen(a, count); sink = eigen.getEigenvalues().getElement(0); });
+                        }});
+        // Regression-shaped least squares: n observations of 100 features (n if fewer, so the system is never wide)
+        list.push_back({"least_squares_tall", tallSizes, [=](const Options &o, int n)
+                        {
+                            const int features = std::min(n, 100);
+                            Matrix a = Matrix::random(n, features, -1.0, 1.0);
+                            Vector b = Vector::random(n, -1.0, 1.0);
+                            const double flops = 2.0 * n * features * features - 2.0 / 3.0 * features * features * features;
+                            return measure(o, "least_squares_tall", n, flops, 2.0 * n * features * word, [&]
+                                           { Vector x = leastSquares(a, b); sink = x.getElement(0); });
+                        }});
+
+        // Matrix-vector operations on an n x n matrix
+        list.push_back({"matrix_vector_multiply", matrixSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0);
+                            Vector x = Vector::random(n, -1.0, 1.0), y(n);
+                            return measure(o, "matrix_vector_multiply", n, 2.0 * n * n, (1.0 * n * n + 2.0 * n) * word, [&]
+                                           { multiply(a, x, y); });
+                        }});
+        list.push_back({"vector_matrix_multiply", matrixSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0);
+                            Vector x = Vector::random(n, -1.0, 1.0);
+                            return measure(o, "vector_matrix_multiply", n, 2.0 * n * n, (1.0 * n * n + 2.0 * n) * word, [&]
+                                           { Vector y = x * a; sink = y.getElement(0); });
+                        }});
+        list.push_back({"ger", matrixSizes, [=](const Options &o, int n)
+                        {
+                            Matrix a = Matrix::random(n, n, -1.0, 1.0);
+                            Vector x = Vector::random(n, -1.0, 1.0), y = Vector::random(n, -1.0, 1.0);
+                            return measure(o, "ger", n, 2.0 * n * n, (2.0 * n * n + 2.0 * n) * word, [&]
+                                           { ger(1e-9, x, y, a); });
+                        }});
+
+        // Sparse products on an n x n banded matrix with 16 nonzeros per row, like a discretized stencil
+        auto sparseMatrix = [](int n)
+        {
+            std::vector<SparseMatrix::Triplet> triplets;
+            triplets.reserve(static_cast<std::size_t>(n) * 16);
+            for (int i = 0; i < n; i++)
+                for (int k = 0; k < 16; k++)
+                    triplets.push_back({i, (i + k * 61) % n, 1.0 / (k + 1)});
+            return SparseMatrix::fromTriplets(n, n, triplets);
+        };
+        list.push_back({"sparse_matrix_vector_multiply", vectorSizes, [=](const Options &o, int n)
+                        {
+                            SparseMatrix a = sparseMatrix(n);
+                            Vector x = Vector::random(n, -1.0, 1.0), y(n);
+                            const double nonZeros = static_cast<double>(a.getNonZeros());
+                            return measure(o, "sparse_matrix_vector_multiply", n, 2.0 * nonZeros, nonZeros * 12.0 + 3.0 * n * word, [&]
+                                           { multiply(a, x, y); });
+                        }});
+        list.push_back({"sparse_matrix_multiply", vectorSizes, [=](const Options &o, int n)
+                        {
+                            const int width = 16;
+                            SparseMatrix a = sparseMatrix(n);
+                            Matrix b = Matrix::random(n, width, -1.0, 1.0), c(n, width);
+                            const double nonZeros = static_cast<double>(a.getNonZeros());
+                            return measure(o, "sparse_matrix_multiply", n, 2.0 * nonZeros * width, nonZeros * 12.0 + 2.0 * n * width * word, [&]
+                                           { multiply(a, b, c); });
+                        }});
+
+        // 20 ILU(0)-preconditioned iterations of each Krylov solver on the 5-point Laplacian of a
+        // sqrt(n) x sqrt(n) grid; the flop counts are per iteration, times 20
+        auto laplacian = [](int n)
+        {
+            const int m = static_cast<int>(std::lround(std::sqrt(static_cast<double>(n))));
+            std::vector<SparseMatrix::Triplet> triplets;
+            triplets.reserve(static_cast<std::size_t>(m) * m * 5);
+            for (int i = 0; i < m; i++)
+                for (int j = 0; j < m; j++)
+                {
+                    const int row = i * m + j;
+                    triplets.push_back({row, row, 4.0});
+                    if (i > 0)
+                        triplets.push_back({row, row - m, -1.0});
+                    if (i + 1 < m)
+                        triplets.push_back({row, row + m, -1.0});
+                    if (j > 0)
+                        triplets.push_back({row, row - 1, -1.1});
+                    if (j + 1 < m)
+                        triplets.push_back({row, row + 1, -0.9});
+                }
+            return SparseMatrix::fromTriplets(m * m, m * m, triplets);
+        };
+        const std::pair<const char *, IterativeMethod> krylovMethods[] = {
+            {"conjugate_gradient_ilu0", IterativeMethod::ConjugateGradient}, {"bicgstab_ilu0", IterativeMethod::BiCGSTAB}, {"gmres_ilu0", IterativeMethod::GMRES}};
+        for (const auto &krylov : krylovMethods)
+        {
+            const std::string name = krylov.first;
+            const IterativeMethod method = krylov.second;
+            list.push_back({name, vectorSizes, [=](const Options &o, int n)
+                            {
+                                SparseMatrix a = laplacian(n);
+                                const int size = a.getRows();
+                                ILU0Preconditioner ilu(a);
+                                IterativeSolver solver(method, size, 20);
+                                solver.setPreconditioner(&ilu);
+                                solver.setTolerance(0.0);
+                                solver.setMaxIterations(20);
+                                Vector b = Vector::random(size, -1.0, 1.0), x(size);
+                                const double products = method == IterativeMethod::BiCGSTAB ? 2.0 : 1.0, nonZeros = static_cast<double>(a.getNonZeros());
+                                const double vectorOps = method == IterativeMethod::GMRES ? 4.0 * 10.0 : 12.0; // GMRES: two Gram-Schmidt passes over about 10 basis vectors
+                                const double flops = 20.0 * products * (4.0 * nonZeros + vectorOps * size);
+                                return measure(o, name, size, flops, 20.0 * products * (3.0 * nonZeros * 12.0 + vectorOps * size * word), [&]
+                                               { x *= 0.0; solver.solve(a, b, x); sink = x.getElement(0); });
+                            }});
+        }
+
+        // Value-returning arithmetic on small n x n operands, where allocation dominates, with the
+        // global heap and inside an arena scope
+        for (const bool arena : {false, true})
+        {
+            const std::string name = arena ? "matrix_temporaries_arena" : "matrix_temporaries";
+            list.push_back({name, temporarySizes, [=](const Options &o, int n)
+                            {
+                                Matrix a = Matrix::random(n, n, -1.0, 1.0), b = Matrix::random(n, n, -1.0, 1.0);
+                                const double nn = static_cast<double>(n) * n;
+                                return measure(o, name, n, 4.0 * nn, 8.0 * nn * word, [&]
+                                               {
+                                                   std::optional<KaloAlgebra::ArenaScope> scope;
+                                                   if (arena)
+                                                       scope.emplace();
+                                                   Matrix sum = a + b;
+                                                   Matrix scaled = sum * 0.5 - a;
+                                                   Matrix transposed = scaled.transpose();
+                                                   sink = transposed.getElement(0, 0); });
+                            }});
+        }
+
+        // Reading an n x n matrix file back: copied into a Matrix, or mapped and read in place
+        for (const bool mapped : {false, true})
+        {
+            const std::string name = mapped ? "matrix_load_mapped" : "matrix_load";
+            list.push_back({name, matrixSizes, [=](const Options &o, int n)
+                            {
+                                const std::string path = (std::filesystem::temp_directory_path() / ("kalo_algebra_" + name + ".kmat")).string();
+                                KaloAlgebra::save(path, Matrix::random(n, n, -1.0, 1.0));
+                                const double nn = static_cast<double>(n) * n;
+                                Result result = measure(o, name, n, 0.0, nn * word, [&]
+                                                        {
+                                                            if (mapped)
+                                                            {
+                                                                KaloAlgebra::MappedMatrix m = KaloAlgebra::loadMapped(path);
+                                                                sink = m.getElement(n - 1, n - 1);
+                                                            }
+                                                            else
+                                                            {
+                                                                Matrix m = KaloAlgebra::load(path);
+                                                                sink = m.getElement(n - 1, n - 1);
+                                                            } });
+                                std::filesystem::remove(path);
+                                return result;
+                            }});
+        }
+
+        // n x n product of mapped files into a file, with a budget of a quarter of one operand
+        list.push_back({"matrix_multiply_out_of_core", productSizes, [=](const Options &o, int n)
+                        {
+                            const std::filesystem::path directory = std::filesystem::temp_directory_path();
+                            const std::string aPath = (directory / "kalo_algebra_ooc_a.kmat").string();
+                            const std::string bPath = (directory / "kalo_algebra_ooc_b.kmat").string();
+                            const std::string cPath = (directory / "kalo_algebra_ooc_c.kmat").string();
+                            KaloAlgebra::save(aPath, Matrix::random(n, n, -1.0, 1.0));
+                            KaloAlgebra::save(bPath, Matrix::random(n, n, -1.0, 1.0));
+                            const std::size_t budget = static_cast<std::size_t>(n) * n * sizeof(double) / 4;
+                            const double nn = static_cast<double>(n) * n;
+                            Result result;
+                            {
+                                KaloAlgebra::MappedMatrix a = KaloAlgebra::loadMapped(aPath), b = KaloAlgebra::loadMapped(bPath);
+                                const int tile = std::max(1, KaloAlgebra::outOfCoreTileSize<double>(budget));
+                                result = measure(o, "matrix_multiply_out_of_core", n, 2.0 * nn * n, (2.0 * nn * n / tile + nn) * word, [&]
+                                                 { KaloAlgebra::multiplyOutOfCore(a, b, cPath, budget); });
+                            }
+                            for (const std::string &path : {aPath, bPath, cPath})
+                                std::filesystem::remove(path);
+                            return result;
+                        }});
+
+        // Vector operations on n elements
+        list.push_back({"vector_dot", vectorSizes, [=](const Options &o, int n)
+                        {
+                            Vector a = Vector::random(n, -1.0, 1.0), b = Vector::random(n, -1.0, 1.0);
+                            return measure(o, "vector_dot", n, 2.0 * n, 2.0 * n * word, [&]
+                                           { sink = a.dot(b); });
+                        }});
+        list.push_back({"vector_magnitude", vectorSizes, [=](const Options &o, int n)
+                        {
+                            Vector a = Vector::random(n, -1.0, 1.0);
+                            return measure(o, "vector_magnitude", n, 2.0 * n, 1.0 * n * word, [&]
+                                           { sink = a.magnitude(); });
+                        }});
+        list.push_back({"vector_add", vectorSizes, [=](const Options &o, int n)
+                        {
+                            Vector a = Vector::random(n, -1.0, 1.0), b = Vector::random(n, -1.0, 1.0), c(n);
+                            return measure(o, "vector_add", n, 1.0 * n, 3.0 * n * word, [&]
+                                           { add(a, b, c); });
+                        }});
+        list.push_back({"vector_scale", vectorSizes, [=](const Options &o, int n)
+                        {
+                            Vector a = Vector::random(n, -1.0, 1.0), c(n);
+                            return measure(o, "vector_scale", n, 1.0 * n, 2.0 * n * word, [&]
+                                           { c = a * 1.5; });
+                        }});
+        list.push_back({"vector_hadamard", vectorSizes, [=](const Options &o, int n)
+                        {
+                            Vector a = Vector::random(n, -1.0, 1.0), b = Vector::random(n, -1.0, 1.0), c(n);
+                            return measure(o, "vector_hadamard", n, 1.0 * n, 3.0 * n * word, [&]
+                                           { hadamard(a, b, c); });
+                        }});
+        list.push_back({"vector_axpy", vectorSizes, [=](const Options &o, int n)
+                        {
+                            Vector x = Vector::random(n, -1.0, 1.0), y = Vector::random(n, -1.0, 1.0);
+                            return measure(o, "vector_axpy", n, 2.0 * n, 3.0 * n * word, [&]
+                                           { axpy(1e-9, x, y); });
+                        }});
+        list.push_back({"vector_normalize", vectorSizes, [=](const Options &o, int n)
+                        {
+                            Vector a = Vector::random(n, -1.0, 1.0);
+                            return measure(o, "vector_normalize", n, 3.0 * n, 3.0 * n * word, [&]
+                                           { Vector u = a.normalize(); sink = u.getElement(0); });
+                        }});
+
+        // Fixed-size operations on n bodies: one rotation, cross product and integration step each
+        list.push_back({"fixed_rigid_body_step", vectorSizes, [=](const Options &o, int n)
+                        {
+                            std::vector<Vector3> positions(n, Vector3(1.0, 2.0, 3.0)), velocities(n, Vector3(0.5, -0.5, 0.25));
+                            const Matrix3 rotation(0.0, -1.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0);
+                            const Vector3 spin(0.0, 0.0, 0.1);
+                            return measure(o, "fixed_rigid_body_step", n, 36.0 * n, 12.0 * n * word, [&]
+                                           {
+                                               for (int i = 0; i < n; i++)
+                                               {
+                                                   velocities[i] = rotation * velocities[i] + spin.cross(positions[i]) * 1e-3;
+                                                   positions[i] += velocities[i] * 1e-3;
+                                               }
+                                               sink = positions[0][0]; });
+                        }});
+
+        // n independent 4x4 transforms: one Matrix product each, then the batched kernels
+        list.push_back({"matrix_multiply_4x4_each", vectorSizes, [=](const Options &o, int n)
+                        {
+                            std::vector<Matrix> a(n, Matrix::random(4, 4, -1.0, 1.0)), b(n, Matrix::random(4, 4, -1.0, 1.0)), c(n, Matrix(4, 4));
+                            return measure(o, "matrix_multiply_4x4_each", n, 128.0 * n, 48.0 * n * word, [&]
+                                           {
+                                               for (int i = 0; i < n; i++)
+                                                   KaloAlgebra::multiply(a[i], b[i], c[i]);
+                                               sink = c[0].getElement(0, 0); });
+                        }});
+        list.push_back({"batch_multiply_4x4", vectorSizes, [=](const Options &o, int n)
+                        {
+                            KaloAlgebra::MatrixBatch a(n, 4, 4, 0.5), b(n, 4, 4, 0.25), c(n, 4, 4);
+                            return measure(o, "batch_multiply_4x4", n, 128.0 * n, 48.0 * n * word, [&]
+                                           {
+                                               KaloAlgebra::multiply(a, b, c);
+                                               sink = c.getElement(0, 0, 0); });
+                        }});
+        list.push_back({"batch_multiply_vector_4x4", vectorSizes, [=](const Options &o, int n)
+                        {
+                            KaloAlgebra::MatrixBatch a(n, 4, 4, 0.5);
+                            KaloAlgebra::VectorBatch x(n, 4, 0.25), y(n, 4);
+                            return measure(o, "batch_multiply_vector_4x4", n, 32.0 * n, 24.0 * n * word, [&]
+                                           {
+                                               KaloAlgebra::multiply(a, x, y);
+                                               sink = y.getElement(0, 0); });
+                        }});
+        list.push_back({"batch_inverse_4x4", vectorSizes, [=](const Options &o, int n)
+                        {
+                            KaloAlgebra::MatrixBatch a = KaloAlgebra::MatrixBatch::identity(n, 4);
+                            for (int i = 0; i < n; i++)
+                                a.setElement(i, 0, 3, 0.5);
+                            return measure(o, "batch_inverse_4x4", n, 128.0 * n, 32.0 * n * word, [&]
+                                           {
+                                               KaloAlgebra::MatrixBatch inverse = a.inverse();
+                                               sink = inverse.getElement(0, 0, 0); });
+                        }});
+        list.push_back({"batch_transpose_4x4", vectorSizes, [=](const Options &o, int n)
+                        {
+                            KaloAlgebra::MatrixBatch a(n, 4, 4, 0.5);
+                            return measure(o, "batch_transpose_4x4", n, 0.0, 32.0 * n * word, [&]
+                                           {
+                                               KaloAlgebra::MatrixBatch t = a.transpose();
+                                               sink = t.getElement(0, 0, 0); });
+                        }});
+        return list;
+    }
+
+    std::vector<int> parseSizes(const std::string &text)
+    {
+        std::vector<int> sizes;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            const int size = std::atoi(item.c_str());
+            if (size <= 0)
+                throw std::invalid_argument("Sizes must be positive integers: " + text);
+            sizes.push_back(size);
+        }
+        return sizes;
+    }
+
+    KaloAlgebra::Isa parseIsa(const std::string &name)
+    {
+        for (KaloAlgebra::Isa isa : {KaloAlgebra::Isa::Scalar, KaloAlgebra::Isa::SSE2, KaloAlgebra::Isa::AVX2, KaloAlgebra::Isa::AVX512})
+        {
+            if (name == KaloAlgebraSimd::isaName(isa))
+                return isa;
+        }
+        throw std::invalid_argument("Unknown instruction set: " + name);
+    }
+
+    std::string context()
+    {
+        std::ostringstream text;
+        text << "\"isa\": \"" << KaloAlgebraSimd::isaName(KaloAlgebra::activeIsa()) << "\", "
+             << "\"threads\": " << KaloAlgebra::getThreadCount() << ", "
+             << "\"build_type\": \"" << KALO_ALGEBRA_BUILD_TYPE << "\", "
+#if defined(__clang__)
+             << "\"compiler\": \"clang " << __clang_major__ << "." << __clang_minor__ << "\"";
+#elif defined(__GNUC__)
+             << "\"compiler\": \"gcc " << __GNUC__ << "." << __GNUC_MINOR__ << "\"";
+#else
+             << "\"compiler\": \"unknown\"";
+#endif
+        return text.str();
+    }
+
+    void writeTable(std::ostream &out, const std::vector<Result> &results)
+    {
+        out << "# " << context() << "\n";
+        char line[160];
+        std::snprintf(line, sizeof(line), "%-28s %9s %8s %14s %14s %10s %10s\n",
+                      "benchmark", "size", "iters", "best", "median", "GFLOP/s", "GB/s");
+        out << line;
+        for (const Result &r : results)
+        {
+            std::snprintf(line, sizeof(line), "%-28s %9d %8d %11.3f us %11.3f us %10.2f %10.2f\n",
+                          r.name.c_str(), r.size, r.iterations, r.bestSeconds * 1e6, r.medianSeconds * 1e6, r.gflops(), r.gbps());
+            out << line;
+        }
+    }
+
+    // One benchmark per line, so --compare can read a baseline back without a JSON library
+    void writeJson(std::ostream &out, const std::vector<Result> &results)
+    {
+        out << "{\n  \"context\": {" << context() << "},\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+            const Result &r = results[i];
+            char line[320];
+            std::snprintf(line, sizeof(line),
+                          "    {\"name\": \"%s\", \"size\": %d, \"iterations\": %d, \"best_ns\": %.1f, \"median_ns\": %.1f, "
+                          "\"gflops\": %.4f, \"gbps\": %.4f}%s\n",
+                          r.name.c_str(), r.size, r.iterations, r.bestSeconds * 1e9, r.medianSeconds * 1e9,
+                          r.gflops(), r.gbps(), i + 1 < results.size() ? "," : "");
+            out << line;
+        }
+        out << "  ]\n}\n";
+    }
+
+    void writeCsv(std::ostream &out, const std::vector<Result> &results)
+    {
+        out << "name,size,iterations,best_ns,median_ns,gflops,gbps\n";
+        for (const Result &r : results)
+        {
+            char line[200];
+            std::snprintf(line, sizeof(line), "%s,%d,%d,%.1f,%.1f,%.4f,%.4f\n", r.name.c_str(), r.size, r.iterations,
+                          r.bestSeconds * 1e9, r.medianSeconds * 1e9, r.gflops(), r.gbps());
+            out << line;
+        }
+    }
+
+    // Best times of a JSON file written by this program, keyed by "name/size"
+    std::map<std::string, double> readBaseline(const std::string &path)
+    {
+        std::ifstream in(path);
+        if (!in)
+            throw std::invalid_argument("Cannot open baseline " + path);
+        std::map<std::string, double> baseline;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            char name[128];
+            int size;
+            double best;
+            const char *entry = std::strstr(line.c_str(), "{\"name\"");
+            if (entry && std::sscanf(entry, "{\"name\": \"%127[^\"]\", \"size\": %d, \"iterations\": %*d, \"best_ns\": %lf", name, &size, &best) == 3)
+                baseline[std::string(name) + "/" + std::to_string(size)] = best * 1e-9;
+        }
+        return baseline;
+    }
+
+    // Prints every benchmark slower than the baseline by more than the tolerance; returns how many
+    int compareWithBaseline(const std::vector<Result> &results, const Options &options)
+    {
+        const std::map<std::string, double> baseline = readBaseline(options.compare);
+        int regressions = 0;
+        for (const Result &r : results)
+        {
+            const auto match = baseline.find(r.name + "/" + std::to_string(r.size));
+            if (match == baseline.end())
+                continue;
+            const double ratio = r.bestSeconds / match->second;
+            if (ratio > 1.0 + options.tolerance)
+            {
+                std::fprintf(stderr, "REGRESSION %s/%d: %.3f us -> %.3f us (%+.1f%%)\n", r.name.c_str(), r.size,
+                             match->second * 1e6, r.bestSeconds * 1e6, (ratio - 1.0) * 100.0);
+                regressions++;
+            }
+        }
+        std::fprintf(stderr, "%d regression(s) against %s\n", regressions, options.compare.c_str());
+        return regressions;
+    }
+
+    Options parseOptions(int argc, char **argv)
+    {
+        Options options;
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string flag = argv[i];
+            if (flag == "--help" || flag == "-h")
+            {
+                std::cout << "benchmark [--filter substring] [--sizes n,n,...] [--min-time seconds] [--repeat count]\n"
+                             "          [--threads count] [--isa scalar|sse2|avx2|avx512] [--format table|json|csv]\n"
+                             "          [--output file] [--compare baseline.json] [--tolerance fraction]\n";
+                std::exit(0);
+            }
+            if (i + 1 >= argc)
+                throw std::invalid_argument("Missing value for " + flag);
+            const std::string value = argv[++i];
+            if (flag == "--filter")
+                options.filter = value;
+            else if (flag == "--sizes")
+                options.sizes = parseSizes(value);
+            else if (flag == "--min-time")
+                options.minTime = std::atof(value.c_str());
+            else if (flag == "--repeat")
+                options.repeat = std::max(1, std::atoi(value.c_str()));
+            else if (flag == "--threads")
+                KaloAlgebra::setThreadCount(std::atoi(value.c_str()));
+            else if (flag == "--isa")
+                KaloAlgebra::forceIsa(parseIsa(value));
+            else if (flag == "--format")
+                options.format = value;
+            else if (flag == "--output")
+                options.output = value;
+            else if (flag == "--compare")
+                options.compare = value;
+            else if (flag == "--tolerance")
+                options.tolerance = std::atof(value.c_str());
+            else
+                throw std::invalid_argument("Unknown option " + flag);
+        }
+        if (options.format != "table" && options.format != "json" && options.format != "csv")
+            throw std::invalid_argument("Format must be table, json or csv");
+        return options;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const Options options = parseOptions(argc, argv);
+
+        std::vector<Result> results;
+        for (const Benchmark &benchmark : benchmarks())
+        {
+            if (benchmark.name.find(options.filter) == std::string::npos)
+                continue;
+            for (int size : options.sizes.empty() ? benchmark.sizes : options.sizes)
+            {
+                results.push_back(benchmark.run(options, size));
+            }
+        }
+
+        std::ofstream file;
+        if (!options.output.empty())
+        {
+            file.open(options.output);
+            if (!file)
+                throw std::invalid_argument("Cannot write " + options.output);
+        }
+        std::ostream &out = options.output.empty() ? std::cout : file;
+        if (options.format == "json")
+            writeJson(out, results);
+        else if (options.format == "csv")
+            writeCsv(out, results);
+        else
+            writeTable(out, results);
+
+        if (!options.compare.empty() && compareWithBaseline(results, options) > 0)
+            return 1;
+    }
+    catch (const std::exception &error)
+    {
+        std::cerr << "benchmark: " << error.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>   // For std::size_t
+#include <new>       // For aligned operator new/delete
+#include <limits>    // For std::numeric_limits
+#include <type_traits> // For std::is_nothrow_default_constructible, std::true_type
+#include <utility>   // For std::forward
+#include "instrumentation.hpp"
+
+namespace KaloAlgebraUtils
+{
+    // Alignment (in bytes) used for all matrix and vector storage: one cache line,
+    // which is also wide enough for AVX-512 aligned loads
+    constexpr std::size_t storageAlignment = 64;
+
+    // Minimal std::allocator replacement that hands out storageAlignment-aligned blocks
+    template <typename T, std::size_t Alignment = storageAlignment>
+    class AlignedAllocator
+    {
+    public:
+        using value_type = T;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() noexcept = default;
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+        T *allocate(std::size_t count)
+        {
+            if (count > std::numeric_limits<std::size_t>::max() / sizeof(T))
+                throw std::bad_array_new_length();
+            return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+        }
+
+        void deallocate(T *pointer, std::size_t) noexcept
+        {
+            ::operator delete(pointer, std::align_val_t(Alignment));
+        }
+
+        // Value-less construction default-initializes, so resize() leaves new doubles unwritten
+        // and results that are about to be overwritten are not zero-filled first
+        template <typename U>
+        void construct(U *pointer) noexcept(std::is_nothrow_default_constructible<U>::value)
+        {
+            ::new (static_cast<void *>(pointer)) U;
+        }
+
+        template <typename U, typename... Args>
+        void construct(U *pointer, Args &&...args)
+        {
+            ::new (static_cast<void *>(pointer)) U(std::forward<Args>(args)...);
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept { return true; }
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept { return false; }
+    };
+
+    // Source of raw memory for Matrix and Vector storage. Implementations hand out blocks of at
+    // least the requested size and alignment; see arena.hpp for the bump arena.
+    class MemoryResource
+    {
+    public:
+        virtual ~MemoryResource() = default;
+        virtual void *allocate(std::size_t bytes, std::size_t alignment) = 0;
+        virtual void deallocate(void *pointer, std::size_t bytes, std::size_t alignment) noexcept = 0;
+    };
+
+    MemoryResource *heapResource();    // Aligned global operator new/delete, the default
+    MemoryResource *currentResource(); // What containers created on this thread allocate from (see ResourceScope)
+
+    // Allocator of the Matrix and Vector storage: aligned like AlignedAllocator, drawing from the
+    // memory resource that was current on the constructing thread. A copy-constructed container
+    // takes the resource current at the copy, not the source's, and assignments keep the
+    // destination's resource, so a result can always be copied or assigned out of an arena scope.
+    template <typename T, std::size_t Alignment = storageAlignment>
+    class ResourceAllocator
+    {
+    private:
+        MemoryResource *resource;
+
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::false_type;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = ResourceAllocator<U, Alignment>;
+        };
+
+        ResourceAllocator() noexcept : resource(currentResource()) {}
+        explicit ResourceAllocator(MemoryResource *resource) noexcept : resource(resource) {}
+        template <typename U>
+        ResourceAllocator(const ResourceAllocator<U, Alignment> &other) noexcept : resource(other.getResource()) {}
+
+        MemoryResource *getResource() const noexcept { return resource; }
+
+        T *allocate(std::size_t count)
+        {
+            if (count > std::numeric_limits<std::size_t>::max() / sizeof(T))
+                throw std::bad_array_new_length();
+#ifdef KALO_ALGEBRA_INSTRUMENTATION
+            KaloAlgebraInstrumentation::recordAllocation(static_cast<long long>(count * sizeof(T)));
+#endif
+            return static_cast<T *>(resource->allocate(count * sizeof(T), Alignment));
+        }
+
+        void deallocate(T *pointer, std::size_t count) noexcept
+        {
+            resource->deallocate(pointer, count * sizeof(T), Alignment);
+        }
+
+        // Default-initializes on value-less construction, as AlignedAllocator does
+        template <typename U>
+        void construct(U *pointer) noexcept(std::is_nothrow_default_constructible<U>::value)
+        {
+            ::new (static_cast<void *>(pointer)) U;
+        }
+
+        template <typename U, typename... Args>
+        void construct(U *pointer, Args &&...args)
+        {
+            ::new (static_cast<void *>(pointer)) U(std::forward<Args>(args)...);
+        }
+
+        ResourceAllocator select_on_container_copy_construction() const noexcept { return ResourceAllocator(); }
+
+        template <typename U>
+        bool operator==(const ResourceAllocator<U, Alignment> &other) const noexcept { return resource == other.getResource(); }
+        template <typename U>
+        bool operator!=(const ResourceAllocator<U, Alignment> &other) const noexcept { return resource != other.getResource(); }
+    };
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef> // For std::size_t
+#include <vector>  // For std::vector
+#include "allocator.hpp"
+
+// Scoped allocation for temporaries. Matrix and Vector draw their storage from the thread's
+// current MemoryResource (allocator.hpp), which is the aligned heap unless a ResourceScope is
+// active. An ArenaScope points it at the thread's bump arena:
+//
+//     {
+//         KaloAlgebra::ArenaScope scope;
+//         Matrix t = a * b + c;  // storage bumped from the arena
+//         result = t * d;        // result was created outside: its own storage is kept
+//     }                          // everything allocated in the scope is released at once
+//
+// Storage allocated in a scope is only valid until the scope ends. Results that must outlive it
+// are assigned into a container created outside the scope, or copy-constructed after it.
+namespace KaloAlgebraUtils
+{
+    // Bump allocator over a list of chunks. Allocation advances an offset; deallocation is free
+    // except for the most recent block, which is popped so loop temporaries reuse the same bytes.
+    // Rewinding releases everything allocated after a mark, keeping the chunks for reuse, so a
+    // warmed-up arena does not touch the heap at all. Not thread-safe: each thread has its own.
+    class Arena : public MemoryResource
+    {
+    public:
+        struct Mark
+        {
+            std::size_t chunk;
+            std::size_t offset;
+        };
+
+        explicit Arena(std::size_t chunkBytes = std::size_t(1) << 20); // Size of each chunk (larger blocks get a chunk of their own)
+        ~Arena() override;
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        void *allocate(std::size_t bytes, std::size_t alignment) override;
+        void deallocate(void *pointer, std::size_t bytes, std::size_t alignment) noexcept override;
+
+        Mark mark() const noexcept { return Mark{current, offset}; } // The current position
+        void rewind(Mark position) noexcept;                         // Release everything allocated after position
+        void reset() noexcept { rewind(Mark{0, 0}); }                // Release everything
+        std::size_t getCapacity() const noexcept;                    // Bytes held in chunks
+        std::size_t getBytesUsed() const noexcept;                   // Bytes up to the current position
+
+    private:
+        struct Chunk
+        {
+            char *data;
+            std::size_t size;
+        };
+
+        std::vector<Chunk> chunks;
+        std::size_t chunkBytes;
+        std::size_t current = 0; // chunk being bumped
+        std::size_t offset = 0;  // first free byte in it
+    };
+
+    Arena &threadArena(); // This thread's arena, used by ArenaScope
+
+    // Makes resource current on this thread for the scope's lifetime (restoring the previous one
+    // afterwards), so containers created inside allocate from it
+    class ResourceScope
+    {
+    public:
+        explicit ResourceScope(MemoryResource &resource);
+        ~ResourceScope();
+        ResourceScope(const ResourceScope &) = delete;
+        ResourceScope &operator=(const ResourceScope &) = delete;
+
+    private:
+        MemoryResource *previous;
+    };
+
+    // Allocates from threadArena() for the scope's lifetime and releases it all at the end.
+    // Scopes nest: an inner scope only releases what was allocated inside it.
+    class ArenaScope
+    {
+    public:
+        ArenaScope();
+        ~ArenaScope();
+        ArenaScope(const ArenaScope &) = delete;
+        ArenaScope &operator=(const ArenaScope &) = delete;
+
+    private:
+        Arena &arena;
+        Arena::Mark start;
+        ResourceScope scope;
+    };
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <vector>    // For std::vector
+#include <stdexcept> // For std::invalid_argument
+#include "allocator.hpp"
+#include "matrix.hpp"
+#include "vector.hpp"
+#include "view.hpp"
+
+// Batches of same-shaped small matrices and vectors, for millions of independent 3x3 or 4x4
+// transforms at once. Storage is interleaved structure-of-arrays: the batch is cut into blocks of
+// `lanes` items (one cache line of scalars), and within a block element (i, j) of every item is
+// stored contiguously. A kernel therefore processes a whole block with one vector instruction per
+// element: 16 floats or 8 doubles per AVX-512 register. The blocks are split across the thread
+// pool. Supported for float and double.
+//
+//     item m, element (i, j)  ->  data()[((m / lanes) * rows * cols + i * cols + j) * lanes + m % lanes]
+//
+// The lanes of the last block past getCount() are padding: kernels compute them too, but they are
+// never read back and do not raise errors.
+template <typename T>
+class BasicMatrixBatch
+{
+public:
+    using value_type = T;
+    using allocator_type = KaloAlgebraUtils::ResourceAllocator<T>;
+    static constexpr int lanes = static_cast<int>(KaloAlgebraUtils::storageAlignment / sizeof(T));
+
+private:
+    std::vector<T, allocator_type> storage;
+    int count, rows, cols;
+
+public:
+    BasicMatrixBatch(int count, int rows, int cols, T initialValue = T(0)); // count matrices of rows x cols
+
+    // Accessors
+    int getCount() const { return count; }
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    int getBlockCount() const { return (count + lanes - 1) / lanes; }
+    T getElement(int index, int row, int col) const;       // Element (row, col) of matrix index
+    void setElement(int index, int row, int col, T value); // Set element (row, col) of matrix index
+    BasicMatrix<T> getMatrix(int index) const;             // Copy matrix index out
+    void setMatrix(int index, MatrixViewOf<const T> matrix); // Copy a rows x cols matrix (or a FixedMatrix's view()) in
+
+    // Raw storage in the layout above, 64-byte aligned, getBlockCount() * rows * cols * lanes elements
+    T *data() { return storage.data(); }
+    const T *data() const { return storage.data(); }
+
+    // Batched operations, one result per item
+    BasicMatrixBatch transpose() const; // Transpose every matrix
+    BasicMatrixBatch inverse() const;   // Invert every matrix, throws if any is singular
+
+    static BasicMatrixBatch identity(int count, int size); // count identity matrices
+};
+
+template <typename T>
+class BasicVectorBatch
+{
+public:
+    using value_type = T;
+    using allocator_type = KaloAlgebraUtils::ResourceAllocator<T>;
+    static constexpr int lanes = BasicMatrixBatch<T>::lanes;
+
+private:
+    std::vector<T, allocator_type> storage;
+    int count, size;
+
+public:
+    BasicVectorBatch(int count, int size, T initialValue = T(0)); // count vectors of size elements
+
+    // Accessors
+    int getCount() const { return count; }
+    int getSize() const { return size; }
+    int getBlockCount() const { return (count + lanes - 1) / lanes; }
+    T getElement(int index, int element) const;
+    void setElement(int index, int element, T value);
+    BasicVector<T> getVector(int index) const;
+    void setVector(int index, VectorViewOf<const T> vector);
+
+    // Raw storage: element e of vector m is at data()[((m / lanes) * size + e) * lanes + m % lanes]
+    T *data() { return storage.data(); }
+    const T *data() const { return storage.data(); }
+};
+
+using MatrixBatch = BasicMatrixBatch<double>;
+using FloatMatrixBatch = BasicMatrixBatch<float>;
+using VectorBatch = BasicVectorBatch<double>;
+using FloatVectorBatch = BasicVectorBatch<float>;
+
+// Output-parameter batched operations: out is resized only if its shape differs, so a loop
+// reusing it does not allocate. out must not be one of the operands of a product.
+template <typename T>
+void add(const BasicMatrixBatch<T> &A, const BasicMatrixBatch<T> &B, BasicMatrixBatch<T> &out);
+template <typename T>
+void subtract(const BasicMatrixBatch<T> &A, const BasicMatrixBatch<T> &B, BasicMatrixBatch<T> &out);
+template <typename T>
+void multiply(const BasicMatrixBatch<T> &A, const BasicMatrixBatch<T> &B, BasicMatrixBatch<T> &out); // out[m] = A[m] * B[m]
+template <typename T>
+void multiply(const BasicMatrixBatch<T> &A, const BasicVectorBatch<T> &x, BasicVectorBatch<T> &out); // out[m] = A[m] * x[m]
+
+// Value-returning forms
+template <typename T>
+BasicMatrixBatch<T> operator+(const BasicMatrixBatch<T> &A, const BasicMatrixBatch<T> &B)
+{
+    BasicMatrixBatch<T> result(A.getCount(), A.getRows(), A.getCols());
+    add(A, B, result);
+    return result;
+}
+
+template <typename T>
+BasicMatrixBatch<T> operator-(const BasicMatrixBatch<T> &A, const BasicMatrixBatch<T> &B)
+{
+    BasicMatrixBatch<T> result(A.getCount(), A.getRows(), A.getCols());
+    subtract(A, B, result);
+    return result;
+}
+
+template <typename T>
+BasicMatrixBatch<T> operator*(const BasicMatrixBatch<T> &A, const BasicMatrixBatch<T> &B)
+{
+    BasicMatrixBatch<T> result(A.getCount(), A.getRows(), B.getCols());
+    multiply(A, B, result);
+    return result;
+}
+
+template <typename T>
+BasicVectorBatch<T> operator*(const BasicMatrixBatch<T> &A, const BasicVectorBatch<T> &x)
+{
+    BasicVectorBatch<T> result(A.getCount(), A.getRows());
+    multiply(A, x, result);
+    return result;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "matrix.hpp"
+#include "vector.hpp"
+
+// Cholesky factorization, A = L * L^T, of a symmetric positive-definite matrix.
+//
+// Only the lower triangle of A is read. The factorization costs about half the flops of LU and
+// needs no pivoting; like LUDecomposition it is blocked, with the trailing updates done by GEMM
+// on the lower triangle only, and the factor is reused across solves.
+//
+// A matrix that is not positive definite does not throw: the factorization stops at the first
+// non-positive pivot and getInfo() reports where (LAPACK's potrf convention). Solving with a
+// failed factorization throws.
+class CholeskyDecomposition
+{
+private:
+    Matrix factor; // L in the lower triangle, zeros above the diagonal
+    int info;      // 0 on success, otherwise the 1-based column whose pivot was not positive
+
+    void solveInPlace(double *B, int ldb, int rhs) const; // B = A^-1 * B for n x rhs row-major B
+
+public:
+    explicit CholeskyDecomposition(const Matrix &A); // Factor A, which must be square
+
+    int getSize() const;                 // Order of the factored matrix
+    int getInfo() const;                 // 0 on success, k > 0 if the leading k x k minor is not positive definite
+    bool isPositiveDefinite() const;     // getInfo() == 0
+    const Matrix &getL() const;          // Lower-triangular factor
+
+    double determinant() const;          // det(A), the squared product of the diagonal of L
+    double logDeterminant() const;       // log(det(A)), without overflow for large matrices
+    Vector solve(const Vector &b) const; // x with A * x = b
+    Matrix solve(const Matrix &B) const; // X with A * X = B, one column per right-hand side
+    void solveInPlace(Vector &b) const;  // b = A^-1 * b, without allocating
+    void solveInPlace(Matrix &B) const;  // B = A^-1 * B, without allocating
+    Matrix inverse() const;              // A^-1
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "matrix.hpp"
+#include "vector.hpp"
+
+// Eigendecomposition, A = V * diag(lambda) * V^T, of a real symmetric matrix.
+//
+// Only the lower triangle of A is read. A is first reduced to a tridiagonal T = Q^T * A * Q by
+// blocked Householder reflectors (LAPACK's sytrd): each panel of reflectors is applied to the
+// trailing matrix as one rank-2k update through GEMM. Then:
+//
+//  - eigenvalues only: implicit QL iteration on T, O(n^2);
+//  - all eigenpairs: divide and conquer on T (LAPACK's stedc). The tridiagonal is split into
+//    small blocks solved by QL, which are merged pairwise through a secular equation; eigenvectors
+//    stay orthogonal through Gu and Eisenstat's recomputed update vector. Independent merges run
+//    in parallel and the eigenvector updates of the large ones are GEMMs;
+//  - the k largest: the same eigenvalues, then inverse iteration on T for just those k vectors,
+//    clusters of close eigenvalues in parallel and reorthogonalized within each cluster.
+//
+// The eigenvectors of T are brought back to A's basis with blocked reflectors in GEMM, so
+// asking for k vectors costs O(n^2 * k) after the reduction instead of O(n^3).
+//
+// Eigenvalues come out largest first, as in principal component analysis, and column j of the
+// eigenvector matrix has unit norm and belongs to eigenvalue j.
+class SymmetricEigenDecomposition
+{
+private:
+    int size;
+    bool withVectors;
+    Vector values;  // descending
+    Matrix vectors; // size x count, or 0 x 0 when only eigenvalues were computed
+
+    void compute(const Matrix &A, int count, bool computeVectors);
+
+public:
+    explicit SymmetricEigenDecomposition(const Matrix &A, bool computeVectors = true); // All eigenvalues, and eigenvectors unless told otherwise
+    SymmetricEigenDecomposition(const Matrix &A, int count, bool computeVectors = true); // The count largest eigenvalues (and their eigenvectors)
+
+    int getSize() const;                  // Order of the decomposed matrix
+    int getCount() const;                 // Number of eigenvalues computed
+    bool hasEigenvectors() const;         // Whether eigenvectors were computed
+    const Vector &getEigenvalues() const; // Eigenvalues in descending order
+    const Matrix &getEigenvectors() const; // size x count, one unit eigenvector per column; throws if none were computed
+};
+
+// One-shot eigenvalues of a symmetric matrix, in descending order
+Vector symmetricEigenvalues(const Matrix &A);
@@ -0,0 +1,371 @@
+#pragma once
+
+#include <cstddef>     // For std::size_t
+#include <stdexcept>   // For std::invalid_argument
+#include <type_traits> // For the detection helpers
+#include <utility>     // For std::declval
+#include "scalar.hpp"
+#include "simd.hpp"
+
+template <typename T>
+class BasicVector;
+template <typename T>
+class BasicMatrix;
+
+// Lazy element-wise arithmetic. Operators on vectors and matrices build small expression
+// objects instead of results; assigning an expression to a Vector or Matrix evaluates the whole
+// tree in one fused pass, so `a + b * 2.0 - c` reads every operand once and allocates only the
+// result. Each element is computed with exactly the operations the eager operators used.
+//
+// An expression of the vector kind provides getSize() and evaluate(i); one of the matrix kind
+// provides getRows(), getCols() and evaluate(i, j). Leaves whose elements are contiguous also
+// expose contiguousData() (vectors) or contiguousRow(i) (matrices), which lets simple nodes hand
+// whole ranges to the SIMD kernels. Every expression names its element type as value_type, and
+// the operands of one node must share it: mixing float and double needs an explicit conversion.
+//
+// Matrix expressions also answer overlapsShifted(data, rows, cols, stride): whether computing
+// element (i, j) may read an element of the row-major block at data other than its own (i, j),
+// as a transposed or shifted view of a matrix does, or reads the block through a view of another
+// shape, which assignment would resize away. A matrix assigned such an expression of itself
+// evaluates it into new storage first.
+namespace KaloAlgebraExpressions
+{
+    template <typename E>
+    class VectorExpression
+    {
+    public:
+        const E &self() const { return static_cast<const E &>(*this); }
+
+        // Writes elements [first, last) to out[first, last); nodes with a faster path hide this
+        template <typename T>
+        void evaluateRange(T *out, long long first, long long last) const
+        {
+            for (long long i = first; i < last; i++)
+                out[i] = self().evaluate(static_cast<int>(i));
+        }
+    };
+
+    template <typename E>
+    class MatrixExpression
+    {
+    public:
+        const E &self() const { return static_cast<const E &>(*this); }
+
+        // Writes row i to out[0, getCols()); nodes with a faster path hide this
+        template <typename T>
+        void evaluateRow(T *out, int i) const
+        {
+            const int cols = self().getCols();
+            for (int j = 0; j < cols; j++)
+                out[j] = self().evaluate(i, j);
+        }
+    };
+
+    // Owning containers are held by reference inside a tree; every other operand (nested nodes,
+    // views) is small and held by value, so a tree never points at a destroyed temporary node
+    template <typename T>
+    struct StoredByReference : std::false_type
+    {
+    };
+    template <typename T>
+    struct StoredByReference<BasicVector<T>> : std::true_type
+    {
+    };
+    template <typename T>
+    struct StoredByReference<BasicMatrix<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    using Operand = std::conditional_t<StoredByReference<T>::value, const T &, const T>;
+
+    // Detects leaves with unit-stride storage
+    template <typename T, typename = void>
+    struct HasContiguousData : std::false_type
+    {
+    };
+    template <typename T>
+    struct HasContiguousData<T, std::void_t<decltype(std::declval<const T &>().contiguousData())>> : std::true_type
+    {
+    };
+
+    template <typename T, typename = void>
+    struct HasContiguousRows : std::false_type
+    {
+    };
+    template <typename T>
+    struct HasContiguousRows<T, std::void_t<decltype(std::declval<const T &>().contiguousRow(0))>> : std::true_type
+    {
+    };
+
+    // The element type shared by two operands
+    template <typename L, typename R>
+    struct CommonValue
+    {
+        static_assert(std::is_same<typename L::value_type, typename R::value_type>::value,
+                      "Operands must have the same scalar type");
+        using type = typename L::value_type;
+    };
+
+    // Element-wise operations: the scalar formula plus the matching SIMD kernel
+    struct AddOp
+    {
+        template <typename T>
+        static T apply(T a, T b) { return a + b; }
+        template <typename T>
+        static void kernel(const T *a, const T *b, T *out, std::size_t n) { KaloAlgebraSimd::add(a, b, out, n); }
+        static constexpr const char *vectorError = "Vectors must be the same size for addition.";
+        static constexpr const char *matrixError = "Matrix dimensions must match in order to perform addition!";
+    };
+
+    struct SubtractOp
+    {
+        template <typename T>
+        static T apply(T a, T b) { return a - b; }
+        template <typename T>
+        static void kernel(const T *a, const T *b, T *out, std::size_t n) { KaloAlgebraSimd::subtract(a, b, out, n); }
+        static constexpr const char *vectorError = "Vectors must be the same size for subtraction.";
+        static constexpr const char *matrixError = "Matrix dimensions must match in order to perform subtraction!";
+    };
+
+    template <typename L, typename R, typename Op>
+    class VectorBinaryExpression : public VectorExpression<VectorBinaryExpression<L, R, Op>>
+    {
+    private:
+        Operand<L> left;
+        Operand<R> right;
+
+    public:
+        using value_type = typename CommonValue<L, R>::type;
+
+        VectorBinaryExpression(const L &left, const R &right) : left(left), right(right)
+        {
+            if (left.getSize() != right.getSize())
+                throw std::invalid_argument(Op::vectorError);
+        }
+
+        int getSize() const { return left.getSize(); }
+        value_type evaluate(int i) const { return Op::apply(left.evaluate(i), right.evaluate(i)); }
+
+        void evaluateRange(value_type *out, long long first, long long last) const
+        {
+            if constexpr (HasContiguousData<L>::value && HasContiguousData<R>::value)
+            {
+                const value_type *a = left.contiguousData();
+                const value_type *b = right.contiguousData();
+                if (a && b)
+                {
+                    Op::kernel(a + first, b + first, out + first, static_cast<std::size_t>(last - first));
+                    return;
+                }
+            }
+            for (long long i = first; i < last; i++)
+                out[i] = evaluate(static_cast<int>(i));
+        }
+    };
+
+    template <typename E>
+    class VectorScaleExpression : public VectorExpression<VectorScaleExpression<E>>
+    {
+    private:
+        using Scalar = typename E::value_type;
+        Operand<E> inner;
+        Scalar scalar;
+
+    public:
+        using value_type = Scalar;
+
+        VectorScaleExpression(const E &inner, Scalar scalar) : inner(inner), scalar(scalar) {}
+
+        int getSize() const { return inner.getSize(); }
+        value_type evaluate(int i) const { return inner.evaluate(i) * scalar; }
+
+        void evaluateRange(value_type *out, long long first, long long last) const
+        {
+            if constexpr (HasContiguousData<E>::value)
+            {
+                if (const value_type *a = inner.contiguousData())
+                {
+                    KaloAlgebraSimd::scale(a + first, scalar, out + first, static_cast<std::size_t>(last - first));
+                    return;
+                }
+            }
+            for (long long i = first; i < last; i++)
+                out[i] = evaluate(static_cast<int>(i));
+        }
+    };
+
+    template <typename L, typename R, typename Op>
+    class MatrixBinaryExpression : public MatrixExpression<MatrixBinaryExpression<L, R, Op>>
+    {
+    private:
+        Operand<L> left;
+        Operand<R> right;
+
+    public:
+        using value_type = typename CommonValue<L, R>::type;
+
+        MatrixBinaryExpression(const L &left, const R &right) : left(left), right(right)
+        {
+            if (left.getRows() != right.getRows() || left.getCols() != right.getCols())
+                throw std::invalid_argument(Op::matrixError);
+        }
+
+        int getRows() const { return left.getRows(); }
+        int getCols() const { return left.getCols(); }
+        value_type evaluate(int i, int j) const { return Op::apply(left.evaluate(i, j), right.evaluate(i, j)); }
+        bool overlapsShifted(const value_type *data, int rows, int cols, int stride) const
+        {
+            return left.overlapsShifted(data, rows, cols, stride) || right.overlapsShifted(data, rows, cols, stride);
+        }
+
+        void evaluateRow(value_type *out, int i) const
+        {
+            if constexpr (HasContiguousRows<L>::value && HasContiguousRows<R>::value)
+            {
+                const value_type *a = left.contiguousRow(i);
+                const value_type *b = right.contiguousRow(i);
+                if (a && b)
+                {
+                    Op::kernel(a, b, out, static_cast<std::size_t>(getCols()));
+                    return;
+                }
+            }
+            const int cols = getCols();
+            for (int j = 0; j < cols; j++)
+                out[j] = evaluate(i, j);
+        }
+    };
+
+    template <typename E>
+    class MatrixScaleExpression : public MatrixExpression<MatrixScaleExpression<E>>
+    {
+    private:
+        using Scalar = typename E::value_type;
+        Operand<E> inner;
+        Scalar scalar;
+
+    public:
+        using value_type = Scalar;
+
+        MatrixScaleExpression(const E &inner, Scalar scalar) : inner(inner), scalar(scalar) {}
+
+        int getRows() const { return inner.getRows(); }
+        int getCols() const { return inner.getCols(); }
+        value_type evaluate(int i, int j) const { return scalar * inner.evaluate(i, j); }
+        bool overlapsShifted(const value_type *data, int rows, int cols, int stride) const { return inner.overlapsShifted(data, rows, cols, stride); }
+
+        void evaluateRow(value_type *out, int i) const
+        {
+            if constexpr (HasContiguousRows<E>::value)
+            {
+                if (const value_type *a = inner.contiguousRow(i))
+                {
+                    KaloAlgebraSimd::scale(a, scalar, out, static_cast<std::size_t>(getCols()));
+                    return;
+                }
+            }
+            const int cols = getCols();
+            for (int j = 0; j < cols; j++)
+                out[j] = evaluate(i, j);
+        }
+    };
+
+    // The scalar of a scaling takes the expression's element type, so `floatMatrix * 2.0` converts
+    // 2.0 to float instead of failing deduction
+    template <typename E>
+    using NonDeducedScalar = KaloAlgebraUtils::NonDeduced<typename E::value_type>;
+
+    // Vector operators
+    template <typename L, typename R>
+    VectorBinaryExpression<L, R, AddOp> operator+(const VectorExpression<L> &left, const VectorExpression<R> &right)
+    {
+        return VectorBinaryExpression<L, R, AddOp>(left.self(), right.self());
+    }
+
+    template <typename L, typename R>
+    VectorBinaryExpression<L, R, SubtractOp> operator-(const VectorExpression<L> &left, const VectorExpression<R> &right)
+    {
+        return VectorBinaryExpression<L, R, SubtractOp>(left.self(), right.self());
+    }
+
+    template <typename E>
+    VectorScaleExpression<E> operator*(const VectorExpression<E> &expression, NonDeducedScalar<E> scalar)
+    {
+        return VectorScaleExpression<E>(expression.self(), scalar);
+    }
+
+    template <typename E>
+    VectorScaleExpression<E> operator*(NonDeducedScalar<E> scalar, const VectorExpression<E> &expression)
+    {
+        return VectorScaleExpression<E>(expression.self(), scalar);
+    }
+
+    template <typename L, typename R>
+    bool operator==(const VectorExpression<L> &left, const VectorExpression<R> &right)
+    {
+        const int size = left.self().getSize();
+        if (size != right.self().getSize())
+            return false;
+        for (int i = 0; i < size; i++)
+        {
+            if (left.self().evaluate(i) != right.self().evaluate(i))
+                return false;
+        }
+        return true;
+    }
+
+    template <typename L, typename R>
+    bool operator!=(const VectorExpression<L> &left, const VectorExpression<R> &right)
+    {
+        return !(left == right);
+    }
+
+    // Matrix operators (the matrix product is not element-wise and lives in matrix.hpp)
+    template <typename L, typename R>
+    MatrixBinaryExpression<L, R, AddOp> operator+(const MatrixExpression<L> &left, const MatrixExpression<R> &right)
+    {
+        return MatrixBinaryExpression<L, R, AddOp>(left.self(), right.self());
+    }
+
+    template <typename L, typename R>
+    MatrixBinaryExpression<L, R, SubtractOp> operator-(const MatrixExpression<L> &left, const MatrixExpression<R> &right)
+    {
+        return MatrixBinaryExpression<L, R, SubtractOp>(left.self(), right.self());
+    }
+
+    template <typename E>
+    MatrixScaleExpression<E> operator*(const MatrixExpression<E> &expression, NonDeducedScalar<E> scalar)
+    {
+        return MatrixScaleExpression<E>(expression.self(), scalar);
+    }
+
+    template <typename E>
+    MatrixScaleExpression<E> operator*(NonDeducedScalar<E> scalar, const MatrixExpression<E> &expression)
+    {
+        return MatrixScaleExpression<E>(expression.self(), scalar);
+    }
+
+    template <typename L, typename R>
+    bool operator==(const MatrixExpression<L> &left, const MatrixExpression<R> &right)
+    {
+        const int rows = left.self().getRows(), cols = left.self().getCols();
+        if (rows != right.self().getRows() || cols != right.self().getCols())
+            return false;
+        for (int i = 0; i < rows; i++)
+        {
+            for (int j = 0; j < cols; j++)
+            {
+                if (left.self().evaluate(i, j) != right.self().evaluate(i, j))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename L, typename R>
+    bool operator!=(const MatrixExpression<L> &left, const MatrixExpression<R> &right)
+    {
+        return !(left == right);
+    }
+}
@@ -0,0 +1,478 @@
+#pragma once
+
+#include <cmath>       // For std::sqrt, std::abs
+#include <stdexcept>   // For std::invalid_argument
+#include <type_traits> // For std::enable_if_t, std::integral_constant
+#include <utility>     // For std::integer_sequence
+#include "matrix.hpp"
+#include "scalar.hpp"
+#include "vector.hpp"
+#include "view.hpp"
+
+// Fixed-size vectors and matrices whose dimensions are template parameters. The elements live
+// inline (a FixedVector<3> is three doubles, no heap and no size field), every operation is
+// unrolled at compile time, and mismatched dimensions fail to compile instead of throwing.
+// Everything except magnitude/normalize (std::sqrt) and the complex types is constexpr.
+//
+// They interoperate with the dynamic types: view() and the implicit view conversions let a fixed
+// object take part in expressions, gemm, gemv, axpy and scal, toVector()/toMatrix() copy out, and
+// the explicit constructors evaluate a Vector, Matrix, view or lazy expression of the right size
+// straight into the inline storage.
+namespace KaloAlgebraUtils
+{
+    template <typename F, int... I>
+    constexpr void unrollSequence(F &f, std::integer_sequence<int, I...>)
+    {
+        (f(std::integral_constant<int, I>()), ...);
+    }
+
+    // Calls f(std::integral_constant<int, I>()) for I = 0 .. N - 1 as a single fold expression
+    template <int N, typename F>
+    constexpr void unroll(F &&f)
+    {
+        unrollSequence(f, std::make_integer_sequence<int, N>());
+    }
+
+    // |x| for picking pivots, constexpr for real types (std::abs is not before C++23)
+    template <typename T>
+    constexpr RealType<T> pivotMagnitude(T x)
+    {
+        if constexpr (ScalarTraits<T>::isComplex)
+            return std::abs(x);
+        else
+            return x < T(0) ? -x : x;
+    }
+}
+
+template <int N, typename T = double>
+class FixedVector
+{
+    static_assert(N > 0, "FixedVector size must be positive");
+
+public:
+    using value_type = T;
+    using Real = KaloAlgebraUtils::RealType<T>;
+
+private:
+    T elements[N];
+
+public:
+    // Constructors
+    constexpr FixedVector() : elements{} {} // Zero vector
+    template <typename... Values, typename = std::enable_if_t<sizeof...(Values) == N && (std::is_convertible<Values, T>::value && ...)>>
+    constexpr FixedVector(Values... values) : elements{static_cast<T>(values)...} {} // One value per element
+    template <typename E>
+    explicit FixedVector(const KaloAlgebraExpressions::VectorExpression<E> &expression) : elements{} // Evaluate a Vector, view or expression
+    {
+        static_assert(std::is_same<typename E::value_type, T>::value, "Expression must have the vector's scalar type");
+        if (expression.self().getSize() != N)
+            throw std::invalid_argument("Vector size must match the fixed size!");
+        KaloAlgebraUtils::unroll<N>([&](auto i)
+                                    { elements[i] = expression.self().evaluate(i); });
+    }
+
+    // Accessors
+    static constexpr int getSize() { return N; }
+    constexpr T &operator[](int index) { return elements[index]; } // Unchecked
+    constexpr const T &operator[](int index) const { return elements[index]; }
+    constexpr T getElement(int index) const
+    {
+        if (index < 0 || index >= N)
+            throw std::invalid_argument("Index out of range!");
+        return elements[index];
+    }
+    constexpr void setElement(int index, T value)
+    {
+        if (index < 0 || index >= N)
+            throw std::invalid_argument("Index out of range!");
+        elements[index] = value;
+    }
+    constexpr T *data() { return elements; }
+    constexpr const T *data() const { return elements; }
+
+    // Interoperability with the dynamic types
+    BasicVectorView<T> view() { return BasicVectorView<T>(elements, N); }
+    BasicVectorView<const T> view() const { return BasicVectorView<const T>(elements, N); }
+    operator BasicVectorView<T>() { return view(); }
+    operator BasicVectorView<const T>() const { return view(); }
+    BasicVector<T> toVector() const { return BasicVector<T>(std::vector<T>(elements, elements + N)); }
+
+    // Vector operations
+    constexpr T dot(const FixedVector &other) const // Sum of x_i * y_i, without conjugation like Vector::dot
+    {
+        T sum = T(0);
+        KaloAlgebraUtils::unroll<N>([&](auto i)
+                                    { sum += elements[i] * other.elements[i]; });
+        return sum;
+    }
+    constexpr Real squaredMagnitude() const // Sum of |x_i|^2
+    {
+        Real sum = Real(0);
+        KaloAlgebraUtils::unroll<N>([&](auto i)
+                                    {
+                                        if constexpr (KaloAlgebraUtils::ScalarTraits<T>::isComplex)
+                                            sum += std::norm(elements[i]);
+                                        else
+                                            sum += elements[i] * elements[i]; });
+        return sum;
+    }
+    Real magnitude() const { return std::sqrt(squaredMagnitude()); }
+    FixedVector normalize() const
+    {
+        const Real length = magnitude();
+        if (length == Real(0))
+            throw std::invalid_argument("Can't normalize a zero vector!");
+        return *this / T(length);
+    }
+    constexpr FixedVector cross(const FixedVector &other) const
+    {
+        static_assert(N == 3, "Cross product is only defined for 3d vectors");
+        return FixedVector(elements[1] * other.elements[2] - elements[2] * other.elements[1],
+                           elements[2] * other.elements[0] - elements[0] * other.elements[2],
+                           elements[0] * other.elements[1] - elements[1] * other.elements[0]);
+    }
+    constexpr FixedVector hadamard(const FixedVector &other) const
+    {
+        FixedVector result;
+        KaloAlgebraUtils::unroll<N>([&](auto i)
+                                    { result.elements[i] = elements[i] * other.elements[i]; });
+        return result;
+    }
+
+    // Compound assignment
+    constexpr FixedVector &operator+=(const FixedVector &other)
+    {
+        KaloAlgebraUtils::unroll<N>([&](auto i)
+                                    { elements[i] += other.elements[i]; });
+        return *this;
+    }
+    constexpr FixedVector &operator-=(const FixedVector &other)
+    {
+        KaloAlgebraUtils::unroll<N>([&](auto i)
+                                    { elements[i] -= other.elements[i]; });
+        return *this;
+    }
+    constexpr FixedVector &operator*=(T scalar)
+    {
+        KaloAlgebraUtils::unroll<N>([&](auto i)
+                                    { elements[i] *= scalar; });
+        return *this;
+    }
+    constexpr FixedVector &operator/=(T scalar)
+    {
+        KaloAlgebraUtils::unroll<N>([&](auto i)
+                                    { elements[i] /= scalar; });
+        return *this;
+    }
+
+    // Arithmetic operators, eager: the result is as small as the operands
+    friend constexpr FixedVector operator+(FixedVector a, const FixedVector &b) { return a += b; }
+    friend constexpr FixedVector operator-(FixedVector a, const FixedVector &b) { return a -= b; }
+    friend constexpr FixedVector operator-(FixedVector a) { return a *= T(-1); }
+    friend constexpr FixedVector operator*(FixedVector a, T scalar) { return a *= scalar; }
+    friend constexpr FixedVector operator*(T scalar, FixedVector a) { return a *= scalar; }
+    friend constexpr FixedVector operator/(FixedVector a, T scalar) { return a /= scalar; }
+    friend constexpr T operator*(const FixedVector &a, const FixedVector &b) { return a.dot(b); } // Dot product
+    friend constexpr bool operator==(const FixedVector &a, const FixedVector &b)
+    {
+        bool equal = true;
+        KaloAlgebraUtils::unroll<N>([&](auto i)
+                                    { equal = equal && a.elements[i] == b.elements[i]; });
+        return equal;
+    }
+    friend constexpr bool operator!=(const FixedVector &a, const FixedVector &b) { return !(a == b); }
+
+    // Static methods
+    static constexpr FixedVector zero() { return FixedVector(); }
+    static constexpr FixedVector filled(T value)
+    {
+        FixedVector result;
+        KaloAlgebraUtils::unroll<N>([&](auto i)
+                                    { result.elements[i] = value; });
+        return result;
+    }
+};
+
+// Row-major R x C matrix with inline storage; data() and view() expose it with row stride C
+template <int R, int C, typename T = double>
+class FixedMatrix
+{
+    static_assert(R > 0 && C > 0, "FixedMatrix dimensions must be positive");
+
+public:
+    using value_type = T;
+    using Real = KaloAlgebraUtils::RealType<T>;
+
+private:
+    T elements[R * C];
+
+public:
+    // Constructors
+    constexpr FixedMatrix() : elements{} {} // Zero matrix
+    template <typename... Values, typename = std::enable_if_t<sizeof...(Values) == R * C && (std::is_convertible<Values, T>::value && ...)>>
+    constexpr FixedMatrix(Values... values) : elements{static_cast<T>(values)...} {} // Row-major values
+    template <typename E>
+    explicit FixedMatrix(const KaloAlgebraExpressions::MatrixExpression<E> &expression) : elements{} // Evaluate a Matrix, view or expression
+    {
+        static_assert(std::is_same<typename E::value_type, T>::value, "Expression must have the matrix's scalar type");
+        if (expression.self().getRows() != R || expression.self().getCols() != C)
+            throw std::invalid_argument("Matrix dimensions must match the fixed dimensions!");
+        KaloAlgebraUtils::unroll<R * C>([&](auto k)
+                                        { elements[k] = expression.self().evaluate(k / C, k % C); });
+    }
+
+    // Accessors
+    static constexpr int getRows() { return R; }
+    static constexpr int getCols() { return C; }
+    constexpr T &operator()(int row, int col) { return elements[row * C + col]; } // Unchecked
+    constexpr const T &operator()(int row, int col) const { return elements[row * C + col]; }
+    constexpr T getElement(int row, int col) const
+    {
+        if (row < 0 || row >= R || col < 0 || col >= C)
+            throw std::invalid_argument("Index out of range!");
+        return elements[row * C + col];
+    }
+    constexpr void setElement(int row, int col, T value)
+    {
+        if (row < 0 || row >= R || col < 0 || col >= C)
+            throw std::invalid_argument("Index out of range!");
+        elements[row * C + col] = value;
+    }
+    constexpr T *data() { return elements; }
+    constexpr const T *data() const { return elements; }
+
+    // Interoperability with the dynamic types
+    BasicMatrixView<T> view() { return BasicMatrixView<T>(elements, R, C, C); }
+    BasicMatrixView<const T> view() const { return BasicMatrixView<const T>(elements, R, C, C); }
+    operator BasicMatrixView<T>() { return view(); }
+    operator BasicMatrixView<const T>() const { return view(); }
+    BasicMatrix<T> toMatrix() const
+    {
+        BasicMatrix<T> result(R, C);
+        for (int i = 0; i < R; i++)
+            for (int j = 0; j < C; j++)
+                result.rowPtr(i)[j] = elements[i * C + j];
+        return result;
+    }
+
+    // Matrix operations
+    constexpr FixedMatrix<C, R, T> transpose() const
+    {
+        FixedMatrix<C, R, T> result;
+        KaloAlgebraUtils::unroll<R * C>([&](auto k)
+                                        { result(k % C, k / C) = elements[k]; });
+        return result;
+    }
+    constexpr T determinant() const;
+    constexpr FixedMatrix inverse() const; // Throws if the matrix is singular
+
+    // Compound assignment
+    constexpr FixedMatrix &operator+=(const FixedMatrix &other)
+    {
+        KaloAlgebraUtils::unroll<R * C>([&](auto k)
+                                        { elements[k] += other.elements[k]; });
+        return *this;
+    }
+    constexpr FixedMatrix &operator-=(const FixedMatrix &other)
+    {
+        KaloAlgebraUtils::unroll<R * C>([&](auto k)
+                                        { elements[k] -= other.elements[k]; });
+        return *this;
+    }
+    constexpr FixedMatrix &operator*=(T scalar)
+    {
+        KaloAlgebraUtils::unroll<R * C>([&](auto k)
+                                        { elements[k] *= scalar; });
+        return *this;
+    }
+    constexpr FixedMatrix &operator/=(T scalar)
+    {
+        KaloAlgebraUtils::unroll<R * C>([&](auto k)
+                                        { elements[k] /= scalar; });
+        return *this;
+    }
+
+    // Arithmetic operators
+    friend constexpr FixedMatrix operator+(FixedMatrix a, const FixedMatrix &b) { return a += b; }
+    friend constexpr FixedMatrix operator-(FixedMatrix a, const FixedMatrix &b) { return a -= b; }
+    friend constexpr FixedMatrix operator-(FixedMatrix a) { return a *= T(-1); }
+    friend constexpr FixedMatrix operator*(FixedMatrix a, T scalar) { return a *= scalar; }
+    friend constexpr FixedMatrix operator*(T scalar, FixedMatrix a) { return a *= scalar; }
+    friend constexpr FixedMatrix operator/(FixedMatrix a, T scalar) { return a /= scalar; }
+    friend constexpr bool operator==(const FixedMatrix &a, const FixedMatrix &b)
+    {
+        bool equal = true;
+        KaloAlgebraUtils::unroll<R * C>([&](auto k)
+                                        { equal = equal && a.elements[k] == b.elements[k]; });
+        return equal;
+    }
+    friend constexpr bool operator!=(const FixedMatrix &a, const FixedMatrix &b) { return !(a == b); }
+
+    // Products: the inner dimensions are part of the types, so a mismatch does not compile
+    template <int K>
+    friend constexpr FixedMatrix<R, K, T> operator*(const FixedMatrix &a, const FixedMatrix<C, K, T> &b)
+    {
+        FixedMatrix<R, K, T> result;
+        KaloAlgebraUtils::unroll<R * K>([&](auto k)
+                                        {
+                                            const int i = k / K, j = k % K;
+                                            T sum = T(0);
+                                            KaloAlgebraUtils::unroll<C>([&](auto p)
+                                                                        { sum += a.elements[i * C + p] * b(p, j); });
+                                            result(i, j) = sum; });
+        return result;
+    }
+    friend constexpr FixedVector<R, T> operator*(const FixedMatrix &a, const FixedVector<C, T> &x) // A * x
+    {
+        FixedVector<R, T> result;
+        KaloAlgebraUtils::unroll<R>([&](auto i)
+                                    {
+                                        T sum = T(0);
+                                        KaloAlgebraUtils::unroll<C>([&](auto j)
+                                                                    { sum += a.elements[i * C + j] * x[j]; });
+                                        result[i] = sum; });
+        return result;
+    }
+    friend constexpr FixedVector<C, T> operator*(const FixedVector<R, T> &x, const FixedMatrix &a) // x^T * A
+    {
+        FixedVector<C, T> result;
+        KaloAlgebraUtils::unroll<C>([&](auto j)
+                                    {
+                                        T sum = T(0);
+                                        KaloAlgebraUtils::unroll<R>([&](auto i)
+                                                                    { sum += x[i] * a.elements[i * C + j]; });
+                                        result[j] = sum; });
+        return result;
+    }
+
+    // Static methods
+    static constexpr FixedMatrix zero() { return FixedMatrix(); }
+    static constexpr FixedMatrix identity()
+    {
+        static_assert(R == C, "Identity matrix must be square");
+        FixedMatrix result;
+        KaloAlgebraUtils::unroll<R>([&](auto i)
+                                    { result.elements[i * C + i] = T(1); });
+        return result;
+    }
+};
+
+// 2 x 2 and 3 x 3 use the closed forms; larger sizes use Gaussian elimination with partial
+// pivoting on a copy
+template <int R, int C, typename T>
+constexpr T FixedMatrix<R, C, T>::determinant() const
+{
+    static_assert(R == C, "Determinant is only defined for square matrices");
+    const T *m = elements;
+    if constexpr (R == 1)
+        return m[0];
+    else if constexpr (R == 2)
+        return m[0] * m[3] - m[1] * m[2];
+    else if constexpr (R == 3)
+        return m[0] * (m[4] * m[8] - m[5] * m[7]) - m[1] * (m[3] * m[8] - m[5] * m[6]) + m[2] * (m[3] * m[7] - m[4] * m[6]);
+    else
+    {
+        FixedMatrix a = *this;
+        T result = T(1);
+        for (int k = 0; k < R; k++)
+        {
+            int pivot = k;
+            for (int i = k + 1; i < R; i++)
+                if (KaloAlgebraUtils::pivotMagnitude(a(i, k)) > KaloAlgebraUtils::pivotMagnitude(a(pivot, k)))
+                    pivot = i;
+            if (a(pivot, k) == T(0))
+                return T(0);
+            if (pivot != k)
+            {
+                for (int j = 0; j < C; j++)
+                {
+                    const T swapped = a(k, j);
+                    a(k, j) = a(pivot, j);
+                    a(pivot, j) = swapped;
+                }
+                result = -result;
+            }
+            result *= a(k, k);
+            for (int i = k + 1; i < R; i++)
+            {
+                const T multiplier = a(i, k) / a(k, k);
+                for (int j = k + 1; j < C; j++)
+                    a(i, j) -= multiplier * a(k, j);
+            }
+        }
+        return result;
+    }
+}
+
+// 2 x 2 and 3 x 3 divide the adjugate by the determinant; larger sizes use Gauss-Jordan
+// elimination with partial pivoting
+template <int R, int C, typename T>
+constexpr FixedMatrix<R, C, T> FixedMatrix<R, C, T>::inverse() const
+{
+    static_assert(R == C, "Inverse is only defined for square matrices");
+    const T *m = elements;
+    if constexpr (R <= 3)
+    {
+        const T det = determinant();
+        if (det == T(0))
+            throw std::invalid_argument("Matrix is singular!");
+        if constexpr (R == 1)
+            return FixedMatrix(T(1) / det);
+        else if constexpr (R == 2)
+            return FixedMatrix(m[3], -m[1], -m[2], m[0]) / det;
+        else
+            return FixedMatrix(m[4] * m[8] - m[5] * m[7], m[2] * m[7] - m[1] * m[8], m[1] * m[5] - m[2] * m[4],
+                               m[5] * m[6] - m[3] * m[8], m[0] * m[8] - m[2] * m[6], m[2] * m[3] - m[0] * m[5],
+                               m[3] * m[7] - m[4] * m[6], m[1] * m[6] - m[0] * m[7], m[0] * m[4] - m[1] * m[3]) /
+                   det;
+    }
+    else
+    {
+        FixedMatrix a = *this;
+        FixedMatrix result = identity();
+        for (int k = 0; k < R; k++)
+        {
+            int pivot = k;
+            for (int i = k + 1; i < R; i++)
+                if (KaloAlgebraUtils::pivotMagnitude(a(i, k)) > KaloAlgebraUtils::pivotMagnitude(a(pivot, k)))
+                    pivot = i;
+            if (a(pivot, k) == T(0))
+                throw std::invalid_argument("Matrix is singular!");
+            for (int j = 0; j < C; j++)
+            {
+                T swapped = a(k, j);
+                a(k, j) = a(pivot, j);
+                a(pivot, j) = swapped;
+                swapped = result(k, j);
+                result(k, j) = result(pivot, j);
+                result(pivot, j) = swapped;
+            }
+            const T scale = T(1) / a(k, k);
+            for (int j = 0; j < C; j++)
+            {
+                a(k, j) *= scale;
+                result(k, j) *= scale;
+            }
+            for (int i = 0; i < R; i++)
+            {
+                if (i == k)
+                    continue;
+                const T multiplier = a(i, k);
+                for (int j = 0; j < C; j++)
+                {
+                    a(i, j) -= multiplier * a(k, j);
+                    result(i, j) -= multiplier * result(k, j);
+                }
+            }
+        }
+        return result;
+    }
+}
+
+// The common small sizes, in double
+using Vector2 = FixedVector<2>;
+using Vector3 = FixedVector<3>;
+using Vector4 = FixedVector<4>;
+using Matrix2 = FixedMatrix<2, 2>;
+using Matrix3 = FixedMatrix<3, 3>;
+using Matrix4 = FixedMatrix<4, 4>;
@@ -0,0 +1,26 @@
+#pragma once
+
+namespace KaloAlgebraKernels
+{
+    // General matrix multiply on raw storage: C = alpha * A * B + beta * C
+    //
+    // A is m x k with element (i, p) at A[i * rowStrideA + p * colStrideA], B is k x n with
+    // element (p, j) at B[p * rowStrideB + j * colStrideB] and C is m x n row-major with
+    // leading dimension ldc. Arbitrary operand strides let callers pass transposed or
+    // strided operands without copying. When beta is 0, C is overwritten and never read.
+    //
+    // Instantiated for float, double, std::complex<float> and std::complex<double>.
+    template <typename T>
+    void gemm(int m, int n, int k, T alpha,
+              const T *A, int rowStrideA, int colStrideA,
+              const T *B, int rowStrideB, int colStrideB,
+              T beta, T *C, int ldc);
+
+    // Symmetric rank-k update on raw storage: C = alpha * A * A^T + beta * C, with A n x k
+    // (strided as in gemm) and C n x n row-major. Only the lower triangle is multiplied, about
+    // half the work of gemm, and is then mirrored into the upper one, so C comes out exactly
+    // symmetric. When beta is not 0, C must already be symmetric. Pass A with its strides
+    // swapped for A^T * A. The transpose is plain, without conjugation, for complex types too.
+    template <typename T>
+    void syrk(int n, int k, T alpha, const T *A, int rowStrideA, int colStrideA, T beta, T *C, int ldc);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+namespace KaloAlgebraKernels
+{
+    // Matrix-vector multiply on raw storage: y = alpha * A * x + beta * y
+    //
+    // A is m x n with element (i, j) at A[i * rowStrideA + j * colStrideA], x has n elements
+    // spaced incx apart and y has m elements spaced incy apart. Row-major A is traversed as one
+    // dot product per row, column-major A (a transposed view) as one axpy per column, so A is
+    // always streamed along its contiguous dimension. When beta is 0, y is overwritten and never read.
+    template <typename T>
+    void gemv(int m, int n, T alpha,
+              const T *A, int rowStrideA, int colStrideA,
+              const T *x, int incx,
+              T beta, T *y, int incy);
+
+    // Rank-1 update on raw storage: A += alpha * x * y^T, with A m x n and leading dimension lda
+    template <typename T>
+    void ger(int m, int n, T alpha, const T *x, int incx, const T *y, int incy, T *A, int lda);
+
+    // Both are instantiated for float, double, std::complex<float> and std::complex<double>
+}
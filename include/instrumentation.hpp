@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>  // For std::chrono::steady_clock
+#include <string>  // For std::string
+#include <vector>  // For std::vector
+
+// Optional per-operation counters: calls, wall time, estimated FLOPs, bytes moved and storage
+// allocations for each public operation, split by size bucket. Compiled out by default; configure
+// with -DKALO_ALGEBRA_INSTRUMENTATION=ON to record. When it is off the macro below expands to
+// nothing (its arguments are not evaluated), and snapshot() is always empty.
+//
+// Operations nest: a product records "Matrix::operator*" and also the "gemm" it runs. Time and
+// FLOPs of the inner call are included in the outer one; allocations go to the innermost.
+namespace KaloAlgebraInstrumentation
+{
+    struct OperationStats
+    {
+        std::string operation; // e.g. "Matrix::transpose"
+        long long sizeBucket;  // Smallest power of two >= the operation's size (largest dimension or vector length)
+        long long calls;
+        double seconds;             // Wall time, summed over calls
+        double flops;               // Estimated floating-point operations
+        double bytes;               // Estimated bytes read and written
+        long long allocations;      // Matrix/Vector storage allocations made during the calls
+        long long allocatedBytes;
+    };
+
+    constexpr bool isEnabled()
+    {
+#ifdef KALO_ALGEBRA_INSTRUMENTATION
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::vector<OperationStats> snapshot(); // Counters so far, sorted by operation then size bucket
+    void reset();                           // Clear all counters
+    std::string report();                   // Human-readable table of snapshot()
+    std::string toJson();                   // snapshot() as a JSON array
+
+    // Records one call from construction to destruction. Use through KALO_ALGEBRA_INSTRUMENT.
+    class ScopedOperation
+    {
+    public:
+        ScopedOperation(const char *operation, long long size, double flops, double bytes);
+        ~ScopedOperation();
+        ScopedOperation(const ScopedOperation &) = delete;
+        ScopedOperation &operator=(const ScopedOperation &) = delete;
+
+        void addAllocation(long long bytes)
+        {
+            allocations++;
+            allocatedBytes += bytes;
+        }
+
+    private:
+        const char *operation;
+        long long size;
+        double flops, bytes;
+        long long allocations = 0, allocatedBytes = 0;
+        ScopedOperation *parent; // enclosing operation on this thread
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void recordAllocation(long long bytes); // Attributes an allocation to this thread's innermost operation
+}
+
+#ifdef KALO_ALGEBRA_INSTRUMENTATION
+#define KALO_ALGEBRA_INSTRUMENT_NAME2(line) kaloAlgebraOperation##line
+#define KALO_ALGEBRA_INSTRUMENT_NAME(line) KALO_ALGEBRA_INSTRUMENT_NAME2(line)
+#define KALO_ALGEBRA_INSTRUMENT(operation, size, flops, bytes) \
+    KaloAlgebraInstrumentation::ScopedOperation KALO_ALGEBRA_INSTRUMENT_NAME(__LINE__)(operation, size, flops, bytes)
+#else
+#define KALO_ALGEBRA_INSTRUMENT(operation, size, flops, bytes) ((void)0)
+#endif
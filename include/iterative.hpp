@@ -0,0 +1,128 @@
+#pragma once
+
+#include <functional> // For std::function
+#include <vector>     // For the residual history
+#include "matrix.hpp"
+#include "sparse.hpp"
+#include "vector.hpp"
+#include "view.hpp"
+
+// y = A * x for an n x n operator A. This is all the iterative solvers need from A, so it never
+// has to be formed: a stencil, a product of factors or a call into other code will do. Both
+// vectors are contiguous and y never overlaps x.
+using LinearOperator = std::function<void(ConstVectorView x, VectorView y)>;
+
+// A preconditioner M approximates A, and apply solves with it: z = M^-1 * r. Both vectors are
+// contiguous and distinct; apply must not allocate, since it runs once or twice per iteration.
+class Preconditioner
+{
+public:
+    virtual ~Preconditioner() = default;
+    virtual int getSize() const = 0;
+    virtual void apply(ConstVectorView r, VectorView z) const = 0;
+};
+
+// Jacobi (diagonal) preconditioner, M = diag(A). Cheap and fully parallel; it helps most when the
+// rows of A are badly scaled relative to each other.
+class JacobiPreconditioner : public Preconditioner
+{
+private:
+    Vector inverseDiagonal;
+
+public:
+    explicit JacobiPreconditioner(const Matrix &A);       // Throws if A is not square or has a zero on the diagonal
+    explicit JacobiPreconditioner(const SparseMatrix &A); // The same, for a missing diagonal entry too
+    explicit JacobiPreconditioner(const Vector &diagonal); // From diag(A), for a matrix-free operator that knows it
+
+    int getSize() const override;
+    void apply(ConstVectorView r, VectorView z) const override; // z = r ./ diag(A)
+};
+
+// Incomplete LU with zero fill-in, ILU(0): L * U ~= A with L unit lower and U upper triangular,
+// both restricted to the nonzero pattern of A. Usually far fewer iterations than Jacobi on
+// matrices from discretized PDEs, at the cost of two sparse triangular solves per application,
+// which are sequential.
+class ILU0Preconditioner : public Preconditioner
+{
+private:
+    int size;
+    std::vector<long long> rowOffsets; // A's pattern
+    std::vector<int> columnIndices;
+    std::vector<double> factors;       // L below the diagonal, U on and above it
+    std::vector<long long> diagonal;   // Index of each row's diagonal entry
+
+public:
+    explicit ILU0Preconditioner(const SparseMatrix &A); // Throws if A is not square, misses a diagonal entry or meets a zero pivot
+
+    int getSize() const override;
+    void apply(ConstVectorView r, VectorView z) const override; // z = U^-1 * L^-1 * r
+};
+
+enum class IterativeMethod
+{
+    ConjugateGradient, // Symmetric positive-definite A (and M): one product per iteration, minimal storage
+    BiCGSTAB,          // General A: two products per iteration, fixed storage
+    GMRES,             // General A: one product per iteration, restarted every `restart` iterations
+};
+
+// Krylov solver for A * x = b with n x n A, optionally preconditioned.
+//
+// All vectors the chosen method needs (for GMRES, restart + 1 basis vectors as well) are allocated
+// once by the constructor and reused by every solve, so iterations never allocate. Dot products
+// are summed over fixed chunks in parallel and vector updates are split over the thread pool;
+// results do not depend on the thread count. GMRES orthogonalizes each new vector against its
+// basis with two passes of classical Gram-Schmidt, each a pair of GEMV calls.
+//
+// solve starts from the x it is given, iterates until ||b - A * x|| <= tolerance * ||b|| or
+// maxIterations, and leaves the last iterate in x. CG and BiCGSTAB may also stop early on a
+// breakdown (A not positive definite for CG); hasConverged() then returns false. BiCGSTAB and
+// GMRES use right preconditioning, so the residual they test is the true one, not M^-1 times it.
+class IterativeSolver
+{
+private:
+    IterativeMethod method;
+    int size, restart, maxIterations;
+    double tolerance;
+    const Preconditioner *preconditioner;
+
+    Matrix work;        // One work vector per row: the iterate, b and the method's vectors
+    Matrix basis;       // GMRES: the Krylov basis, one vector per row
+    Matrix hessenberg;  // GMRES: column j of the Hessenberg matrix in row j, rotated to triangular
+    std::vector<double> cosines, sines, projection, coefficients; // GMRES: rotations, rotated residual, y
+    mutable std::vector<double> partialSums;                      // One per chunk of a dot product
+    std::vector<double> history;
+    int iterations;
+    bool converged;
+    double residual; // ||b - A * x|| / ||b|| at the end of the last solve
+
+    double dot(const double *a, const double *b) const;
+    double norm(const double *a) const;
+    void precondition(const double *r, double *z) const;
+    void conjugateGradient(const LinearOperator &A, double bNorm);
+    void biCGSTAB(const LinearOperator &A, double bNorm);
+    void gmres(const LinearOperator &A, double bNorm);
+
+public:
+    IterativeSolver(IterativeMethod method, int size, int restart = 30);
+
+    // Settings
+    void setTolerance(double relativeTolerance);       // Default 1e-10, relative to ||b||
+    void setMaxIterations(int count);                  // Default 1000
+    void setPreconditioner(const Preconditioner *M);   // Not owned; nullptr (the default) for none
+    IterativeMethod getMethod() const { return method; }
+    int getSize() const { return size; }
+    int getRestart() const { return restart; }
+    double getTolerance() const { return tolerance; }
+    int getMaxIterations() const { return maxIterations; }
+
+    // Solves A * x = b from the initial guess in x; returns hasConverged()
+    bool solve(const LinearOperator &A, ConstVectorView b, VectorView x);
+    bool solve(const Matrix &A, ConstVectorView b, VectorView x);
+    bool solve(const SparseMatrix &A, ConstVectorView b, VectorView x);
+
+    // Report of the last solve
+    bool hasConverged() const { return converged; }
+    int getIterations() const { return iterations; }
+    double getResidualNorm() const { return residual; }                      // Final ||b - A * x|| / ||b||
+    const std::vector<double> &getResidualHistory() const { return history; } // Initial relative residual, then one per iteration
+};
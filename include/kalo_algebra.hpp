@@ -2,14 +2,131 @@
 
 #include "matrix.hpp"
 #include "vector.hpp"
+#include "lu.hpp"
+#include "cholesky.hpp"
+#include "qr.hpp"
+#include "eigen.hpp"
+#include "sparse.hpp"
+#include "iterative.hpp"
+#include "fixed.hpp"
+#include "matrix_io.hpp"
+#include "out_of_core.hpp"
+#include "batch.hpp"
+#include "arena.hpp"
+#include "instrumentation.hpp"
+#include "random.hpp"
 #include "utils.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
 
 namespace KaloAlgebra
 {
     // Re-exporting the followings
 
+    template <typename T>
+    using BasicMatrix = ::BasicMatrix<T>;
+    template <typename T>
+    using BasicVector = ::BasicVector<T>;
+    template <typename T>
+    using BasicMatrixView = ::BasicMatrixView<T>;
+    template <typename T>
+    using BasicVectorView = ::BasicVectorView<T>;
+
     using Matrix = ::Matrix;
     using Vector = ::Vector;
+    using FloatMatrix = ::FloatMatrix;
+    using FloatVector = ::FloatVector;
+    using ComplexFloatMatrix = ::ComplexFloatMatrix;
+    using ComplexFloatVector = ::ComplexFloatVector;
+    using ComplexMatrix = ::ComplexMatrix;
+    using ComplexVector = ::ComplexVector;
+    template <int N, typename T = double>
+    using FixedVector = ::FixedVector<N, T>;
+    template <int R, int C, typename T = double>
+    using FixedMatrix = ::FixedMatrix<R, C, T>;
+    using Vector2 = ::Vector2;
+    using Vector3 = ::Vector3;
+    using Vector4 = ::Vector4;
+    using Matrix2 = ::Matrix2;
+    using Matrix3 = ::Matrix3;
+    using Matrix4 = ::Matrix4;
+    using LUDecomposition = ::LUDecomposition;
+    using CholeskyDecomposition = ::CholeskyDecomposition;
+    using QRDecomposition = ::QRDecomposition;
+    using SymmetricEigenDecomposition = ::SymmetricEigenDecomposition;
+    using SparseMatrix = ::SparseMatrix;
+    using LinearOperator = ::LinearOperator;
+    using Preconditioner = ::Preconditioner;
+    using JacobiPreconditioner = ::JacobiPreconditioner;
+    using ILU0Preconditioner = ::ILU0Preconditioner;
+    using IterativeMethod = ::IterativeMethod;
+    using IterativeSolver = ::IterativeSolver;
+    template <typename T>
+    using BasicMappedMatrix = ::BasicMappedMatrix<T>;
+    using MappedMatrix = ::MappedMatrix;
+    template <typename T>
+    using BasicMatrixBatch = ::BasicMatrixBatch<T>;
+    template <typename T>
+    using BasicVectorBatch = ::BasicVectorBatch<T>;
+    using MatrixBatch = ::MatrixBatch;
+    using FloatMatrixBatch = ::FloatMatrixBatch;
+    using VectorBatch = ::VectorBatch;
+    using FloatVectorBatch = ::FloatVectorBatch;
+    using MatrixView = ::MatrixView;
+    using ConstMatrixView = ::ConstMatrixView;
+    using VectorView = ::VectorView;
+    using ConstVectorView = ::ConstVectorView;
+
+    using ::add;
+    using ::axpy;
+    using ::defaultOutOfCoreBudget;
+    using ::gemm;
+    using ::gemv;
+    using ::ger;
+    using ::hadamard;
+    using ::leastSquares;
+    using ::load;
+    using ::loadMapped;
+    using ::multiply;
+    using ::multiplyOutOfCore;
+    using ::outOfCoreTileSize;
+    using ::save;
+    using ::scal;
+    using ::solve;
+    using ::spmm;
+    using ::spmv;
+    using ::subtract;
+    using ::symmetricEigenvalues;
+    using ::syrk;
+
+    using KaloAlgebraSimd::Isa;
+    using KaloAlgebraSimd::activeIsa;
+    using KaloAlgebraSimd::detectIsa;
+    using KaloAlgebraSimd::forceIsa;
+    using KaloAlgebraSimd::isIsaSupported;
+    using KaloAlgebraSimd::resetIsa;
+
+    using KaloAlgebraParallel::getSerialThreshold;
+    using KaloAlgebraParallel::getThreadCount;
+    using KaloAlgebraParallel::parallelFor;
+    using KaloAlgebraParallel::setSerialThreshold;
+    using KaloAlgebraParallel::setThreadCount;
+
+    using KaloAlgebraUtils::RandomGenerator;
+    using KaloAlgebraUtils::philox4x32;
+    using KaloAlgebraUtils::threadGenerator;
+
+    using KaloAlgebraUtils::Arena;
+    using KaloAlgebraUtils::ArenaScope;
+    using KaloAlgebraUtils::MemoryResource;
+    using KaloAlgebraUtils::ResourceScope;
+    using KaloAlgebraUtils::currentResource;
+    using KaloAlgebraUtils::heapResource;
+    using KaloAlgebraUtils::threadArena;
+
+    // Instrumentation::snapshot(), reset(), report() and toJson(); see instrumentation.hpp
+    namespace Instrumentation = KaloAlgebraInstrumentation;
+    using KaloAlgebraInstrumentation::OperationStats;
 
     using KaloAlgebraUtils::approximatelyEquals;
     using KaloAlgebraUtils::euclideanNorm;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector> // For std::vector
+#include "matrix.hpp"
+#include "vector.hpp"
+
+// LU decomposition with partial pivoting, P * A = L * U, of a square matrix.
+//
+// The factorization is computed once and can then solve any number of right-hand sides, or give
+// the determinant and inverse, without refactoring. It is blocked and right-looking: each panel
+// of columns is factored on its own, and the rest of the matrix is updated with one GEMM per
+// panel, so nearly all of the work runs in the packed, multithreaded GEMM kernel.
+class LUDecomposition
+{
+private:
+    Matrix factors;          // Strictly lower part: L (its unit diagonal is implied), upper part: U
+    std::vector<int> pivots; // Row i was swapped with row pivots[i] at step i
+    int swapSign;            // +1 or -1, the sign of the permutation
+    bool singular;           // Whether some pivot was exactly zero
+
+    void solveInPlace(double *B, int ldb, int rhs) const; // B = A^-1 * B for n x rhs row-major B
+
+public:
+    explicit LUDecomposition(const Matrix &A); // Factor A, which must be square
+
+    int getSize() const;                         // Order of the factored matrix
+    bool isSingular() const;                     // True if A is exactly singular; solve() then throws
+    const Matrix &getFactors() const;            // L and U packed into one matrix
+    const std::vector<int> &getPivots() const;   // Row interchanges, LAPACK style
+    Matrix getL() const;                         // Unit lower-triangular factor
+    Matrix getU() const;                         // Upper-triangular factor
+    Matrix getP() const;                         // Permutation matrix with P * A = L * U
+
+    double determinant() const;                  // det(A)
+    Vector solve(const Vector &b) const;         // x with A * x = b
+    Matrix solve(const Matrix &B) const;         // X with A * X = B, one column per right-hand side
+    void solveInPlace(Vector &b) const;          // b = A^-1 * b, without allocating
+    void solveInPlace(Matrix &B) const;          // B = A^-1 * B, without allocating
+    Matrix inverse() const;                      // A^-1
+};
+
+// One-shot solves that factor A first; keep an LUDecomposition to solve against the same A repeatedly
+Vector solve(const Matrix &A, const Vector &b);
+Matrix solve(const Matrix &A, const Matrix &B);
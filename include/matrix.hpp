@@ -3,50 +3,273 @@
 #include <iostream>  // For functions like std::cout
 #include <vector>    // For std::vector usage
 #include <stdexcept> // For exceptions like std::invalid_argument
+#include <complex>   // For the complex scalar types
+#include "allocator.hpp"
+#include "expression.hpp"
+#include "random.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+#include "view.hpp"
 
-class Matrix
+// Dense row-major matrix over the scalar type T: float, double, std::complex<float> or
+// std::complex<double>. The member functions are compiled once per type in matrix.cpp; Matrix
+// is the double matrix.
+template <typename T>
+class BasicMatrix : public KaloAlgebraExpressions::MatrixExpression<BasicMatrix<T>>
 {
+public:
+    using value_type = T;
+    using Real = KaloAlgebraUtils::RealType<T>; // random bounds
+    using allocator_type = KaloAlgebraUtils::ResourceAllocator<T>;
+
 private:
-    std::vector<std::vector<double>> data; // 2D vector to store matrix elements
-    int rows, cols;                        // Dimensions of the matrix
+    std::vector<T, allocator_type> storage; // Contiguous row-major elements, 64-byte aligned, from the current memory resource (arena.hpp)
+    int rows, cols;                                                // Dimensions of the matrix
+    int stride;                                                    // Leading dimension: elements between the starts of consecutive rows
+
+    static int leadingDimension(int cols); // Row length padded so every row starts on a cache line
+
+    struct Uninitialized
+    {
+    };
+    BasicMatrix(int rows, int cols, Uninitialized); // Allocate without writing the elements
+
+    template <typename E>
+    void assign(const E &expression); // Fused, parallel evaluation of an expression into storage
 
 public:
     // Constructors
-    Matrix(int rows, int cols, double initialValue = 0.0);     // Initialize with dimensions and a default value
-    Matrix(const std::vector<std::vector<double>> &inputData); // Initialize with 2D vector
-    Matrix(const Matrix &other);                               // Copy constructor
-    Matrix(Matrix &&other) noexcept;                           // Move constructor
+    BasicMatrix(int rows, int cols, T initialValue = T(0));     // Initialize with dimensions and a default value
+    BasicMatrix(const std::vector<std::vector<T>> &inputData); // Initialize with 2D vector
+    BasicMatrix(const BasicMatrix &other);                     // Copy constructor
+    BasicMatrix(BasicMatrix &&other) noexcept;                 // Move constructor
+    template <typename E>
+    BasicMatrix(const KaloAlgebraExpressions::MatrixExpression<E> &expression); // Evaluate a lazy expression
 
     // Destructor
-    ~Matrix(); // Clean up resources if necessary
+    ~BasicMatrix(); // Clean up resources if necessary
 
     // Accessors
-    int getRows() const;                             // Get the number of rows
-    int getCols() const;                             // Get the number of columns
-    double getElement(int row, int col) const;       // Get the element at (row, col)
-    void setElement(int row, int col, double value); // Set the element at (row, col)
+    int getRows() const;                        // Get the number of rows
+    int getCols() const;                        // Get the number of columns
+    T getElement(int row, int col) const;       // Get the element at (row, col)
+    void setElement(int row, int col, T value); // Set the element at (row, col)
+    int getStride() const;                      // Get the leading dimension (>= cols)
+    KaloAlgebraUtils::MemoryResource *getResource() const { return storage.get_allocator().getResource(); } // Where the storage comes from
+
+    // Raw storage access for kernels: element (i, j) lives at data()[i * getStride() + j]
+    T *data() { return storage.data(); }
+    const T *data() const { return storage.data(); }
+    T *rowPtr(int row) { return storage.data() + static_cast<std::size_t>(row) * stride; }
+    const T *rowPtr(int row) const { return storage.data() + static_cast<std::size_t>(row) * stride; }
+    T evaluate(int row, int col) const { return rowPtr(row)[col]; } // Unchecked access for expressions
+    const T *contiguousRow(int row) const { return rowPtr(row); }
+    bool overlapsShifted(const T *, int, int, int) const { return false; } // Either the target itself, read in place, or other storage
+
+    // Views: non-owning windows onto this matrix's storage (see view.hpp), valid while it is alive and not resized
+    BasicMatrixView<T> view();                                                          // The whole matrix
+    BasicMatrixView<const T> view() const;
+    BasicMatrixView<T> block(int startRow, int startCol, int blockRows, int blockCols); // blockRows x blockCols from (startRow, startCol)
+    BasicMatrixView<const T> block(int startRow, int startCol, int blockRows, int blockCols) const;
+    BasicVectorView<T> row(int index);                                                  // One row
+    BasicVectorView<const T> row(int index) const;
+    BasicVectorView<T> col(int index);                                                  // One column (strided)
+    BasicVectorView<const T> col(int index) const;
+    BasicMatrixView<T> t();                                                             // Lazy transpose, no copy (see BasicMatrixView::t)
+    BasicMatrixView<const T> t() const;
+    operator BasicMatrixView<T>() { return view(); }
+    operator BasicMatrixView<const T>() const { return view(); }
 
     // Matrix Operations
-    Matrix transpose() const;                                                   // Transpose the matrix
-    Matrix subMatrix(int startRow, int startCol, int endRow, int endCol) const; // Extract a sub-matrix
-    void print() const;                                                         // Print the matrix
+    BasicMatrix transpose() const;                                                   // Transpose the matrix
+    void transposeInPlace();                                                         // Transpose a square matrix without allocating
+    BasicMatrix subMatrix(int startRow, int startCol, int endRow, int endCol) const; // Extract a sub-matrix (copies, see block() for a view)
+    T determinant() const;                                                           // Determinant of a square matrix (double: via LU, see lu.hpp)
+    BasicMatrix inverse() const;                                                     // Inverse of a square matrix, throws if it is singular
+    void print() const;                                                              // Print the matrix
 
-    // Arithmetic Operators
-    Matrix operator+(const Matrix &other) const; // Matrix addition
-    Matrix operator-(const Matrix &other) const; // Matrix subtraction
-    Matrix operator*(const Matrix &other) const; // Matrix multiplication
-    Matrix operator*(double scalar) const;       // Scalar multiplication
+    // Arithmetic Operators: +, -, scalar * and the comparisons are lazy expressions (expression.hpp),
+    // the matrix product is declared below
 
     // Assignment Operators
-    Matrix &operator=(const Matrix &other);     // Copy assignment
-    Matrix &operator=(Matrix &&other) noexcept; // Move assignment
+    BasicMatrix &operator=(const BasicMatrix &other);     // Copy assignment
+    BasicMatrix &operator=(BasicMatrix &&other);          // Move assignment (copies if other's storage is from another memory resource)
+    template <typename E>
+    BasicMatrix &operator=(const KaloAlgebraExpressions::MatrixExpression<E> &expression); // Evaluate a lazy expression
 
-    // Comparison Operators
-    bool operator==(const Matrix &other) const; // Check equality
-    bool operator!=(const Matrix &other) const; // Check inequality
+    // Compound Assignment Operators: in place, without allocating
+    template <typename E>
+    BasicMatrix &operator+=(const KaloAlgebraExpressions::MatrixExpression<E> &expression); // Add element-wise
+    template <typename E>
+    BasicMatrix &operator-=(const KaloAlgebraExpressions::MatrixExpression<E> &expression); // Subtract element-wise
+    BasicMatrix &operator*=(T scalar);                                                     // Scale every element
+    BasicMatrix &operator/=(T scalar);                                                     // Divide every element
 
     // Static Methods
-    static Matrix identity(int size);                                 // Create an identity matrix
-    static Matrix zero(int rows, int cols);                           // Create a zero matrix
-    static Matrix random(int rows, int cols, double min, double max); // Create a random matrix
+    static BasicMatrix identity(int size);                           // Create an identity matrix
+    static BasicMatrix zero(int rows, int cols);                     // Create a zero matrix
+    static BasicMatrix random(int rows, int cols, Real min, Real max); // Create a random matrix (complex: both parts in [min, max))
+    static BasicMatrix random(int rows, int cols, Real min, Real max, KaloAlgebraUtils::RandomGenerator &generator); // Draw from a seeded generator
 };
+
+using Matrix = BasicMatrix<double>;
+using FloatMatrix = BasicMatrix<float>;
+using ComplexFloatMatrix = BasicMatrix<std::complex<float>>;
+using ComplexMatrix = BasicMatrix<std::complex<double>>;
+
+extern template class BasicMatrix<float>;
+extern template class BasicMatrix<double>;
+extern template class BasicMatrix<std::complex<float>>;
+extern template class BasicMatrix<std::complex<double>>;
+
+// The free functions below are templates over the scalar type, instantiated for the four supported
+// types. alpha and beta must already have that type (2.0f for float matrices); matrices and
+// writable views convert to the view parameters implicitly.
+
+// General matrix multiply: C = alpha * A * B + beta * C (C must already have the product's shape).
+// Matrices and views are both accepted; C must not overlap A or B. With beta 0 and B == A.t(), as
+// in X * X.t(), the product goes through syrk and only half of it is computed.
+template <typename T>
+void gemm(T alpha, MatrixViewOf<const T> A, MatrixViewOf<const T> B, T beta, MatrixViewOf<T> C);
+
+// Symmetric rank-k update: C = alpha * A * A^T + beta * C, with C n x n for an n x k A. About half
+// the work of gemm; pass X.t() as A for X^T * X. C must already be symmetric when beta is not 0.
+template <typename T>
+void syrk(T alpha, MatrixViewOf<const T> A, T beta, MatrixViewOf<T> C);
+
+// Output-parameter and BLAS style operations: they write into storage the caller owns, and only
+// allocate when out does not have the result's shape yet
+template <typename T>
+void add(const BasicMatrix<T> &A, const BasicMatrix<T> &B, BasicMatrix<T> &out);      // out = A + B
+template <typename T>
+void subtract(const BasicMatrix<T> &A, const BasicMatrix<T> &B, BasicMatrix<T> &out); // out = A - B
+template <typename T>
+void multiply(MatrixViewOf<const T> A, MatrixViewOf<const T> B, BasicMatrix<T> &out); // out = A * B
+template <typename T>
+void axpy(T alpha, MatrixViewOf<const T> X, MatrixViewOf<T> Y);                         // Y += alpha * X
+template <typename T>
+void scal(T alpha, MatrixViewOf<T> X);                                                  // X *= alpha
+
+// Matrix-vector operations: y must not overlap A or x
+template <typename T>
+void gemv(T alpha, MatrixViewOf<const T> A, VectorViewOf<const T> x, T beta, VectorViewOf<T> y); // y = alpha * A * x + beta * y
+template <typename T>
+void ger(T alpha, VectorViewOf<const T> x, VectorViewOf<const T> y, MatrixViewOf<T> A);         // A += alpha * x * y^T
+template <typename T>
+void multiply(MatrixViewOf<const T> A, VectorViewOf<const T> x, BasicVector<T> &out);           // out = A * x
+
+template <typename T>
+template <typename E>
+BasicMatrix<T>::BasicMatrix(const KaloAlgebraExpressions::MatrixExpression<E> &expression)
+    : BasicMatrix(expression.self().getRows(), expression.self().getCols(), Uninitialized())
+{
+    assign(expression.self());
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T> &BasicMatrix<T>::operator=(const KaloAlgebraExpressions::MatrixExpression<E> &expression)
+{
+    // Element-wise expressions read (i, j) of each operand to write (i, j), so this matrix may
+    // appear as an operand. A transposed or shifted view of it may not: writing (i, j) would change
+    // an element still to be read, so such an expression is evaluated into new storage first. The
+    // check also comes before any reallocation, which would free storage the expression reads.
+    const E &source = expression.self();
+    if (source.overlapsShifted(data(), rows, cols, stride))
+    {
+        if constexpr (std::is_same<E, BasicMatrixView<const T>>::value || std::is_same<E, BasicMatrixView<T>>::value)
+        {
+            // A = A.t() for square A needs no new storage
+            if (rows == cols && source.getRows() == rows && source.data() == data() && source.getRowStride() == 1 && source.getColStride() == stride)
+            {
+                transposeInPlace();
+                return *this;
+            }
+        }
+        return *this = BasicMatrix(source);
+    }
+    if (rows != source.getRows() || cols != source.getCols())
+    {
+        *this = BasicMatrix(source.getRows(), source.getCols(), Uninitialized());
+    }
+    assign(source);
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T> &BasicMatrix<T>::operator+=(const KaloAlgebraExpressions::MatrixExpression<E> &expression)
+{
+    // Same per-element arithmetic as `A = A + expression`, so both spellings give the same bits. An
+    // expression reading this matrix transposed or shifted is evaluated first, as in operator=.
+    if (expression.self().overlapsShifted(data(), rows, cols, stride))
+    {
+        const BasicMatrix operand(expression.self());
+        assign(KaloAlgebraExpressions::MatrixBinaryExpression<BasicMatrix, BasicMatrix, KaloAlgebraExpressions::AddOp>(*this, operand));
+        return *this;
+    }
+    assign(KaloAlgebraExpressions::MatrixBinaryExpression<BasicMatrix, E, KaloAlgebraExpressions::AddOp>(*this, expression.self()));
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+BasicMatrix<T> &BasicMatrix<T>::operator-=(const KaloAlgebraExpressions::MatrixExpression<E> &expression)
+{
+    if (expression.self().overlapsShifted(data(), rows, cols, stride))
+    {
+        const BasicMatrix operand(expression.self());
+        assign(KaloAlgebraExpressions::MatrixBinaryExpression<BasicMatrix, BasicMatrix, KaloAlgebraExpressions::SubtractOp>(*this, operand));
+        return *this;
+    }
+    assign(KaloAlgebraExpressions::MatrixBinaryExpression<BasicMatrix, E, KaloAlgebraExpressions::SubtractOp>(*this, expression.self()));
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+void BasicMatrix<T>::assign(const E &expression)
+{
+    static_assert(std::is_same<typename E::value_type, T>::value, "Expression must have the matrix's scalar type");
+    KaloAlgebraParallel::parallelFor(0, rows, cols, [&](long long first, long long last)
+                                     {
+        for (int i = static_cast<int>(first); i < last; i++)
+        {
+            expression.evaluateRow(rowPtr(i), i);
+        } });
+}
+
+namespace KaloAlgebraExpressions
+{
+    // Operands of the matrix product are evaluated once up front; leaves are used in place
+    template <typename T>
+    BasicMatrixView<const T> materialize(const BasicMatrix<T> &matrix) { return matrix.view(); }
+    template <typename E>
+    BasicMatrix<typename E::value_type> materialize(const MatrixExpression<E> &expression) { return BasicMatrix<typename E::value_type>(expression); }
+
+    template <typename T>
+    BasicMatrix<T> matrixProduct(BasicMatrixView<const T> left, BasicMatrixView<const T> right); // Matrix multiplication through gemm
+
+    template <typename L, typename R>
+    BasicMatrix<typename CommonValue<L, R>::type> operator*(const MatrixExpression<L> &left, const MatrixExpression<R> &right)
+    {
+        return matrixProduct<typename CommonValue<L, R>::type>(materialize(left.self()), materialize(right.self()));
+    }
+
+    template <typename T>
+    BasicVector<T> matrixVectorProduct(BasicMatrixView<const T> matrix, BasicVectorView<const T> vector); // A * x through gemv
+    template <typename T>
+    BasicVector<T> vectorMatrixProduct(BasicVectorView<const T> vector, BasicMatrixView<const T> matrix); // x^T * A through gemv
+
+    template <typename L, typename R>
+    BasicVector<typename CommonValue<L, R>::type> operator*(const MatrixExpression<L> &matrix, const VectorExpression<R> &vector)
+    {
+        return matrixVectorProduct<typename CommonValue<L, R>::type>(materialize(matrix.self()), materialize(vector.self()));
+    }
+
+    template <typename L, typename R>
+    BasicVector<typename CommonValue<L, R>::type> operator*(const VectorExpression<L> &vector, const MatrixExpression<R> &matrix)
+    {
+        return vectorMatrixProduct<typename CommonValue<L, R>::type>(materialize(vector.self()), materialize(matrix.self()));
+    }
+}
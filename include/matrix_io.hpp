@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>     // For fixed-width header fields
+#include <string>      // For file paths
+#include <type_traits> // For std::remove_const_t
+#include "matrix.hpp"
+#include "view.hpp"
+
+// Binary matrix files. A file is a 64-byte header followed by the raw row-major elements:
+//
+//     offset  size  field
+//          0     8  magic "KALOMTX\0"
+//          8     4  format version (1)
+//         12     4  byte-order mark 0x01020304, written in the writer's byte order
+//         16     4  scalar type (MatrixFileScalar)
+//         20     4  alignment in bytes of the data and of every row (64)
+//         24     8  rows
+//         32     8  cols
+//         40     8  row stride in elements (>= cols; rows are padded like Matrix storage)
+//         48     8  offset of the first element from the start of the file
+//         56     8  reserved, zero
+//
+// Integer fields use the byte order given by the mark. The rows follow each other at the row stride
+// and padding elements are zero, so the data is a Matrix's storage written out verbatim.
+// loadMapped() maps it into memory and reads the elements in place without copying them.
+namespace KaloAlgebraIO
+{
+    constexpr char fileMagic[8] = {'K', 'A', 'L', 'O', 'M', 'T', 'X', '\0'};
+    constexpr std::uint32_t fileVersion = 1;
+    constexpr std::uint32_t byteOrderMark = 0x01020304;
+    constexpr std::uint32_t fileAlignment = 64;
+
+    enum class MatrixFileScalar : std::uint32_t
+    {
+        Float32 = 1,
+        Float64 = 2,
+        ComplexFloat32 = 3,
+        ComplexFloat64 = 4,
+    };
+
+    template <typename T>
+    constexpr MatrixFileScalar scalarCodeOf()
+    {
+        if constexpr (std::is_same<T, float>::value)
+            return MatrixFileScalar::Float32;
+        else if constexpr (std::is_same<T, double>::value)
+            return MatrixFileScalar::Float64;
+        else if constexpr (std::is_same<T, std::complex<float>>::value)
+            return MatrixFileScalar::ComplexFloat32;
+        else
+        {
+            static_assert(std::is_same<T, std::complex<double>>::value, "unsupported scalar type");
+            return MatrixFileScalar::ComplexFloat64;
+        }
+    }
+
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t scalar;
+        std::uint32_t alignment;
+        std::uint64_t rows;
+        std::uint64_t cols;
+        std::uint64_t rowStride;
+        std::uint64_t dataOffset;
+        std::uint64_t reserved;
+    };
+    static_assert(sizeof(FileHeader) == 64, "the header is exactly 64 bytes");
+
+    // The header save() writes for a rows x cols matrix of T in this machine's byte order
+    template <typename T>
+    FileHeader makeHeader(int rows, int cols);
+
+    // A read-only mapping of a whole file; unmapped on destruction
+    class FileMapping
+    {
+    public:
+        explicit FileMapping(const std::string &path);
+        ~FileMapping();
+        FileMapping(FileMapping &&other) noexcept;
+        FileMapping &operator=(FileMapping &&other) noexcept;
+        FileMapping(const FileMapping &) = delete;
+        FileMapping &operator=(const FileMapping &) = delete;
+
+        const unsigned char *data() const { return address; }
+        std::size_t size() const { return length; }
+
+    private:
+        void release() noexcept;
+
+        const unsigned char *address = nullptr;
+        std::size_t length = 0;
+    };
+}
+
+// A matrix file mapped read-only into memory. The elements are never copied: view() points into
+// the mapping, which stays valid for the lifetime of this object, and the operating system pages
+// them in on first access. Works with every function taking a const view (gemm, gemv, ...).
+template <typename T>
+class BasicMappedMatrix
+{
+public:
+    using value_type = T;
+
+    explicit BasicMappedMatrix(const std::string &path); // Map a file written by save() for this scalar type
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    int getStride() const { return stride; }
+    T getElement(int row, int col) const { return view().getElement(row, col); }
+    const T *data() const { return elements; }
+    BasicMatrixView<const T> view() const { return BasicMatrixView<const T>(elements, rows, cols, stride); }
+    operator BasicMatrixView<const T>() const { return view(); }
+    BasicMatrix<T> toMatrix() const { return BasicMatrix<T>(view()); } // Copy into an owning Matrix
+
+private:
+    KaloAlgebraIO::FileMapping mapping;
+    const T *elements;
+    int rows, cols, stride;
+};
+
+using MappedMatrix = BasicMappedMatrix<double>;
+
+// Write a matrix (or any view of one) to path in the format above, replacing the file
+template <typename T>
+void save(const std::string &path, BasicMatrixView<const T> matrix);
+
+template <typename T>
+void save(const std::string &path, BasicMatrixView<T> matrix)
+{
+    save<T>(path, BasicMatrixView<const T>(matrix));
+}
+
+template <typename T>
+void save(const std::string &path, const BasicMatrix<T> &matrix)
+{
+    save<T>(path, matrix.view());
+}
+
+// Read a file into a new Matrix; files written on a machine of the other byte order are converted
+template <typename T = double>
+BasicMatrix<T> load(const std::string &path);
+
+// Map a file without copying it; it must have been written in this machine's byte order
+template <typename T = double>
+BasicMappedMatrix<T> loadMapped(const std::string &path)
+{
+    return BasicMappedMatrix<T>(path);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef> // For std::size_t
+#include <string>  // For file paths
+#include "matrix_io.hpp"
+#include "view.hpp"
+
+// Out-of-core matrix multiplication for operands and results larger than memory.
+//
+// The product C = A * B is computed one square tile of C at a time. Each tile accumulates the
+// products of a tile row of A and a tile column of B, and is then written to the output file (the
+// format of matrix_io.hpp). Only six tiles are in memory at once: the A and B tiles in use and
+// the next pair, which a background thread is already copying in from the operands, plus the C
+// tile being computed and the one being written out. So reading and writing overlap with the GEMMs.
+//
+// The operands are usually memory-mapped files (MappedMatrix), which the copy pages in from disk,
+// but any view works. The tile size is the largest that keeps the six tiles within memoryBudget
+// bytes. Disk traffic is about 2 * m * n * k / tile elements, so a larger budget reads less.
+constexpr std::size_t defaultOutOfCoreBudget = std::size_t(256) << 20; // 256 MiB
+
+template <typename T>
+void multiplyOutOfCore(BasicMatrixView<const T> A, BasicMatrixView<const T> B, const std::string &outputPath,
+                       std::size_t memoryBudget = defaultOutOfCoreBudget);
+
+template <typename T>
+void multiplyOutOfCore(const BasicMappedMatrix<T> &A, const BasicMappedMatrix<T> &B, const std::string &outputPath,
+                       std::size_t memoryBudget = defaultOutOfCoreBudget)
+{
+    multiplyOutOfCore<T>(A.view(), B.view(), outputPath, memoryBudget);
+}
+
+// The tile size multiplyOutOfCore uses for a budget, or 0 if the budget is too small
+template <typename T>
+int outOfCoreTileSize(std::size_t memoryBudget);
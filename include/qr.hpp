@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector> // For std::vector
+#include "matrix.hpp"
+#include "vector.hpp"
+
+// Householder QR decomposition, A = Q * R, of an m x n matrix with m >= n.
+//
+// Q is kept implicitly as Householder reflectors (LAPACK's geqrf layout) and applied with
+// compact-WY block reflectors, I - V * T * V^T, so that nearly all of the work of both the
+// factorization and applyQ()/applyQT() runs in GEMM. Q is only formed when getQ() is called.
+//
+// Tall-skinny matrices use TSQR: the rows are split into blocks that are factored in parallel,
+// and the stacked R factors of the blocks are factored once more. The split depends only on the
+// shape of A, so the result is the same for every thread count.
+class QRDecomposition
+{
+private:
+    // Reflectors of one flat factorization
+    struct Reflectors
+    {
+        Matrix factors;          // R on and above the diagonal, the Householder vectors below it (unit diagonal implied)
+        std::vector<double> tau; // Scalar factor of each reflector
+        Matrix blockT;           // Upper-triangular T of each block of reflectors, side by side
+
+        Reflectors() : factors(0, 0), blockT(0, 0) {}
+    };
+
+    int rows, cols;
+    int leafRows;                  // Rows per TSQR block (the last block takes the remainder)
+    std::vector<Reflectors> leaves; // One entry when TSQR is not used
+    Reflectors root;               // QR of the stacked leaf R factors, TSQR only
+
+    static void factor(Reflectors &reflectors);
+    static void apply(const Reflectors &reflectors, bool transpose, double *B, int ldb, int rhs);
+    void applyInPlace(bool transpose, double *B, int ldb, int rhs) const;
+    const Matrix &rFactors() const;
+
+public:
+    explicit QRDecomposition(const Matrix &A); // Factor A, which needs at least as many rows as columns
+
+    int getRows() const;
+    int getCols() const;
+    bool isFullRank() const; // False if some diagonal element of R is exactly zero
+    Matrix getR() const;     // n x n upper-triangular factor
+    Matrix getQ() const;     // m x n factor with orthonormal columns (forms it explicitly)
+
+    void applyQT(Vector &b) const; // b = Q^T * b with the full m x m Q, without forming Q
+    void applyQT(Matrix &B) const; // B = Q^T * B
+    void applyQ(Vector &b) const;  // b = Q * b
+    void applyQ(Matrix &B) const;  // B = Q * B
+
+    Vector leastSquares(const Vector &b) const; // x minimizing ||A * x - b||
+    Matrix leastSquares(const Matrix &B) const; // The same for every column of B
+};
+
+// One-shot least-squares solves that factor A first
+Vector leastSquares(const Matrix &A, const Vector &b);
+Matrix leastSquares(const Matrix &A, const Matrix &B);
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>   // For the Philox counter and key
+#include <cstddef> // For std::size_t
+#include <cstdint> // For std::uint32_t, std::uint64_t
+#include "scalar.hpp"
+#include "view.hpp"
+
+namespace KaloAlgebraUtils
+{
+    // Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3"): ten rounds of
+    // multiplies and xors that turn a 128-bit counter and a 64-bit key into 128 random bits.
+    // Block n of a stream is a pure function of (key, n), so any range of a fill can be computed
+    // on its own, by any thread or SIMD lane, with the same result.
+    std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key);
+
+    // Seedable, counter-based random generator. The seed is the Philox key, the stream is the
+    // upper half of the counter and the position, the lower half, is the next block to use; a
+    // generator is just these three integers, so creating or copying one is free.
+    //
+    // Each block gives 2 doubles or 4 floats (complex values take two). Fills use consecutive
+    // blocks from the position and advance it, split across the thread pool: the values depend
+    // only on (seed, stream, position), never on the thread count or instruction set. Generators
+    // with the same seed and different streams never overlap, which is how to give each of many
+    // tasks its own generator (split).
+    class RandomGenerator
+    {
+    private:
+        std::uint64_t seed, stream, position;
+
+    public:
+        explicit RandomGenerator(std::uint64_t seed, std::uint64_t stream = 0);
+        static RandomGenerator fromEntropy(); // seeded once from std::random_device
+
+        // Accessors
+        std::uint64_t getSeed() const { return seed; }
+        std::uint64_t getStream() const { return stream; }
+        std::uint64_t getPosition() const { return position; }
+        void setPosition(std::uint64_t block) { position = block; } // jump anywhere in the stream
+        RandomGenerator split(std::uint64_t newStream) const { return RandomGenerator(seed, newStream); }
+
+        // Single draws, one block each
+        std::array<std::uint32_t, 4> nextBlock();  // 128 raw bits
+        double uniform(double min, double max);    // uniform in [min, max)
+        double normal(double mean, double stddev); // normal, by Box-Muller
+
+        // Fills: uniform in [min, max), or normal with the given mean and standard deviation.
+        // Complex elements draw the real and imaginary parts independently.
+        template <typename T>
+        void fillUniform(T *data, std::size_t count, RealType<T> min, RealType<T> max);
+        template <typename T>
+        void fillNormal(T *data, std::size_t count, RealType<T> mean, RealType<T> stddev);
+        template <typename T>
+        void fillUniform(BasicMatrixView<T> target, RealType<T> min, RealType<T> max); // row-major element order
+        template <typename T>
+        void fillNormal(BasicMatrixView<T> target, RealType<T> mean, RealType<T> stddev);
+        template <typename T>
+        void fillUniform(BasicVectorView<T> target, RealType<T> min, RealType<T> max);
+        template <typename T>
+        void fillNormal(BasicVectorView<T> target, RealType<T> mean, RealType<T> stddev);
+    };
+
+    // The calling thread's generator, seeded from std::random_device the first time a thread
+    // uses it. Matrix::random, Vector::random and randomDouble draw from it unless given a
+    // generator; assign RandomGenerator(seed) to it to make them reproducible.
+    RandomGenerator &threadGenerator();
+}
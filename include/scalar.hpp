@@ -0,0 +1,37 @@
+#pragma once
+
+#include <complex>     // For std::complex
+#include <type_traits> // For std::false_type, std::true_type
+
+namespace KaloAlgebraUtils
+{
+    // Element types the containers and kernels are instantiated for: float, double,
+    // std::complex<float> and std::complex<double>
+    template <typename T>
+    struct ScalarTraits
+    {
+        using Real = T; // Type of magnitudes, norms and random bounds
+        static constexpr bool isComplex = false;
+    };
+
+    template <typename T>
+    struct ScalarTraits<std::complex<T>>
+    {
+        using Real = T;
+        static constexpr bool isComplex = true;
+    };
+
+    template <typename T>
+    using RealType = typename ScalarTraits<T>::Real;
+
+    // Wrapping a parameter type in NonDeduced keeps template argument deduction away from it, so
+    // the scalar type comes from the other arguments and matrices or vectors convert to views
+    template <typename T>
+    struct Identity
+    {
+        using type = T;
+    };
+
+    template <typename T>
+    using NonDeduced = typename Identity<T>::type;
+}
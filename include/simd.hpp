@@ -0,0 +1,61 @@
+#pragma once
+
+#include <complex> // For std::complex
+#include <cstddef> // For std::size_t
+
+namespace KaloAlgebraSimd
+{
+    // Instruction sets the kernels are compiled for, from slowest to fastest
+    enum class Isa
+    {
+        Scalar, // portable C++, no intrinsics
+        SSE2,
+        AVX2,   // AVX2 + FMA
+        AVX512  // AVX-512F
+    };
+
+    Isa detectIsa();                // best instruction set this CPU supports
+    Isa activeIsa();                // instruction set the kernels currently dispatch to
+    bool isIsaSupported(Isa isa);   // whether this CPU (and build) can run kernels for isa
+    void forceIsa(Isa isa);         // dispatch to isa from now on, throws if it is unsupported
+    void resetIsa();                // go back to the detected instruction set
+    const char *isaName(Isa isa);   // "scalar", "sse2", "avx2" or "avx512"
+
+    // BLAS-1 kernels on raw storage, dispatched to the active instruction set.
+    // The output may alias an input exactly (in-place updates) but must not partially overlap.
+    double dot(const double *a, const double *b, std::size_t n);              // sum of a[i] * b[i]
+    double sumOfSquares(const double *a, std::size_t n);                      // sum of a[i] * a[i]
+    void add(const double *a, const double *b, double *out, std::size_t n);      // out = a + b
+    void subtract(const double *a, const double *b, double *out, std::size_t n); // out = a - b
+    void multiply(const double *a, const double *b, double *out, std::size_t n); // out = a .* b
+    void scale(const double *a, double scalar, double *out, std::size_t n);      // out = a * scalar
+    void axpy(double alpha, const double *x, double *y, std::size_t n);          // y += alpha * x
+
+    // The same kernels for float, with twice as many lanes per register
+    float dot(const float *a, const float *b, std::size_t n);
+    float sumOfSquares(const float *a, std::size_t n);
+    void add(const float *a, const float *b, float *out, std::size_t n);
+    void subtract(const float *a, const float *b, float *out, std::size_t n);
+    void multiply(const float *a, const float *b, float *out, std::size_t n);
+    void scale(const float *a, float scalar, float *out, std::size_t n);
+    void axpy(float alpha, const float *x, float *y, std::size_t n);
+
+    // Complex elements are (real, imaginary) pairs in memory. Add, subtract and sumOfSquares run the
+    // real kernels over 2n values; the products are portable loops the compiler vectorizes.
+    // dot is the plain bilinear sum of a[i] * b[i], without conjugation; sumOfSquares is sum of |a[i]|^2.
+    std::complex<float> dot(const std::complex<float> *a, const std::complex<float> *b, std::size_t n);
+    float sumOfSquares(const std::complex<float> *a, std::size_t n);
+    void add(const std::complex<float> *a, const std::complex<float> *b, std::complex<float> *out, std::size_t n);
+    void subtract(const std::complex<float> *a, const std::complex<float> *b, std::complex<float> *out, std::size_t n);
+    void multiply(const std::complex<float> *a, const std::complex<float> *b, std::complex<float> *out, std::size_t n);
+    void scale(const std::complex<float> *a, std::complex<float> scalar, std::complex<float> *out, std::size_t n);
+    void axpy(std::complex<float> alpha, const std::complex<float> *x, std::complex<float> *y, std::size_t n);
+
+    std::complex<double> dot(const std::complex<double> *a, const std::complex<double> *b, std::size_t n);
+    double sumOfSquares(const std::complex<double> *a, std::size_t n);
+    void add(const std::complex<double> *a, const std::complex<double> *b, std::complex<double> *out, std::size_t n);
+    void subtract(const std::complex<double> *a, const std::complex<double> *b, std::complex<double> *out, std::size_t n);
+    void multiply(const std::complex<double> *a, const std::complex<double> *b, std::complex<double> *out, std::size_t n);
+    void scale(const std::complex<double> *a, std::complex<double> scalar, std::complex<double> *out, std::size_t n);
+    void axpy(std::complex<double> alpha, const std::complex<double> *x, std::complex<double> *y, std::size_t n);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector> // For std::vector
+#include "matrix.hpp"
+#include "vector.hpp"
+#include "view.hpp"
+
+// Sparse matrix in compressed sparse row (CSR) form: only the nonzero elements are stored, row by
+// row, each row sorted by column. Products are row-parallel, with the rows split so that every
+// task gets about the same number of nonzeros; each output element is summed in a fixed order, so
+// results do not depend on the thread count.
+class SparseMatrix
+{
+public:
+    // One (row, col, value) entry for fromTriplets()
+    struct Triplet
+    {
+        int row, col;
+        double value;
+    };
+
+    // Compressed sparse column (CSC) arrays, the column-major counterpart of CSR
+    struct CompressedColumns
+    {
+        int rows, cols;
+        std::vector<long long> colOffsets; // Column j holds entries colOffsets[j] .. colOffsets[j + 1] - 1
+        std::vector<int> rowIndices;       // Row of each entry, sorted within a column
+        std::vector<double> values;
+    };
+
+private:
+    int rows, cols;
+    std::vector<long long> rowOffsets; // Row i holds entries rowOffsets[i] .. rowOffsets[i + 1] - 1, rows + 1 entries
+    std::vector<int> columnIndices;    // Column of each entry, strictly increasing within a row
+    std::vector<double> values;        // Value of each entry
+
+public:
+    // Constructors
+    SparseMatrix(int rows, int cols); // All zeros
+    SparseMatrix(int rows, int cols, std::vector<long long> rowOffsets, std::vector<int> columnIndices,
+                 std::vector<double> values); // Adopt CSR arrays, which are checked
+    explicit SparseMatrix(const Matrix &dense, double dropTolerance = 0.0); // Keep elements with |value| > dropTolerance
+
+    // Builds a matrix from entries in any order; entries at the same position are summed
+    static SparseMatrix fromTriplets(int rows, int cols, const std::vector<Triplet> &triplets);
+    static SparseMatrix fromCSC(const CompressedColumns &csc);
+
+    // Accessors
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    long long getNonZeros() const { return rowOffsets.back(); }
+    const std::vector<long long> &getRowOffsets() const { return rowOffsets; }
+    const std::vector<int> &getColumnIndices() const { return columnIndices; }
+    const std::vector<double> &getValues() const { return values; }
+    double getElement(int row, int col) const; // Binary search within the row, 0 for an entry that is not stored
+
+    // Conversions
+    Matrix toDense() const;
+    CompressedColumns toCSC() const;
+    SparseMatrix transpose() const;
+
+    // Products
+    Vector operator*(ConstVectorView x) const; // A * x
+    Matrix operator*(ConstMatrixView B) const; // A * B
+};
+
+// Sparse products on existing storage
+void spmv(double alpha, const SparseMatrix &A, ConstVectorView x, double beta, VectorView y); // y = alpha * A * x + beta * y
+void spmm(double alpha, const SparseMatrix &A, ConstMatrixView B, double beta, MatrixView C); // C = alpha * A * B + beta * C
+void multiply(const SparseMatrix &A, ConstVectorView x, Vector &out);                         // out = A * x
+void multiply(const SparseMatrix &A, ConstMatrixView B, Matrix &out);                         // out = A * B
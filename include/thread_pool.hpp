@@ -0,0 +1,65 @@
+#pragma once
+
+#include <utility> // For std::forward
+
+namespace KaloAlgebraParallel
+{
+    // Number of threads (including the calling thread) parallel kernels use.
+    // Defaults to the hardware concurrency, or KALO_ALGEBRA_NUM_THREADS when it is set.
+    void setThreadCount(int count); // 0 selects the hardware concurrency
+    int getThreadCount();
+
+    // Operations whose estimated work (elements touched, or multiply-adds for products)
+    // is below this threshold run serially on the calling thread
+    void setSerialThreshold(long long work);
+    long long getSerialThreshold();
+
+    // True while the current thread is running a parallel task; nested loops then run serially
+    bool insideParallelRegion();
+
+    // 0 on threads outside the pool, 1..getThreadCount()-1 on pool workers. The threads running
+    // the chunks of one parallelFor always have distinct indices, so per-thread scratch can be
+    // indexed by it.
+    int currentThreadIndex();
+
+    // Non-owning reference to a callable taking a [begin, end) range, so dispatching work never allocates
+    class RangeFunction
+    {
+    private:
+        void *object;
+        void (*invoke)(void *, long long, long long);
+
+    public:
+        template <typename Body>
+        explicit RangeFunction(Body &body)
+            : object(const_cast<void *>(static_cast<const void *>(&body))),
+              invoke([](void *target, long long begin, long long end)
+                     { (*static_cast<Body *>(target))(begin, end); }) {}
+
+        void operator()(long long begin, long long end) const { invoke(object, begin, end); }
+    };
+
+    // Splits [begin, end) into at most chunkCount contiguous chunks and runs them on the shared
+    // work-stealing pool, with the calling thread helping. Returns once every chunk is done and
+    // rethrows the first exception a chunk threw.
+    void runParallel(long long begin, long long end, long long chunkCount, const RangeFunction &body);
+
+    // Runs body(rangeBegin, rangeEnd) over [begin, end), in parallel when the total work
+    // (end - begin) * costPerIndex reaches the serial threshold. Chunks are contiguous, so
+    // element-wise kernels give the same bits for every thread count.
+    template <typename Body>
+    void parallelFor(long long begin, long long end, long long costPerIndex, Body &&body)
+    {
+        const long long count = end - begin;
+        if (count <= 0)
+            return;
+        const int threads = getThreadCount();
+        if (threads <= 1 || count == 1 || insideParallelRegion() || count * costPerIndex < getSerialThreshold())
+        {
+            body(begin, end);
+            return;
+        }
+        // A few chunks per thread leave the stealers something to balance with
+        runParallel(begin, end, static_cast<long long>(threads) * 4, RangeFunction(body));
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace KaloAlgebraKernels
+{
+    // Out-of-place transpose on raw storage: B = A^T
+    //
+    // A is rows x cols with leading dimension lda, B is cols x rows with leading dimension ldb;
+    // the two must not overlap. The matrix is split recursively until blocks fit in L1, and each
+    // block is moved in square register tiles, so both the loads and the stores stream through
+    // whole cache lines.
+    template <typename T>
+    void transpose(int rows, int cols, const T *A, int lda, T *B, int ldb);
+
+    // In-place transpose of an n x n matrix with leading dimension lda, without extra memory
+    template <typename T>
+    void transposeInPlace(int n, T *A, int lda);
+
+    // Both are instantiated for float, double, std::complex<float> and std::complex<double>
+}
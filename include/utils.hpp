@@ -7,6 +7,8 @@
 
 namespace KaloAlgebraUtils
 {
+    class RandomGenerator; // random.hpp
+
     // euclidean norm of a std::vector<double>
     double euclideanNorm(const std::vector<double> &vec);
 
@@ -16,6 +18,7 @@ namespace KaloAlgebraUtils
     // print 2d std::vector<std::vetctor<double>>
     void print2DVector(const std::vector<std::vector<double>> &mat);
 
-    // generate random double value
+    // generate random double value, from the thread's generator or a seeded one
     double randomDouble(double min, double max);
+    double randomDouble(double min, double max, RandomGenerator &generator);
 }
\ No newline at end of file
@@ -4,53 +4,185 @@
 #include <vector>
 #include <stdexcept>
 #include <cmath> //For math operations
+#include <complex>
+#include "allocator.hpp"
+#include "expression.hpp"
+#include "random.hpp"
+#include "thread_pool.hpp"
+#include "view.hpp"
 
-class Vector
+// Dense vector over the scalar type T: float, double, std::complex<float> or std::complex<double>.
+// The member functions are compiled once per type in vector.cpp; Vector is the double vector.
+template <typename T>
+class BasicVector : public KaloAlgebraExpressions::VectorExpression<BasicVector<T>>
 {
+public:
+    using value_type = T;
+    using Real = KaloAlgebraUtils::RealType<T>; // magnitudes and random bounds
+    using allocator_type = KaloAlgebraUtils::ResourceAllocator<T>;
+
 private:
-    std::vector<double> data; // data storage for vector
-    int size;                 // vector size
+    std::vector<T, allocator_type> storage; // contiguous, 64-byte aligned elements from the current memory resource (arena.hpp)
+    int size;                                                      // vector size
+
+    struct Uninitialized
+    {
+    };
+    BasicVector(int size, Uninitialized); // allocate without writing the elements
+
+    template <typename E>
+    void assign(const E &expression); // fused, parallel evaluation of an expression into storage
 
 public:
     // constructors
-    Vector() : size(0), data() {} // Default constructor
-    Vector(int size, double initialValue = 0.0);  // with size and initial value
-    Vector(const std::vector<double> &inputData); // with std::vector instance
-    Vector(const Vector &other);                  // copy constructor
-    Vector(Vector &&other) noexcept;              // move constructor
+    BasicVector() : storage(), size(0) {} // Default constructor
+    BasicVector(int size, T initialValue = T(0));  // with size and initial value
+    BasicVector(const std::vector<T> &inputData); // with std::vector instance
+    BasicVector(const BasicVector &other);        // copy constructor
+    BasicVector(BasicVector &&other) noexcept;    // move constructor
+    template <typename E>
+    BasicVector(const KaloAlgebraExpressions::VectorExpression<E> &expression); // evaluate a lazy expression
 
     // Destructor
-    ~Vector();
+    ~BasicVector();
 
     // Accessors
-    int getSize() const;                      // get vector size
-    double getElement(int index) const;       // get an element
-    void setElement(int index, double value); // set value
+    int getSize() const;                 // get vector size
+    KaloAlgebraUtils::MemoryResource *getResource() const { return storage.get_allocator().getResource(); } // where the storage comes from
+    T getElement(int index) const;       // get an element
+    void setElement(int index, T value); // set value
+    T *data() { return storage.data(); }             // raw storage for kernels
+    const T *data() const { return storage.data(); } // raw storage for kernels
+    T evaluate(int index) const { return storage[index]; } // unchecked access for expressions
+    const T *contiguousData() const { return storage.data(); }
     void print() const;
 
+    // Views: non-owning windows onto this vector's storage (see view.hpp)
+    BasicVectorView<T> view() { return BasicVectorView<T>(data(), size); }
+    BasicVectorView<const T> view() const { return BasicVectorView<const T>(data(), size); }
+    BasicVectorView<T> segment(int start, int length) { return view().segment(start, length); } // elements [start, start + length)
+    BasicVectorView<const T> segment(int start, int length) const { return view().segment(start, length); }
+    operator BasicVectorView<T>() { return view(); }
+    operator BasicVectorView<const T>() const { return view(); }
+
     // Vector operations
-    double magnitude() const;                // returns magnitude
-    Vector normalize() const;                // returns normalized vector
-    double dot(const Vector &other) const;   // dot product
-    Vector cross(const Vector &other) const; // cross product (only for 3d vectors)
-    Vector projectOnto(const Vector &other) const; // useful in physics for collision resolution and neural network for weight adjustment
-    Vector hadamard(const Vector &other) const; // Essential in NN for element-wise weight updates 
-
-    // Arithmetic Operators
-    Vector operator+(const Vector &other) const; // vector addition
-    Vector operator-(const Vector &other) const; // vector subtraction
-    Vector operator*(double scalar) const;       // scalar multiplication
-    double operator*(const Vector &other) const; // dot product
+    Real magnitude() const;                            // returns magnitude (sum of |x_i|^2, square-rooted)
+    BasicVector normalize() const;                     // returns normalized vector
+    T dot(const BasicVector &other) const;             // dot product, sum of x_i * y_i without conjugation
+    BasicVector cross(const BasicVector &other) const; // cross product (only for 3d vectors)
+    BasicVector projectOnto(const BasicVector &other) const; // useful in physics for collision resolution and neural network for weight adjustment
+    BasicVector hadamard(const BasicVector &other) const; // Essential in NN for element-wise weight updates 
+
+    // Arithmetic operators (+, -, * by a scalar, == and !=) are lazy expressions, see expression.hpp
 
     // Assignment operators
-    Vector &operator=(const Vector &other); // copy assignment
-    Vector &operator=(Vector &&other) noexcept;      // move assignment
+    BasicVector &operator=(const BasicVector &other);     // copy assignment
+    BasicVector &operator=(BasicVector &&other);          // move assignment (copies if other's storage is from another memory resource)
+    template <typename E>
+    BasicVector &operator=(const KaloAlgebraExpressions::VectorExpression<E> &expression); // evaluate a lazy expression
 
-    // Comparision operators
-    bool operator==(const Vector &other) const; // equality check
-    bool operator!=(const Vector &other) const; // inequality check
+    // Compound assignment, in place without allocating
+    template <typename E>
+    BasicVector &operator+=(const KaloAlgebraExpressions::VectorExpression<E> &expression); // add element-wise
+    template <typename E>
+    BasicVector &operator-=(const KaloAlgebraExpressions::VectorExpression<E> &expression); // subtract element-wise
+    BasicVector &operator*=(T scalar);                                                     // scale every element
+    BasicVector &operator/=(T scalar);                                                     // divide every element
 
     // Static methods
-    static Vector zero(int size);                           // create a zero vector
-    static Vector random(int size, double min, double max); // create a random vector
+    static BasicVector zero(int size);                       // create a zero vector
+    static BasicVector random(int size, Real min, Real max); // create a random vector (complex: both parts in [min, max))
+    static BasicVector random(int size, Real min, Real max, KaloAlgebraUtils::RandomGenerator &generator); // draw from a seeded generator
 };
+
+using Vector = BasicVector<double>;
+using FloatVector = BasicVector<float>;
+using ComplexFloatVector = BasicVector<std::complex<float>>;
+using ComplexVector = BasicVector<std::complex<double>>;
+
+extern template class BasicVector<float>;
+extern template class BasicVector<double>;
+extern template class BasicVector<std::complex<float>>;
+extern template class BasicVector<std::complex<double>>;
+
+template <typename T>
+template <typename E>
+BasicVector<T>::BasicVector(const KaloAlgebraExpressions::VectorExpression<E> &expression) : BasicVector(expression.self().getSize(), Uninitialized())
+{
+    assign(expression.self());
+}
+
+template <typename T>
+template <typename E>
+BasicVector<T> &BasicVector<T>::operator=(const KaloAlgebraExpressions::VectorExpression<E> &expression)
+{
+    // Element-wise expressions only read index i to write index i, so assigning an expression
+    // that uses this vector is safe. A size change means this vector is not an operand.
+    if (size != expression.self().getSize())
+    {
+        *this = BasicVector(expression.self().getSize(), Uninitialized());
+    }
+    assign(expression.self());
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+BasicVector<T> &BasicVector<T>::operator+=(const KaloAlgebraExpressions::VectorExpression<E> &expression)
+{
+    // Same per-element arithmetic as `v = v + expression`, so both spellings give the same bits
+    assign(KaloAlgebraExpressions::VectorBinaryExpression<BasicVector, E, KaloAlgebraExpressions::AddOp>(*this, expression.self()));
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+BasicVector<T> &BasicVector<T>::operator-=(const KaloAlgebraExpressions::VectorExpression<E> &expression)
+{
+    assign(KaloAlgebraExpressions::VectorBinaryExpression<BasicVector, E, KaloAlgebraExpressions::SubtractOp>(*this, expression.self()));
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+void BasicVector<T>::assign(const E &expression)
+{
+    static_assert(std::is_same<typename E::value_type, T>::value, "Expression must have the vector's scalar type");
+    T *out = data();
+    KaloAlgebraParallel::parallelFor(0, size, 1, [&](long long first, long long last)
+                                     { expression.evaluateRange(out, first, last); });
+}
+
+// Output-parameter and BLAS-1 style operations: they write into storage the caller owns, and
+// only allocate when out does not have the result's size yet. Each is a template over the scalar
+// type, instantiated for the four supported types; alpha must already have that type (2.0f for
+// float vectors), the vectors and views convert implicitly.
+template <typename T>
+void add(const BasicVector<T> &a, const BasicVector<T> &b, BasicVector<T> &out);      // out = a + b
+template <typename T>
+void subtract(const BasicVector<T> &a, const BasicVector<T> &b, BasicVector<T> &out); // out = a - b
+template <typename T>
+void hadamard(const BasicVector<T> &a, const BasicVector<T> &b, BasicVector<T> &out); // out = a .* b
+template <typename T>
+void axpy(T alpha, VectorViewOf<const T> x, VectorViewOf<T> y);                        // y += alpha * x
+template <typename T>
+void scal(T alpha, VectorViewOf<T> x);                                                 // x *= alpha
+
+namespace KaloAlgebraExpressions
+{
+    // Operands of non-element-wise operations are evaluated once up front; leaves are used in place
+    template <typename T>
+    BasicVectorView<const T> materialize(const BasicVector<T> &vector) { return vector.view(); }
+    template <typename E>
+    BasicVector<typename E::value_type> materialize(const VectorExpression<E> &expression) { return BasicVector<typename E::value_type>(expression); }
+
+    template <typename T>
+    T dotProduct(BasicVectorView<const T> left, BasicVectorView<const T> right); // SIMD when both are contiguous
+
+    // dot product
+    template <typename L, typename R>
+    typename CommonValue<L, R>::type operator*(const VectorExpression<L> &left, const VectorExpression<R> &right)
+    {
+        return dotProduct<typename CommonValue<L, R>::type>(materialize(left.self()), materialize(right.self()));
+    }
+}
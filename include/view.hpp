@@ -0,0 +1,294 @@
+#pragma once
+
+#include <cstddef>     // For std::ptrdiff_t
+#include <stdexcept>   // For std::invalid_argument
+#include <type_traits> // For std::is_const, std::enable_if_t
+#include <utility>     // For std::swap
+#include "expression.hpp"
+#include "thread_pool.hpp"
+
+// Non-owning, strided windows onto the storage of a Matrix or Vector (or any other buffer).
+// A view never copies: reading it reads the underlying elements, and assigning to it writes
+// them. Views are expression leaves, so they mix freely with matrices, vectors and lazy
+// expressions, and they are cheap to pass by value.
+//
+// The Scalar parameter is the element type (double, float or a std::complex) for a writable view
+// and its const version for a read-only one; the aliases below name the double views. A writable
+// view converts to the read-only kind.
+//
+// Assigning an expression to a view evaluates element (i, j) into position (i, j). An expression
+// that reads elements of the view at other positions (overlapping, shifted views) gives
+// unspecified results, as with BLAS.
+template <typename Scalar>
+class BasicVectorView : public KaloAlgebraExpressions::VectorExpression<BasicVectorView<Scalar>>
+{
+private:
+    Scalar *pointer;
+    int size;
+    int increment; // distance in elements between consecutive entries
+
+    template <typename E>
+    void assign(const E &expression);
+
+public:
+    using value_type = std::remove_const_t<Scalar>;
+
+    BasicVectorView(Scalar *data, int size, int increment = 1) : pointer(data), size(size), increment(increment)
+    {
+        if (size < 0)
+            throw std::invalid_argument("View size must not be negative!");
+    }
+    BasicVectorView(const BasicVectorView &other) = default;
+    template <typename Other, typename = std::enable_if_t<std::is_same<const Other, Scalar>::value && !std::is_same<Other, Scalar>::value>>
+    BasicVectorView(const BasicVectorView<Other> &other) : pointer(other.data()), size(other.getSize()), increment(other.getIncrement()) {}
+
+    // Accessors
+    int getSize() const { return size; }
+    int getIncrement() const { return increment; }
+    Scalar *data() const { return pointer; }
+    value_type getElement(int index) const
+    {
+        if (index < 0 || index >= size)
+            throw std::invalid_argument("Index out of range!");
+        return evaluate(index);
+    }
+    void setElement(int index, value_type value) const
+    {
+        static_assert(!std::is_const<Scalar>::value, "Cannot write through a read-only view");
+        if (index < 0 || index >= size)
+            throw std::invalid_argument("Index out of range!");
+        pointer[static_cast<std::ptrdiff_t>(index) * increment] = value;
+    }
+    value_type evaluate(int index) const { return pointer[static_cast<std::ptrdiff_t>(index) * increment]; }
+    const value_type *contiguousData() const { return increment == 1 ? pointer : nullptr; }
+
+    // Elements [start, start + length) of this view
+    BasicVectorView segment(int start, int length) const
+    {
+        if (start < 0 || length < 0 || start + length > size)
+            throw std::invalid_argument("Index out of bound!");
+        return BasicVectorView(pointer + static_cast<std::ptrdiff_t>(start) * increment, length, increment);
+    }
+
+    // Assignment writes the viewed elements; it never rebinds the view
+    BasicVectorView &operator=(const BasicVectorView &other)
+    {
+        return *this = static_cast<const KaloAlgebraExpressions::VectorExpression<BasicVectorView> &>(other);
+    }
+    template <typename E>
+    BasicVectorView &operator=(const KaloAlgebraExpressions::VectorExpression<E> &expression)
+    {
+        if (expression.self().getSize() != size)
+            throw std::invalid_argument("Vectors must be the same size for assignment.");
+        assign(expression.self());
+        return *this;
+    }
+    template <typename E>
+    BasicVectorView &operator+=(const KaloAlgebraExpressions::VectorExpression<E> &expression)
+    {
+        assign(KaloAlgebraExpressions::VectorBinaryExpression<BasicVectorView, E, KaloAlgebraExpressions::AddOp>(*this, expression.self()));
+        return *this;
+    }
+    template <typename E>
+    BasicVectorView &operator-=(const KaloAlgebraExpressions::VectorExpression<E> &expression)
+    {
+        assign(KaloAlgebraExpressions::VectorBinaryExpression<BasicVectorView, E, KaloAlgebraExpressions::SubtractOp>(*this, expression.self()));
+        return *this;
+    }
+    BasicVectorView &operator*=(value_type scalar)
+    {
+        assign(KaloAlgebraExpressions::VectorScaleExpression<BasicVectorView>(*this, scalar));
+        return *this;
+    }
+    BasicVectorView &operator/=(value_type scalar)
+    {
+        static_assert(!std::is_const<Scalar>::value, "Cannot write through a read-only view");
+        for (int i = 0; i < size; i++)
+            pointer[static_cast<std::ptrdiff_t>(i) * increment] /= scalar;
+        return *this;
+    }
+};
+
+template <typename Scalar>
+class BasicMatrixView : public KaloAlgebraExpressions::MatrixExpression<BasicMatrixView<Scalar>>
+{
+private:
+    Scalar *pointer;
+    int rows, cols;
+    int rowStride, colStride; // distances in elements between consecutive rows and columns
+
+    template <typename E>
+    void assign(const E &expression);
+
+public:
+    using value_type = std::remove_const_t<Scalar>;
+
+    BasicMatrixView(Scalar *data, int rows, int cols, int rowStride, int colStride = 1)
+        : pointer(data), rows(rows), cols(cols), rowStride(rowStride), colStride(colStride)
+    {
+        if (rows < 0 || cols < 0)
+            throw std::invalid_argument("Matrix dimensions must not be negative!");
+    }
+    BasicMatrixView(const BasicMatrixView &other) = default;
+    template <typename Other, typename = std::enable_if_t<std::is_same<const Other, Scalar>::value && !std::is_same<Other, Scalar>::value>>
+    BasicMatrixView(const BasicMatrixView<Other> &other)
+        : pointer(other.data()), rows(other.getRows()), cols(other.getCols()), rowStride(other.getRowStride()), colStride(other.getColStride()) {}
+
+    // Accessors
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    int getRowStride() const { return rowStride; }
+    int getColStride() const { return colStride; }
+    Scalar *data() const { return pointer; }
+    Scalar *elementPtr(int row, int col) const
+    {
+        return pointer + static_cast<std::ptrdiff_t>(row) * rowStride + static_cast<std::ptrdiff_t>(col) * colStride;
+    }
+    value_type getElement(int row, int col) const
+    {
+        if (row < 0 || row >= rows || col < 0 || col >= cols)
+            throw std::invalid_argument("Index out of range!");
+        return *elementPtr(row, col);
+    }
+    void setElement(int row, int col, value_type value) const
+    {
+        static_assert(!std::is_const<Scalar>::value, "Cannot write through a read-only view");
+        if (row < 0 || row >= rows || col < 0 || col >= cols)
+            throw std::invalid_argument("Index out of range!");
+        *elementPtr(row, col) = value;
+    }
+    value_type evaluate(int row, int col) const { return *elementPtr(row, col); }
+    const value_type *contiguousRow(int row) const { return colStride == 1 ? elementPtr(row, 0) : nullptr; }
+    bool overlapsShifted(const value_type *target, int targetRows, int targetCols, int targetStride) const
+    {
+        if (rows == 0 || cols == 0 || targetRows == 0 || targetCols == 0)
+            return false;
+        if (pointer == target && rows == targetRows && cols == targetCols && rowStride == targetStride && colStride == 1)
+            return false; // Reads (i, j) of the target itself; a different shape would be resized away under it
+        const value_type *first = pointer, *last = elementPtr(rows - 1, cols - 1);
+        if (last < first)
+            std::swap(first, last);
+        const value_type *targetLast = target + static_cast<std::ptrdiff_t>(targetRows - 1) * targetStride + targetCols - 1;
+        return first <= targetLast && target <= last;
+    }
+
+    // Sub-views
+    BasicMatrixView block(int startRow, int startCol, int blockRows, int blockCols) const
+    {
+        if (startRow < 0 || startCol < 0 || blockRows < 0 || blockCols < 0 || startRow + blockRows > rows || startCol + blockCols > cols)
+            throw std::invalid_argument("Index out of bound!");
+        return BasicMatrixView(elementPtr(startRow, startCol), blockRows, blockCols, rowStride, colStride);
+    }
+    BasicVectorView<Scalar> row(int index) const
+    {
+        if (index < 0 || index >= rows)
+            throw std::invalid_argument("Index out of range!");
+        return BasicVectorView<Scalar>(elementPtr(index, 0), cols, colStride);
+    }
+    BasicVectorView<Scalar> col(int index) const
+    {
+        if (index < 0 || index >= cols)
+            throw std::invalid_argument("Index out of range!");
+        return BasicVectorView<Scalar>(elementPtr(0, index), rows, rowStride);
+    }
+    // Lazy transpose: the same elements with rows and columns (and their strides) swapped. Products
+    // consume it directly (A.t() * B, A * B.t() ...) without a copy. Plain transpose for complex
+    // types, without conjugation.
+    BasicMatrixView t() const { return BasicMatrixView(pointer, cols, rows, colStride, rowStride); }
+
+    // Assignment writes the viewed elements; it never rebinds the view
+    BasicMatrixView &operator=(const BasicMatrixView &other)
+    {
+        return *this = static_cast<const KaloAlgebraExpressions::MatrixExpression<BasicMatrixView> &>(other);
+    }
+    template <typename E>
+    BasicMatrixView &operator=(const KaloAlgebraExpressions::MatrixExpression<E> &expression)
+    {
+        if (expression.self().getRows() != rows || expression.self().getCols() != cols)
+            throw std::invalid_argument("Matrix dimensions must match in order to perform assignment!");
+        assign(expression.self());
+        return *this;
+    }
+    template <typename E>
+    BasicMatrixView &operator+=(const KaloAlgebraExpressions::MatrixExpression<E> &expression)
+    {
+        assign(KaloAlgebraExpressions::MatrixBinaryExpression<BasicMatrixView, E, KaloAlgebraExpressions::AddOp>(*this, expression.self()));
+        return *this;
+    }
+    template <typename E>
+    BasicMatrixView &operator-=(const KaloAlgebraExpressions::MatrixExpression<E> &expression)
+    {
+        assign(KaloAlgebraExpressions::MatrixBinaryExpression<BasicMatrixView, E, KaloAlgebraExpressions::SubtractOp>(*this, expression.self()));
+        return *this;
+    }
+    BasicMatrixView &operator*=(value_type scalar)
+    {
+        assign(KaloAlgebraExpressions::MatrixScaleExpression<BasicMatrixView>(*this, scalar));
+        return *this;
+    }
+    BasicMatrixView &operator/=(value_type scalar)
+    {
+        static_assert(!std::is_const<Scalar>::value, "Cannot write through a read-only view");
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < cols; j++)
+                *elementPtr(i, j) /= scalar;
+        return *this;
+    }
+};
+
+using VectorView = BasicVectorView<double>;
+using ConstVectorView = BasicVectorView<const double>;
+using MatrixView = BasicMatrixView<double>;
+using ConstMatrixView = BasicMatrixView<const double>;
+
+// View parameters of the scalar-generic free functions. The scalar type is deduced from the other
+// arguments, so matrices, vectors and writable views convert to these implicitly.
+template <typename Scalar>
+using VectorViewOf = KaloAlgebraUtils::NonDeduced<BasicVectorView<Scalar>>;
+template <typename Scalar>
+using MatrixViewOf = KaloAlgebraUtils::NonDeduced<BasicMatrixView<Scalar>>;
+
+template <typename Scalar>
+template <typename E>
+void BasicVectorView<Scalar>::assign(const E &expression)
+{
+    static_assert(!std::is_const<Scalar>::value, "Cannot write through a read-only view");
+    if (increment == 1)
+    {
+        KaloAlgebraParallel::parallelFor(0, size, 1, [&](long long first, long long last)
+                                         { expression.evaluateRange(pointer, first, last); });
+        return;
+    }
+    KaloAlgebraParallel::parallelFor(0, size, 1, [&](long long first, long long last)
+                                     {
+        for (long long i = first; i < last; i++)
+            pointer[i * increment] = expression.evaluate(static_cast<int>(i)); });
+}
+
+template <typename Scalar>
+template <typename E>
+void BasicMatrixView<Scalar>::assign(const E &expression)
+{
+    static_assert(!std::is_const<Scalar>::value, "Cannot write through a read-only view");
+    KaloAlgebraParallel::parallelFor(0, rows, cols, [&](long long first, long long last)
+                                     {
+        for (int i = static_cast<int>(first); i < last; i++)
+        {
+            if (colStride == 1)
+            {
+                expression.evaluateRow(elementPtr(i, 0), i);
+                continue;
+            }
+            for (int j = 0; j < cols; j++)
+                *elementPtr(i, j) = expression.evaluate(i, j);
+        } });
+}
+
+namespace KaloAlgebraExpressions
+{
+    // Views are already leaves; non-element-wise operations use them as they are
+    template <typename Scalar>
+    BasicVectorView<const std::remove_const_t<Scalar>> materialize(const BasicVectorView<Scalar> &view) { return view; }
+    template <typename Scalar>
+    BasicMatrixView<const std::remove_const_t<Scalar>> materialize(const BasicMatrixView<Scalar> &view) { return view; }
+}
@@ -1,6 +1,6 @@
 #include "kalo_algebra.hpp"
 #include <iostream>
-#include "tests/test_vector.cpp"
+#include <vector>
 
 int main() {
     // Create a 3x3 matrix and set elements
@@ -18,10 +18,16 @@ int main() {
     KaloAlgebra::Vector vec(3, 2.0);
     std::cout << "\nVector Magnitude: " << vec.magnitude() << "\n";
 
-    // test hadamard and test projection
-    testhadamard(); 
-    std::cout<<"\n"; 
-    testProjectOnto(); 
+    // Hadamard product and projection
+    KaloAlgebra::Vector v1(std::vector<double>{1.0, 2.0, 3.0});
+    KaloAlgebra::Vector v2(std::vector<double>{4.0, 5.0, 6.0});
+    std::cout << "Hadamard product of v1 and v2: ";
+    v1.hadamard(v2).print();
+    std::cout << "\n";
+    KaloAlgebra::Vector v3(std::vector<double>{3, 4});
+    KaloAlgebra::Vector v4(std::vector<double>{1, 0});
+    std::cout << "Projection of v3 onto v4: ";
+    v3.projectOnto(v4).print();
      
     return 0;
 }
@@ -0,0 +1,132 @@
+#include "arena.hpp"
+#include <algorithm> // For std::max
+#include <cstdint>   // For std::uintptr_t
+#include <new>       // For aligned operator new/delete
+
+namespace KaloAlgebraUtils
+{
+    namespace
+    {
+        class HeapResource : public MemoryResource
+        {
+        public:
+            void *allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                return ::operator new(bytes, std::align_val_t(alignment));
+            }
+
+            void deallocate(void *pointer, std::size_t, std::size_t alignment) noexcept override
+            {
+                ::operator delete(pointer, std::align_val_t(alignment));
+            }
+        };
+
+        // nullptr means the heap; only ResourceScope changes it
+        thread_local MemoryResource *threadResource = nullptr;
+    }
+
+    MemoryResource *heapResource()
+    {
+        static HeapResource heap;
+        return &heap;
+    }
+
+    MemoryResource *currentResource()
+    {
+        return threadResource ? threadResource : heapResource();
+    }
+
+    Arena::Arena(std::size_t chunkBytes) : chunkBytes(std::max<std::size_t>(chunkBytes, storageAlignment)) {}
+
+    Arena::~Arena()
+    {
+        for (const Chunk &chunk : chunks)
+            ::operator delete(chunk.data, std::align_val_t(storageAlignment));
+    }
+
+    void *Arena::allocate(std::size_t bytes, std::size_t alignment)
+    {
+        // Aligns the address rather than the offset, so alignments above the chunks' own work too
+        const auto fit = [&](const Chunk &chunk, std::size_t from) -> char *
+        {
+            const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(chunk.data);
+            const std::uintptr_t aligned = (base + from + alignment - 1) / alignment * alignment;
+            return aligned - base + bytes <= chunk.size ? chunk.data + (aligned - base) : nullptr;
+        };
+
+        if (!chunks.empty())
+        {
+            if (char *pointer = fit(chunks[current], offset))
+            {
+                offset = pointer + bytes - chunks[current].data;
+                return pointer;
+            }
+        }
+
+        // Move on to the next chunk, reusing one left over from before a rewind if it is large
+        // enough, and inserting a fresh one otherwise
+        const std::size_t next = chunks.empty() ? 0 : current + 1;
+        if (next >= chunks.size() || !fit(chunks[next], 0))
+        {
+            const std::size_t size = std::max(chunkBytes, bytes + alignment);
+            Chunk chunk{static_cast<char *>(::operator new(size, std::align_val_t(storageAlignment))), size};
+            chunks.insert(chunks.begin() + next, chunk);
+        }
+        current = next;
+        char *pointer = fit(chunks[current], 0);
+        offset = pointer + bytes - chunks[current].data;
+        return pointer;
+    }
+
+    void Arena::deallocate(void *pointer, std::size_t bytes, std::size_t) noexcept
+    {
+        // Only the most recent block can be given back before the arena is rewound
+        if (!chunks.empty() && static_cast<char *>(pointer) + bytes == chunks[current].data + offset)
+            offset = static_cast<char *>(pointer) - chunks[current].data;
+    }
+
+    void Arena::rewind(Mark position) noexcept
+    {
+        current = position.chunk;
+        offset = position.offset;
+    }
+
+    std::size_t Arena::getCapacity() const noexcept
+    {
+        std::size_t capacity = 0;
+        for (const Chunk &chunk : chunks)
+            capacity += chunk.size;
+        return capacity;
+    }
+
+    std::size_t Arena::getBytesUsed() const noexcept
+    {
+        std::size_t used = offset;
+        for (std::size_t i = 0; i < current && i < chunks.size(); i++)
+            used += chunks[i].size;
+        return used;
+    }
+
+    Arena &threadArena()
+    {
+        thread_local Arena arena;
+        return arena;
+    }
+
+    ResourceScope::ResourceScope(MemoryResource &resource) : previous(threadResource)
+    {
+        threadResource = &resource;
+    }
+
+    ResourceScope::~ResourceScope()
+    {
+        threadResource = previous;
+    }
+
+    ArenaScope::ArenaScope() : arena(threadArena()), start(arena.mark()), scope(arena) {}
+
+    ArenaScope::~ArenaScope()
+    {
+        arena.rewind(start);
+    }
+}
@@ -0,0 +1,465 @@
+#include "batch.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KALO_ALGEBRA_X86_KERNELS 1
+#endif
+
+#ifdef __GNUC__
+#define KALO_ALGEBRA_ALWAYS_INLINE __attribute__((always_inline))
+#else
+#define KALO_ALGEBRA_ALWAYS_INLINE
+#endif
+
+// A lane loop that must stay a loop: fully unrolled early, the compiler would vectorize the
+// surrounding loop instead, across rows it cannot prove are disjoint, and run the scalar fallback
+#if defined(__clang__)
+#define KALO_ALGEBRA_LANE_LOOP _Pragma("clang loop unroll(disable)")
+#elif defined(__GNUC__)
+#define KALO_ALGEBRA_LANE_LOOP _Pragma("GCC unroll 1")
+#else
+#define KALO_ALGEBRA_LANE_LOOP
+#endif
+
+// Every kernel is a loop body over one block whose innermost loops run over the lanes, a fixed
+// count, so the compiler turns each of them into whole-register operations. The body is inlined
+// into one copy of the block loop per instruction set, and the copy for the active one runs.
+namespace
+{
+    template <typename Body>
+    void blocksGeneric(long long first, long long last, const Body &body)
+    {
+        for (long long block = first; block < last; block++)
+            body(block);
+    }
+
+#ifdef KALO_ALGEBRA_X86_KERNELS
+    template <typename Body>
+    __attribute__((target("avx2,fma"))) void blocksAvx2(long long first, long long last, const Body &body)
+    {
+        for (long long block = first; block < last; block++)
+            body(block);
+    }
+
+    template <typename Body>
+    __attribute__((target("avx512f"))) void blocksAvx512(long long first, long long last, const Body &body)
+    {
+        for (long long block = first; block < last; block++)
+            body(block);
+    }
+#endif
+
+    // Runs body(block) for blocks [0, blocks) on the thread pool
+    template <typename Body>
+    void forEachBlock(long long blocks, long long costPerBlock, const Body &body)
+    {
+        const KaloAlgebraSimd::Isa isa = KaloAlgebraSimd::activeIsa();
+        KaloAlgebraParallel::parallelFor(0, blocks, costPerBlock, [&](long long first, long long last)
+                                         {
+            switch (isa)
+            {
+#ifdef KALO_ALGEBRA_X86_KERNELS
+            case KaloAlgebraSimd::Isa::AVX512:
+                blocksAvx512(first, last, body);
+                return;
+            case KaloAlgebraSimd::Isa::AVX2:
+                blocksAvx2(first, last, body);
+                return;
+#endif
+            default:
+                blocksGeneric(first, last, body);
+            } });
+    }
+
+    // Number of real items in a block; the rest are padding
+    int validLanes(int count, long long block, int lanes)
+    {
+        return static_cast<int>(std::min<long long>(lanes, count - block * lanes));
+    }
+}
+
+// Matrix batch
+template <typename T>
+BasicMatrixBatch<T>::BasicMatrixBatch(int count, int rows, int cols, T initialValue) : count(count), rows(rows), cols(cols)
+{
+    if (count < 0 || rows <= 0 || cols <= 0)
+        throw std::invalid_argument("Batch dimensions must be greater than 0!");
+    storage.assign(static_cast<std::size_t>(getBlockCount()) * rows * cols * lanes, initialValue);
+}
+
+template <typename T>
+T BasicMatrixBatch<T>::getElement(int index, int row, int col) const
+{
+    if (index < 0 || index >= count || row < 0 || row >= rows || col < 0 || col >= cols)
+        throw std::invalid_argument("Index out of range!");
+    return storage[((static_cast<std::size_t>(index / lanes) * rows + row) * cols + col) * lanes + index % lanes];
+}
+
+template <typename T>
+void BasicMatrixBatch<T>::setElement(int index, int row, int col, T value)
+{
+    if (index < 0 || index >= count || row < 0 || row >= rows || col < 0 || col >= cols)
+        throw std::invalid_argument("Index out of range!");
+    storage[((static_cast<std::size_t>(index / lanes) * rows + row) * cols + col) * lanes + index % lanes] = value;
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrixBatch<T>::getMatrix(int index) const
+{
+    if (index < 0 || index >= count)
+        throw std::invalid_argument("Index out of range!");
+    BasicMatrix<T> result(rows, cols);
+    const T *source = data() + static_cast<std::size_t>(index / lanes) * rows * cols * lanes + index % lanes;
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            result.rowPtr(i)[j] = source[(i * cols + j) * lanes];
+    return result;
+}
+
+template <typename T>
+void BasicMatrixBatch<T>::setMatrix(int index, MatrixViewOf<const T> matrix)
+{
+    if (index < 0 || index >= count)
+        throw std::invalid_argument("Index out of range!");
+    if (matrix.getRows() != rows || matrix.getCols() != cols)
+        throw std::invalid_argument("Matrix dimensions must match the batch!");
+    T *target = data() + static_cast<std::size_t>(index / lanes) * rows * cols * lanes + index % lanes;
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            target[(i * cols + j) * lanes] = *matrix.elementPtr(i, j);
+}
+
+template <typename T>
+BasicMatrixBatch<T> BasicMatrixBatch<T>::transpose() const
+{
+    KALO_ALGEBRA_INSTRUMENT("MatrixBatch::transpose", count, 0.0, 2.0 * count * rows * cols * sizeof(T));
+    constexpr int L = lanes;
+    BasicMatrixBatch result(count, cols, rows);
+    const int m = rows, n = cols;
+    const T *in = data();
+    T *out = result.data();
+    forEachBlock(getBlockCount(), static_cast<long long>(m) * n * L, [&](long long block) KALO_ALGEBRA_ALWAYS_INLINE
+                 {
+        const T *a = in + block * m * n * L;
+        T *b = out + block * m * n * L;
+        for (int i = 0; i < m; i++)
+            for (int j = 0; j < n; j++)
+                for (int l = 0; l < L; l++)
+                    b[(j * m + i) * L + l] = a[(i * n + j) * L + l]; });
+    return result;
+}
+
+// Gauss-Jordan elimination with partial pivoting, run on all lanes of a block at once: each lane
+// picks its own pivot row, and the row swaps are done with per-lane selects instead of branches.
+// The lane loops are separate functions over non-aliasing rows so that each one vectorizes whole.
+namespace
+{
+    template <typename T, int L>
+    KALO_ALGEBRA_ALWAYS_INLINE inline void pickPivot(const T *__restrict candidate, T row, T *__restrict best, T *__restrict pivotRow)
+    {
+        KALO_ALGEBRA_LANE_LOOP
+        for (int l = 0; l < L; l++)
+        {
+            const T magnitude = std::abs(candidate[l]);
+            const bool larger = magnitude > best[l];
+            pivotRow[l] = larger ? row : pivotRow[l];
+            best[l] = larger ? magnitude : best[l];
+        }
+    }
+
+    template <typename T, int L>
+    KALO_ALGEBRA_ALWAYS_INLINE inline void swapLanes(T *__restrict top, T *__restrict other, const T *__restrict pivotRow, T row)
+    {
+        KALO_ALGEBRA_LANE_LOOP
+        for (int l = 0; l < L; l++)
+        {
+            const bool swap = pivotRow[l] == row;
+            const T upper = top[l], lower = other[l];
+            top[l] = swap ? lower : upper;
+            other[l] = swap ? upper : lower;
+        }
+    }
+
+    template <typename T, int L>
+    KALO_ALGEBRA_ALWAYS_INLINE inline void scaleLanes(T *__restrict row, const T *__restrict scale)
+    {
+        KALO_ALGEBRA_LANE_LOOP
+        for (int l = 0; l < L; l++)
+            row[l] *= scale[l];
+    }
+
+    template <typename T, int L>
+    KALO_ALGEBRA_ALWAYS_INLINE inline void eliminateLanes(T *__restrict row, const T *__restrict pivotValues, const T *__restrict factor)
+    {
+        KALO_ALGEBRA_LANE_LOOP
+        for (int l = 0; l < L; l++)
+            row[l] -= factor[l] * pivotValues[l];
+    }
+}
+
+template <typename T>
+BasicMatrixBatch<T> BasicMatrixBatch<T>::inverse() const
+{
+    if (rows != cols)
+        throw std::invalid_argument("Matrix must be square to invert!");
+    const int n = rows;
+    KALO_ALGEBRA_INSTRUMENT("MatrixBatch::inverse", count, 2.0 * count * n * n * n, 2.0 * count * n * n * sizeof(T));
+    constexpr int L = lanes;
+    BasicMatrixBatch work(*this);
+    BasicMatrixBatch result = identity(count, n);
+
+    // Padding lanes become identities, so they stay finite
+    const int lastValid = count % L;
+    if (lastValid != 0)
+    {
+        T *last = work.data() + static_cast<std::size_t>(getBlockCount() - 1) * n * n * L;
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                for (int l = lastValid; l < L; l++)
+                    last[(i * n + j) * L + l] = i == j ? T(1) : T(0);
+    }
+
+    std::atomic<bool> singular{false};
+    const int itemCount = count;
+    T *w = work.data();
+    T *r = result.data();
+    forEachBlock(getBlockCount(), 2LL * n * n * n * L, [&](long long block) KALO_ALGEBRA_ALWAYS_INLINE
+                 {
+        T *a = w + block * n * n * L;
+        T *x = r + block * n * n * L;
+        bool zeroPivot = false;
+        for (int c = 0; c < n; c++)
+        {
+            // Each lane's pivot is the largest magnitude in column c, at or below the diagonal
+            T best[L], pivotRow[L];
+            KALO_ALGEBRA_LANE_LOOP
+            for (int l = 0; l < L; l++)
+            {
+                best[l] = std::abs(a[(c * n + c) * L + l]);
+                pivotRow[l] = T(c);
+            }
+            for (int i = c + 1; i < n; i++)
+                pickPivot<T, L>(a + (i * n + c) * L, T(i), best, pivotRow);
+            for (int i = c + 1; i < n; i++)
+            {
+                for (int j = 0; j < n; j++)
+                    swapLanes<T, L>(a + (c * n + j) * L, a + (i * n + j) * L, pivotRow, T(i));
+                for (int j = 0; j < n; j++)
+                    swapLanes<T, L>(x + (c * n + j) * L, x + (i * n + j) * L, pivotRow, T(i));
+            }
+
+            T scale[L];
+            const T *pivot = a + (c * n + c) * L;
+            for (int l = 0; l < validLanes(itemCount, block, L); l++)
+                zeroPivot = zeroPivot || pivot[l] == T(0);
+            KALO_ALGEBRA_LANE_LOOP
+            for (int l = 0; l < L; l++)
+                scale[l] = T(1) / pivot[l];
+            for (int j = 0; j < n; j++)
+                scaleLanes<T, L>(a + (c * n + j) * L, scale);
+            for (int j = 0; j < n; j++)
+                scaleLanes<T, L>(x + (c * n + j) * L, scale);
+
+            for (int i = 0; i < n; i++)
+            {
+                if (i == c)
+                    continue;
+                T factor[L];
+                std::copy(a + (i * n + c) * L, a + (i * n + c + 1) * L, factor);
+                for (int j = 0; j < n; j++)
+                    eliminateLanes<T, L>(a + (i * n + j) * L, a + (c * n + j) * L, factor);
+                for (int j = 0; j < n; j++)
+                    eliminateLanes<T, L>(x + (i * n + j) * L, x + (c * n + j) * L, factor);
+            }
+        }
+        if (zeroPivot)
+            singular.store(true, std::memory_order_relaxed); });
+
+    if (singular.load())
+        throw std::invalid_argument("Matrix is singular!");
+    return result;
+}
+
+template <typename T>
+BasicMatrixBatch<T> BasicMatrixBatch<T>::identity(int count, int size)
+{
+    BasicMatrixBatch result(count, size, size);
+    T *values = result.data();
+    for (int block = 0; block < result.getBlockCount(); block++)
+        for (int i = 0; i < size; i++)
+            std::fill_n(values + ((static_cast<std::size_t>(block) * size + i) * size + i) * lanes, lanes, T(1));
+    return result;
+}
+
+// Vector batch
+template <typename T>
+BasicVectorBatch<T>::BasicVectorBatch(int count, int size, T initialValue) : count(count), size(size)
+{
+    if (count < 0 || size <= 0)
+        throw std::invalid_argument("Batch dimensions must be greater than 0!");
+    storage.assign(static_cast<std::size_t>(getBlockCount()) * size * lanes, initialValue);
+}
+
+template <typename T>
+T BasicVectorBatch<T>::getElement(int index, int element) const
+{
+    if (index < 0 || index >= count || element < 0 || element >= size)
+        throw std::invalid_argument("Index out of range!");
+    return storage[(static_cast<std::size_t>(index / lanes) * size + element) * lanes + index % lanes];
+}
+
+template <typename T>
+void BasicVectorBatch<T>::setElement(int index, int element, T value)
+{
+    if (index < 0 || index >= count || element < 0 || element >= size)
+        throw std::invalid_argument("Index out of range!");
+    storage[(static_cast<std::size_t>(index / lanes) * size + element) * lanes + index % lanes] = value;
+}
+
+template <typename T>
+BasicVector<T> BasicVectorBatch<T>::getVector(int index) const
+{
+    if (index < 0 || index >= count)
+        throw std::invalid_argument("Index out of range!");
+    BasicVector<T> result(size);
+    const T *source = data() + static_cast<std::size_t>(index / lanes) * size * lanes + index % lanes;
+    for (int e = 0; e < size; e++)
+        result.data()[e] = source[e * lanes];
+    return result;
+}
+
+template <typename T>
+void BasicVectorBatch<T>::setVector(int index, VectorViewOf<const T> vector)
+{
+    if (index < 0 || index >= count)
+        throw std::invalid_argument("Index out of range!");
+    if (vector.getSize() != size)
+        throw std::invalid_argument("Vector size must match the batch!");
+    T *target = data() + static_cast<std::size_t>(index / lanes) * size * lanes + index % lanes;
+    for (int e = 0; e < size; e++)
+        target[e * lanes] = vector.data()[static_cast<std::ptrdiff_t>(e) * vector.getIncrement()];
+}
+
+// Batched operations
+namespace
+{
+    template <typename T, typename Kernel>
+    void elementWise(const BasicMatrixBatch<T> &A, const BasicMatrixBatch<T> &B, BasicMatrixBatch<T> &out, Kernel kernel)
+    {
+        if (A.getCount() != B.getCount() || A.getRows() != B.getRows() || A.getCols() != B.getCols())
+            throw std::invalid_argument("Batch dimensions must match!");
+        if (out.getCount() != A.getCount() || out.getRows() != A.getRows() || out.getCols() != A.getCols())
+            out = BasicMatrixBatch<T>(A.getCount(), A.getRows(), A.getCols());
+        const std::size_t blockSize = static_cast<std::size_t>(A.getRows()) * A.getCols() * BasicMatrixBatch<T>::lanes;
+        const T *a = A.data(), *b = B.data();
+        T *c = out.data();
+        KaloAlgebraParallel::parallelFor(0, A.getBlockCount(), static_cast<long long>(blockSize), [&](long long first, long long last)
+                                         { kernel(a + first * blockSize, b + first * blockSize, c + first * blockSize, (last - first) * blockSize); });
+    }
+}
+
+template <typename T>
+void add(const BasicMatrixBatch<T> &A, const BasicMatrixBatch<T> &B, BasicMatrixBatch<T> &out)
+{
+    KALO_ALGEBRA_INSTRUMENT("MatrixBatch::add", A.getCount(), 1.0 * A.getCount() * A.getRows() * A.getCols(),
+                            3.0 * A.getCount() * A.getRows() * A.getCols() * sizeof(T));
+    elementWise(A, B, out, [](const T *a, const T *b, T *c, std::size_t n)
+                { KaloAlgebraSimd::add(a, b, c, n); });
+}
+
+template <typename T>
+void subtract(const BasicMatrixBatch<T> &A, const BasicMatrixBatch<T> &B, BasicMatrixBatch<T> &out)
+{
+    KALO_ALGEBRA_INSTRUMENT("MatrixBatch::subtract", A.getCount(), 1.0 * A.getCount() * A.getRows() * A.getCols(),
+                            3.0 * A.getCount() * A.getRows() * A.getCols() * sizeof(T));
+    elementWise(A, B, out, [](const T *a, const T *b, T *c, std::size_t n)
+                { KaloAlgebraSimd::subtract(a, b, c, n); });
+}
+
+template <typename T>
+void multiply(const BasicMatrixBatch<T> &A, const BasicMatrixBatch<T> &B, BasicMatrixBatch<T> &out)
+{
+    if (A.getCount() != B.getCount() || A.getCols() != B.getRows())
+        throw std::invalid_argument("Columns of first matrix must match rows of second matrix in order to perform multiplication!");
+    if (&out == &A || &out == &B)
+        throw std::invalid_argument("Output batch must not be one of the operands!");
+    const int m = A.getRows(), k = A.getCols(), n = B.getCols();
+    KALO_ALGEBRA_INSTRUMENT("MatrixBatch::multiply", A.getCount(), 2.0 * A.getCount() * m * n * k,
+                            1.0 * A.getCount() * (m * k + k * n + m * n) * sizeof(T));
+    if (out.getCount() != A.getCount() || out.getRows() != m || out.getCols() != n)
+        out = BasicMatrixBatch<T>(A.getCount(), m, n);
+
+    constexpr int L = BasicMatrixBatch<T>::lanes;
+    const T *left = A.data(), *right = B.data();
+    T *product = out.data();
+    forEachBlock(A.getBlockCount(), 2LL * m * n * k * L, [&](long long block) KALO_ALGEBRA_ALWAYS_INLINE
+                 {
+        const T *a = left + block * m * k * L;
+        const T *b = right + block * k * n * L;
+        T *c = product + block * m * n * L;
+        for (int i = 0; i < m; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                T sum[L] = {};
+                for (int p = 0; p < k; p++)
+                {
+                    const T *x = a + (i * k + p) * L, *y = b + (p * n + j) * L;
+                    for (int l = 0; l < L; l++)
+                        sum[l] += x[l] * y[l];
+                }
+                std::copy(sum, sum + L, c + (i * n + j) * L);
+            }
+        } });
+}
+
+template <typename T>
+void multiply(const BasicMatrixBatch<T> &A, const BasicVectorBatch<T> &x, BasicVectorBatch<T> &out)
+{
+    if (A.getCount() != x.getCount() || A.getCols() != x.getSize())
+        throw std::invalid_argument("Matrix columns must match vector size in order to perform multiplication!");
+    if (&out == &x)
+        throw std::invalid_argument("Output batch must not be one of the operands!");
+    const int m = A.getRows(), n = A.getCols();
+    KALO_ALGEBRA_INSTRUMENT("MatrixBatch::multiply(VectorBatch)", A.getCount(), 2.0 * A.getCount() * m * n,
+                            1.0 * A.getCount() * (m * n + n + m) * sizeof(T));
+    if (out.getCount() != A.getCount() || out.getSize() != m)
+        out = BasicVectorBatch<T>(A.getCount(), m);
+
+    constexpr int L = BasicMatrixBatch<T>::lanes;
+    const T *matrices = A.data(), *vectors = x.data();
+    T *result = out.data();
+    forEachBlock(A.getBlockCount(), 2LL * m * n * L, [&](long long block) KALO_ALGEBRA_ALWAYS_INLINE
+                 {
+        const T *a = matrices + block * m * n * L;
+        const T *v = vectors + block * n * L;
+        T *y = result + block * m * L;
+        for (int i = 0; i < m; i++)
+        {
+            T sum[L] = {};
+            for (int j = 0; j < n; j++)
+            {
+                const T *row = a + (i * n + j) * L, *element = v + j * L;
+                for (int l = 0; l < L; l++)
+                    sum[l] += row[l] * element[l];
+            }
+            std::copy(sum, sum + L, y + i * L);
+        } });
+}
+
+// Explicit instantiations for the supported scalar types
+#define KALO_ALGEBRA_INSTANTIATE_BATCH(T)                                                                     \
+    template class BasicMatrixBatch<T>;                                                                       \
+    template class BasicVectorBatch<T>;                                                                       \
+    template void add<T>(const BasicMatrixBatch<T> &, const BasicMatrixBatch<T> &, BasicMatrixBatch<T> &);      \
+    template void subtract<T>(const BasicMatrixBatch<T> &, const BasicMatrixBatch<T> &, BasicMatrixBatch<T> &); \
+    template void multiply<T>(const BasicMatrixBatch<T> &, const BasicMatrixBatch<T> &, BasicMatrixBatch<T> &); \
+    template void multiply<T>(const BasicMatrixBatch<T> &, const BasicVectorBatch<T> &, BasicVectorBatch<T> &);
+
+KALO_ALGEBRA_INSTANTIATE_BATCH(float)
+KALO_ALGEBRA_INSTANTIATE_BATCH(double)
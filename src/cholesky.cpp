@@ -0,0 +1,290 @@
+#include "cholesky.hpp"
+#include "gemm.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    constexpr int blockSize = 96;    // columns per panel; the trailing GEMMs have this depth
+    constexpr int panelStrip = 16;   // panel columns solved directly before a GEMM updates the rest of the panel
+    constexpr int updateWidth = 256; // columns of the trailing matrix per GEMM in the lower-triangle update
+    constexpr int columnBand = 256;  // right-hand-side columns per task in the triangular solves
+
+    // B = L^-1 * B for a jb x jb lower-triangular L and a jb x cols B, in column bands
+    void solveLower(int jb, int cols, const double *L, int ldl, double *B, int ldb)
+    {
+        const long long bands = (cols + columnBand - 1) / columnBand;
+        KaloAlgebraParallel::parallelFor(0, bands, static_cast<long long>(jb) * jb * columnBand, [&](long long first, long long last)
+                                         {
+            const int begin = static_cast<int>(first * columnBand);
+            const int width = static_cast<int>(std::min<long long>(cols, last * columnBand)) - begin;
+            for (int i = 0; i < jb; i++)
+            {
+                double *target = B + static_cast<long long>(i) * ldb + begin;
+                const double *row = L + static_cast<long long>(i) * ldl;
+                for (int p = 0; p < i; p++)
+                    KaloAlgebraSimd::axpy(-row[p], B + static_cast<long long>(p) * ldb + begin, target, static_cast<std::size_t>(width));
+                for (int j = 0; j < width; j++)
+                    target[j] /= row[i];
+            } });
+    }
+
+    // B = L^-T * B for a jb x jb lower-triangular L and a jb x cols B, in column bands. Row i of L
+    // is column i of L^T, so every step is an axpy with a contiguous row of L
+    void solveLowerTransposed(int jb, int cols, const double *L, int ldl, double *B, int ldb)
+    {
+        const long long bands = (cols + columnBand - 1) / columnBand;
+        KaloAlgebraParallel::parallelFor(0, bands, static_cast<long long>(jb) * jb * columnBand, [&](long long first, long long last)
+                                         {
+            const int begin = static_cast<int>(first * columnBand);
+            const int width = static_cast<int>(std::min<long long>(cols, last * columnBand)) - begin;
+            for (int i = jb - 1; i >= 0; i--)
+            {
+                double *source = B + static_cast<long long>(i) * ldb + begin;
+                const double *row = L + static_cast<long long>(i) * ldl;
+                for (int j = 0; j < width; j++)
+                    source[j] /= row[i];
+                for (int p = 0; p < i; p++)
+                    KaloAlgebraSimd::axpy(-row[p], source, B + static_cast<long long>(p) * ldb + begin, static_cast<std::size_t>(width));
+            } });
+    }
+}
+
+// Blocked right-looking factorization (LAPACK's potrf, lower): factor the diagonal block, solve
+// for the panel below it row by row, then subtract L21 * L21^T from the lower triangle of the
+// trailing matrix
+CholeskyDecomposition::CholeskyDecomposition(const Matrix &A) : factor(A), info(0)
+{
+    KALO_ALGEBRA_INSTRUMENT("CholeskyDecomposition::factor", A.getRows(), 1.0 / 3.0 * A.getRows() * A.getRows() * A.getCols(), 2.0 * A.getRows() * A.getCols() * sizeof(double));
+    if (A.getRows() != A.getCols())
+    {
+        throw std::invalid_argument("Matrix must be square for Cholesky decomposition!");
+    }
+    const int n = A.getRows();
+    double *a = factor.data();
+    const int lda = factor.getStride();
+
+    for (int k = 0; k < n && info == 0; k += blockSize)
+    {
+        const int jb = std::min(blockSize, n - k);
+        double *diagonal = a + static_cast<long long>(k) * lda + k;
+
+        // Diagonal block, unblocked and left-looking: each entry is one dot product along rows
+        for (int j = 0; j < jb && info == 0; j++)
+        {
+            double *rowJ = diagonal + static_cast<long long>(j) * lda;
+            const double pivot = rowJ[j] - KaloAlgebraSimd::sumOfSquares(rowJ, static_cast<std::size_t>(j));
+            if (!(pivot > 0.0)) // also catches NaN
+            {
+                info = k + j + 1;
+                break;
+            }
+            rowJ[j] = std::sqrt(pivot);
+            for (int i = j + 1; i < jb; i++)
+            {
+                double *rowI = diagonal + static_cast<long long>(i) * lda;
+                rowI[j] = (rowI[j] - KaloAlgebraSimd::dot(rowI, rowJ, static_cast<std::size_t>(j))) / rowJ[j];
+            }
+        }
+        if (info != 0)
+            break;
+
+        // L21 = A21 * L11^-T, a few columns at a time: the rows of each narrow strip are solved
+        // independently, then a GEMM removes the strip from the columns to its right
+        const int rest = n - k - jb;
+        double *panel = diagonal + static_cast<long long>(jb) * lda;
+        for (int s = 0; s < jb; s += panelStrip)
+        {
+            const int width = std::min(panelStrip, jb - s);
+            KaloAlgebraParallel::parallelFor(0, rest, static_cast<long long>(width) * width, [&](long long first, long long last)
+                                             {
+                for (long long i = first; i < last; i++)
+                {
+                    double *row = panel + i * lda + s;
+                    for (int j = 0; j < width; j++)
+                    {
+                        const double *rowJ = diagonal + static_cast<long long>(s + j) * lda + s;
+                        row[j] = (row[j] - KaloAlgebraSimd::dot(row, rowJ, static_cast<std::size_t>(j))) / rowJ[j];
+                    }
+                } });
+            if (s + width < jb)
+            {
+                KaloAlgebraKernels::gemm(rest, jb - s - width, width, -1.0,
+                                         panel + s, lda, 1,
+                                         diagonal + static_cast<long long>(s + width) * lda + s, 1, lda,
+                                         1.0, panel + s + width, lda);
+            }
+        }
+
+        // A22 -= L21 * L21^T on the lower triangle, one column band at a time so the GEMMs skip
+        // (almost all of) the upper triangle
+        for (int j = 0; j < rest; j += updateWidth)
+        {
+            const int width = std::min(updateWidth, rest - j);
+            const double *rowsBelow = panel + static_cast<long long>(j) * lda;
+            KaloAlgebraKernels::gemm(rest - j, width, jb, -1.0,
+                                     rowsBelow, lda, 1,
+                                     rowsBelow, 1, lda,
+                                     1.0, panel + static_cast<long long>(j) * lda + jb + j, lda);
+        }
+    }
+
+    // The upper triangle holds leftovers of A and of the trailing updates
+    for (int i = 0; i < n; i++)
+    {
+        std::fill(factor.rowPtr(i) + i + 1, factor.rowPtr(i) + n, 0.0);
+    }
+}
+
+int CholeskyDecomposition::getSize() const
+{
+    return factor.getRows();
+}
+
+int CholeskyDecomposition::getInfo() const
+{
+    return info;
+}
+
+bool CholeskyDecomposition::isPositiveDefinite() const
+{
+    return info == 0;
+}
+
+const Matrix &CholeskyDecomposition::getL() const
+{
+    return factor;
+}
+
+double CholeskyDecomposition::determinant() const
+{
+    if (info != 0)
+    {
+        throw std::invalid_argument("Matrix is not positive definite!");
+    }
+    double product = 1.0;
+    for (int i = 0; i < getSize(); i++)
+    {
+        product *= factor.rowPtr(i)[i];
+    }
+    return product * product;
+}
+
+double CholeskyDecomposition::logDeterminant() const
+{
+    if (info != 0)
+    {
+        throw std::invalid_argument("Matrix is not positive definite!");
+    }
+    double sum = 0.0;
+    for (int i = 0; i < getSize(); i++)
+    {
+        sum += std::log(factor.rowPtr(i)[i]);
+    }
+    return 2.0 * sum;
+}
+
+// Forward substitution with L, then back substitution with L^T, blocked like the factorization
+void CholeskyDecomposition::solveInPlace(double *B, int ldb, int rhs) const
+{
+    KALO_ALGEBRA_INSTRUMENT("CholeskyDecomposition::solve", getSize(), 2.0 * getSize() * getSize() * rhs, (1.0 * getSize() * getSize() + 2.0 * getSize() * rhs) * sizeof(double));
+    if (info != 0)
+    {
+        throw std::invalid_argument("Matrix is not positive definite!");
+    }
+    const int n = getSize();
+    const double *a = factor.data();
+    const int lda = factor.getStride();
+
+    for (int k = 0; k < n; k += blockSize)
+    {
+        const int jb = std::min(blockSize, n - k);
+        const double *diagonal = a + static_cast<long long>(k) * lda + k;
+        double *block = B + static_cast<long long>(k) * ldb;
+        solveLower(jb, rhs, diagonal, lda, block, ldb);
+        if (k + jb < n)
+        {
+            KaloAlgebraKernels::gemm(n - k - jb, rhs, jb, -1.0,
+                                     diagonal + static_cast<long long>(jb) * lda, lda, 1,
+                                     block, ldb, 1,
+                                     1.0, block + static_cast<long long>(jb) * ldb, ldb);
+        }
+    }
+
+    // B[0, k) -= L(k .. k + jb, 0 .. k)^T * X[k, k + jb)
+    for (int k = (n - 1) / blockSize * blockSize; k >= 0; k -= blockSize)
+    {
+        const int jb = std::min(blockSize, n - k);
+        const double *diagonal = a + static_cast<long long>(k) * lda + k;
+        double *block = B + static_cast<long long>(k) * ldb;
+        solveLowerTransposed(jb, rhs, diagonal, lda, block, ldb);
+        if (k > 0)
+        {
+            KaloAlgebraKernels::gemm(k, rhs, jb, -1.0,
+                                     a + static_cast<long long>(k) * lda, 1, lda,
+                                     block, ldb, 1,
+                                     1.0, B, ldb);
+        }
+    }
+}
+
+// A single right-hand side: dot products along rows of L going forward, axpys with rows of L
+// coming back, so both passes read L contiguously
+void CholeskyDecomposition::solveInPlace(Vector &b) const
+{
+    const int n = getSize();
+    if (b.getSize() != n)
+    {
+        throw std::invalid_argument("Vector size must match the matrix size in order to solve!");
+    }
+    if (info != 0)
+    {
+        throw std::invalid_argument("Matrix is not positive definite!");
+    }
+    double *x = b.data();
+    for (int i = 0; i < n; i++)
+    {
+        const double *row = factor.rowPtr(i);
+        x[i] = (x[i] - KaloAlgebraSimd::dot(row, x, static_cast<std::size_t>(i))) / row[i];
+    }
+    for (int i = n - 1; i >= 0; i--)
+    {
+        const double *row = factor.rowPtr(i);
+        x[i] /= row[i];
+        KaloAlgebraSimd::axpy(-x[i], row, x, static_cast<std::size_t>(i));
+    }
+}
+
+void CholeskyDecomposition::solveInPlace(Matrix &B) const
+{
+    if (B.getRows() != getSize())
+    {
+        throw std::invalid_argument("Matrix rows must match the matrix size in order to solve!");
+    }
+    solveInPlace(B.data(), B.getStride(), B.getCols());
+}
+
+Vector CholeskyDecomposition::solve(const Vector &b) const
+{
+    Vector x = b;
+    solveInPlace(x);
+    return x;
+}
+
+Matrix CholeskyDecomposition::solve(const Matrix &B) const
+{
+    Matrix X = B;
+    solveInPlace(X);
+    return X;
+}
+
+Matrix CholeskyDecomposition::inverse() const
+{
+    Matrix result = Matrix::identity(getSize());
+    solveInPlace(result);
+    return result;
+}
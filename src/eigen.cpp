@@ -0,0 +1,884 @@
+#include "eigen.hpp"
+#include "gemm.hpp"
+#include "gemv.hpp"
+#include "transpose.hpp"
+#include "random.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    constexpr int blockSize = 64;        // reflectors per panel of the reduction and of the back-transformation
+    constexpr int leafSize = 32;         // divide and conquer solves subproblems at most this large by QL
+    constexpr int maxSweeps = 60;        // QL iterations per eigenvalue before giving up
+    constexpr int maxInverseSteps = 5;   // inverse iteration steps before accepting a vector ...
+    constexpr int extraInverseSteps = 2; // ... and steps taken after it has converged
+    constexpr double clusterGap = 1e-3;  // eigenvalues closer than this (relative to |T|) are reorthogonalized together
+    const double epsilon = std::numeric_limits<double>::epsilon();
+
+    double *rowOf(double *base, int ld, int i) { return base + static_cast<long long>(i) * ld; }
+    const double *rowOf(const double *base, int ld, int i) { return base + static_cast<long long>(i) * ld; }
+
+    // Householder reflector for x[0], x[incx], ..., x[(length - 1) * incx] (LAPACK's dlarfg):
+    // returns tau, writes beta over x[0] and the vector v (with v[0] = 1 implied) over the rest
+    double householder(int length, double *x, int incx)
+    {
+        double sigma = 0.0;
+        for (int i = 1; i < length; i++)
+        {
+            const double value = x[static_cast<long long>(i) * incx];
+            sigma += value * value;
+        }
+        if (sigma == 0.0)
+            return 0.0;
+        const double alpha = x[0];
+        const double beta = -std::copysign(std::sqrt(alpha * alpha + sigma), alpha);
+        const double scale = 1.0 / (alpha - beta);
+        for (int i = 1; i < length; i++)
+            x[static_cast<long long>(i) * incx] *= scale;
+        x[0] = beta;
+        return (beta - alpha) / beta;
+    }
+
+    // Blocked reduction of the full symmetric n x n matrix a to tridiagonal form (LAPACK's sytrd
+    // with latrd panels), T = Q^T * A * Q with Q = H_0 * H_1 * ... * H_{n-2}.
+    //
+    // Within a panel, the reflectors are not applied to the trailing matrix yet: reflector i also
+    // yields w_i with H_i * A * H_i = A - v_i * w_i^T - w_i * v_i^T, and row j is brought up to
+    // date from the earlier (v, w) pairs just before it is reduced. At the end of the panel one
+    // GEMM of depth 2 * nb applies all of them, A -= [V W] * [W V]^T.
+    //
+    // Row j keeps the reflector H_j = I - tau_j * v_j * v_j^T after the superdiagonal: v_j is 0
+    // up to j, 1 at j + 1 and a(j, j + 2 ..) after that.
+    void reduceToTridiagonal(int n, double *a, int lda, double *d, double *e, double *tau)
+    {
+        // Rows 0 .. nb hold the panel's v, nb .. 2 nb its w, and 2 nb .. 3 nb the v again, so
+        // [V W] and [W V] are both contiguous for the trailing GEMM
+        std::vector<double> panel(static_cast<std::size_t>(3) * blockSize * n);
+        for (int k = 0; k < n; k += blockSize)
+        {
+            const int nb = std::min(blockSize, n - k);
+            double *V = panel.data();
+            double *W = V + static_cast<long long>(nb) * n;
+            for (int i = 0; i < nb; i++)
+            {
+                const int j = k + i;
+                double *row = rowOf(a, lda, j);
+                for (int p = 0; p < i; p++)
+                {
+                    const double *vp = rowOf(V, n, p), *wp = rowOf(W, n, p);
+                    KaloAlgebraSimd::axpy(-vp[j], wp + j, row + j, static_cast<std::size_t>(n - j));
+                    KaloAlgebraSimd::axpy(-wp[j], vp + j, row + j, static_cast<std::size_t>(n - j));
+                }
+                d[j] = row[j];
+
+                double *v = rowOf(V, n, i), *w = rowOf(W, n, i);
+                std::fill(v, v + n, 0.0);
+                std::fill(w, w + n, 0.0);
+                tau[j] = 0.0;
+                if (j + 1 >= n)
+                    continue;
+                const int length = n - j - 1;
+                tau[j] = householder(length, row + j + 1, 1);
+                e[j] = row[j + 1];
+                v[j + 1] = 1.0;
+                std::copy(row + j + 2, row + n, v + j + 2);
+                if (tau[j] == 0.0)
+                    continue;
+
+                // w = tau * A22 * v, with A22 corrected for the earlier reflectors of the panel
+                double *wTail = w + j + 1;
+                const double *vTail = v + j + 1;
+                KaloAlgebraKernels::gemv(length, length, 1.0, rowOf(a, lda, j + 1) + j + 1, lda, 1, vTail, 1, 0.0, wTail, 1);
+                for (int p = 0; p < i; p++)
+                {
+                    const double *vp = rowOf(V, n, p) + j + 1, *wp = rowOf(W, n, p) + j + 1;
+                    const double wv = KaloAlgebraSimd::dot(wp, vTail, static_cast<std::size_t>(length));
+                    const double vv = KaloAlgebraSimd::dot(vp, vTail, static_cast<std::size_t>(length));
+                    KaloAlgebraSimd::axpy(-wv, vp, wTail, static_cast<std::size_t>(length));
+                    KaloAlgebraSimd::axpy(-vv, wp, wTail, static_cast<std::size_t>(length));
+                }
+                KaloAlgebraSimd::scale(wTail, tau[j], wTail, static_cast<std::size_t>(length));
+
+                // w -= (tau / 2) * (w^T * v) * v
+                const double alpha = -0.5 * tau[j] * KaloAlgebraSimd::dot(wTail, vTail, static_cast<std::size_t>(length));
+                KaloAlgebraSimd::axpy(alpha, vTail, wTail, static_cast<std::size_t>(length));
+            }
+
+            const int s = k + nb;
+            if (s < n)
+            {
+                std::copy(V, V + static_cast<long long>(nb) * n, W + static_cast<long long>(nb) * n);
+                KaloAlgebraKernels::gemm(n - s, n - s, 2 * nb, -1.0, V + s, 1, n, W + s, n, 1, 1.0, rowOf(a, lda, s) + s, lda);
+            }
+        }
+    }
+
+    // Z = Q * Z for the Q of reduceToTridiagonal and an n x cols Z (LAPACK's ormtr). The
+    // reflectors go in blocks, last block first, each as I - Y * T * Y^T (compact WY) with
+    // two GEMMs.
+    void backTransform(int n, const double *a, int lda, const double *tau, double *Z, int ldz, int cols)
+    {
+        if (n < 2 || cols == 0)
+            return;
+        const int reflectors = n - 1;
+        std::vector<double> Y(static_cast<std::size_t>(blockSize) * n), S(blockSize * blockSize), T(blockSize * blockSize);
+        std::vector<double> W(static_cast<std::size_t>(blockSize) * cols);
+        const int blocks = (reflectors + blockSize - 1) / blockSize;
+        for (int b = blocks - 1; b >= 0; b--)
+        {
+            const int j0 = b * blockSize;
+            const int nb = std::min(blockSize, reflectors - j0);
+            const int length = n - j0 - 1; // rows j0 + 1 .. n - 1
+
+            // Y^T, one reflector per row, over rows j0 + 1 .. n - 1 of Z
+            for (int i = 0; i < nb; i++)
+            {
+                double *y = rowOf(Y.data(), length, i);
+                const double *source = rowOf(a, lda, j0 + i) + j0 + 1;
+                std::fill(y, y + i, 0.0);
+                y[i] = 1.0;
+                std::copy(source + i + 1, source + length, y + i + 1);
+            }
+
+            // T (LAPACK's larft): T(i, i) = tau_i and T(0 .. i, i) = -tau_i * T(0 .. i, 0 .. i) * (Y^T * Y)(0 .. i, i)
+            KaloAlgebraKernels::gemm(nb, nb, length, 1.0, Y.data(), length, 1, Y.data(), 1, length, 0.0, S.data(), nb);
+            for (int i = 0; i < nb; i++)
+            {
+                const double t = tau[j0 + i];
+                T[static_cast<long long>(i) * nb + i] = t;
+                for (int r = 0; r < i; r++)
+                {
+                    double sum = 0.0;
+                    for (int p = r; p < i; p++)
+                        sum += T[static_cast<long long>(r) * nb + p] * S[static_cast<long long>(p) * nb + i];
+                    T[static_cast<long long>(r) * nb + i] = -t * sum;
+                }
+            }
+
+            // W = T * (Y^T * Z), then Z -= Y * W
+            double *target = rowOf(Z, ldz, j0 + 1);
+            KaloAlgebraKernels::gemm(nb, cols, length, 1.0, Y.data(), length, 1, target, ldz, 1, 0.0, W.data(), cols);
+            for (int p = 0; p < nb; p++)
+            {
+                double *row = rowOf(W.data(), cols, p);
+                const double *t = rowOf(T.data(), nb, p);
+                KaloAlgebraSimd::scale(row, t[p], row, static_cast<std::size_t>(cols));
+                for (int i = p + 1; i < nb; i++)
+                    KaloAlgebraSimd::axpy(t[i], rowOf(W.data(), cols, i), row, static_cast<std::size_t>(cols));
+            }
+            KaloAlgebraKernels::gemm(length, cols, nb, -1.0, Y.data(), 1, length, W.data(), cols, 1, 1.0, target, ldz);
+        }
+    }
+
+    // Implicit QL with Wilkinson shifts on the n x n tridiagonal with diagonal d and off-diagonal
+    // e[0 .. n - 1) (e[n - 1] is scratch; e is destroyed). The eigenvalues overwrite d, unsorted.
+    // When z is given, the rotations are also applied to its columns, so starting from the
+    // identity its columns end up as the eigenvectors.
+    void tridiagonalQL(int n, double *d, double *e, double *z, int ldz)
+    {
+        // An off-diagonal element is dropped once negligible next to its neighbours or, when those
+        // are tiny (a run of zero eigenvalues), next to the whole matrix
+        double norm = 0.0;
+        for (int i = 0; i < n; i++)
+            norm = std::max(norm, std::fabs(d[i]) + (i + 1 < n ? std::fabs(e[i]) : 0.0));
+        const double floor = epsilon * norm;
+        e[n - 1] = 0.0;
+        for (int l = 0; l < n; l++)
+        {
+            int sweeps = 0;
+            while (true)
+            {
+                int m = l;
+                while (m < n - 1 && !(std::fabs(e[m]) <= epsilon * (std::fabs(d[m]) + std::fabs(d[m + 1])) + floor))
+                    m++;
+                if (m == l)
+                    break;
+                if (++sweeps > maxSweeps)
+                    throw std::runtime_error("Eigenvalue iteration did not converge!");
+
+                double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+                double r = std::hypot(g, 1.0);
+                g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+                double s = 1.0, c = 1.0, p = 0.0;
+                int i = m - 1;
+                for (; i >= l; i--)
+                {
+                    const double f = s * e[i], b = c * e[i];
+                    r = std::hypot(f, g);
+                    e[i + 1] = r;
+                    if (r == 0.0)
+                    {
+                        // An off-diagonal element underflowed: the matrix splits, start again
+                        d[i + 1] -= p;
+                        e[m] = 0.0;
+                        break;
+                    }
+                    s = f / r;
+                    c = g / r;
+                    g = d[i + 1] - p;
+                    r = (d[i] - g) * s + 2.0 * c * b;
+                    p = s * r;
+                    d[i + 1] = g + p;
+                    g = c * r - b;
+                    if (z)
+                    {
+                        for (int k = 0; k < n; k++)
+                        {
+                            double *row = rowOf(z, ldz, k);
+                            const double next = row[i + 1];
+                            row[i + 1] = s * row[i] + c * next;
+                            row[i] = c * row[i] - s * next;
+                        }
+                    }
+                }
+                if (r == 0.0 && i >= l)
+                    continue;
+                d[l] -= p;
+                e[l] = g;
+                e[m] = 0.0;
+            }
+        }
+    }
+
+    // Sorts the n eigenvalues in d ascending, with the matching columns of the n x n z
+    void sortAscending(int n, double *d, double *z, int ldz)
+    {
+        for (int i = 0; i < n - 1; i++)
+        {
+            const int smallest = static_cast<int>(std::min_element(d + i, d + n) - d);
+            if (smallest == i)
+                continue;
+            std::swap(d[i], d[smallest]);
+            for (int k = 0; k < n; k++)
+                std::swap(rowOf(z, ldz, k)[i], rowOf(z, ldz, k)[smallest]);
+        }
+    }
+
+    // Root j of the secular equation f(lambda) = 1 + rho * sum_i z_i^2 / (d_i - lambda) = 0, for
+    // strictly increasing d, rho > 0 and every z_i != 0 (LAPACK's laed4). Root j lies between d_j
+    // and d_{j+1}, the last one between d_{K-1} and d_{K-1} + rho * |z|^2. It is returned as an
+    // offset tau from the nearer pole d_origin, so that every d_i - lambda = (d_i - d_origin) - tau
+    // keeps its relative accuracy.
+    //
+    // Each step models the poles left and right of the root as p + q / (d_j - x) and
+    // r + s / (d_{j+1} - x), matching value and slope (Bunch, Nielsen and Sorensen), and solves the
+    // model exactly; a step outside the bracket the signs of f maintain falls back to bisection.
+    void secularRoot(int K, const double *dl, const double *zl, double rho, double zNorm2, int j, int &origin, double &tau)
+    {
+        if (K == 1)
+        {
+            origin = 0;
+            tau = rho * zNorm2;
+            return;
+        }
+        double lo, hi;
+        if (j < K - 1)
+        {
+            const double half = (dl[j + 1] - dl[j]) / 2.0;
+            double f = 1.0;
+            for (int i = 0; i < K; i++)
+                f += rho * zl[i] * zl[i] / ((dl[i] - dl[j]) - half);
+            // f increases across the interval, so its sign at the midpoint tells which pole is nearer
+            origin = f >= 0.0 ? j : j + 1;
+            lo = origin == j ? 0.0 : -half;
+            hi = origin == j ? half : 0.0;
+        }
+        else
+        {
+            origin = K - 1;
+            lo = 0.0;
+            hi = rho * zNorm2;
+        }
+
+        const double base = dl[origin];
+        tau = (lo + hi) / 2.0;
+        for (int step = 0; step < 200; step++)
+        {
+            double psi = 0.0, dpsi = 0.0, phi = 0.0, dphi = 0.0;
+            for (int i = 0; i < K; i++)
+            {
+                const double difference = (dl[i] - base) - tau;
+                const double term = rho * zl[i] * zl[i] / difference;
+                if (i <= j)
+                {
+                    psi += term;
+                    dpsi += term / difference;
+                }
+                else
+                {
+                    phi += term;
+                    dphi += term / difference;
+                }
+            }
+            const double f = 1.0 + psi + phi;
+            if (f < 0.0)
+                lo = tau;
+            else
+                hi = tau;
+            if (std::fabs(f) <= 8.0 * epsilon * K * (1.0 + std::fabs(psi) + std::fabs(phi)))
+                break;
+
+            // Step eta from tau: solve C + q / (a - eta) + s / (b - eta) = 0 for the model
+            const double a = (dl[j] - base) - tau;
+            const double q = dpsi * a * a;
+            double C = 1.0 + psi - dpsi * a;
+            double eta;
+            if (j < K - 1)
+            {
+                const double b = (dl[j + 1] - base) - tau;
+                const double s = dphi * b * b;
+                C += phi - dphi * b;
+                const double B2 = C * (a + b) + q + s;
+                const double C2 = C * a * b + q * b + s * a;
+                if (C == 0.0)
+                {
+                    eta = C2 / B2;
+                }
+                else
+                {
+                    const double root = std::sqrt(std::max(B2 * B2 - 4.0 * C * C2, 0.0));
+                    const double big = B2 >= 0.0 ? B2 + root : B2 - root;
+                    const double first = big / (2.0 * C), second = 2.0 * C2 / big;
+                    const double lower = std::min(a, b), upper = std::max(a, b); // the model root lies between the poles
+                    eta = first > lower && first < upper ? first : second;
+                }
+            }
+            else
+            {
+                eta = a + q / C;
+            }
+
+            double next = tau + eta;
+            if (!(next > lo && next < hi))
+                next = (lo + hi) / 2.0;
+            const bool converged = std::fabs(next - tau) <= 2.0 * epsilon * std::fabs(next) || hi - lo <= 2.0 * epsilon * std::max(std::fabs(lo), std::fabs(hi));
+            tau = next;
+            if (converged)
+                break;
+        }
+    }
+
+    // Merges the solved subproblems [start, mid) and [mid, end) of the divide and conquer, whose
+    // eigenvalues are in d (ascending) and eigenvectors in the diagonal blocks of z, through the
+    // rank-one tear beta that split them (LAPACK's laed1). On return d[start .. end) and the
+    // block z[start .. end, start .. end) hold the merged eigensystem.
+    void mergeBlocks(double *dAll, double beta, double *zAll, int ldz, int start, int mid, int end)
+    {
+        const int n1 = mid - start, N = end - start;
+        double *d = dAll + start;
+        double *Q = rowOf(zAll, ldz, start) + start;
+
+        // T = diag(Q1, Q2) * (diag(D) + rho * z * z^T) * diag(Q1, Q2)^T with z made of the last
+        // row of Q1 and the first row of Q2, |z| = 1
+        const double rho = 2.0 * std::fabs(beta);
+        const double sign = beta < 0.0 ? -1.0 : 1.0;
+        std::vector<double> z(N);
+        std::vector<int> type(N); // 1: supported on the top rows, 2: on the bottom rows, 3: both
+        for (int i = 0; i < N; i++)
+        {
+            z[i] = (i < n1 ? rowOf(Q, ldz, n1 - 1)[i] : sign * rowOf(Q, ldz, n1)[i]) / std::sqrt(2.0);
+            type[i] = i < n1 ? 1 : 2;
+        }
+        std::vector<int> order(N);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int x, int y)
+                         { return d[x] < d[y]; });
+
+        // Deflation (LAPACK's laed2): a negligible z_i leaves (d_i, q_i) an eigenpair, and two
+        // nearly equal d are rotated so that one of them has z_i = 0
+        double largestD = 0.0, largestZ = 0.0;
+        for (int i = 0; i < N; i++)
+        {
+            largestD = std::max(largestD, std::fabs(d[i]));
+            largestZ = std::max(largestZ, std::fabs(z[i]));
+        }
+        const double tolerance = 8.0 * epsilon * std::max(largestD, largestZ);
+        std::vector<int> kept, dropped;
+        int pending = -1;
+        for (int index : order)
+        {
+            if (rho * std::fabs(z[index]) <= tolerance)
+            {
+                dropped.push_back(index);
+                continue;
+            }
+            if (pending < 0)
+            {
+                pending = index;
+                continue;
+            }
+            const double tau = std::hypot(z[index], z[pending]);
+            const double c = z[index] / tau, s = -z[pending] / tau;
+            if (std::fabs((d[index] - d[pending]) * c * s) <= tolerance)
+            {
+                z[index] = tau;
+                z[pending] = 0.0;
+                type[index] = type[pending] = type[index] | type[pending];
+                for (int k = 0; k < N; k++)
+                {
+                    double *row = rowOf(Q, ldz, k);
+                    const double x = row[pending], y = row[index];
+                    row[pending] = c * x + s * y;
+                    row[index] = c * y - s * x;
+                }
+                const double combined = d[pending] * c * c + d[index] * s * s;
+                d[index] = d[pending] * s * s + d[index] * c * c;
+                d[pending] = combined;
+                dropped.push_back(pending);
+            }
+            else
+            {
+                kept.push_back(pending);
+            }
+            pending = index;
+        }
+        if (pending >= 0)
+            kept.push_back(pending);
+
+        // The secular equation for the K surviving poles
+        const int K = static_cast<int>(kept.size());
+        std::vector<double> dl(K), zl(K), lambda(K), tau(K), zHat(K), U(static_cast<std::size_t>(K) * K);
+        std::vector<int> origin(K);
+        double zNorm2 = 0.0;
+        for (int k = 0; k < K; k++)
+        {
+            dl[k] = d[kept[k]];
+            zl[k] = z[kept[k]];
+            zNorm2 += zl[k] * zl[k];
+        }
+        KaloAlgebraParallel::parallelFor(0, K, 20LL * K, [&](long long first, long long last)
+                                         {
+            for (long long j = first; j < last; j++)
+            {
+                secularRoot(K, dl.data(), zl.data(), rho, zNorm2, static_cast<int>(j), origin[j], tau[j]);
+                lambda[j] = dl[origin[j]] + tau[j];
+            } });
+        auto difference = [&](int i, int j)
+        { return (dl[i] - dl[origin[j]]) - tau[j]; }; // d_i - lambda_j
+
+        // Gu and Eisenstat: recompute z from the computed roots (Loewner's formula) so that they are
+        // the exact eigenvalues of a nearby problem, whose eigenvectors d_i - lambda_j then give
+        // orthogonal to working precision
+        KaloAlgebraParallel::parallelFor(0, K, K, [&](long long first, long long last)
+                                         {
+            for (long long index = first; index < last; index++)
+            {
+                const int i = static_cast<int>(index);
+                double product = -difference(i, K - 1) / rho;
+                for (int j = 0; j < i; j++)
+                    product *= -difference(i, j) / (dl[j] - dl[i]);
+                for (int j = i; j < K - 1; j++)
+                    product *= -difference(i, j) / (dl[j + 1] - dl[i]);
+                zHat[i] = std::copysign(std::sqrt(std::max(product, 0.0)), zl[i]);
+            } });
+        KaloAlgebraParallel::parallelFor(0, K, K, [&](long long first, long long last)
+                                         {
+            for (long long index = first; index < last; index++)
+            {
+                const int j = static_cast<int>(index);
+                double norm2 = 0.0;
+                for (int i = 0; i < K; i++)
+                {
+                    const double value = zHat[i] / difference(i, j);
+                    U[static_cast<long long>(i) * K + j] = value;
+                    norm2 += value * value;
+                }
+                const double scale = 1.0 / std::sqrt(norm2);
+                for (int i = 0; i < K; i++)
+                    U[static_cast<long long>(i) * K + j] *= scale;
+            } });
+
+        // New eigenvectors Q_kept * U. Columns supported only on the top (bottom) rows are grouped
+        // so that the top and bottom halves are two GEMMs without the zero blocks
+        std::vector<int> grouped;
+        for (int wanted : {1, 3, 2})
+            for (int k = 0; k < K; k++)
+                if (type[kept[k]] == wanted)
+                    grouped.push_back(k);
+        const int top = static_cast<int>(std::count_if(grouped.begin(), grouped.end(), [&](int k)
+                                                       { return type[kept[k]] != 2; }));
+        const int bottomFirst = static_cast<int>(std::count_if(grouped.begin(), grouped.end(), [&](int k)
+                                                               { return type[kept[k]] == 1; }));
+        const int n2 = N - n1;
+        std::vector<double> groupedU(static_cast<std::size_t>(K) * K), left(static_cast<std::size_t>(std::max(n1, n2)) * K);
+        std::vector<double> vectors(static_cast<std::size_t>(N) * K);
+        for (int r = 0; r < K; r++)
+            std::copy(U.data() + static_cast<long long>(grouped[r]) * K, U.data() + static_cast<long long>(grouped[r] + 1) * K,
+                      groupedU.data() + static_cast<long long>(r) * K);
+        if (top > 0)
+        {
+            for (int i = 0; i < n1; i++)
+                for (int c = 0; c < top; c++)
+                    left[static_cast<long long>(i) * top + c] = rowOf(Q, ldz, i)[kept[grouped[c]]];
+            KaloAlgebraKernels::gemm(n1, K, top, 1.0, left.data(), top, 1, groupedU.data(), K, 1, 0.0, vectors.data(), K);
+        }
+        else
+        {
+            std::fill(vectors.begin(), vectors.begin() + static_cast<long long>(n1) * K, 0.0);
+        }
+        const int bottom = K - bottomFirst;
+        if (bottom > 0)
+        {
+            for (int i = 0; i < n2; i++)
+                for (int c = 0; c < bottom; c++)
+                    left[static_cast<long long>(i) * bottom + c] = rowOf(Q, ldz, n1 + i)[kept[grouped[bottomFirst + c]]];
+            KaloAlgebraKernels::gemm(n2, K, bottom, 1.0, left.data(), bottom, 1, groupedU.data() + static_cast<long long>(bottomFirst) * K, K, 1,
+                                     0.0, vectors.data() + static_cast<long long>(n1) * K, K);
+        }
+        else
+        {
+            std::fill(vectors.begin() + static_cast<long long>(n1) * K, vectors.end(), 0.0);
+        }
+
+        // Deflated pairs are kept as they are; write both back in ascending order
+        std::vector<double> values(N);
+        std::vector<int> source(N); // >= 0: column of vectors, < 0: deflated column -1 - source of Q
+        for (int k = 0; k < K; k++)
+        {
+            values[k] = lambda[k];
+            source[k] = k;
+        }
+        for (std::size_t i = 0; i < dropped.size(); i++)
+        {
+            values[K + i] = d[dropped[i]];
+            source[K + i] = -1 - dropped[i];
+        }
+        std::vector<int> ascending(N);
+        std::iota(ascending.begin(), ascending.end(), 0);
+        std::stable_sort(ascending.begin(), ascending.end(), [&](int x, int y)
+                         { return values[x] < values[y]; });
+        std::vector<double> merged(static_cast<std::size_t>(N) * N);
+        for (int i = 0; i < N; i++)
+        {
+            const double *row = rowOf(Q, ldz, i);
+            double *target = merged.data() + static_cast<long long>(i) * N;
+            const double *computed = vectors.data() + static_cast<long long>(i) * K;
+            for (int c = 0; c < N; c++)
+            {
+                const int from = source[ascending[c]];
+                target[c] = from >= 0 ? computed[from] : row[-1 - from];
+            }
+        }
+        for (int c = 0; c < N; c++)
+            d[c] = values[ascending[c]];
+        for (int i = 0; i < N; i++)
+            std::copy(merged.data() + static_cast<long long>(i) * N, merged.data() + static_cast<long long>(i + 1) * N, rowOf(Q, ldz, i));
+    }
+
+    // All eigenpairs of the n x n tridiagonal with diagonal d and off-diagonal e (LAPACK's stedc):
+    // the eigenvalues overwrite d in ascending order, the eigenvectors fill the columns of z.
+    //
+    // The tridiagonal is cut into a power-of-two number of pieces of at most leafSize, each made
+    // independent by subtracting |e| at the cut from the two diagonal elements beside it. The
+    // pieces are solved by QL in parallel and merged pairwise, level by level: the many small
+    // merges of a level run in parallel, the few large ones each use the whole pool in their GEMMs.
+    void divideAndConquer(int n, double *d, const double *offDiagonal, double *z, int ldz)
+    {
+        for (int i = 0; i < n; i++)
+            std::fill(rowOf(z, ldz, i), rowOf(z, ldz, i) + n, 0.0);
+        double scale = 0.0;
+        for (int i = 0; i < n; i++)
+            scale = std::max(scale, std::fabs(d[i]));
+        for (int i = 0; i + 1 < n; i++)
+            scale = std::max(scale, std::fabs(offDiagonal[i]));
+        if (scale == 0.0)
+        {
+            for (int i = 0; i < n; i++)
+                rowOf(z, ldz, i)[i] = 1.0;
+            return;
+        }
+
+        // Work on T / |T| so the deflation tolerances are relative
+        std::vector<double> e(n, 0.0);
+        for (int i = 0; i < n; i++)
+            d[i] /= scale;
+        for (int i = 0; i + 1 < n; i++)
+            e[i] = offDiagonal[i] / scale;
+
+        int pieces = 1;
+        while (n / pieces > leafSize)
+            pieces *= 2;
+        std::vector<int> bounds(pieces + 1);
+        for (int p = 0; p <= pieces; p++)
+            bounds[p] = static_cast<int>(static_cast<long long>(p) * n / pieces);
+        for (int p = 1; p < pieces; p++)
+        {
+            const int cut = bounds[p];
+            d[cut - 1] -= std::fabs(e[cut - 1]);
+            d[cut] -= std::fabs(e[cut - 1]);
+        }
+
+        KaloAlgebraParallel::parallelFor(0, pieces, static_cast<long long>(leafSize) * leafSize * leafSize, [&](long long first, long long last)
+                                         {
+            std::vector<double> offDiagonalPiece(leafSize + 1);
+            for (long long p = first; p < last; p++)
+            {
+                const int start = bounds[p], size = bounds[p + 1] - bounds[p];
+                double *block = rowOf(z, ldz, start) + start;
+                for (int i = 0; i < size; i++)
+                    rowOf(block, ldz, i)[i] = 1.0;
+                std::copy(e.begin() + start, e.begin() + start + size - 1, offDiagonalPiece.begin());
+                tridiagonalQL(size, d + start, offDiagonalPiece.data(), block, ldz);
+                sortAscending(size, d + start, block, ldz);
+            } });
+
+        const int threads = KaloAlgebraParallel::getThreadCount();
+        for (int width = 1; width < pieces; width *= 2)
+        {
+            const int merges = pieces / (2 * width);
+            auto mergeRange = [&](long long first, long long last)
+            {
+                for (long long m = first; m < last; m++)
+                {
+                    const int start = bounds[2 * m * width], mid = bounds[(2 * m + 1) * width], end = bounds[(2 * m + 2) * width];
+                    mergeBlocks(d, e[mid - 1], z, ldz, start, mid, end);
+                }
+            };
+            if (merges >= threads)
+            {
+                const long long size = n / merges;
+                KaloAlgebraParallel::parallelFor(0, merges, size * size * size, mergeRange);
+            }
+            else
+            {
+                mergeRange(0, merges);
+            }
+        }
+
+        for (int i = 0; i < n; i++)
+            d[i] *= scale;
+    }
+
+    // Eigenvectors of the n x n tridiagonal for eigenvalues lambda[0 .. count), in descending
+    // order, by inverse iteration (LAPACK's stein): one vector per row of vectors, ldv apart. Each
+    // eigenvalue gets a pivoted LU of T - lambda * I, and its vector is solved for from a random
+    // start until it has grown enough. Eigenvalues closer than clusterGap * |T| form a cluster whose vectors
+    // are orthogonalized against each other after every solve; clusters run in parallel.
+    void inverseIteration(int n, const double *d, const double *e, const double *lambda, int count, double *vectors, int ldv)
+    {
+        double norm = 0.0;
+        for (int i = 0; i < n; i++)
+            norm = std::max(norm, std::fabs(d[i]) + (i > 0 ? std::fabs(e[i - 1]) : 0.0) + (i + 1 < n ? std::fabs(e[i]) : 0.0));
+        norm = std::max(norm, std::numeric_limits<double>::min());
+        std::vector<int> clusterStart;
+        for (int j = 0; j < count; j++)
+            if (j == 0 || lambda[j - 1] - lambda[j] > clusterGap * norm)
+                clusterStart.push_back(j);
+        clusterStart.push_back(count);
+
+        const long long clusters = static_cast<long long>(clusterStart.size()) - 1;
+        KaloAlgebraParallel::parallelFor(0, clusters, 20LL * n, [&](long long first, long long last)
+                                         {
+            std::vector<double> diagonal(n), upper1(n), upper2(n), multiplier(n);
+            std::vector<char> swapped(n);
+            for (long long c = first; c < last; c++)
+            {
+                double previous = 0.0;
+                for (int j = clusterStart[c]; j < clusterStart[c + 1]; j++)
+                {
+                    // Separate equal eigenvalues of a cluster slightly, so their vectors differ
+                    double shift = lambda[j];
+                    const double separation = 10.0 * epsilon * std::max(std::fabs(shift), norm);
+                    if (j > clusterStart[c] && previous - shift < separation)
+                        shift = previous - separation;
+                    previous = shift;
+
+                    // T - shift * I = P * L * U, with U upper triangular with two superdiagonals
+                    diagonal[0] = d[0] - shift;
+                    upper1[0] = n > 1 ? e[0] : 0.0;
+                    upper2[0] = 0.0;
+                    for (int i = 0; i + 1 < n; i++)
+                    {
+                        const double below = e[i], next = d[i + 1] - shift, nextUpper = i + 2 < n ? e[i + 1] : 0.0;
+                        if (std::fabs(diagonal[i]) >= std::fabs(below))
+                        {
+                            const double m = diagonal[i] == 0.0 ? 0.0 : below / diagonal[i];
+                            multiplier[i] = m;
+                            swapped[i] = 0;
+                            diagonal[i + 1] = next - m * upper1[i];
+                            upper1[i + 1] = nextUpper - m * upper2[i];
+                        }
+                        else
+                        {
+                            const double m = diagonal[i] / below;
+                            multiplier[i] = m;
+                            swapped[i] = 1;
+                            diagonal[i + 1] = upper1[i] - m * next;
+                            upper1[i + 1] = upper2[i] - m * nextUpper;
+                            diagonal[i] = below;
+                            upper1[i] = next;
+                            upper2[i] = nextUpper;
+                        }
+                        upper2[i + 1] = 0.0;
+                        if (diagonal[i] == 0.0)
+                            diagonal[i] = epsilon * norm;
+                    }
+                    if (diagonal[n - 1] == 0.0)
+                        diagonal[n - 1] = epsilon * norm;
+
+                    double *x = vectors + static_cast<long long>(j) * ldv;
+                    KaloAlgebraUtils::RandomGenerator generator(0x9e3779b97f4a7c15ull, static_cast<std::uint64_t>(j));
+                    generator.fillUniform(x, static_cast<std::size_t>(n), -1.0, 1.0);
+                    // Growth that marks convergence for a start of unit 1-norm (LAPACK's stein)
+                    const double target = std::sqrt(0.1 / n) / (n * norm * std::max(epsilon, std::fabs(diagonal[n - 1])));
+                    int extra = 0;
+                    for (int step = 0; step < maxInverseSteps + extraInverseSteps && extra < extraInverseSteps; step++)
+                    {
+                        for (int p = clusterStart[c]; p < j; p++)
+                        {
+                            const double *other = vectors + static_cast<long long>(p) * ldv;
+                            KaloAlgebraSimd::axpy(-KaloAlgebraSimd::dot(other, x, static_cast<std::size_t>(n)), other, x, static_cast<std::size_t>(n));
+                        }
+                        double oneNorm = 0.0;
+                        for (int i = 0; i < n; i++)
+                            oneNorm += std::fabs(x[i]);
+                        KaloAlgebraSimd::scale(x, 1.0 / oneNorm, x, static_cast<std::size_t>(n));
+
+                        for (int i = 0; i + 1 < n; i++)
+                        {
+                            if (swapped[i])
+                                std::swap(x[i], x[i + 1]);
+                            x[i + 1] -= multiplier[i] * x[i];
+                        }
+                        for (int i = n - 1; i >= 0; i--)
+                        {
+                            double value = x[i];
+                            if (i + 1 < n)
+                                value -= upper1[i] * x[i + 1];
+                            if (i + 2 < n)
+                                value -= upper2[i] * x[i + 2];
+                            x[i] = value / diagonal[i];
+                        }
+                        double largest = 0.0;
+                        for (int i = 0; i < n; i++)
+                            largest = std::max(largest, std::fabs(x[i]));
+                        if (largest >= target || step + 1 >= maxInverseSteps)
+                            extra++;
+                    }
+                    for (int p = clusterStart[c]; p < j; p++)
+                    {
+                        const double *other = vectors + static_cast<long long>(p) * ldv;
+                        KaloAlgebraSimd::axpy(-KaloAlgebraSimd::dot(other, x, static_cast<std::size_t>(n)), other, x, static_cast<std::size_t>(n));
+                    }
+                    const double length = std::sqrt(KaloAlgebraSimd::sumOfSquares(x, static_cast<std::size_t>(n)));
+                    KaloAlgebraSimd::scale(x, 1.0 / length, x, static_cast<std::size_t>(n));
+                }
+            } });
+    }
+}
+
+SymmetricEigenDecomposition::SymmetricEigenDecomposition(const Matrix &A, bool computeVectors) : size(A.getRows()), withVectors(computeVectors), values(1), vectors(0, 0)
+{
+    compute(A, A.getRows(), computeVectors);
+}
+
+SymmetricEigenDecomposition::SymmetricEigenDecomposition(const Matrix &A, int count, bool computeVectors) : size(A.getRows()), withVectors(computeVectors), values(1), vectors(0, 0)
+{
+    compute(A, count, computeVectors);
+}
+
+// Reduce to tridiagonal, solve the tridiagonal problem, then bring the vectors back with Q.
+// Divide and conquer finds every vector at once; when only a few of many are wanted, inverse
+// iteration on just those is cheaper.
+void SymmetricEigenDecomposition::compute(const Matrix &A, int count, bool computeVectors)
+{
+    KALO_ALGEBRA_INSTRUMENT("SymmetricEigenDecomposition::factor", A.getRows(), 4.0 / 3.0 * A.getRows() * A.getRows() * A.getRows() + (computeVectors ? 2.0 * A.getRows() * A.getRows() * count : 0.0),
+                            (1.0 * A.getRows() * A.getCols() + (computeVectors ? 1.0 * A.getRows() * count : 0.0)) * sizeof(double));
+    if (A.getRows() != A.getCols())
+    {
+        throw std::invalid_argument("Matrix must be square for eigendecomposition!");
+    }
+    const int n = size;
+    if (n == 0)
+    {
+        throw std::invalid_argument("Matrix must not be empty for eigendecomposition!");
+    }
+    if (count < 1 || count > n)
+    {
+        throw std::invalid_argument("Eigenvalue count out of range!");
+    }
+    values = Vector(count);
+
+    // The full symmetric matrix, from the lower triangle of A
+    Matrix a(n, n);
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j <= i; j++)
+        {
+            a.rowPtr(i)[j] = A.rowPtr(i)[j];
+            a.rowPtr(j)[i] = A.rowPtr(i)[j];
+        }
+    }
+    std::vector<double> d(n), e(n, 0.0), tau(n, 0.0);
+    reduceToTridiagonal(n, a.data(), a.getStride(), d.data(), e.data(), tau.data());
+
+    if (computeVectors && 4LL * count > n)
+    {
+        Matrix z(n, n);
+        divideAndConquer(n, d.data(), e.data(), z.data(), z.getStride());
+        vectors = Matrix(n, count);
+        for (int c = 0; c < count; c++)
+        {
+            values.data()[c] = d[n - 1 - c];
+            for (int i = 0; i < n; i++)
+                vectors.rowPtr(i)[c] = z.rowPtr(i)[n - 1 - c];
+        }
+    }
+    else
+    {
+        std::vector<double> sorted(d), scratch(e);
+        tridiagonalQL(n, sorted.data(), scratch.data(), nullptr, 0);
+        std::sort(sorted.begin(), sorted.end(), std::greater<double>());
+        std::copy(sorted.begin(), sorted.begin() + count, values.data());
+        if (!computeVectors)
+            return;
+        Matrix rows(count, n);
+        inverseIteration(n, d.data(), e.data(), values.data(), count, rows.data(), rows.getStride());
+        vectors = Matrix(n, count);
+        KaloAlgebraKernels::transpose(count, n, rows.data(), rows.getStride(), vectors.data(), vectors.getStride());
+    }
+    backTransform(n, a.data(), a.getStride(), tau.data(), vectors.data(), vectors.getStride(), count);
+}
+
+int SymmetricEigenDecomposition::getSize() const
+{
+    return size;
+}
+
+int SymmetricEigenDecomposition::getCount() const
+{
+    return values.getSize();
+}
+
+bool SymmetricEigenDecomposition::hasEigenvectors() const
+{
+    return withVectors;
+}
+
+const Vector &SymmetricEigenDecomposition::getEigenvalues() const
+{
+    return values;
+}
+
+const Matrix &SymmetricEigenDecomposition::getEigenvectors() const
+{
+    if (!hasEigenvectors())
+    {
+        throw std::invalid_argument("Eigenvectors were not computed!");
+    }
+    return vectors;
+}
+
+Vector symmetricEigenvalues(const Matrix &A)
+{
+    return SymmetricEigenDecomposition(A, false).getEigenvalues();
+}
@@ -0,0 +1,769 @@
+#include "gemm.hpp"
+#include "transpose.hpp"
+#include "allocator.hpp"
+#include "scalar.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include <vector>
+#include <algorithm>
+#include <complex>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KALO_ALGEBRA_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// Blocked GEMM in the style of GotoBLAS/BLIS: B is packed into a KC x NC panel that lives in L3,
+// A into an MC x KC block that lives in L2, and a register-tiled MR x NR micro-kernel streams
+// through both. Packing makes every operand layout (row-major, transposed, strided) look the
+// same to the micro-kernel. float and double have their own register-tiled micro-kernels; the
+// complex ones broadcast the real and imaginary parts of A separately and combine them per tile.
+namespace KaloAlgebraKernels
+{
+    namespace
+    {
+        constexpr int blockK = 256;  // depth of a packed panel (KC)
+        constexpr int blockM = 96;   // rows of A packed per block (MC), a multiple of every MR below
+        constexpr int blockN = 4096; // columns of B packed per panel (NC), a multiple of every NR below
+
+        // Below this many multiply-adds packing costs more than it saves
+        constexpr long long smallProblem = 32 * 32 * 32;
+
+        template <typename T>
+        using Buffer = std::vector<T, KaloAlgebraUtils::AlignedAllocator<T>>;
+
+        // Computes the MR x NR product of a packed A sliver and a packed B sliver over kc steps
+        // and writes C = alpha * AB + beta * C (C is not read when beta is 0)
+        template <typename T>
+        using MicroKernel = void (*)(int kc, const T *a, const T *b, T alpha, T beta, T *c, int ldc);
+
+        template <typename T>
+        struct KernelInfo
+        {
+            int mr;
+            int nr;
+            MicroKernel<T> kernel;
+        };
+
+        constexpr int maxTile = 256; // largest MR * NR of any micro-kernel below
+
+        // Portable micro-kernel: the fixed-size accumulator block is kept in registers by the compiler
+        template <typename T, int MR, int NR>
+        void microKernelGeneric(int kc, const T *a, const T *b, T alpha, T beta, T *c, int ldc)
+        {
+            T ab[MR][NR] = {};
+            for (int p = 0; p < kc; p++)
+            {
+                for (int i = 0; i < MR; i++)
+                {
+                    for (int j = 0; j < NR; j++)
+                    {
+                        ab[i][j] += a[i] * b[j];
+                    }
+                }
+                a += MR;
+                b += NR;
+            }
+            for (int i = 0; i < MR; i++)
+            {
+                T *row = c + static_cast<long long>(i) * ldc;
+                for (int j = 0; j < NR; j++)
+                {
+                    row[j] = beta == T(0) ? alpha * ab[i][j] : alpha * ab[i][j] + beta * row[j];
+                }
+            }
+        }
+
+        // Complex tiles are accumulated in real arithmetic: byReal holds Re(a) * b and byImag holds
+        // Im(a) * b over the interleaved (re, im) row of B, so every step is a contiguous broadcast
+        // multiply-add. a * b = byReal + i * byImag, combined once per tile here.
+        template <typename R, int MR, int NR>
+        void storeComplexTile(const R (&byReal)[MR][2 * NR], const R (&byImag)[MR][2 * NR], std::complex<R> alpha,
+                              std::complex<R> beta, std::complex<R> *c, int ldc)
+        {
+            const R alphaRe = alpha.real(), alphaIm = alpha.imag();
+            const bool noBeta = beta == std::complex<R>(0);
+            for (int i = 0; i < MR; i++)
+            {
+                std::complex<R> *row = c + static_cast<long long>(i) * ldc;
+                for (int j = 0; j < NR; j++)
+                {
+                    const R re = byReal[i][2 * j] - byImag[i][2 * j + 1];
+                    const R im = byReal[i][2 * j + 1] + byImag[i][2 * j];
+                    const std::complex<R> scaled(alphaRe * re - alphaIm * im, alphaRe * im + alphaIm * re);
+                    row[j] = noBeta ? scaled : scaled + beta * row[j];
+                }
+            }
+        }
+
+        template <typename R, int MR, int NR>
+        void microKernelComplex(int kc, const std::complex<R> *a, const std::complex<R> *b, std::complex<R> alpha,
+                                std::complex<R> beta, std::complex<R> *c, int ldc)
+        {
+            R byReal[MR][2 * NR] = {}, byImag[MR][2 * NR] = {};
+            const R *ap = reinterpret_cast<const R *>(a);
+            const R *bp = reinterpret_cast<const R *>(b);
+            for (int p = 0; p < kc; p++)
+            {
+                for (int i = 0; i < MR; i++)
+                {
+                    const R ar = ap[2 * i], ai = ap[2 * i + 1];
+                    for (int j = 0; j < 2 * NR; j++)
+                    {
+                        byReal[i][j] += ar * bp[j];
+                        byImag[i][j] += ai * bp[j];
+                    }
+                }
+                ap += 2 * MR;
+                bp += 2 * NR;
+            }
+            storeComplexTile<R, MR, NR>(byReal, byImag, alpha, beta, c, ldc);
+        }
+
+#ifdef KALO_ALGEBRA_X86_KERNELS
+        __attribute__((target("avx2,fma"))) inline void storeRowAvx2(double *c, __m256d acc0, __m256d acc1, double alpha, double beta)
+        {
+            const __m256d alphaV = _mm256_set1_pd(alpha);
+            acc0 = _mm256_mul_pd(alphaV, acc0);
+            acc1 = _mm256_mul_pd(alphaV, acc1);
+            if (beta != 0.0)
+            {
+                const __m256d betaV = _mm256_set1_pd(beta);
+                acc0 = _mm256_fmadd_pd(betaV, _mm256_loadu_pd(c), acc0);
+                acc1 = _mm256_fmadd_pd(betaV, _mm256_loadu_pd(c + 4), acc1);
+            }
+            _mm256_storeu_pd(c, acc0);
+            _mm256_storeu_pd(c + 4, acc1);
+        }
+
+        // 6 x 8 AVX2 micro-kernel: 12 accumulators, two B loads and six broadcasts per step
+        __attribute__((target("avx2,fma"))) void microKernelAvx2(int kc, const double *a, const double *b, double alpha, double beta, double *c, int ldc)
+        {
+            __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+            __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+            __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+            __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+            __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+            __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+            for (int p = 0; p < kc; p++)
+            {
+                const __m256d b0 = _mm256_loadu_pd(b);
+                const __m256d b1 = _mm256_loadu_pd(b + 4);
+                __m256d ai = _mm256_broadcast_sd(a);
+                c00 = _mm256_fmadd_pd(ai, b0, c00);
+                c01 = _mm256_fmadd_pd(ai, b1, c01);
+                ai = _mm256_broadcast_sd(a + 1);
+                c10 = _mm256_fmadd_pd(ai, b0, c10);
+                c11 = _mm256_fmadd_pd(ai, b1, c11);
+                ai = _mm256_broadcast_sd(a + 2);
+                c20 = _mm256_fmadd_pd(ai, b0, c20);
+                c21 = _mm256_fmadd_pd(ai, b1, c21);
+                ai = _mm256_broadcast_sd(a + 3);
+                c30 = _mm256_fmadd_pd(ai, b0, c30);
+                c31 = _mm256_fmadd_pd(ai, b1, c31);
+                ai = _mm256_broadcast_sd(a + 4);
+                c40 = _mm256_fmadd_pd(ai, b0, c40);
+                c41 = _mm256_fmadd_pd(ai, b1, c41);
+                ai = _mm256_broadcast_sd(a + 5);
+                c50 = _mm256_fmadd_pd(ai, b0, c50);
+                c51 = _mm256_fmadd_pd(ai, b1, c51);
+                a += 6;
+                b += 8;
+            }
+            storeRowAvx2(c, c00, c01, alpha, beta);
+            storeRowAvx2(c + ldc, c10, c11, alpha, beta);
+            storeRowAvx2(c + 2LL * ldc, c20, c21, alpha, beta);
+            storeRowAvx2(c + 3LL * ldc, c30, c31, alpha, beta);
+            storeRowAvx2(c + 4LL * ldc, c40, c41, alpha, beta);
+            storeRowAvx2(c + 5LL * ldc, c50, c51, alpha, beta);
+        }
+
+        // 8 x 16 AVX-512 micro-kernel: 16 accumulators, two B loads and eight broadcasts per step
+        __attribute__((target("avx512f"))) void microKernelAvx512(int kc, const double *a, const double *b, double alpha, double beta, double *c, int ldc)
+        {
+            __m512d acc0[8], acc1[8];
+#pragma GCC unroll 8
+            for (int i = 0; i < 8; i++)
+            {
+                acc0[i] = _mm512_setzero_pd();
+                acc1[i] = _mm512_setzero_pd();
+            }
+            for (int p = 0; p < kc; p++)
+            {
+                const __m512d b0 = _mm512_loadu_pd(b);
+                const __m512d b1 = _mm512_loadu_pd(b + 8);
+#pragma GCC unroll 8
+                for (int i = 0; i < 8; i++)
+                {
+                    const __m512d ai = _mm512_set1_pd(a[i]);
+                    acc0[i] = _mm512_fmadd_pd(ai, b0, acc0[i]);
+                    acc1[i] = _mm512_fmadd_pd(ai, b1, acc1[i]);
+                }
+                a += 8;
+                b += 16;
+            }
+            const __m512d alphaV = _mm512_set1_pd(alpha);
+            const __m512d betaV = _mm512_set1_pd(beta);
+#pragma GCC unroll 8
+            for (int i = 0; i < 8; i++)
+            {
+                double *row = c + static_cast<long long>(i) * ldc;
+                __m512d r0 = _mm512_mul_pd(alphaV, acc0[i]);
+                __m512d r1 = _mm512_mul_pd(alphaV, acc1[i]);
+                if (beta != 0.0)
+                {
+                    r0 = _mm512_fmadd_pd(betaV, _mm512_loadu_pd(row), r0);
+                    r1 = _mm512_fmadd_pd(betaV, _mm512_loadu_pd(row + 8), r1);
+                }
+                _mm512_storeu_pd(row, r0);
+                _mm512_storeu_pd(row + 8, r1);
+            }
+        }
+
+        __attribute__((target("avx2,fma"))) inline void storeRowAvx2(float *c, __m256 acc0, __m256 acc1, float alpha, float beta)
+        {
+            const __m256 alphaV = _mm256_set1_ps(alpha);
+            acc0 = _mm256_mul_ps(alphaV, acc0);
+            acc1 = _mm256_mul_ps(alphaV, acc1);
+            if (beta != 0.0f)
+            {
+                const __m256 betaV = _mm256_set1_ps(beta);
+                acc0 = _mm256_fmadd_ps(betaV, _mm256_loadu_ps(c), acc0);
+                acc1 = _mm256_fmadd_ps(betaV, _mm256_loadu_ps(c + 8), acc1);
+            }
+            _mm256_storeu_ps(c, acc0);
+            _mm256_storeu_ps(c + 8, acc1);
+        }
+
+        // 6 x 16 AVX2 micro-kernel for float: the double kernel's register layout with twice the lanes
+        __attribute__((target("avx2,fma"))) void microKernelAvx2(int kc, const float *a, const float *b, float alpha, float beta, float *c, int ldc)
+        {
+            __m256 acc0[6], acc1[6];
+#pragma GCC unroll 6
+            for (int i = 0; i < 6; i++)
+            {
+                acc0[i] = _mm256_setzero_ps();
+                acc1[i] = _mm256_setzero_ps();
+            }
+            for (int p = 0; p < kc; p++)
+            {
+                const __m256 b0 = _mm256_loadu_ps(b);
+                const __m256 b1 = _mm256_loadu_ps(b + 8);
+#pragma GCC unroll 6
+                for (int i = 0; i < 6; i++)
+                {
+                    const __m256 ai = _mm256_broadcast_ss(a + i);
+                    acc0[i] = _mm256_fmadd_ps(ai, b0, acc0[i]);
+                    acc1[i] = _mm256_fmadd_ps(ai, b1, acc1[i]);
+                }
+                a += 6;
+                b += 16;
+            }
+#pragma GCC unroll 6
+            for (int i = 0; i < 6; i++)
+                storeRowAvx2(c + static_cast<long long>(i) * ldc, acc0[i], acc1[i], alpha, beta);
+        }
+
+        // 8 x 32 AVX-512 micro-kernel for float
+        __attribute__((target("avx512f"))) void microKernelAvx512(int kc, const float *a, const float *b, float alpha, float beta, float *c, int ldc)
+        {
+            __m512 acc0[8], acc1[8];
+#pragma GCC unroll 8
+            for (int i = 0; i < 8; i++)
+            {
+                acc0[i] = _mm512_setzero_ps();
+                acc1[i] = _mm512_setzero_ps();
+            }
+            for (int p = 0; p < kc; p++)
+            {
+                const __m512 b0 = _mm512_loadu_ps(b);
+                const __m512 b1 = _mm512_loadu_ps(b + 16);
+#pragma GCC unroll 8
+                for (int i = 0; i < 8; i++)
+                {
+                    const __m512 ai = _mm512_set1_ps(a[i]);
+                    acc0[i] = _mm512_fmadd_ps(ai, b0, acc0[i]);
+                    acc1[i] = _mm512_fmadd_ps(ai, b1, acc1[i]);
+                }
+                a += 8;
+                b += 32;
+            }
+            const __m512 alphaV = _mm512_set1_ps(alpha);
+            const __m512 betaV = _mm512_set1_ps(beta);
+#pragma GCC unroll 8
+            for (int i = 0; i < 8; i++)
+            {
+                float *row = c + static_cast<long long>(i) * ldc;
+                __m512 r0 = _mm512_mul_ps(alphaV, acc0[i]);
+                __m512 r1 = _mm512_mul_ps(alphaV, acc1[i]);
+                if (beta != 0.0f)
+                {
+                    r0 = _mm512_fmadd_ps(betaV, _mm512_loadu_ps(row), r0);
+                    r1 = _mm512_fmadd_ps(betaV, _mm512_loadu_ps(row + 16), r1);
+                }
+                _mm512_storeu_ps(row, r0);
+                _mm512_storeu_ps(row + 16, r1);
+            }
+        }
+
+        // 3 x 4 AVX2 complex micro-kernel: each B row is two registers of (re, im) pairs, and the
+        // real and imaginary parts of each A element are broadcast separately (12 accumulators)
+        __attribute__((target("avx2,fma"))) void microKernelComplexAvx2(int kc, const std::complex<double> *a, const std::complex<double> *b,
+                                                                       std::complex<double> alpha, std::complex<double> beta,
+                                                                       std::complex<double> *c, int ldc)
+        {
+            __m256d accReal[3][2], accImag[3][2];
+#pragma GCC unroll 3
+            for (int i = 0; i < 3; i++)
+                accReal[i][0] = accReal[i][1] = accImag[i][0] = accImag[i][1] = _mm256_setzero_pd();
+            const double *ap = reinterpret_cast<const double *>(a);
+            const double *bp = reinterpret_cast<const double *>(b);
+            for (int p = 0; p < kc; p++)
+            {
+                const __m256d b0 = _mm256_loadu_pd(bp);
+                const __m256d b1 = _mm256_loadu_pd(bp + 4);
+#pragma GCC unroll 3
+                for (int i = 0; i < 3; i++)
+                {
+                    const __m256d ar = _mm256_broadcast_sd(ap + 2 * i);
+                    const __m256d ai = _mm256_broadcast_sd(ap + 2 * i + 1);
+                    accReal[i][0] = _mm256_fmadd_pd(ar, b0, accReal[i][0]);
+                    accReal[i][1] = _mm256_fmadd_pd(ar, b1, accReal[i][1]);
+                    accImag[i][0] = _mm256_fmadd_pd(ai, b0, accImag[i][0]);
+                    accImag[i][1] = _mm256_fmadd_pd(ai, b1, accImag[i][1]);
+                }
+                ap += 6;
+                bp += 8;
+            }
+            double byReal[3][8], byImag[3][8];
+            for (int i = 0; i < 3; i++)
+            {
+                _mm256_storeu_pd(byReal[i], accReal[i][0]);
+                _mm256_storeu_pd(byReal[i] + 4, accReal[i][1]);
+                _mm256_storeu_pd(byImag[i], accImag[i][0]);
+                _mm256_storeu_pd(byImag[i] + 4, accImag[i][1]);
+            }
+            storeComplexTile<double, 3, 4>(byReal, byImag, alpha, beta, c, ldc);
+        }
+
+        // 3 x 8 AVX2 complex micro-kernel for complex<float>
+        __attribute__((target("avx2,fma"))) void microKernelComplexAvx2(int kc, const std::complex<float> *a, const std::complex<float> *b,
+                                                                       std::complex<float> alpha, std::complex<float> beta,
+                                                                       std::complex<float> *c, int ldc)
+        {
+            __m256 accReal[3][2], accImag[3][2];
+#pragma GCC unroll 3
+            for (int i = 0; i < 3; i++)
+                accReal[i][0] = accReal[i][1] = accImag[i][0] = accImag[i][1] = _mm256_setzero_ps();
+            const float *ap = reinterpret_cast<const float *>(a);
+            const float *bp = reinterpret_cast<const float *>(b);
+            for (int p = 0; p < kc; p++)
+            {
+                const __m256 b0 = _mm256_loadu_ps(bp);
+                const __m256 b1 = _mm256_loadu_ps(bp + 8);
+#pragma GCC unroll 3
+                for (int i = 0; i < 3; i++)
+                {
+                    const __m256 ar = _mm256_broadcast_ss(ap + 2 * i);
+                    const __m256 ai = _mm256_broadcast_ss(ap + 2 * i + 1);
+                    accReal[i][0] = _mm256_fmadd_ps(ar, b0, accReal[i][0]);
+                    accReal[i][1] = _mm256_fmadd_ps(ar, b1, accReal[i][1]);
+                    accImag[i][0] = _mm256_fmadd_ps(ai, b0, accImag[i][0]);
+                    accImag[i][1] = _mm256_fmadd_ps(ai, b1, accImag[i][1]);
+                }
+                ap += 6;
+                bp += 16;
+            }
+            float byReal[3][16], byImag[3][16];
+            for (int i = 0; i < 3; i++)
+            {
+                _mm256_storeu_ps(byReal[i], accReal[i][0]);
+                _mm256_storeu_ps(byReal[i] + 8, accReal[i][1]);
+                _mm256_storeu_ps(byImag[i], accImag[i][0]);
+                _mm256_storeu_ps(byImag[i] + 8, accImag[i][1]);
+            }
+            storeComplexTile<float, 3, 8>(byReal, byImag, alpha, beta, c, ldc);
+        }
+
+        // 6 x 8 AVX-512 complex micro-kernel: 24 accumulators
+        __attribute__((target("avx512f"))) void microKernelComplexAvx512(int kc, const std::complex<double> *a, const std::complex<double> *b,
+                                                                        std::complex<double> alpha, std::complex<double> beta,
+                                                                        std::complex<double> *c, int ldc)
+        {
+            __m512d accReal[6][2], accImag[6][2];
+#pragma GCC unroll 6
+            for (int i = 0; i < 6; i++)
+                accReal[i][0] = accReal[i][1] = accImag[i][0] = accImag[i][1] = _mm512_setzero_pd();
+            const double *ap = reinterpret_cast<const double *>(a);
+            const double *bp = reinterpret_cast<const double *>(b);
+            for (int p = 0; p < kc; p++)
+            {
+                const __m512d b0 = _mm512_loadu_pd(bp);
+                const __m512d b1 = _mm512_loadu_pd(bp + 8);
+#pragma GCC unroll 6
+                for (int i = 0; i < 6; i++)
+                {
+                    const __m512d ar = _mm512_set1_pd(ap[2 * i]);
+                    const __m512d ai = _mm512_set1_pd(ap[2 * i + 1]);
+                    accReal[i][0] = _mm512_fmadd_pd(ar, b0, accReal[i][0]);
+                    accReal[i][1] = _mm512_fmadd_pd(ar, b1, accReal[i][1]);
+                    accImag[i][0] = _mm512_fmadd_pd(ai, b0, accImag[i][0]);
+                    accImag[i][1] = _mm512_fmadd_pd(ai, b1, accImag[i][1]);
+                }
+                ap += 12;
+                bp += 16;
+            }
+            double byReal[6][16], byImag[6][16];
+            for (int i = 0; i < 6; i++)
+            {
+                _mm512_storeu_pd(byReal[i], accReal[i][0]);
+                _mm512_storeu_pd(byReal[i] + 8, accReal[i][1]);
+                _mm512_storeu_pd(byImag[i], accImag[i][0]);
+                _mm512_storeu_pd(byImag[i] + 8, accImag[i][1]);
+            }
+            storeComplexTile<double, 6, 8>(byReal, byImag, alpha, beta, c, ldc);
+        }
+
+        // 6 x 16 AVX-512 complex micro-kernel for complex<float>
+        __attribute__((target("avx512f"))) void microKernelComplexAvx512(int kc, const std::complex<float> *a, const std::complex<float> *b,
+                                                                        std::complex<float> alpha, std::complex<float> beta,
+                                                                        std::complex<float> *c, int ldc)
+        {
+            __m512 accReal[6][2], accImag[6][2];
+#pragma GCC unroll 6
+            for (int i = 0; i < 6; i++)
+                accReal[i][0] = accReal[i][1] = accImag[i][0] = accImag[i][1] = _mm512_setzero_ps();
+            const float *ap = reinterpret_cast<const float *>(a);
+            const float *bp = reinterpret_cast<const float *>(b);
+            for (int p = 0; p < kc; p++)
+            {
+                const __m512 b0 = _mm512_loadu_ps(bp);
+                const __m512 b1 = _mm512_loadu_ps(bp + 16);
+#pragma GCC unroll 6
+                for (int i = 0; i < 6; i++)
+                {
+                    const __m512 ar = _mm512_set1_ps(ap[2 * i]);
+                    const __m512 ai = _mm512_set1_ps(ap[2 * i + 1]);
+                    accReal[i][0] = _mm512_fmadd_ps(ar, b0, accReal[i][0]);
+                    accReal[i][1] = _mm512_fmadd_ps(ar, b1, accReal[i][1]);
+                    accImag[i][0] = _mm512_fmadd_ps(ai, b0, accImag[i][0]);
+                    accImag[i][1] = _mm512_fmadd_ps(ai, b1, accImag[i][1]);
+                }
+                ap += 12;
+                bp += 32;
+            }
+            float byReal[6][32], byImag[6][32];
+            for (int i = 0; i < 6; i++)
+            {
+                _mm512_storeu_ps(byReal[i], accReal[i][0]);
+                _mm512_storeu_ps(byReal[i] + 16, accReal[i][1]);
+                _mm512_storeu_ps(byImag[i], accImag[i][0]);
+                _mm512_storeu_ps(byImag[i] + 16, accImag[i][1]);
+            }
+            storeComplexTile<float, 6, 16>(byReal, byImag, alpha, beta, c, ldc);
+        }
+#endif
+
+        // Follows the instruction set chosen by the SIMD dispatcher, so forcing an ISA covers GEMM too
+        template <typename T>
+        KernelInfo<T> selectKernel()
+        {
+            if constexpr (KaloAlgebraUtils::ScalarTraits<T>::isComplex)
+            {
+                constexpr bool single = std::is_same<T, std::complex<float>>::value;
+                switch (KaloAlgebraSimd::activeIsa())
+                {
+#ifdef KALO_ALGEBRA_X86_KERNELS
+                case KaloAlgebraSimd::Isa::AVX512:
+                    return KernelInfo<T>{6, single ? 16 : 8, microKernelComplexAvx512};
+                case KaloAlgebraSimd::Isa::AVX2:
+                    return KernelInfo<T>{3, single ? 8 : 4, microKernelComplexAvx2};
+#endif
+                default:
+                    return KernelInfo<T>{4, single ? 8 : 4, microKernelComplex<KaloAlgebraUtils::RealType<T>, 4, single ? 8 : 4>};
+                }
+            }
+            else
+            {
+                switch (KaloAlgebraSimd::activeIsa())
+                {
+#ifdef KALO_ALGEBRA_X86_KERNELS
+                case KaloAlgebraSimd::Isa::AVX512:
+                    return KernelInfo<T>{8, std::is_same<T, float>::value ? 32 : 16, microKernelAvx512};
+                case KaloAlgebraSimd::Isa::AVX2:
+                    return KernelInfo<T>{6, std::is_same<T, float>::value ? 16 : 8, microKernelAvx2};
+#endif
+                default:
+                    return KernelInfo<T>{4, 4, microKernelGeneric<T, 4, 4>};
+                }
+            }
+        }
+
+        // C = beta * C, without reading C when beta is 0
+        template <typename T>
+        void scaleOutput(int m, int n, T beta, T *C, int ldc)
+        {
+            if (beta == T(1))
+                return;
+            for (int i = 0; i < m; i++)
+            {
+                T *row = C + static_cast<long long>(i) * ldc;
+                for (int j = 0; j < n; j++)
+                {
+                    row[j] = beta == T(0) ? T(0) : beta * row[j];
+                }
+            }
+        }
+
+        // Unpacked i-p-j loop for tiny products, where packing would dominate
+        template <typename T>
+        void gemmSmall(int m, int n, int k, T alpha,
+                       const T *A, int rsA, int csA, const T *B, int rsB, int csB,
+                       T beta, T *C, int ldc)
+        {
+            scaleOutput(m, n, beta, C, ldc);
+            for (int i = 0; i < m; i++)
+            {
+                T *row = C + static_cast<long long>(i) * ldc;
+                for (int p = 0; p < k; p++)
+                {
+                    const T scaled = alpha * A[static_cast<long long>(i) * rsA + static_cast<long long>(p) * csA];
+                    const T *bRow = B + static_cast<long long>(p) * rsB;
+                    for (int j = 0; j < n; j++)
+                    {
+                        row[j] += scaled * bRow[static_cast<long long>(j) * csB];
+                    }
+                }
+            }
+        }
+
+        // Pack an mc x kc block of A into slivers of mr rows, each stored column by column.
+        // Rows past mc are zero filled so the micro-kernel never needs an edge case.
+        template <typename T>
+        void packA(int mc, int kc, int mr, const T *A, int rsA, int csA, T *packed)
+        {
+            for (int ir = 0; ir < mc; ir += mr)
+            {
+                const int rowsHere = std::min(mr, mc - ir);
+                for (int p = 0; p < kc; p++)
+                {
+                    const T *source = A + static_cast<long long>(ir) * rsA + static_cast<long long>(p) * csA;
+                    int i = 0;
+                    for (; i < rowsHere; i++)
+                        packed[i] = source[static_cast<long long>(i) * rsA];
+                    for (; i < mr; i++)
+                        packed[i] = T(0);
+                    packed += mr;
+                }
+            }
+        }
+
+        // Pack a kc x nc panel of B into slivers of nr columns, each stored row by row
+        template <typename T>
+        void packB(int kc, int nc, int nr, const T *B, int rsB, int csB, T *packed)
+        {
+            for (int jr = 0; jr < nc; jr += nr)
+            {
+                const int colsHere = std::min(nr, nc - jr);
+                for (int p = 0; p < kc; p++)
+                {
+                    const T *source = B + static_cast<long long>(p) * rsB + static_cast<long long>(jr) * csB;
+                    int j = 0;
+                    if (csB == 1)
+                    {
+                        for (; j < colsHere; j++)
+                            packed[j] = source[j];
+                    }
+                    else
+                    {
+                        for (; j < colsHere; j++)
+                            packed[j] = source[static_cast<long long>(j) * csB];
+                    }
+                    for (; j < nr; j++)
+                        packed[j] = T(0);
+                    packed += nr;
+                }
+            }
+        }
+
+        // Multiply one packed mc x kc block of A by the packed kc x nc panel of B into C
+        template <typename T>
+        void macroKernel(const KernelInfo<T> &info, int mc, int nc, int kc, T alpha, T beta,
+                         const T *packedA, const T *packedB, T *C, int ldc)
+        {
+            const int mr = info.mr, nr = info.nr;
+            T edge[maxTile]; // scratch for partial tiles at the right and bottom borders
+            for (int jr = 0; jr < nc; jr += nr)
+            {
+                const int colsHere = std::min(nr, nc - jr);
+                const T *b = packedB + static_cast<long long>(jr) * kc;
+                for (int ir = 0; ir < mc; ir += mr)
+                {
+                    const int rowsHere = std::min(mr, mc - ir);
+                    const T *a = packedA + static_cast<long long>(ir) * kc;
+                    T *c = C + static_cast<long long>(ir) * ldc + jr;
+                    if (rowsHere == mr && colsHere == nr)
+                    {
+                        info.kernel(kc, a, b, alpha, beta, c, ldc);
+                        continue;
+                    }
+                    info.kernel(kc, a, b, T(1), T(0), edge, nr);
+                    for (int i = 0; i < rowsHere; i++)
+                    {
+                        T *row = c + static_cast<long long>(i) * ldc;
+                        for (int j = 0; j < colsHere; j++)
+                        {
+                            row[j] = beta == T(0) ? alpha * edge[i * nr + j] : alpha * edge[i * nr + j] + beta * row[j];
+                        }
+                    }
+                }
+            }
+        }
+
+        // The packed, blocked product. With lowerOnly, row block ic stops at column ic + mc, so
+        // only the lower triangle of C (and the upper part of its diagonal blocks) is computed.
+        template <typename T>
+        void gemmBlocked(int m, int n, int k, T alpha,
+                         const T *A, int rowStrideA, int colStrideA,
+                         const T *B, int rowStrideB, int colStrideB,
+                         T beta, T *C, int ldc, bool lowerOnly)
+        {
+            const KernelInfo<T> info = selectKernel<T>();
+            const int mr = info.mr, nr = info.nr;
+
+            const int threads = KaloAlgebraParallel::getThreadCount();
+
+            // Packing buffers belong to the calling thread and are reused across calls, so steady-state
+            // products never allocate. A blocks are packed into one slot per pool thread index.
+            thread_local Buffer<T> packedB, packedA;
+            const std::size_t needB = static_cast<std::size_t>(blockK) * ((std::min(n, blockN) + nr - 1) / nr * nr);
+            const std::size_t slotA = static_cast<std::size_t>(blockM) * blockK;
+            const int slots = std::max(threads, KaloAlgebraParallel::currentThreadIndex() + 1);
+            if (packedB.size() < needB)
+                packedB.resize(needB);
+            if (packedA.size() < slotA * slots)
+                packedA.resize(slotA * slots);
+
+            // Work is split over MC row blocks, and also over column groups when there are fewer row
+            // blocks than threads. Every C tile is still produced by the same micro-kernel calls in the
+            // same order, so the result does not depend on the thread count.
+            const int rowBlocks = (m + blockM - 1) / blockM;
+            const bool parallel = threads > 1 && !KaloAlgebraParallel::insideParallelRegion() &&
+                                  static_cast<long long>(m) * n * k >= KaloAlgebraParallel::getSerialThreshold();
+
+            for (int jc = 0; jc < n; jc += blockN)
+            {
+                const int nc = std::min(blockN, n - jc);
+                const int slivers = (nc + nr - 1) / nr;
+                const int colGroups = parallel ? std::max(1, std::min(slivers, (threads + rowBlocks - 1) / rowBlocks)) : 1;
+                for (int pc = 0; pc < k; pc += blockK)
+                {
+                    const int kc = std::min(blockK, k - pc);
+                    // Later depth slices accumulate onto the partial sums of the earlier ones
+                    const T betaHere = pc == 0 ? beta : T(1);
+                    const T *panelB = B + static_cast<long long>(pc) * rowStrideB + static_cast<long long>(jc) * colStrideB;
+                    T *bufferB = packedB.data();
+                    T *bufferA = packedA.data();
+
+                    KaloAlgebraParallel::parallelFor(0, slivers, static_cast<long long>(kc) * nr, [&](long long first, long long last)
+                                                     {
+                        const int firstCol = static_cast<int>(first) * nr;
+                        const int lastCol = std::min(nc, static_cast<int>(last) * nr);
+                        packB(kc, lastCol - firstCol, nr, panelB + static_cast<long long>(firstCol) * colStrideB,
+                              rowStrideB, colStrideB, bufferB + static_cast<long long>(firstCol) * kc); });
+
+                    const long long taskCost = static_cast<long long>(blockM) * kc * nc / colGroups;
+                    KaloAlgebraParallel::parallelFor(0, static_cast<long long>(rowBlocks) * colGroups, taskCost, [&](long long first, long long last)
+                                                     {
+                        const int slot = KaloAlgebraParallel::currentThreadIndex();
+                        thread_local Buffer<T> overflow; // only if the thread count changed mid-call
+                        if (slot >= slots && overflow.size() < slotA)
+                            overflow.resize(slotA);
+                        T *blockA = slot < slots ? bufferA + slotA * slot : overflow.data();
+                        for (long long task = first; task < last; task++)
+                        {
+                            const int ic = static_cast<int>(task / colGroups) * blockM;
+                            const int group = static_cast<int>(task % colGroups);
+                            const int mc = std::min(blockM, m - ic);
+                            const int firstCol = slivers * group / colGroups * nr;
+                            int lastCol = std::min(nc, slivers * (group + 1) / colGroups * nr);
+                            if (lowerOnly)
+                                lastCol = std::min(lastCol, ic + mc - jc);
+                            if (lastCol <= firstCol)
+                                continue;
+                            packA(mc, kc, mr, A + static_cast<long long>(ic) * rowStrideA + static_cast<long long>(pc) * colStrideA,
+                                  rowStrideA, colStrideA, blockA);
+                            macroKernel(info, mc, lastCol - firstCol, kc, alpha, betaHere, blockA,
+                                        bufferB + static_cast<long long>(firstCol) * kc,
+                                        C + static_cast<long long>(ic) * ldc + jc + firstCol, ldc);
+                        } });
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    void gemm(int m, int n, int k, T alpha,
+              const T *A, int rowStrideA, int colStrideA,
+              const T *B, int rowStrideB, int colStrideB,
+              T beta, T *C, int ldc)
+    {
+        if (m <= 0 || n <= 0)
+            return;
+        if (k <= 0 || alpha == T(0))
+        {
+            scaleOutput(m, n, beta, C, ldc);
+            return;
+        }
+        if (static_cast<long long>(m) * n * k <= smallProblem)
+        {
+            gemmSmall(m, n, k, alpha, A, rowStrideA, colStrideA, B, rowStrideB, colStrideB, beta, C, ldc);
+            return;
+        }
+        gemmBlocked(m, n, k, alpha, A, rowStrideA, colStrideA, B, rowStrideB, colStrideB, beta, C, ldc, false);
+    }
+
+    template <typename T>
+    void syrk(int n, int k, T alpha, const T *A, int rowStrideA, int colStrideA, T beta, T *C, int ldc)
+    {
+        if (n <= 0)
+            return;
+        if (k <= 0 || alpha == T(0))
+        {
+            scaleOutput(n, n, beta, C, ldc);
+            return;
+        }
+        // A^T is A with the strides swapped. Small problems compute all of C, which is cheaper than
+        // skipping tiles; the mirroring below still makes it exactly symmetric.
+        if (static_cast<long long>(n) * n * k <= smallProblem)
+            gemmSmall(n, n, k, alpha, A, rowStrideA, colStrideA, A, colStrideA, rowStrideA, beta, C, ldc);
+        else
+            gemmBlocked(n, n, k, alpha, A, rowStrideA, colStrideA, A, colStrideA, rowStrideA, beta, C, ldc, true);
+
+        // Mirror the lower triangle: the part right of each row block's diagonal block with the
+        // tiled transpose, and the diagonal block element by element
+        for (int ic = 0; ic < n; ic += blockM)
+        {
+            const int mc = std::min(blockM, n - ic);
+            T *diagonal = C + static_cast<long long>(ic) * ldc + ic;
+            for (int i = 0; i < mc; i++)
+                for (int j = i + 1; j < mc; j++)
+                    diagonal[static_cast<long long>(i) * ldc + j] = diagonal[static_cast<long long>(j) * ldc + i];
+            if (ic + mc < n)
+                transpose(n - ic - mc, mc, diagonal + static_cast<long long>(mc) * ldc, ldc, diagonal + mc, ldc);
+        }
+    }
+
+    template void gemm<float>(int, int, int, float, const float *, int, int, const float *, int, int, float, float *, int);
+    template void gemm<double>(int, int, int, double, const double *, int, int, const double *, int, int, double, double *, int);
+    template void gemm<std::complex<float>>(int, int, int, std::complex<float>, const std::complex<float> *, int, int,
+                                            const std::complex<float> *, int, int, std::complex<float>, std::complex<float> *, int);
+    template void gemm<std::complex<double>>(int, int, int, std::complex<double>, const std::complex<double> *, int, int,
+                                             const std::complex<double> *, int, int, std::complex<double>, std::complex<double> *, int);
+    template void syrk<float>(int, int, float, const float *, int, int, float, float *, int);
+    template void syrk<double>(int, int, double, const double *, int, int, double, double *, int);
+    template void syrk<std::complex<float>>(int, int, std::complex<float>, const std::complex<float> *, int, int, std::complex<float>,
+                                            std::complex<float> *, int);
+    template void syrk<std::complex<double>>(int, int, std::complex<double>, const std::complex<double> *, int, int, std::complex<double>,
+                                             std::complex<double> *, int);
+}
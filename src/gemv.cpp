@@ -0,0 +1,122 @@
+#include "gemv.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <complex>
+
+// BLAS-2 kernels. Both are bound by streaming A from memory, so they reuse the BLAS-1 SIMD kernels
+// along A's contiguous dimension and spread independent rows (or column bands) over the pool.
+// Every output element is accumulated in the same order for any thread count.
+namespace KaloAlgebraKernels
+{
+    namespace
+    {
+        constexpr int columnBand = 256; // columns of y per task when A is traversed by columns
+
+        // y = beta * y, without reading y when beta is 0
+        template <typename T>
+        void scaleOutput(int m, T beta, T *y, int incy)
+        {
+            if (beta == T(1))
+                return;
+            for (int i = 0; i < m; i++)
+            {
+                T &value = y[static_cast<long long>(i) * incy];
+                value = beta == T(0) ? T(0) : beta * value;
+            }
+        }
+    }
+
+    template <typename T>
+    void gemv(int m, int n, T alpha,
+              const T *A, int rowStrideA, int colStrideA,
+              const T *x, int incx,
+              T beta, T *y, int incy)
+    {
+        if (m <= 0)
+            return;
+        if (n <= 0 || alpha == T(0))
+        {
+            scaleOutput(m, beta, y, incy);
+            return;
+        }
+
+        if (colStrideA == 1 && incx == 1)
+        {
+            // Rows are contiguous: y(i) is one SIMD dot product
+            KaloAlgebraParallel::parallelFor(0, m, n, [&](long long first, long long last)
+                                             {
+                for (long long i = first; i < last; i++)
+                {
+                    const T sum = KaloAlgebraSimd::dot(A + i * rowStrideA, x, static_cast<std::size_t>(n));
+                    T &out = y[i * incy];
+                    out = beta == T(0) ? alpha * sum : alpha * sum + beta * out;
+                } });
+            return;
+        }
+
+        if (rowStrideA == 1 && incy == 1)
+        {
+            // Columns are contiguous: y += (alpha * x(j)) * column j, each task owning a band of y
+            const long long bands = (m + columnBand - 1) / columnBand;
+            KaloAlgebraParallel::parallelFor(0, bands, static_cast<long long>(n) * columnBand, [&](long long first, long long last)
+                                             {
+                const int begin = static_cast<int>(first * columnBand);
+                const int end = static_cast<int>(std::min<long long>(m, last * columnBand));
+                scaleOutput(end - begin, beta, y + begin, 1);
+                for (int j = 0; j < n; j++)
+                {
+                    const T *column = A + static_cast<long long>(j) * colStrideA + begin;
+                    KaloAlgebraSimd::axpy(alpha * x[static_cast<long long>(j) * incx], column, y + begin, static_cast<std::size_t>(end - begin));
+                } });
+            return;
+        }
+
+        // Arbitrary strides: plain per-row sums
+        KaloAlgebraParallel::parallelFor(0, m, n, [&](long long first, long long last)
+                                         {
+            for (long long i = first; i < last; i++)
+            {
+                T sum = T(0);
+                for (int j = 0; j < n; j++)
+                    sum += A[i * rowStrideA + static_cast<long long>(j) * colStrideA] * x[static_cast<long long>(j) * incx];
+                T &out = y[i * incy];
+                out = beta == T(0) ? alpha * sum : alpha * sum + beta * out;
+            } });
+    }
+
+    template <typename T>
+    void ger(int m, int n, T alpha, const T *x, int incx, const T *y, int incy, T *A, int lda)
+    {
+        if (m <= 0 || n <= 0 || alpha == T(0))
+            return;
+        KaloAlgebraParallel::parallelFor(0, m, 2LL * n, [&](long long first, long long last)
+                                         {
+            for (long long i = first; i < last; i++)
+            {
+                const T scale = alpha * x[i * incx];
+                T *row = A + i * lda;
+                if (incy == 1)
+                {
+                    KaloAlgebraSimd::axpy(scale, y, row, static_cast<std::size_t>(n));
+                    continue;
+                }
+                for (int j = 0; j < n; j++)
+                    row[j] += scale * y[static_cast<long long>(j) * incy];
+            } });
+    }
+
+    template void gemv<float>(int, int, float, const float *, int, int, const float *, int, float, float *, int);
+    template void gemv<double>(int, int, double, const double *, int, int, const double *, int, double, double *, int);
+    template void gemv<std::complex<float>>(int, int, std::complex<float>, const std::complex<float> *, int, int,
+                                            const std::complex<float> *, int, std::complex<float>, std::complex<float> *, int);
+    template void gemv<std::complex<double>>(int, int, std::complex<double>, const std::complex<double> *, int, int,
+                                             const std::complex<double> *, int, std::complex<double>, std::complex<double> *, int);
+
+    template void ger<float>(int, int, float, const float *, int, const float *, int, float *, int);
+    template void ger<double>(int, int, double, const double *, int, const double *, int, double *, int);
+    template void ger<std::complex<float>>(int, int, std::complex<float>, const std::complex<float> *, int,
+                                           const std::complex<float> *, int, std::complex<float> *, int);
+    template void ger<std::complex<double>>(int, int, std::complex<double>, const std::complex<double> *, int,
+                                            const std::complex<double> *, int, std::complex<double> *, int);
+}
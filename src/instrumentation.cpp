@@ -0,0 +1,148 @@
+#include "instrumentation.hpp"
+#include <algorithm> // For std::max
+#include <cstdio>    // For std::snprintf
+#include <map>       // For std::map
+#include <mutex>     // For std::mutex, std::lock_guard
+#include <sstream>   // For std::ostringstream
+#include <utility>   // For std::pair
+
+namespace KaloAlgebraInstrumentation
+{
+    namespace
+    {
+        // Keyed by the name's address so that recording a call does not build a string (and so
+        // does not allocate once the entry exists); snapshot() merges equal names
+        using Key = std::pair<const char *, long long>;
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::map<Key, OperationStats> stats;
+        };
+
+        Registry &registry()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        thread_local ScopedOperation *innermost = nullptr;
+
+        long long bucketOf(long long size)
+        {
+            long long bucket = 1;
+            while (bucket < size)
+                bucket *= 2;
+            return bucket;
+        }
+    }
+
+    ScopedOperation::ScopedOperation(const char *operation, long long size, double flops, double bytes)
+        : operation(operation), size(size), flops(flops), bytes(bytes), parent(innermost), start(std::chrono::steady_clock::now())
+    {
+        innermost = this;
+    }
+
+    ScopedOperation::~ScopedOperation()
+    {
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        innermost = parent;
+
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        const long long bucket = bucketOf(size);
+        auto found = r.stats.find(Key(operation, bucket));
+        if (found == r.stats.end())
+            found = r.stats.emplace(Key(operation, bucket), OperationStats{operation, bucket, 0, 0.0, 0.0, 0.0, 0, 0}).first;
+        OperationStats &entry = found->second;
+        entry.calls++;
+        entry.seconds += seconds;
+        entry.flops += flops;
+        entry.bytes += bytes;
+        entry.allocations += allocations;
+        entry.allocatedBytes += allocatedBytes;
+    }
+
+    void recordAllocation(long long bytes)
+    {
+        if (innermost)
+            innermost->addAllocation(bytes);
+    }
+
+    std::vector<OperationStats> snapshot()
+    {
+        Registry &r = registry();
+        std::map<std::pair<std::string, long long>, OperationStats> merged;
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (const auto &entry : r.stats)
+            {
+                const OperationStats &s = entry.second;
+                auto inserted = merged.emplace(std::make_pair(s.operation, s.sizeBucket), s);
+                if (inserted.second)
+                    continue;
+                OperationStats &total = inserted.first->second;
+                total.calls += s.calls;
+                total.seconds += s.seconds;
+                total.flops += s.flops;
+                total.bytes += s.bytes;
+                total.allocations += s.allocations;
+                total.allocatedBytes += s.allocatedBytes;
+            }
+        }
+        std::vector<OperationStats> result;
+        result.reserve(merged.size());
+        for (const auto &entry : merged)
+            result.push_back(entry.second);
+        return result;
+    }
+
+    void reset()
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.stats.clear();
+    }
+
+    std::string report()
+    {
+        const std::vector<OperationStats> stats = snapshot();
+        std::ostringstream out;
+        if (!isEnabled())
+            out << "# instrumentation is compiled out (configure with -DKALO_ALGEBRA_INSTRUMENTATION=ON)\n";
+        std::size_t width = 9;
+        for (const OperationStats &s : stats)
+            width = std::max(width, s.operation.size());
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-*s %8s %10s %12s %10s %10s %8s %12s\n", static_cast<int>(width), "operation",
+                      "size<=", "calls", "total ms", "GFLOP/s", "GB/s", "allocs", "alloc MB");
+        out << line;
+        for (const OperationStats &s : stats)
+        {
+            const double rate = s.seconds > 0.0 ? 1.0 / s.seconds / 1e9 : 0.0;
+            std::snprintf(line, sizeof(line), "%-*s %8lld %10lld %12.3f %10.2f %10.2f %8lld %12.3f\n", static_cast<int>(width),
+                          s.operation.c_str(), s.sizeBucket, s.calls, s.seconds * 1e3, s.flops * rate, s.bytes * rate,
+                          s.allocations, s.allocatedBytes / 1e6);
+            out << line;
+        }
+        return out.str();
+    }
+
+    std::string toJson()
+    {
+        const std::vector<OperationStats> stats = snapshot();
+        std::ostringstream out;
+        out.precision(17);
+        out << "[";
+        for (std::size_t i = 0; i < stats.size(); i++)
+        {
+            const OperationStats &s = stats[i];
+            out << (i ? ",\n " : "\n ") << "{\"operation\": \"" << s.operation << "\", \"size_bucket\": " << s.sizeBucket
+                << ", \"calls\": " << s.calls << ", \"seconds\": " << s.seconds << ", \"flops\": " << s.flops
+                << ", \"bytes\": " << s.bytes << ", \"allocations\": " << s.allocations
+                << ", \"allocated_bytes\": " << s.allocatedBytes << "}";
+        }
+        out << (stats.empty() ? "]" : "\n]");
+        return out.str();
+    }
+}
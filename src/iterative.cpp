@@ -0,0 +1,552 @@
+#include "iterative.hpp"
+#include "gemv.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    // Elements per partial sum of a dot product. Fixed, so the summation order, and with it the
+    // result, is the same for every thread count.
+    constexpr int dotChunk = 4096;
+
+    // Work vector rows shared by all methods
+    constexpr int solutionRow = 0, rightHandSideRow = 1;
+
+    int workRows(IterativeMethod method)
+    {
+        switch (method)
+        {
+        case IterativeMethod::ConjugateGradient:
+            return 6; // x, b, r, z, p, q
+        case IterativeMethod::BiCGSTAB:
+            return 10; // x, b, r, r0, p, v, M^-1 p, s, M^-1 s, t
+        default:
+            return 4; // x, b, r, M^-1 * (V * y)
+        }
+    }
+
+    // Runs body(first, last) over the n elements of a vector update, split across the thread pool
+    template <typename Body>
+    void forElements(int n, Body body)
+    {
+        KaloAlgebraParallel::parallelFor(0, n, 4, [&](long long first, long long last)
+                                         { body(static_cast<std::size_t>(first), static_cast<std::size_t>(last)); });
+    }
+
+    // y += alpha * x
+    void update(int n, double alpha, const double *x, double *y)
+    {
+        forElements(n, [&](std::size_t first, std::size_t last)
+                    { KaloAlgebraSimd::axpy(alpha, x + first, y + first, last - first); });
+    }
+
+    void copy(int n, const double *x, double *y)
+    {
+        forElements(n, [&](std::size_t first, std::size_t last)
+                    { std::copy(x + first, x + last, y + first); });
+    }
+}
+
+JacobiPreconditioner::JacobiPreconditioner(const Matrix &A) : inverseDiagonal(1)
+{
+    if (A.getRows() != A.getCols() || A.getRows() == 0)
+    {
+        throw std::invalid_argument("Matrix must be square and not empty for a preconditioner!");
+    }
+    Vector diagonal(A.getRows());
+    for (int i = 0; i < A.getRows(); i++)
+        diagonal.data()[i] = A.rowPtr(i)[i];
+    *this = JacobiPreconditioner(diagonal);
+}
+
+JacobiPreconditioner::JacobiPreconditioner(const SparseMatrix &A) : inverseDiagonal(1)
+{
+    if (A.getRows() != A.getCols() || A.getRows() == 0)
+    {
+        throw std::invalid_argument("Matrix must be square and not empty for a preconditioner!");
+    }
+    Vector diagonal(A.getRows());
+    for (int i = 0; i < A.getRows(); i++)
+        diagonal.data()[i] = A.getElement(i, i);
+    *this = JacobiPreconditioner(diagonal);
+}
+
+JacobiPreconditioner::JacobiPreconditioner(const Vector &diagonal) : inverseDiagonal(diagonal.getSize())
+{
+    for (int i = 0; i < diagonal.getSize(); i++)
+    {
+        if (diagonal.data()[i] == 0.0)
+        {
+            throw std::invalid_argument("Matrix has a zero on the diagonal!");
+        }
+        inverseDiagonal.data()[i] = 1.0 / diagonal.data()[i];
+    }
+}
+
+int JacobiPreconditioner::getSize() const
+{
+    return inverseDiagonal.getSize();
+}
+
+void JacobiPreconditioner::apply(ConstVectorView r, VectorView z) const
+{
+    const double *in = r.data(), *scale = inverseDiagonal.data();
+    double *out = z.data();
+    forElements(getSize(), [&](std::size_t first, std::size_t last)
+                {
+        for (std::size_t i = first; i < last; i++)
+            out[i] = in[i] * scale[i]; });
+}
+
+// ILU(0) in the IKJ order: row i is eliminated with the already factored rows above it, and only
+// the entries present in A's pattern are updated, so there is no fill-in
+ILU0Preconditioner::ILU0Preconditioner(const SparseMatrix &A)
+    : size(A.getRows()), rowOffsets(A.getRowOffsets()), columnIndices(A.getColumnIndices()), factors(A.getValues()), diagonal(A.getRows())
+{
+    KALO_ALGEBRA_INSTRUMENT("ILU0Preconditioner::factor", A.getRows(), 2.0 * A.getNonZeros(), 2.0 * A.getNonZeros() * (sizeof(double) + sizeof(int)));
+    if (A.getRows() != A.getCols() || A.getRows() == 0)
+    {
+        throw std::invalid_argument("Matrix must be square and not empty for a preconditioner!");
+    }
+    for (int i = 0; i < size; i++)
+    {
+        const auto begin = columnIndices.begin() + rowOffsets[i], end = columnIndices.begin() + rowOffsets[i + 1];
+        const auto found = std::lower_bound(begin, end, i);
+        if (found == end || *found != i)
+        {
+            throw std::invalid_argument("Matrix is missing a diagonal entry for ILU(0)!");
+        }
+        diagonal[i] = found - columnIndices.begin();
+    }
+
+    std::vector<long long> position(size, -1); // Entry of row i in each column, -1 if none
+    for (int i = 0; i < size; i++)
+    {
+        for (long long p = rowOffsets[i]; p < rowOffsets[i + 1]; p++)
+            position[columnIndices[p]] = p;
+        for (long long p = rowOffsets[i]; p < diagonal[i]; p++)
+        {
+            const int k = columnIndices[p];
+            const double multiplier = factors[p] / factors[diagonal[k]];
+            factors[p] = multiplier;
+            for (long long q = diagonal[k] + 1; q < rowOffsets[k + 1]; q++)
+            {
+                const long long target = position[columnIndices[q]];
+                if (target >= 0)
+                    factors[target] -= multiplier * factors[q];
+            }
+        }
+        if (factors[diagonal[i]] == 0.0)
+        {
+            throw std::invalid_argument("Incomplete factorization has a zero pivot!");
+        }
+        for (long long p = rowOffsets[i]; p < rowOffsets[i + 1]; p++)
+            position[columnIndices[p]] = -1;
+    }
+}
+
+int ILU0Preconditioner::getSize() const
+{
+    return size;
+}
+
+void ILU0Preconditioner::apply(ConstVectorView r, VectorView z) const
+{
+    const double *in = r.data();
+    double *out = z.data();
+    // L * y = r, then U * z = y, in place in z
+    for (int i = 0; i < size; i++)
+    {
+        double value = in[i];
+        for (long long p = rowOffsets[i]; p < diagonal[i]; p++)
+            value -= factors[p] * out[columnIndices[p]];
+        out[i] = value;
+    }
+    for (int i = size - 1; i >= 0; i--)
+    {
+        double value = out[i];
+        for (long long p = diagonal[i] + 1; p < rowOffsets[i + 1]; p++)
+            value -= factors[p] * out[columnIndices[p]];
+        out[i] = value / factors[diagonal[i]];
+    }
+}
+
+IterativeSolver::IterativeSolver(IterativeMethod method, int size, int restart)
+    : method(method), size(size), restart(restart), maxIterations(1000), tolerance(1e-10), preconditioner(nullptr),
+      work(0, 0), basis(0, 0), hessenberg(0, 0), iterations(0), converged(false), residual(0.0)
+{
+    if (size <= 0)
+    {
+        throw std::invalid_argument("Size must be greater than 0!");
+    }
+    if (method == IterativeMethod::GMRES && restart <= 0)
+    {
+        throw std::invalid_argument("GMRES restart length must be greater than 0!");
+    }
+    work = Matrix(workRows(method), size);
+    if (method == IterativeMethod::GMRES)
+    {
+        basis = Matrix(restart + 1, size);
+        hessenberg = Matrix(restart, restart + 1);
+        cosines.resize(restart);
+        sines.resize(restart);
+        projection.resize(restart + 1);
+        coefficients.resize(restart + 1);
+    }
+    partialSums.resize((size + dotChunk - 1) / dotChunk);
+    history.reserve(maxIterations + 1);
+}
+
+void IterativeSolver::setTolerance(double relativeTolerance)
+{
+    if (!(relativeTolerance >= 0.0))
+    {
+        throw std::invalid_argument("Tolerance must not be negative!");
+    }
+    tolerance = relativeTolerance;
+}
+
+void IterativeSolver::setMaxIterations(int count)
+{
+    if (count < 0)
+    {
+        throw std::invalid_argument("Iteration count must not be negative!");
+    }
+    maxIterations = count;
+    history.reserve(maxIterations + 1);
+}
+
+void IterativeSolver::setPreconditioner(const Preconditioner *M)
+{
+    if (M && M->getSize() != size)
+    {
+        throw std::invalid_argument("Preconditioner size must match the solver!");
+    }
+    preconditioner = M;
+}
+
+// Partial sums over fixed chunks, in parallel, then added in chunk order
+double IterativeSolver::dot(const double *a, const double *b) const
+{
+    const long long chunks = static_cast<long long>(partialSums.size());
+    double *partial = partialSums.data();
+    KaloAlgebraParallel::parallelFor(0, chunks, 2LL * dotChunk, [&](long long first, long long last)
+                                     {
+        for (long long c = first; c < last; c++)
+        {
+            const long long start = c * dotChunk;
+            const std::size_t length = static_cast<std::size_t>(std::min<long long>(dotChunk, size - start));
+            partial[c] = KaloAlgebraSimd::dot(a + start, b + start, length);
+        } });
+    double sum = 0.0;
+    for (long long c = 0; c < chunks; c++)
+        sum += partial[c];
+    return sum;
+}
+
+double IterativeSolver::norm(const double *a) const
+{
+    return std::sqrt(dot(a, a));
+}
+
+void IterativeSolver::precondition(const double *r, double *z) const
+{
+    if (preconditioner)
+        preconditioner->apply(ConstVectorView(r, size), VectorView(z, size));
+    else
+        copy(size, r, z);
+}
+
+bool IterativeSolver::solve(const LinearOperator &A, ConstVectorView b, VectorView x)
+{
+    KALO_ALGEBRA_INSTRUMENT("IterativeSolver::solve", size, 0.0, 0.0);
+    if (b.getSize() != size || x.getSize() != size)
+    {
+        throw std::invalid_argument("Vector size must match the solver!");
+    }
+    double *solution = work.rowPtr(solutionRow), *rightHandSide = work.rowPtr(rightHandSideRow);
+    for (int i = 0; i < size; i++)
+    {
+        solution[i] = x.evaluate(i);
+        rightHandSide[i] = b.evaluate(i);
+    }
+    history.clear();
+    iterations = 0;
+    converged = false;
+
+    const double bNorm = norm(rightHandSide);
+    if (bNorm == 0.0)
+    {
+        // x = 0 solves it exactly
+        std::fill(solution, solution + size, 0.0);
+        history.push_back(0.0);
+        residual = 0.0;
+        converged = true;
+    }
+    else if (method == IterativeMethod::ConjugateGradient)
+        conjugateGradient(A, bNorm);
+    else if (method == IterativeMethod::BiCGSTAB)
+        biCGSTAB(A, bNorm);
+    else
+        gmres(A, bNorm);
+
+    for (int i = 0; i < size; i++)
+        x.setElement(i, solution[i]);
+    return converged;
+}
+
+bool IterativeSolver::solve(const Matrix &A, ConstVectorView b, VectorView x)
+{
+    if (A.getRows() != size || A.getCols() != size)
+    {
+        throw std::invalid_argument("Matrix size must match the solver!");
+    }
+    return solve([&A](ConstVectorView in, VectorView out)
+                 { gemv(1.0, A.view(), in, 0.0, out); },
+                 b, x);
+}
+
+bool IterativeSolver::solve(const SparseMatrix &A, ConstVectorView b, VectorView x)
+{
+    if (A.getRows() != size || A.getCols() != size)
+    {
+        throw std::invalid_argument("Matrix size must match the solver!");
+    }
+    return solve([&A](ConstVectorView in, VectorView out)
+                 { spmv(1.0, A, in, 0.0, out); },
+                 b, x);
+}
+
+// Preconditioned conjugate gradients (Hestenes-Stiefel)
+void IterativeSolver::conjugateGradient(const LinearOperator &A, double bNorm)
+{
+    double *x = work.rowPtr(solutionRow), *b = work.rowPtr(rightHandSideRow), *r = work.rowPtr(2), *z = work.rowPtr(3), *p = work.rowPtr(4), *q = work.rowPtr(5);
+    const int n = size;
+
+    A(ConstVectorView(x, n), VectorView(r, n));
+    forElements(n, [&](std::size_t first, std::size_t last)
+                {
+        for (std::size_t i = first; i < last; i++)
+            r[i] = b[i] - r[i]; });
+    residual = norm(r) / bNorm;
+    history.push_back(residual);
+    converged = residual <= tolerance;
+    if (converged)
+        return;
+    precondition(r, z);
+    copy(n, z, p);
+    double rz = dot(r, z);
+
+    while (iterations < maxIterations)
+    {
+        A(ConstVectorView(p, n), VectorView(q, n));
+        const double curvature = dot(p, q);
+        if (!(curvature > 0.0) || !(rz > 0.0))
+            return; // A or M is not positive definite
+        const double alpha = rz / curvature;
+        update(n, alpha, p, x);
+        update(n, -alpha, q, r);
+        iterations++;
+        residual = norm(r) / bNorm;
+        history.push_back(residual);
+        if (residual <= tolerance)
+        {
+            converged = true;
+            return;
+        }
+
+        precondition(r, z);
+        const double rzNext = dot(r, z), beta = rzNext / rz;
+        rz = rzNext;
+        forElements(n, [&](std::size_t first, std::size_t last)
+                    {
+            for (std::size_t i = first; i < last; i++)
+                p[i] = z[i] + beta * p[i]; });
+    }
+}
+
+// Right-preconditioned BiCGSTAB (van der Vorst): A * M^-1 * u = b with x = M^-1 * u
+void IterativeSolver::biCGSTAB(const LinearOperator &A, double bNorm)
+{
+    double *x = work.rowPtr(solutionRow), *b = work.rowPtr(rightHandSideRow), *r = work.rowPtr(2), *r0 = work.rowPtr(3), *p = work.rowPtr(4), *v = work.rowPtr(5);
+    double *pHat = work.rowPtr(6), *s = work.rowPtr(7), *sHat = work.rowPtr(8), *t = work.rowPtr(9);
+    const int n = size;
+
+    A(ConstVectorView(x, n), VectorView(r, n));
+    forElements(n, [&](std::size_t first, std::size_t last)
+                {
+        for (std::size_t i = first; i < last; i++)
+            r[i] = b[i] - r[i]; });
+    residual = norm(r) / bNorm;
+    history.push_back(residual);
+    converged = residual <= tolerance;
+    if (converged)
+        return;
+    copy(n, r, r0);
+    std::fill(p, p + n, 0.0);
+    std::fill(v, v + n, 0.0);
+    double rho = 1.0, alpha = 1.0, omega = 1.0;
+
+    while (iterations < maxIterations)
+    {
+        const double rhoNext = dot(r0, r);
+        if (rhoNext == 0.0)
+            return; // r has become orthogonal to r0: breakdown
+        const double beta = (rhoNext / rho) * (alpha / omega);
+        rho = rhoNext;
+        forElements(n, [&](std::size_t first, std::size_t last)
+                    {
+            for (std::size_t i = first; i < last; i++)
+                p[i] = r[i] + beta * (p[i] - omega * v[i]); });
+
+        precondition(p, pHat);
+        A(ConstVectorView(pHat, n), VectorView(v, n));
+        const double r0v = dot(r0, v);
+        if (r0v == 0.0)
+            return;
+        alpha = rho / r0v;
+        forElements(n, [&](std::size_t first, std::size_t last)
+                    {
+            for (std::size_t i = first; i < last; i++)
+                s[i] = r[i] - alpha * v[i]; });
+        iterations++;
+        const double sNorm = norm(s) / bNorm;
+        if (sNorm <= tolerance)
+        {
+            // Half a step is enough
+            update(n, alpha, pHat, x);
+            copy(n, s, r);
+            residual = sNorm;
+            history.push_back(residual);
+            converged = true;
+            return;
+        }
+
+        precondition(s, sHat);
+        A(ConstVectorView(sHat, n), VectorView(t, n));
+        const double tt = dot(t, t);
+        omega = tt > 0.0 ? dot(t, s) / tt : 0.0;
+        forElements(n, [&](std::size_t first, std::size_t last)
+                    {
+            for (std::size_t i = first; i < last; i++)
+            {
+                x[i] += alpha * pHat[i] + omega * sHat[i];
+                r[i] = s[i] - omega * t[i];
+            } });
+        residual = norm(r) / bNorm;
+        history.push_back(residual);
+        if (residual <= tolerance)
+        {
+            converged = true;
+            return;
+        }
+        if (omega == 0.0)
+            return; // Stagnation: the method cannot continue
+    }
+}
+
+// Restarted, right-preconditioned GMRES. Each cycle builds an orthonormal basis V of the Krylov
+// space of A * M^-1 from the residual, keeps the Hessenberg matrix H triangular with Givens
+// rotations so the residual norm is known at every step, and at the end of the cycle solves the
+// small least-squares problem for y and updates x += M^-1 * V * y.
+void IterativeSolver::gmres(const LinearOperator &A, double bNorm)
+{
+    double *x = work.rowPtr(solutionRow), *b = work.rowPtr(rightHandSideRow), *r = work.rowPtr(2), *z = work.rowPtr(3);
+    const int n = size, ldv = basis.getStride();
+    double *g = projection.data();
+
+    while (true)
+    {
+        A(ConstVectorView(x, n), VectorView(r, n));
+        forElements(n, [&](std::size_t first, std::size_t last)
+                    {
+            for (std::size_t i = first; i < last; i++)
+                r[i] = b[i] - r[i]; });
+        const double beta = norm(r);
+        residual = beta / bNorm;
+        // The recurrence's estimate ends each cycle; replace it with the true residual
+        if (history.empty())
+            history.push_back(residual);
+        else
+            history.back() = residual;
+        if (residual <= tolerance)
+        {
+            converged = true;
+            return;
+        }
+        if (iterations >= maxIterations)
+            return;
+
+        double *v0 = basis.rowPtr(0);
+        forElements(n, [&](std::size_t first, std::size_t last)
+                    { KaloAlgebraSimd::scale(r + first, 1.0 / beta, v0 + first, last - first); });
+        std::fill(g, g + restart + 1, 0.0);
+        g[0] = beta;
+
+        int steps = 0;
+        while (steps < restart && iterations < maxIterations)
+        {
+            const int j = steps;
+            double *h = hessenberg.rowPtr(j), *w = basis.rowPtr(j + 1);
+            precondition(basis.rowPtr(j), z);
+            A(ConstVectorView(z, n), VectorView(w, n));
+
+            // Two passes of classical Gram-Schmidt, h = V * w and w -= V^T * h, keep w orthogonal
+            // to the basis to working precision
+            double *c = coefficients.data();
+            std::fill(h, h + restart + 1, 0.0);
+            for (int pass = 0; pass < 2; pass++)
+            {
+                KaloAlgebraKernels::gemv(j + 1, n, 1.0, basis.data(), ldv, 1, w, 1, 0.0, c, 1);
+                KaloAlgebraKernels::gemv(n, j + 1, -1.0, basis.data(), 1, ldv, c, 1, 1.0, w, 1);
+                for (int i = 0; i <= j; i++)
+                    h[i] += c[i];
+            }
+            h[j + 1] = norm(w);
+            const bool invariant = h[j + 1] == 0.0; // The Krylov space is invariant: the solution is in it
+            if (!invariant)
+                forElements(n, [&](std::size_t first, std::size_t last)
+                            { KaloAlgebraSimd::scale(w + first, 1.0 / h[j + 1], w + first, last - first); });
+
+            // Apply the earlier rotations to the new column, then one more to zero h[j + 1]
+            for (int i = 0; i < j; i++)
+            {
+                const double top = cosines[i] * h[i] + sines[i] * h[i + 1];
+                h[i + 1] = cosines[i] * h[i + 1] - sines[i] * h[i];
+                h[i] = top;
+            }
+            const double radius = std::hypot(h[j], h[j + 1]);
+            cosines[j] = radius == 0.0 ? 1.0 : h[j] / radius;
+            sines[j] = radius == 0.0 ? 0.0 : h[j + 1] / radius;
+            h[j] = radius;
+            h[j + 1] = 0.0;
+            g[j + 1] = -sines[j] * g[j];
+            g[j] = cosines[j] * g[j];
+
+            steps++;
+            iterations++;
+            residual = std::fabs(g[j + 1]) / bNorm;
+            history.push_back(residual);
+            if (residual <= tolerance || invariant)
+                break;
+        }
+
+        // y = H^-1 * g, then x += M^-1 * V^T * y
+        double *y = coefficients.data();
+        for (int i = steps - 1; i >= 0; i--)
+        {
+            double value = g[i];
+            for (int k = i + 1; k < steps; k++)
+                value -= hessenberg.rowPtr(k)[i] * y[k];
+            const double pivot = hessenberg.rowPtr(i)[i];
+            y[i] = pivot == 0.0 ? 0.0 : value / pivot;
+        }
+        KaloAlgebraKernels::gemv(n, steps, 1.0, basis.data(), 1, ldv, y, 1, 0.0, r, 1);
+        precondition(r, z);
+        update(n, 1.0, z, x);
+    }
+}
@@ -0,0 +1,309 @@
+#include "lu.hpp"
+#include "gemm.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    constexpr int blockSize = 96;   // columns per panel; the trailing GEMMs have this depth
+    constexpr int columnBand = 256; // right-hand-side columns per task in the triangular solves
+
+    // B = L^-1 * B for a jb x jb unit lower-triangular L and a jb x cols B, in column bands
+    void solveUnitLower(int jb, int cols, const double *L, int ldl, double *B, int ldb)
+    {
+        const long long bands = (cols + columnBand - 1) / columnBand;
+        KaloAlgebraParallel::parallelFor(0, bands, static_cast<long long>(jb) * jb * columnBand, [&](long long first, long long last)
+                                         {
+            const int begin = static_cast<int>(first * columnBand);
+            const int width = static_cast<int>(std::min<long long>(cols, last * columnBand)) - begin;
+            for (int i = 1; i < jb; i++)
+            {
+                double *target = B + static_cast<long long>(i) * ldb + begin;
+                const double *row = L + static_cast<long long>(i) * ldl;
+                for (int p = 0; p < i; p++)
+                    KaloAlgebraSimd::axpy(-row[p], B + static_cast<long long>(p) * ldb + begin, target, static_cast<std::size_t>(width));
+            } });
+    }
+
+    // B = U^-1 * B for a jb x jb upper-triangular U and a jb x cols B, in column bands
+    void solveUpper(int jb, int cols, const double *U, int ldu, double *B, int ldb)
+    {
+        const long long bands = (cols + columnBand - 1) / columnBand;
+        KaloAlgebraParallel::parallelFor(0, bands, static_cast<long long>(jb) * jb * columnBand, [&](long long first, long long last)
+                                         {
+            const int begin = static_cast<int>(first * columnBand);
+            const int width = static_cast<int>(std::min<long long>(cols, last * columnBand)) - begin;
+            for (int i = jb - 1; i >= 0; i--)
+            {
+                double *target = B + static_cast<long long>(i) * ldb + begin;
+                const double *row = U + static_cast<long long>(i) * ldu;
+                for (int p = i + 1; p < jb; p++)
+                    KaloAlgebraSimd::axpy(-row[p], B + static_cast<long long>(p) * ldb + begin, target, static_cast<std::size_t>(width));
+                for (int j = 0; j < width; j++)
+                    target[j] /= row[i];
+            } });
+    }
+
+    void swapRows(double *a, int lda, int first, int second, int length)
+    {
+        std::swap_ranges(a + static_cast<long long>(first) * lda, a + static_cast<long long>(first) * lda + length,
+                         a + static_cast<long long>(second) * lda);
+    }
+}
+
+// Blocked right-looking factorization (LAPACK's getrf): factor a panel of columns with partial
+// pivoting, solve for the matching block row of U, then update the trailing matrix with one GEMM
+LUDecomposition::LUDecomposition(const Matrix &A) : factors(A), pivots(A.getRows()), swapSign(1), singular(false)
+{
+    KALO_ALGEBRA_INSTRUMENT("LUDecomposition::factor", A.getRows(), 2.0 / 3.0 * A.getRows() * A.getRows() * A.getCols(), 2.0 * A.getRows() * A.getCols() * sizeof(double));
+    if (A.getRows() != A.getCols())
+    {
+        throw std::invalid_argument("Matrix must be square for LU decomposition!");
+    }
+    const int n = A.getRows();
+    double *a = factors.data();
+    const int lda = factors.getStride();
+
+    for (int k = 0; k < n; k += blockSize)
+    {
+        const int jb = std::min(blockSize, n - k);
+
+        // Panel: columns k .. k + jb - 1, unblocked
+        for (int j = k; j < k + jb; j++)
+        {
+            int pivot = j;
+            for (int i = j + 1; i < n; i++)
+            {
+                if (std::fabs(a[static_cast<long long>(i) * lda + j]) > std::fabs(a[static_cast<long long>(pivot) * lda + j]))
+                    pivot = i;
+            }
+            pivots[j] = pivot;
+            if (pivot != j)
+            {
+                // Whole rows are swapped, so the L columns already computed follow their rows
+                swapRows(a, lda, j, pivot, n);
+                swapSign = -swapSign;
+            }
+            const double *pivotRow = a + static_cast<long long>(j) * lda;
+            if (pivotRow[j] == 0.0)
+            {
+                singular = true;
+                continue;
+            }
+
+            // Multipliers below the pivot, then a rank-1 update of the rest of the panel
+            const int width = k + jb - j - 1;
+            KaloAlgebraParallel::parallelFor(j + 1, n, width + 1, [&](long long first, long long last)
+                                             {
+                for (long long i = first; i < last; i++)
+                {
+                    double *row = a + i * lda;
+                    row[j] /= pivotRow[j];
+                    KaloAlgebraSimd::axpy(-row[j], pivotRow + j + 1, row + j + 1, static_cast<std::size_t>(width));
+                } });
+        }
+
+        const int rest = n - k - jb;
+        if (rest == 0)
+            break;
+        double *diagonal = a + static_cast<long long>(k) * lda + k;
+
+        // U12 = L11^-1 * A12
+        solveUnitLower(jb, rest, diagonal, lda, diagonal + jb, lda);
+
+        // A22 -= L21 * U12; the three blocks are disjoint parts of the same storage
+        KaloAlgebraKernels::gemm(rest, rest, jb, -1.0,
+                                 diagonal + static_cast<long long>(jb) * lda, lda, 1,
+                                 diagonal + jb, lda, 1,
+                                 1.0, diagonal + static_cast<long long>(jb) * lda + jb, lda);
+    }
+}
+
+int LUDecomposition::getSize() const
+{
+    return factors.getRows();
+}
+
+bool LUDecomposition::isSingular() const
+{
+    return singular;
+}
+
+const Matrix &LUDecomposition::getFactors() const
+{
+    return factors;
+}
+
+const std::vector<int> &LUDecomposition::getPivots() const
+{
+    return pivots;
+}
+
+Matrix LUDecomposition::getL() const
+{
+    const int n = getSize();
+    Matrix L = Matrix::identity(n);
+    for (int i = 1; i < n; i++)
+    {
+        std::copy(factors.rowPtr(i), factors.rowPtr(i) + i, L.rowPtr(i));
+    }
+    return L;
+}
+
+Matrix LUDecomposition::getU() const
+{
+    const int n = getSize();
+    Matrix U(n, n);
+    for (int i = 0; i < n; i++)
+    {
+        std::copy(factors.rowPtr(i) + i, factors.rowPtr(i) + n, U.rowPtr(i) + i);
+    }
+    return U;
+}
+
+Matrix LUDecomposition::getP() const
+{
+    const int n = getSize();
+    Matrix P = Matrix::identity(n);
+    for (int i = 0; i < n; i++)
+    {
+        if (pivots[i] != i)
+            swapRows(P.data(), P.getStride(), i, pivots[i], n);
+    }
+    return P;
+}
+
+double LUDecomposition::determinant() const
+{
+    double product = swapSign;
+    for (int i = 0; i < getSize(); i++)
+    {
+        product *= factors.rowPtr(i)[i];
+    }
+    return product;
+}
+
+// Forward and back substitution, blocked like the factorization: small triangular solves on the
+// diagonal blocks, GEMM updates for everything else
+void LUDecomposition::solveInPlace(double *B, int ldb, int rhs) const
+{
+    KALO_ALGEBRA_INSTRUMENT("LUDecomposition::solve", getSize(), 2.0 * getSize() * getSize() * rhs, (1.0 * getSize() * getSize() + 2.0 * getSize() * rhs) * sizeof(double));
+    if (singular)
+    {
+        throw std::invalid_argument("Matrix is singular!");
+    }
+    const int n = getSize();
+    const double *a = factors.data();
+    const int lda = factors.getStride();
+
+    for (int i = 0; i < n; i++)
+    {
+        if (pivots[i] != i)
+            swapRows(B, ldb, i, pivots[i], rhs);
+    }
+
+    for (int k = 0; k < n; k += blockSize)
+    {
+        const int jb = std::min(blockSize, n - k);
+        const double *diagonal = a + static_cast<long long>(k) * lda + k;
+        double *block = B + static_cast<long long>(k) * ldb;
+        solveUnitLower(jb, rhs, diagonal, lda, block, ldb);
+        if (k + jb < n)
+        {
+            KaloAlgebraKernels::gemm(n - k - jb, rhs, jb, -1.0,
+                                     diagonal + static_cast<long long>(jb) * lda, lda, 1,
+                                     block, ldb, 1,
+                                     1.0, block + static_cast<long long>(jb) * ldb, ldb);
+        }
+    }
+
+    for (int k = (n - 1) / blockSize * blockSize; k >= 0; k -= blockSize)
+    {
+        const int jb = std::min(blockSize, n - k);
+        const double *diagonal = a + static_cast<long long>(k) * lda + k;
+        double *block = B + static_cast<long long>(k) * ldb;
+        solveUpper(jb, rhs, diagonal, lda, block, ldb);
+        if (k > 0)
+        {
+            KaloAlgebraKernels::gemm(k, rhs, jb, -1.0,
+                                     a + k, lda, 1,
+                                     block, ldb, 1,
+                                     1.0, B, ldb);
+        }
+    }
+}
+
+// A single right-hand side is bound by reading the factors, so each substitution step is one
+// SIMD dot product along a contiguous row
+void LUDecomposition::solveInPlace(Vector &b) const
+{
+    const int n = getSize();
+    if (b.getSize() != n)
+    {
+        throw std::invalid_argument("Vector size must match the matrix size in order to solve!");
+    }
+    if (singular)
+    {
+        throw std::invalid_argument("Matrix is singular!");
+    }
+    double *x = b.data();
+    for (int i = 0; i < n; i++)
+    {
+        if (pivots[i] != i)
+            std::swap(x[i], x[pivots[i]]);
+    }
+    for (int i = 1; i < n; i++)
+    {
+        x[i] -= KaloAlgebraSimd::dot(factors.rowPtr(i), x, static_cast<std::size_t>(i));
+    }
+    for (int i = n - 1; i >= 0; i--)
+    {
+        const double *row = factors.rowPtr(i);
+        x[i] = (x[i] - KaloAlgebraSimd::dot(row + i + 1, x + i + 1, static_cast<std::size_t>(n - i - 1))) / row[i];
+    }
+}
+
+void LUDecomposition::solveInPlace(Matrix &B) const
+{
+    if (B.getRows() != getSize())
+    {
+        throw std::invalid_argument("Matrix rows must match the matrix size in order to solve!");
+    }
+    solveInPlace(B.data(), B.getStride(), B.getCols());
+}
+
+Vector LUDecomposition::solve(const Vector &b) const
+{
+    Vector x = b;
+    solveInPlace(x);
+    return x;
+}
+
+Matrix LUDecomposition::solve(const Matrix &B) const
+{
+    Matrix X = B;
+    solveInPlace(X);
+    return X;
+}
+
+Matrix LUDecomposition::inverse() const
+{
+    Matrix result = Matrix::identity(getSize());
+    solveInPlace(result);
+    return result;
+}
+
+Vector solve(const Matrix &A, const Vector &b)
+{
+    return LUDecomposition(A).solve(b);
+}
+
+Matrix solve(const Matrix &A, const Matrix &B)
+{
+    return LUDecomposition(A).solve(B);
+}
@@ -1,260 +1,807 @@
 #include "matrix.hpp"
+#include "gemm.hpp"
+#include "gemv.hpp"
+#include "lu.hpp"
+#include "transpose.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include "instrumentation.hpp"
 #include <iostream>
 #include <stdexcept>
 #include <vector>
-#include <random> //For random number generation
+#include <algorithm> //For std::copy and std::equal
+#include <cmath>
+#include <complex>
+
+namespace
+{
+    // Whether two views may share elements. Views whose address ranges meet are compared as
+    // lattices: with P the larger and q the smaller of their strides, element i * P + j * q of a
+    // view whose rows do not wrap past P sits at (row, column) = (offset / P, offset % P), so two
+    // views share an element only if their row ranges meet and their column progressions do.
+    // Disjoint blocks of one matrix, or its even and odd columns, are therefore told apart; layouts
+    // that do not fit this model (three strides, wrapping rows) are assumed to overlap.
+    template <typename T>
+    bool mayOverlap(BasicMatrixView<const T> a, BasicMatrixView<const T> b)
+    {
+        if (a.getRows() == 0 || a.getCols() == 0 || b.getRows() == 0 || b.getCols() == 0)
+            return false;
+        const T *aFirst = std::min(a.data(), a.elementPtr(a.getRows() - 1, a.getCols() - 1));
+        const T *aLast = std::max(a.data(), a.elementPtr(a.getRows() - 1, a.getCols() - 1));
+        const T *bFirst = std::min(b.data(), b.elementPtr(b.getRows() - 1, b.getCols() - 1));
+        const T *bLast = std::max(b.data(), b.elementPtr(b.getRows() - 1, b.getCols() - 1));
+        if (aLast < bFirst || bLast < aFirst)
+            return false;
+
+        // The dimensions that have more than one element, as (stride, count)
+        struct Dimension
+        {
+            long long stride, count;
+        };
+        const BasicMatrixView<const T> views[2] = {a, b};
+        Dimension dimensions[2][2];
+        int dimensionCount[2] = {0, 0};
+        long long strides[4];
+        int strideCount = 0;
+        for (int v = 0; v < 2; v++)
+        {
+            const Dimension both[2] = {{views[v].getRowStride(), views[v].getRows()}, {views[v].getColStride(), views[v].getCols()}};
+            for (const Dimension &dimension : both)
+            {
+                if (dimension.count == 1)
+                    continue;
+                if (dimension.stride <= 0)
+                    return true;
+                dimensions[v][dimensionCount[v]++] = dimension;
+                if (std::find(strides, strides + strideCount, dimension.stride) == strides + strideCount)
+                    strides[strideCount++] = dimension.stride;
+            }
+            if (dimensionCount[v] == 2 && dimensions[v][0].stride == dimensions[v][1].stride)
+                return true;
+        }
+        if (strideCount > 2)
+            return true;
+
+        const T *base = std::min(a.data(), b.data());
+        const long long startA = a.data() - base, startB = b.data() - base;
+        if (strideCount == 0)
+            return startA == startB;
+        const long long P = strideCount == 2 ? std::max(strides[0], strides[1]) : 0, q = std::min(strides[0], strideCount == 2 ? strides[1] : strides[0]);
+
+        // Row range and column progression of each view in the (offset / P, offset % P) grid; with
+        // a single stride everything is one row
+        long long rowFirst[2], rowLast[2], columnFirst[2], columnLast[2];
+        const long long starts[2] = {startA, startB};
+        for (int v = 0; v < 2; v++)
+        {
+            long long majorCount = 1, minorCount = 1;
+            for (int d = 0; d < dimensionCount[v]; d++)
+                (dimensions[v][d].stride == P ? majorCount : minorCount) = dimensions[v][d].count;
+            rowFirst[v] = P ? starts[v] / P : 0;
+            rowLast[v] = rowFirst[v] + majorCount - 1;
+            columnFirst[v] = P ? starts[v] % P : starts[v];
+            columnLast[v] = columnFirst[v] + q * (minorCount - 1);
+            if (P && columnLast[v] >= P)
+                return true;
+        }
+        return rowFirst[0] <= rowLast[1] && rowFirst[1] <= rowLast[0] && columnFirst[0] <= columnLast[1] && columnFirst[1] <= columnLast[0] &&
+               (columnFirst[0] - columnFirst[1]) % q == 0;
+    }
+
+    // A vector as a one-row matrix, for the overlap test
+    template <typename T>
+    BasicMatrixView<const T> asRow(BasicVectorView<const T> vector)
+    {
+        return BasicMatrixView<const T>(vector.data(), 1, vector.getSize(), 0, vector.getIncrement());
+    }
+
+    template <typename T>
+    void axpyRow(T alpha, const T *x, T *y, int n)
+    {
+        for (int j = 0; j < n; j++)
+            y[j] += alpha * x[j];
+    }
+
+    // Unblocked LU with partial pivoting, for the scalar types LUDecomposition (double only) does
+    // not cover. Row k was swapped with row pivots[k]; returns the parity of the swaps (+1 or -1),
+    // or 0 if a pivot is exactly zero
+    template <typename T>
+    int factorInPlace(BasicMatrix<T> &A, std::vector<int> &pivots)
+    {
+        if (A.getRows() != A.getCols())
+            throw std::invalid_argument("Matrix must be square for LU decomposition!");
+        const int n = A.getRows();
+        pivots.assign(n, 0);
+        int sign = 1;
+        for (int k = 0; k < n; k++)
+        {
+            int pivot = k;
+            for (int i = k + 1; i < n; i++)
+            {
+                if (std::abs(A.rowPtr(i)[k]) > std::abs(A.rowPtr(pivot)[k]))
+                    pivot = i;
+            }
+            pivots[k] = pivot;
+            if (A.rowPtr(pivot)[k] == T(0))
+                return 0;
+            if (pivot != k)
+            {
+                std::swap_ranges(A.rowPtr(k), A.rowPtr(k) + n, A.rowPtr(pivot));
+                sign = -sign;
+            }
+            for (int i = k + 1; i < n; i++)
+            {
+                T &multiplier = A.rowPtr(i)[k];
+                multiplier /= A.rowPtr(k)[k];
+                axpyRow(-multiplier, A.rowPtr(k) + k + 1, A.rowPtr(i) + k + 1, n - k - 1);
+            }
+        }
+        return sign;
+    }
+}
+
+// Pad rows to a multiple of 64 bytes (8 doubles) so each row starts on its own cache line.
+// Narrow matrices stay compact, padding them would only waste memory.
+template <typename T>
+int BasicMatrix<T>::leadingDimension(int cols)
+{
+    const int elementsPerLine = static_cast<int>(KaloAlgebraUtils::storageAlignment / sizeof(T));
+    if (cols < elementsPerLine)
+        return cols;
+    return (cols + elementsPerLine - 1) / elementsPerLine * elementsPerLine;
+}
 
 // Constructor: Initialized with dimensions and initial value
-Matrix::Matrix(int rows, int cols, double initialValue) : rows(rows), cols(cols)
+template <typename T>
+BasicMatrix<T>::BasicMatrix(int rows, int cols, T initialValue) : rows(rows), cols(cols)
 {
-    data = std::vector<std::vector<double>>(rows, std::vector<double>(cols, initialValue));
+    if (rows < 0 || cols < 0)
+    {
+        throw std::invalid_argument("Matrix dimensions must not be negative!");
+    }
+    stride = leadingDimension(cols);
+    storage.assign(static_cast<std::size_t>(rows) * stride, T(0));
+    for (int i = 0; i < rows; i++)
+    {
+        T *row = rowPtr(i);
+        for (int j = 0; j < cols; j++)
+        {
+            row[j] = initialValue;
+        }
+    }
 }
 
 // Constructor: Initialized with a 2d vector
-Matrix::Matrix(const std::vector<std::vector<double>> &inputData) : data(inputData)
+template <typename T>
+BasicMatrix<T>::BasicMatrix(const std::vector<std::vector<T>> &inputData)
 {
-    rows = data.size();
-    cols = data.empty() ? 0 : data[0].size();
+    rows = inputData.size();
+    cols = inputData.empty() ? 0 : inputData[0].size();
 
     // Check if all rows have same number of columns
-    for (const auto &row : data)
+    for (const auto &row : inputData)
     {
         if (row.size() != cols)
         {
             throw std::invalid_argument("All rows must have same number of column!");
         }
     }
+
+    stride = leadingDimension(cols);
+    storage.assign(static_cast<std::size_t>(rows) * stride, T(0));
+    for (int i = 0; i < rows; i++)
+    {
+        std::copy(inputData[i].begin(), inputData[i].end(), rowPtr(i));
+    }
+}
+
+// Constructor: Allocate without writing the elements, for results that are about to be overwritten
+template <typename T>
+BasicMatrix<T>::BasicMatrix(int rows, int cols, Uninitialized) : rows(rows), cols(cols), stride(leadingDimension(cols))
+{
+    if (rows < 0 || cols < 0)
+    {
+        throw std::invalid_argument("Matrix dimensions must not be negative!");
+    }
+    storage.resize(static_cast<std::size_t>(rows) * stride);
+    // Padding is still zeroed so it never holds garbage
+    for (int i = 0; i < rows && stride > cols; i++)
+    {
+        std::fill(rowPtr(i) + cols, rowPtr(i) + stride, T(0));
+    }
 }
 
 // Constructor: Initialize with copy constructor
-Matrix::Matrix(const Matrix &other) : rows(other.rows), cols(other.cols), data(other.data)
+template <typename T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix &other) : storage(other.storage), rows(other.rows), cols(other.cols), stride(other.stride)
 {
 }
 
 // Constructor: Move
-Matrix::Matrix(Matrix &&other) noexcept : rows(other.rows), cols(other.cols), data(std::move(other.data))
+template <typename T>
+BasicMatrix<T>::BasicMatrix(BasicMatrix &&other) noexcept : storage(std::move(other.storage)), rows(other.rows), cols(other.cols), stride(other.stride)
 {
     other.rows = 0;
     other.cols = 0;
+    other.stride = 0;
 }
 
 // Destructor
-Matrix::~Matrix()
+template <typename T>
+BasicMatrix<T>::~BasicMatrix()
 {
 }
 
 // Accessors
-int Matrix::getRows() const
+template <typename T>
+int BasicMatrix<T>::getRows() const
 {
     return rows;
 }
 
-int Matrix::getCols() const
+template <typename T>
+int BasicMatrix<T>::getCols() const
 {
     return cols;
 }
 
-double Matrix::getElement(int row, int col) const
+template <typename T>
+int BasicMatrix<T>::getStride() const
+{
+    return stride;
+}
+
+template <typename T>
+T BasicMatrix<T>::getElement(int row, int col) const
 {
     if (row < 0 || row >= rows || col < 0 || col >= cols)
     {
         throw std::invalid_argument("Index out of range!");
     }
-    return data[row][col];
+    return rowPtr(row)[col];
 }
 
-void Matrix::setElement(int row, int col, double value)
+template <typename T>
+void BasicMatrix<T>::setElement(int row, int col, T value)
 {
     if (row < 0 || row >= rows || col < 0 || col >= cols)
     {
         throw std::invalid_argument("Index out of range!");
     }
-    data[row][col] = value;
+    rowPtr(row)[col] = value;
 }
 
 // Matrix Operations
-Matrix Matrix::transpose() const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::transpose() const
 {
-    Matrix result(cols, rows);
-    for (int i = 0; i < rows; i++)
-    {
-        for (int j = 0; j < cols; j++)
-        {
-            result.data[j][i] = data[i][j];
-        }
-    }
+    KALO_ALGEBRA_INSTRUMENT("Matrix::transpose", std::max(rows, cols), 0.0, 2.0 * rows * cols * sizeof(T));
+    BasicMatrix result(cols, rows, Uninitialized());
+    KaloAlgebraKernels::transpose(rows, cols, data(), stride, result.data(), result.stride);
     return result;
 }
 
-// Sub matrix
-Matrix Matrix::subMatrix(int startRow, int startCol, int endRow, int endCol) const
+template <typename T>
+void BasicMatrix<T>::transposeInPlace()
 {
-    if (startRow < 0 || startRow >= rows || startCol < 0 || startCol >= cols || endRow < 0 || endRow >= rows || endCol < 0 || endCol >= cols)
-    {
-        throw std::invalid_argument("Index out of bound!");
-    }
-    Matrix result(endRow - startRow + 1, endCol - startCol + 1);
-    for (int i = startRow; i <= endRow; i++)
+    KALO_ALGEBRA_INSTRUMENT("Matrix::transposeInPlace", rows, 0.0, 2.0 * rows * cols * sizeof(T));
+    if (rows != cols)
     {
-        for (int j = startCol; j <= endCol; j++)
-        {
-            result.data[i - startRow][j - startCol] = data[i][j];
-        }
+        throw std::invalid_argument("Matrix must be square to transpose in place!");
     }
-    return result;
+    KaloAlgebraKernels::transposeInPlace(rows, data(), stride);
 }
 
-void Matrix::print() const
+template <typename T>
+T BasicMatrix<T>::determinant() const
 {
-    for (int i = 0; i < rows; i++)
+    KALO_ALGEBRA_INSTRUMENT("Matrix::determinant", rows, 2.0 / 3.0 * rows * rows * rows, 2.0 * rows * cols * sizeof(T));
+    if constexpr (std::is_same<T, double>::value)
+        return LUDecomposition(*this).determinant();
+    else
     {
-        for (int j = 0; j < cols; j++)
-        {
-            std::cout << data[i][j] << "  ";
-        }
-        std::cout << std::endl;
+        BasicMatrix factors(*this);
+        std::vector<int> pivots;
+        const int sign = factorInPlace(factors, pivots);
+        T result = T(sign);
+        for (int i = 0; i < rows && sign != 0; i++)
+            result *= factors.rowPtr(i)[i];
+        return result;
     }
 }
 
-// Arithmetic Operators
-// Matrix addition
-Matrix Matrix::operator+(const Matrix &other) const
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::inverse() const
 {
-    if (other.rows != rows || other.cols != cols)
+    KALO_ALGEBRA_INSTRUMENT("Matrix::inverse", rows, 2.0 * rows * rows * rows, 3.0 * rows * cols * sizeof(T));
+    if constexpr (std::is_same<T, double>::value)
+        return LUDecomposition(*this).inverse();
+    else
     {
-        throw std::invalid_argument("Matrix dimensions must match in order to perform addition!");
-    }
-    Matrix result(rows, cols);
-    for (int i = 0; i < rows; i++)
-    {
-        for (int j = 0; j < cols; j++)
+        BasicMatrix factors(*this);
+        std::vector<int> pivots;
+        if (factorInPlace(factors, pivots) == 0)
+            throw std::invalid_argument("Matrix is singular!");
+        BasicMatrix result = identity(rows);
+        for (int k = 0; k < rows; k++)
+        {
+            if (pivots[k] != k)
+                std::swap_ranges(result.rowPtr(k), result.rowPtr(k) + cols, result.rowPtr(pivots[k]));
+        }
+        // Forward substitution with the unit lower triangle, then back substitution with U
+        for (int i = 0; i < rows; i++)
+            for (int k = 0; k < i; k++)
+                axpyRow(-factors.rowPtr(i)[k], result.rowPtr(k), result.rowPtr(i), cols);
+        for (int i = rows - 1; i >= 0; i--)
         {
-            result.data[i][j] = data[i][j] + other.data[i][j];
+            for (int k = i + 1; k < rows; k++)
+                axpyRow(-factors.rowPtr(i)[k], result.rowPtr(k), result.rowPtr(i), cols);
+            const T pivot = factors.rowPtr(i)[i];
+            for (int j = 0; j < cols; j++)
+                result.rowPtr(i)[j] /= pivot;
         }
+        return result;
     }
-    return result;
 }
 
-// Matrix subtraction
-Matrix Matrix::operator-(const Matrix &other) const
+// Views
+template <typename T>
+BasicMatrixView<T> BasicMatrix<T>::view()
+{
+    return BasicMatrixView<T>(data(), rows, cols, stride);
+}
+
+template <typename T>
+BasicMatrixView<const T> BasicMatrix<T>::view() const
+{
+    return BasicMatrixView<const T>(data(), rows, cols, stride);
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrix<T>::block(int startRow, int startCol, int blockRows, int blockCols)
+{
+    return view().block(startRow, startCol, blockRows, blockCols);
+}
+
+template <typename T>
+BasicMatrixView<const T> BasicMatrix<T>::block(int startRow, int startCol, int blockRows, int blockCols) const
 {
-    if (other.rows != rows || other.cols != cols)
+    return view().block(startRow, startCol, blockRows, blockCols);
+}
+
+template <typename T>
+BasicVectorView<T> BasicMatrix<T>::row(int index)
+{
+    return view().row(index);
+}
+
+template <typename T>
+BasicVectorView<const T> BasicMatrix<T>::row(int index) const
+{
+    return view().row(index);
+}
+
+template <typename T>
+BasicVectorView<T> BasicMatrix<T>::col(int index)
+{
+    return view().col(index);
+}
+
+template <typename T>
+BasicVectorView<const T> BasicMatrix<T>::col(int index) const
+{
+    return view().col(index);
+}
+
+template <typename T>
+BasicMatrixView<T> BasicMatrix<T>::t()
+{
+    return view().t();
+}
+
+template <typename T>
+BasicMatrixView<const T> BasicMatrix<T>::t() const
+{
+    return view().t();
+}
+
+// Sub matrix
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::subMatrix(int startRow, int startCol, int endRow, int endCol) const
+{
+    KALO_ALGEBRA_INSTRUMENT("Matrix::subMatrix", std::max(endRow - startRow, endCol - startCol) + 1, 0.0, 2.0 * (endRow - startRow + 1) * (endCol - startCol + 1) * sizeof(T));
+    if (startRow < 0 || startRow >= rows || startCol < 0 || startCol >= cols || endRow < 0 || endRow >= rows || endCol < 0 || endCol >= cols)
     {
-        throw std::invalid_argument("Matrix dimensions must match in order to perform subtraction!");
+        throw std::invalid_argument("Index out of bound!");
     }
-    Matrix result(rows, cols);
-    for (int i = 0; i < rows; i++)
+    if (endRow < startRow || endCol < startCol)
     {
-        for (int j = 0; j < cols; j++)
-        {
-            result.data[i][j] = data[i][j] - other.data[i][j];
-        }
+        throw std::invalid_argument("Sub-matrix range is reversed!");
+    }
+    BasicMatrix result(endRow - startRow + 1, endCol - startCol + 1, Uninitialized());
+    for (int i = startRow; i <= endRow; i++)
+    {
+        const T *source = rowPtr(i) + startCol;
+        std::copy(source, source + result.cols, result.rowPtr(i - startRow));
     }
     return result;
 }
 
-// Matrix multiplication
-Matrix Matrix::operator*(const Matrix &other) const
+template <typename T>
+void BasicMatrix<T>::print() const
 {
-    if (cols != other.rows)
-    {
-        throw std::invalid_argument("Columns of first matrix must match rows of second matrix in order to perform multiplication!");
-    }
-    Matrix result(rows, other.cols);
     for (int i = 0; i < rows; i++)
     {
-        for (int j = 0; j < other.cols; j++)
+        for (int j = 0; j < cols; j++)
         {
-            for (int k = 0; k < cols; k++)
-            {
-                result.data[i][j] += data[i][k] * other.data[k][j];
-            }
+            std::cout << rowPtr(i)[j] << "  ";
         }
+        std::cout << std::endl;
     }
-    return result;
 }
 
-// Scalar multiplication
-Matrix Matrix::operator*(double scalar) const
+// Arithmetic Operators
+// Matrix multiplication
+template <typename T>
+BasicMatrix<T> KaloAlgebraExpressions::matrixProduct(BasicMatrixView<const T> left, BasicMatrixView<const T> right)
 {
-    Matrix result(rows, cols);
-    for (int i = 0; i < rows; i++)
+    KALO_ALGEBRA_INSTRUMENT("Matrix::operator*", std::max({left.getRows(), left.getCols(), right.getCols()}), 2.0 * left.getRows() * left.getCols() * right.getCols(), (1.0 * left.getRows() * left.getCols() + 1.0 * right.getRows() * right.getCols() + 1.0 * left.getRows() * right.getCols()) * sizeof(T));
+    if (left.getCols() != right.getRows())
     {
-        for (int j = 0; j < cols; j++)
-        {
-            result.data[i][j] = scalar * data[i][j];
-        }
+        throw std::invalid_argument("Columns of first matrix must match rows of second matrix in order to perform multiplication!");
     }
+    BasicMatrix<T> result(left.getRows(), right.getCols());
+    gemm(T(1), left, right, T(0), result);
     return result;
 }
 
 // Assignment Operators
 // Copy assignment
-Matrix &Matrix::operator=(const Matrix &other)
+template <typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(const BasicMatrix &other)
 {
+    KALO_ALGEBRA_INSTRUMENT("Matrix::copy", std::max(other.rows, other.cols), 0.0, 2.0 * other.rows * other.cols * sizeof(T));
     if (this != &other)
     {
         rows = other.rows;
         cols = other.cols;
-        data = other.data;
+        stride = other.stride;
+        storage = other.storage;
     }
     return *this;
 }
 // Move assignment
-Matrix &Matrix::operator=(Matrix &&other) noexcept
+template <typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(BasicMatrix &&other)
 {
     if (this != &other)
     {
         rows = other.rows;
         cols = other.cols;
-        data = std::move(other.data);
+        stride = other.stride;
+        storage = std::move(other.storage);
         other.rows = 0;
         other.cols = 0;
+        other.stride = 0;
     }
     return *this;
 }
 
-// Comparison Operators
-// Check equality
-bool Matrix::operator==(const Matrix &other) const
+// Compound Assignment Operators
+template <typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator*=(T scalar)
 {
-    return rows == other.rows && cols == other.cols && data == other.data;
+    scal(scalar, *this);
+    return *this;
 }
-// Check inequality
-bool Matrix::operator!=(const Matrix &other) const
+
+template <typename T>
+BasicMatrix<T> &BasicMatrix<T>::operator/=(T scalar)
 {
-    return !(*this == other);
+    KALO_ALGEBRA_INSTRUMENT("Matrix::operator/=", std::max(rows, cols), 1.0 * rows * cols, 2.0 * rows * cols * sizeof(T));
+    KaloAlgebraParallel::parallelFor(0, rows, cols, [&](long long first, long long last)
+                                     {
+        for (int i = static_cast<int>(first); i < last; i++)
+        {
+            T *row = rowPtr(i);
+            for (int j = 0; j < cols; j++)
+                row[j] /= scalar;
+        } });
+    return *this;
 }
 
 // Static Methods
 // Create an identity matrix
-Matrix Matrix::identity(int size)
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::identity(int size)
 {
-    Matrix result(size, size, 0.0);
+    BasicMatrix result(size, size, T(0));
     for (int i = 0; i < size; i++)
     {
-        result.data[i][i] = 1.0;
+        result.rowPtr(i)[i] = T(1);
     }
     return result;
 }
 // Create a zero matrix
-Matrix Matrix::zero(int rows, int cols)
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::zero(int rows, int cols)
 {
-    return Matrix(rows, cols, 0.0);
+    return BasicMatrix(rows, cols, T(0));
 }
 // Create a random matrix
-Matrix Matrix::random(int rows, int cols, double min, double max)
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::random(int rows, int cols, Real min, Real max)
 {
-    Matrix result(rows, cols);
-    std::random_device rd;                                 // seed
-    std::mt19937 gen(rd());                                // generator
-    std::uniform_real_distribution<double> dist(min, max); // range
-    for (int i = 0; i < rows; i++)
+    return random(rows, cols, min, max, KaloAlgebraUtils::threadGenerator());
+}
+
+template <typename T>
+BasicMatrix<T> BasicMatrix<T>::random(int rows, int cols, Real min, Real max, KaloAlgebraUtils::RandomGenerator &generator)
+{
+    KALO_ALGEBRA_INSTRUMENT("Matrix::random", std::max(rows, cols), 0.0, 1.0 * rows * cols * sizeof(T));
+    BasicMatrix result(rows, cols, Uninitialized());
+    generator.fillUniform(result.view(), min, max); // rows are split across threads by the generator
+    return result;
+}
+
+// General matrix multiply: C = alpha * A * B + beta * C, accumulating into C without allocating
+template <typename T>
+void gemm(T alpha, MatrixViewOf<const T> A, MatrixViewOf<const T> B, T beta, MatrixViewOf<T> C)
+{
+    KALO_ALGEBRA_INSTRUMENT("gemm", std::max({A.getRows(), A.getCols(), B.getCols()}), 2.0 * A.getRows() * A.getCols() * B.getCols(), (1.0 * A.getRows() * A.getCols() + 1.0 * B.getRows() * B.getCols() + 2.0 * C.getRows() * C.getCols()) * sizeof(T));
+    if (A.getCols() != B.getRows())
     {
-        for (int j = 0; j < cols; j++)
+        throw std::invalid_argument("Columns of first matrix must match rows of second matrix in order to perform multiplication!");
+    }
+    if (C.getRows() != A.getRows() || C.getCols() != B.getCols())
+    {
+        throw std::invalid_argument("Output matrix dimensions must match the product dimensions!");
+    }
+    if (mayOverlap<T>(C, A) || mayOverlap<T>(C, B))
+    {
+        throw std::invalid_argument("Output matrix must not be one of the operands!");
+    }
+    if (beta == T(0) && B.data() == A.data() && B.getRowStride() == A.getColStride() && B.getColStride() == A.getRowStride() &&
+        (C.getColStride() == 1 || C.getRowStride() == 1))
+    {
+        // B is A.t(), so C = alpha * A * A^T is symmetric: the rank-k kernel computes only half of it,
+        // and a symmetric result is its own transpose whichever way C is laid out
+        KaloAlgebraKernels::syrk(A.getRows(), A.getCols(), alpha, A.data(), A.getRowStride(), A.getColStride(),
+                                 beta, C.data(), C.getColStride() == 1 ? C.getRowStride() : C.getColStride());
+    }
+    else if (C.getColStride() == 1)
+    {
+        KaloAlgebraKernels::gemm(A.getRows(), B.getCols(), A.getCols(), alpha,
+                                 A.data(), A.getRowStride(), A.getColStride(),
+                                 B.data(), B.getRowStride(), B.getColStride(),
+                                 beta, C.data(), C.getRowStride());
+    }
+    else if (C.getRowStride() == 1)
+    {
+        // A column-major output: compute its transpose, C^T = B^T * A^T, which is row-major
+        KaloAlgebraKernels::gemm(B.getCols(), A.getRows(), A.getCols(), alpha,
+                                 B.data(), B.getColStride(), B.getRowStride(),
+                                 A.data(), A.getColStride(), A.getRowStride(),
+                                 beta, C.data(), C.getColStride());
+    }
+    else
+    {
+        throw std::invalid_argument("Output view must have unit stride along its rows or columns!");
+    }
+}
+
+// Symmetric rank-k update: C = alpha * A * A^T + beta * C, computing only the lower triangle
+template <typename T>
+void syrk(T alpha, MatrixViewOf<const T> A, T beta, MatrixViewOf<T> C)
+{
+    KALO_ALGEBRA_INSTRUMENT("syrk", std::max(A.getRows(), A.getCols()), 1.0 * A.getRows() * A.getRows() * A.getCols(), (1.0 * A.getRows() * A.getCols() + 2.0 * C.getRows() * C.getCols()) * sizeof(T));
+    if (C.getRows() != A.getRows() || C.getCols() != A.getRows())
+    {
+        throw std::invalid_argument("Output matrix dimensions must match the product dimensions!");
+    }
+    if (mayOverlap<T>(C, A))
+    {
+        throw std::invalid_argument("Output matrix must not be one of the operands!");
+    }
+    if (C.getColStride() != 1 && C.getRowStride() != 1)
+    {
+        throw std::invalid_argument("Output view must have unit stride along its rows or columns!");
+    }
+    // C is symmetric on input and output, so a column-major C is handled as its own transpose
+    KaloAlgebraKernels::syrk(A.getRows(), A.getCols(), alpha, A.data(), A.getRowStride(), A.getColStride(),
+                             beta, C.data(), C.getColStride() == 1 ? C.getRowStride() : C.getColStride());
+}
+
+// Output-parameter operations
+template <typename T>
+void add(const BasicMatrix<T> &A, const BasicMatrix<T> &B, BasicMatrix<T> &out)
+{
+    KALO_ALGEBRA_INSTRUMENT("Matrix::add", std::max(A.getRows(), A.getCols()), 1.0 * A.getRows() * A.getCols(), 3.0 * A.getRows() * A.getCols() * sizeof(T));
+    out = A + B;
+}
+
+template <typename T>
+void subtract(const BasicMatrix<T> &A, const BasicMatrix<T> &B, BasicMatrix<T> &out)
+{
+    KALO_ALGEBRA_INSTRUMENT("Matrix::subtract", std::max(A.getRows(), A.getCols()), 1.0 * A.getRows() * A.getCols(), 3.0 * A.getRows() * A.getCols() * sizeof(T));
+    out = A - B;
+}
+
+template <typename T>
+void multiply(MatrixViewOf<const T> A, MatrixViewOf<const T> B, BasicMatrix<T> &out)
+{
+    if (mayOverlap<T>(out, A) || mayOverlap<T>(out, B))
+    {
+        // The product reads operands while writing the output, so an aliased output needs a temporary
+        out = KaloAlgebraExpressions::matrixProduct<T>(A, B);
+        return;
+    }
+    if (A.getCols() != B.getRows())
+    {
+        throw std::invalid_argument("Columns of first matrix must match rows of second matrix in order to perform multiplication!");
+    }
+    if (out.getRows() != A.getRows() || out.getCols() != B.getCols())
+    {
+        out = BasicMatrix<T>(A.getRows(), B.getCols());
+    }
+    gemm(T(1), A, B, T(0), out);
+}
+
+template <typename T>
+void axpy(T alpha, MatrixViewOf<const T> X, MatrixViewOf<T> Y)
+{
+    KALO_ALGEBRA_INSTRUMENT("Matrix::axpy", std::max(X.getRows(), X.getCols()), 2.0 * X.getRows() * X.getCols(), 3.0 * X.getRows() * X.getCols() * sizeof(T));
+    if (X.getRows() != Y.getRows() || X.getCols() != Y.getCols())
+    {
+        throw std::invalid_argument("Matrix dimensions must match in order to perform axpy!");
+    }
+    const int cols = Y.getCols();
+    KaloAlgebraParallel::parallelFor(0, Y.getRows(), 2LL * cols, [&](long long first, long long last)
+                                     {
+        for (int i = static_cast<int>(first); i < last; i++)
         {
-            result.data[i][j] = dist(gen); // generate random number
-        }
+            if (X.getColStride() == 1 && Y.getColStride() == 1)
+            {
+                KaloAlgebraSimd::axpy(alpha, X.elementPtr(i, 0), Y.elementPtr(i, 0), static_cast<std::size_t>(cols));
+                continue;
+            }
+            for (int j = 0; j < cols; j++)
+                *Y.elementPtr(i, j) += alpha * *X.elementPtr(i, j);
+        } });
+}
+
+template <typename T>
+void scal(T alpha, MatrixViewOf<T> X)
+{
+    KALO_ALGEBRA_INSTRUMENT("Matrix::scal", std::max(X.getRows(), X.getCols()), 1.0 * X.getRows() * X.getCols(), 2.0 * X.getRows() * X.getCols() * sizeof(T));
+    const int cols = X.getCols();
+    KaloAlgebraParallel::parallelFor(0, X.getRows(), cols, [&](long long first, long long last)
+                                     {
+        for (int i = static_cast<int>(first); i < last; i++)
+        {
+            if (X.getColStride() == 1)
+            {
+                T *row = X.elementPtr(i, 0);
+                KaloAlgebraSimd::scale(row, alpha, row, static_cast<std::size_t>(cols));
+                continue;
+            }
+            for (int j = 0; j < cols; j++)
+                *X.elementPtr(i, j) *= alpha;
+        } });
+}
+
+// Matrix-vector operations
+template <typename T>
+void gemv(T alpha, MatrixViewOf<const T> A, VectorViewOf<const T> x, T beta, VectorViewOf<T> y)
+{
+    KALO_ALGEBRA_INSTRUMENT("gemv", std::max(A.getRows(), A.getCols()), 2.0 * A.getRows() * A.getCols(), (1.0 * A.getRows() * A.getCols() + x.getSize() + 2.0 * y.getSize()) * sizeof(T));
+    if (A.getCols() != x.getSize() || A.getRows() != y.getSize())
+    {
+        throw std::invalid_argument("Matrix columns must match vector size in order to perform multiplication!");
+    }
+    if (mayOverlap<T>(asRow<T>(y), A) || mayOverlap<T>(asRow<T>(y), asRow<T>(x)))
+    {
+        throw std::invalid_argument("Output vector must not be one of the operands!");
+    }
+    KaloAlgebraKernels::gemv(A.getRows(), A.getCols(), alpha,
+                             A.data(), A.getRowStride(), A.getColStride(),
+                             x.data(), x.getIncrement(),
+                             beta, y.data(), y.getIncrement());
+}
+
+template <typename T>
+void ger(T alpha, VectorViewOf<const T> x, VectorViewOf<const T> y, MatrixViewOf<T> A)
+{
+    KALO_ALGEBRA_INSTRUMENT("ger", std::max(A.getRows(), A.getCols()), 2.0 * A.getRows() * A.getCols(), (2.0 * A.getRows() * A.getCols() + x.getSize() + y.getSize()) * sizeof(T));
+    if (A.getRows() != x.getSize() || A.getCols() != y.getSize())
+    {
+        throw std::invalid_argument("Vector sizes must match the matrix dimensions in order to perform a rank-1 update!");
     }
+    if (mayOverlap<T>(A, asRow<T>(x)) || mayOverlap<T>(A, asRow<T>(y)))
+    {
+        throw std::invalid_argument("Updated matrix must not overlap the vectors!");
+    }
+    if (A.getColStride() == 1)
+    {
+        KaloAlgebraKernels::ger(A.getRows(), A.getCols(), alpha, x.data(), x.getIncrement(), y.data(), y.getIncrement(), A.data(), A.getRowStride());
+    }
+    else if (A.getRowStride() == 1)
+    {
+        // A column-major matrix: update its transpose, A^T += alpha * y * x^T
+        KaloAlgebraKernels::ger(A.getCols(), A.getRows(), alpha, y.data(), y.getIncrement(), x.data(), x.getIncrement(), A.data(), A.getColStride());
+    }
+    else
+    {
+        throw std::invalid_argument("Updated view must have unit stride along its rows or columns!");
+    }
+}
+
+template <typename T>
+void multiply(MatrixViewOf<const T> A, VectorViewOf<const T> x, BasicVector<T> &out)
+{
+    if (mayOverlap<T>(asRow<T>(out), A) || mayOverlap<T>(asRow<T>(out), asRow<T>(x)))
+    {
+        // An aliased output needs a temporary
+        out = KaloAlgebraExpressions::matrixVectorProduct<T>(A, x);
+        return;
+    }
+    if (A.getCols() != x.getSize())
+    {
+        throw std::invalid_argument("Matrix columns must match vector size in order to perform multiplication!");
+    }
+    if (out.getSize() != A.getRows())
+    {
+        out = BasicVector<T>(A.getRows());
+    }
+    gemv(T(1), A, x, T(0), out);
+}
+
+template <typename T>
+BasicVector<T> KaloAlgebraExpressions::matrixVectorProduct(BasicMatrixView<const T> matrix, BasicVectorView<const T> vector)
+{
+    KALO_ALGEBRA_INSTRUMENT("Matrix::operator*(Vector)", std::max(matrix.getRows(), matrix.getCols()), 2.0 * matrix.getRows() * matrix.getCols(), (1.0 * matrix.getRows() * matrix.getCols() + matrix.getRows() + matrix.getCols()) * sizeof(T));
+    if (matrix.getCols() != vector.getSize())
+    {
+        throw std::invalid_argument("Matrix columns must match vector size in order to perform multiplication!");
+    }
+    BasicVector<T> result(matrix.getRows());
+    gemv(T(1), matrix, vector, T(0), result);
     return result;
-}
\ No newline at end of file
+}
+
+template <typename T>
+BasicVector<T> KaloAlgebraExpressions::vectorMatrixProduct(BasicVectorView<const T> vector, BasicMatrixView<const T> matrix)
+{
+    KALO_ALGEBRA_INSTRUMENT("Vector::operator*(Matrix)", std::max(matrix.getRows(), matrix.getCols()), 2.0 * matrix.getRows() * matrix.getCols(), (1.0 * matrix.getRows() * matrix.getCols() + matrix.getRows() + matrix.getCols()) * sizeof(T));
+    if (matrix.getRows() != vector.getSize())
+    {
+        throw std::invalid_argument("Vector size must match matrix rows in order to perform multiplication!");
+    }
+    // x^T * A is A^T * x: the same matrix with its strides swapped
+    BasicMatrixView<const T> transposed(matrix.data(), matrix.getCols(), matrix.getRows(), matrix.getColStride(), matrix.getRowStride());
+    BasicVector<T> result(matrix.getCols());
+    gemv(T(1), transposed, vector, T(0), result);
+    return result;
+}
+
+// Explicit instantiations for the supported scalar types
+#define KALO_ALGEBRA_INSTANTIATE_MATRIX(T)                                                                                    \
+    template class BasicMatrix<T>;                                                                                            \
+    template void gemm<T>(T, MatrixViewOf<const T>, MatrixViewOf<const T>, T, MatrixViewOf<T>);                               \
+    template void syrk<T>(T, MatrixViewOf<const T>, T, MatrixViewOf<T>);                                                      \
+    template void add<T>(const BasicMatrix<T> &, const BasicMatrix<T> &, BasicMatrix<T> &);                                   \
+    template void subtract<T>(const BasicMatrix<T> &, const BasicMatrix<T> &, BasicMatrix<T> &);                              \
+    template void multiply<T>(MatrixViewOf<const T>, MatrixViewOf<const T>, BasicMatrix<T> &);                                \
+    template void axpy<T>(T, MatrixViewOf<const T>, MatrixViewOf<T>);                                                         \
+    template void scal<T>(T, MatrixViewOf<T>);                                                                                \
+    template void gemv<T>(T, MatrixViewOf<const T>, VectorViewOf<const T>, T, VectorViewOf<T>);                               \
+    template void ger<T>(T, VectorViewOf<const T>, VectorViewOf<const T>, MatrixViewOf<T>);                                   \
+    template void multiply<T>(MatrixViewOf<const T>, VectorViewOf<const T>, BasicVector<T> &);                                \
+    template BasicMatrix<T> KaloAlgebraExpressions::matrixProduct<T>(BasicMatrixView<const T>, BasicMatrixView<const T>);     \
+    template BasicVector<T> KaloAlgebraExpressions::matrixVectorProduct<T>(BasicMatrixView<const T>, BasicVectorView<const T>); \
+    template BasicVector<T> KaloAlgebraExpressions::vectorMatrixProduct<T>(BasicVectorView<const T>, BasicMatrixView<const T>);
+
+KALO_ALGEBRA_INSTANTIATE_MATRIX(float)
+KALO_ALGEBRA_INSTANTIATE_MATRIX(double)
+KALO_ALGEBRA_INSTANTIATE_MATRIX(std::complex<float>)
+KALO_ALGEBRA_INSTANTIATE_MATRIX(std::complex<double>)
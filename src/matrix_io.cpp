@@ -0,0 +1,307 @@
+#include "matrix_io.hpp"
+#include "instrumentation.hpp"
+#include <algorithm> // For std::reverse
+#include <climits>   // For INT_MAX
+#include <cstring>   // For std::memcmp, std::memcpy
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>    // For open
+#include <sys/mman.h> // For mmap, munmap
+#include <sys/stat.h> // For fstat
+#include <unistd.h>   // For close
+#endif
+
+using namespace KaloAlgebraIO;
+
+namespace
+{
+    template <typename U>
+    U swapBytes(U value)
+    {
+        unsigned char bytes[sizeof(U)];
+        std::memcpy(bytes, &value, sizeof(U));
+        std::reverse(bytes, bytes + sizeof(U));
+        std::memcpy(&value, bytes, sizeof(U));
+        return value;
+    }
+
+    // Reverses the bytes of every real component; complex elements are two of them
+    template <typename T>
+    void swapElementBytes(T *data, std::size_t count)
+    {
+        using Real = KaloAlgebraUtils::RealType<T>;
+        unsigned char *bytes = reinterpret_cast<unsigned char *>(data);
+        for (std::size_t i = 0; i < count * sizeof(T) / sizeof(Real); i++)
+            std::reverse(bytes + i * sizeof(Real), bytes + (i + 1) * sizeof(Real));
+    }
+
+    // Rows padded like Matrix storage, so a file maps and loads with the same layout
+    template <typename T>
+    std::uint64_t fileStride(int cols)
+    {
+        const int elementsPerLine = static_cast<int>(fileAlignment / sizeof(T));
+        if (cols < elementsPerLine)
+            return static_cast<std::uint64_t>(cols);
+        return static_cast<std::uint64_t>((cols + elementsPerLine - 1) / elementsPerLine) * elementsPerLine;
+    }
+
+    struct Layout
+    {
+        int rows, cols, stride;
+        std::uint64_t dataOffset;
+        bool swapped; // written in the other byte order
+    };
+
+    // Validates the header of a fileSize-byte file holding T elements
+    template <typename T>
+    Layout readHeader(const unsigned char *bytes, std::uint64_t fileSize)
+    {
+        FileHeader header;
+        if (fileSize < sizeof(FileHeader))
+            throw std::invalid_argument("Not a Kalo Algebra matrix file!");
+        std::memcpy(&header, bytes, sizeof(FileHeader));
+        if (std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0)
+            throw std::invalid_argument("Not a Kalo Algebra matrix file!");
+
+        const bool swapped = header.byteOrder == swapBytes(byteOrderMark);
+        if (!swapped && header.byteOrder != byteOrderMark)
+            throw std::invalid_argument("Matrix file has an invalid byte-order mark!");
+        if (swapped)
+        {
+            header.version = swapBytes(header.version);
+            header.scalar = swapBytes(header.scalar);
+            header.alignment = swapBytes(header.alignment);
+            header.rows = swapBytes(header.rows);
+            header.cols = swapBytes(header.cols);
+            header.rowStride = swapBytes(header.rowStride);
+            header.dataOffset = swapBytes(header.dataOffset);
+        }
+
+        if (header.version != fileVersion)
+            throw std::invalid_argument("Unsupported matrix file version!");
+        if (header.scalar != static_cast<std::uint32_t>(scalarCodeOf<T>()))
+            throw std::invalid_argument("Matrix file holds a different scalar type!");
+        if (header.rows > INT_MAX || header.cols > INT_MAX || header.rowStride > INT_MAX || header.rowStride < header.cols)
+            throw std::invalid_argument("Matrix file has invalid dimensions!");
+        if (header.dataOffset < sizeof(FileHeader) || header.dataOffset % alignof(T) != 0 || header.dataOffset > fileSize)
+            throw std::invalid_argument("Matrix file has an invalid data offset!");
+        if (header.rows * header.rowStride > (fileSize - header.dataOffset) / sizeof(T))
+            throw std::invalid_argument("Matrix file is truncated!");
+
+        return Layout{static_cast<int>(header.rows), static_cast<int>(header.cols), static_cast<int>(header.rowStride),
+                      header.dataOffset, swapped};
+    }
+}
+
+template <typename T>
+FileHeader KaloAlgebraIO::makeHeader(int rows, int cols)
+{
+    FileHeader header{};
+    std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    header.version = fileVersion;
+    header.byteOrder = byteOrderMark;
+    header.scalar = static_cast<std::uint32_t>(scalarCodeOf<T>());
+    header.alignment = fileAlignment;
+    header.rows = static_cast<std::uint64_t>(rows);
+    header.cols = static_cast<std::uint64_t>(cols);
+    header.rowStride = fileStride<T>(cols);
+    header.dataOffset = sizeof(FileHeader); // the header is one alignment unit long
+    return header;
+}
+
+// File mapping
+FileMapping::FileMapping(const std::string &path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Cannot open matrix file " + path + "!");
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        throw std::runtime_error("Cannot read the size of matrix file " + path + "!");
+    }
+    length = static_cast<std::size_t>(size.QuadPart);
+    if (length > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping)
+            CloseHandle(mapping); // the view keeps the mapping alive
+        if (!view)
+        {
+            CloseHandle(file);
+            throw std::runtime_error("Cannot map matrix file " + path + "!");
+        }
+        address = static_cast<const unsigned char *>(view);
+    }
+    CloseHandle(file);
+#else
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        throw std::runtime_error("Cannot open matrix file " + path + "!");
+    struct stat info;
+    if (::fstat(file, &info) != 0)
+    {
+        ::close(file);
+        throw std::runtime_error("Cannot read the size of matrix file " + path + "!");
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length > 0)
+    {
+        void *view = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+        if (view == MAP_FAILED)
+        {
+            ::close(file);
+            throw std::runtime_error("Cannot map matrix file " + path + "!");
+        }
+        address = static_cast<const unsigned char *>(view);
+    }
+    ::close(file); // the mapping keeps the file alive
+#endif
+}
+
+FileMapping::~FileMapping()
+{
+    release();
+}
+
+FileMapping::FileMapping(FileMapping &&other) noexcept : address(other.address), length(other.length)
+{
+    other.address = nullptr;
+    other.length = 0;
+}
+
+FileMapping &FileMapping::operator=(FileMapping &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        address = other.address;
+        length = other.length;
+        other.address = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+void FileMapping::release() noexcept
+{
+    if (!address)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(address);
+#else
+    ::munmap(const_cast<unsigned char *>(address), length);
+#endif
+    address = nullptr;
+    length = 0;
+}
+
+// Mapped matrix
+template <typename T>
+BasicMappedMatrix<T>::BasicMappedMatrix(const std::string &path) : mapping(path)
+{
+    const Layout layout = readHeader<T>(mapping.data(), mapping.size());
+    if (layout.swapped)
+        throw std::invalid_argument("Matrix file was written in the other byte order; use load() to convert it!");
+    elements = reinterpret_cast<const T *>(mapping.data() + layout.dataOffset);
+    rows = layout.rows;
+    cols = layout.cols;
+    stride = layout.stride;
+}
+
+// Saving and loading
+template <typename T>
+void save(const std::string &path, BasicMatrixView<const T> matrix)
+{
+    const int rows = matrix.getRows(), cols = matrix.getCols();
+    const FileHeader header = makeHeader<T>(rows, cols);
+    const std::uint64_t stride = header.rowStride;
+    KALO_ALGEBRA_INSTRUMENT("save", std::max(rows, cols), 0.0, 1.0 * rows * stride * sizeof(T));
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Cannot open matrix file " + path + " for writing!");
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    // Rows with unit column stride are written straight from the matrix; others are gathered first
+    std::vector<T> row(static_cast<std::size_t>(stride), T(0));
+    for (int i = 0; i < rows && out; i++)
+    {
+        if (matrix.getColStride() == 1)
+        {
+            out.write(reinterpret_cast<const char *>(matrix.elementPtr(i, 0)), static_cast<std::streamsize>(cols * sizeof(T)));
+            out.write(reinterpret_cast<const char *>(row.data() + cols), static_cast<std::streamsize>((stride - cols) * sizeof(T)));
+            continue;
+        }
+        for (int j = 0; j < cols; j++)
+            row[j] = *matrix.elementPtr(i, j);
+        out.write(reinterpret_cast<const char *>(row.data()), static_cast<std::streamsize>(stride * sizeof(T)));
+    }
+    out.flush();
+    if (!out)
+        throw std::runtime_error("Failed to write matrix file " + path + "!");
+}
+
+template <typename T>
+BasicMatrix<T> load(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+        throw std::runtime_error("Cannot open matrix file " + path + "!");
+    const std::uint64_t fileSize = static_cast<std::uint64_t>(in.tellg());
+    unsigned char bytes[sizeof(FileHeader)] = {};
+    in.seekg(0);
+    in.read(reinterpret_cast<char *>(bytes), static_cast<std::streamsize>(std::min<std::uint64_t>(fileSize, sizeof(bytes))));
+    const Layout layout = readHeader<T>(bytes, fileSize);
+    KALO_ALGEBRA_INSTRUMENT("load", std::max(layout.rows, layout.cols), 0.0, 1.0 * layout.rows * layout.stride * sizeof(T));
+
+    BasicMatrix<T> result(layout.rows, layout.cols);
+    in.seekg(static_cast<std::streamoff>(layout.dataOffset));
+    if (result.getStride() == layout.stride)
+    {
+        // Same layout as the storage: one read straight into it
+        in.read(reinterpret_cast<char *>(result.data()), static_cast<std::streamsize>(static_cast<std::uint64_t>(layout.rows) * layout.stride * sizeof(T)));
+    }
+    else
+    {
+        for (int i = 0; i < layout.rows && in; i++)
+        {
+            in.seekg(static_cast<std::streamoff>(layout.dataOffset + static_cast<std::uint64_t>(i) * layout.stride * sizeof(T)));
+            in.read(reinterpret_cast<char *>(result.rowPtr(i)), static_cast<std::streamsize>(layout.cols * sizeof(T)));
+        }
+    }
+    if (!in)
+        throw std::runtime_error("Failed to read matrix file " + path + "!");
+    if (layout.swapped)
+    {
+        for (int i = 0; i < layout.rows; i++)
+            swapElementBytes(result.rowPtr(i), static_cast<std::size_t>(layout.cols));
+    }
+    return result;
+}
+
+// Explicit instantiations for the supported scalar types
+#define KALO_ALGEBRA_INSTANTIATE_MATRIX_IO(T)                                 \
+    template class BasicMappedMatrix<T>;                                      \
+    template FileHeader KaloAlgebraIO::makeHeader<T>(int, int);               \
+    template void save<T>(const std::string &, BasicMatrixView<const T>);     \
+    template BasicMatrix<T> load<T>(const std::string &);
+
+KALO_ALGEBRA_INSTANTIATE_MATRIX_IO(float)
+KALO_ALGEBRA_INSTANTIATE_MATRIX_IO(double)
+KALO_ALGEBRA_INSTANTIATE_MATRIX_IO(std::complex<float>)
+KALO_ALGEBRA_INSTANTIATE_MATRIX_IO(std::complex<double>)
@@ -0,0 +1,154 @@
+#include "out_of_core.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>  // For std::min, std::copy
+#include <cmath>      // For std::sqrt
+#include <filesystem> // For std::filesystem::resize_file
+#include <fstream>
+#include <future> // For std::async
+#include <stdexcept>
+
+namespace
+{
+    constexpr int tileMultiple = 16; // keeps every tile row a whole number of cache lines
+
+    // Copies a view into the top-left corner of a tile buffer
+    template <typename T>
+    void copyIn(BasicMatrixView<const T> source, BasicMatrix<T> &tile)
+    {
+        for (int i = 0; i < source.getRows(); i++)
+        {
+            T *target = tile.rowPtr(i);
+            if (source.getColStride() == 1)
+            {
+                const T *row = source.elementPtr(i, 0);
+                std::copy(row, row + source.getCols(), target);
+                continue;
+            }
+            for (int j = 0; j < source.getCols(); j++)
+                target[j] = *source.elementPtr(i, j);
+        }
+    }
+}
+
+template <typename T>
+int outOfCoreTileSize(std::size_t memoryBudget)
+{
+    // Two A tiles, two B tiles and two C tiles
+    const double fit = std::sqrt(static_cast<double>(memoryBudget) / (6.0 * sizeof(T)));
+    const int tile = static_cast<int>(std::min(fit, 1e9)) / tileMultiple * tileMultiple;
+    return tile;
+}
+
+template <typename T>
+void multiplyOutOfCore(BasicMatrixView<const T> A, BasicMatrixView<const T> B, const std::string &outputPath, std::size_t memoryBudget)
+{
+    if (A.getCols() != B.getRows())
+    {
+        throw std::invalid_argument("Columns of first matrix must match rows of second matrix in order to perform multiplication!");
+    }
+    const int tile = outOfCoreTileSize<T>(memoryBudget);
+    if (tile == 0)
+    {
+        throw std::invalid_argument("Memory budget is too small for out-of-core multiplication!");
+    }
+    const int m = A.getRows(), n = B.getCols(), k = A.getCols();
+    KALO_ALGEBRA_INSTRUMENT("multiplyOutOfCore", std::max({m, n, k}), 2.0 * m * n * k,
+                            (2.0 * m * n * k / tile + 1.0 * m * n) * sizeof(T));
+
+    // The output starts as a header and zeros, so an empty inner dimension leaves C = 0
+    const KaloAlgebraIO::FileHeader header = KaloAlgebraIO::makeHeader<T>(m, n);
+    {
+        std::ofstream create(outputPath, std::ios::binary | std::ios::trunc);
+        create.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if (!create)
+            throw std::runtime_error("Cannot open matrix file " + outputPath + " for writing!");
+    }
+    std::filesystem::resize_file(outputPath, header.dataOffset + header.rows * header.rowStride * sizeof(T));
+    const long long rowTiles = (m + tile - 1) / tile, colTiles = (n + tile - 1) / tile, depthTiles = (k + tile - 1) / tile;
+    const long long steps = rowTiles * colTiles * depthTiles;
+    if (steps == 0)
+        return;
+
+    std::fstream out(outputPath, std::ios::in | std::ios::out | std::ios::binary);
+    if (!out)
+        throw std::runtime_error("Cannot open matrix file " + outputPath + " for writing!");
+
+    const int tm = std::min(tile, m), tn = std::min(tile, n), tk = std::min(tile, k);
+    BasicMatrix<T> aTiles[2] = {BasicMatrix<T>(tm, tk), BasicMatrix<T>(tm, tk)};
+    BasicMatrix<T> bTiles[2] = {BasicMatrix<T>(tk, tn), BasicMatrix<T>(tk, tn)};
+    BasicMatrix<T> cTiles[2] = {BasicMatrix<T>(tm, tn), BasicMatrix<T>(tm, tn)};
+
+    // Step s multiplies tile (i, p) of A by tile (p, j) of B into tile (i, j) of C, with p fastest
+    struct Step
+    {
+        int row, col, depth;          // first element of the C tile, and of the shared dimension
+        int rows, cols, depthLength;  // tile extents, smaller at the edges
+        bool first, last;             // first and last step of its C tile
+    };
+    const auto stepAt = [&](long long s)
+    {
+        const int p = static_cast<int>(s % depthTiles);
+        const int j = static_cast<int>(s / depthTiles % colTiles);
+        const int i = static_cast<int>(s / depthTiles / colTiles);
+        Step step{i * tile, j * tile, p * tile, 0, 0, 0, p == 0, p == depthTiles - 1};
+        step.rows = std::min(tile, m - step.row);
+        step.cols = std::min(tile, n - step.col);
+        step.depthLength = std::min(tile, k - step.depth);
+        return step;
+    };
+    const auto load = [&](long long s)
+    {
+        const Step step = stepAt(s);
+        copyIn<T>(A.block(step.row, step.depth, step.rows, step.depthLength), aTiles[s & 1]);
+        copyIn<T>(B.block(step.depth, step.col, step.depthLength, step.cols), bTiles[s & 1]);
+    };
+    const auto store = [&](const Step &step, const BasicMatrix<T> &c)
+    {
+        for (int i = 0; i < step.rows && out; i++)
+        {
+            const std::uint64_t element = static_cast<std::uint64_t>(step.row + i) * header.rowStride + step.col;
+            out.seekp(static_cast<std::streamoff>(header.dataOffset + element * sizeof(T)));
+            out.write(reinterpret_cast<const char *>(c.rowPtr(i)), static_cast<std::streamsize>(step.cols * sizeof(T)));
+        }
+        if (!out)
+            throw std::runtime_error("Failed to write matrix file " + outputPath + "!");
+    };
+
+    // The next step's tiles load, and the previous C tile is written, while this step computes
+    std::future<void> loading = std::async(std::launch::async, load, 0LL);
+    std::future<void> writing;
+    int cSlot = 0;
+    for (long long s = 0; s < steps; s++)
+    {
+        loading.get();
+        if (s + 1 < steps)
+            loading = std::async(std::launch::async, load, s + 1);
+
+        const Step step = stepAt(s);
+        BasicMatrixView<T> c = cTiles[cSlot].view().block(0, 0, step.rows, step.cols);
+        gemm(T(1), aTiles[s & 1].view().block(0, 0, step.rows, step.depthLength),
+             bTiles[s & 1].view().block(0, 0, step.depthLength, step.cols), step.first ? T(0) : T(1), c);
+        if (step.last)
+        {
+            if (writing.valid())
+                writing.get(); // it wrote the other C tile, which the next tile reuses
+            writing = std::async(std::launch::async, store, step, std::cref(cTiles[cSlot]));
+            cSlot ^= 1;
+        }
+    }
+    writing.get();
+    out.close();
+    if (out.fail())
+        throw std::runtime_error("Failed to write matrix file " + outputPath + "!");
+}
+
+// Explicit instantiations for the supported scalar types
+#define KALO_ALGEBRA_INSTANTIATE_OUT_OF_CORE(T)                                                                  \
+    template int outOfCoreTileSize<T>(std::size_t);                                                              \
+    template void multiplyOutOfCore<T>(BasicMatrixView<const T>, BasicMatrixView<const T>, const std::string &, \
+                                       std::size_t);
+
+KALO_ALGEBRA_INSTANTIATE_OUT_OF_CORE(float)
+KALO_ALGEBRA_INSTANTIATE_OUT_OF_CORE(double)
+KALO_ALGEBRA_INSTANTIATE_OUT_OF_CORE(std::complex<float>)
+KALO_ALGEBRA_INSTANTIATE_OUT_OF_CORE(std::complex<double>)
@@ -0,0 +1,516 @@
+#include "qr.hpp"
+#include "gemm.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    constexpr int blockSize = 64;         // reflectors per block; the GEMMs applying a block have this depth
+    constexpr int narrowPanel = 8;        // panels this narrow are factored one reflector at a time
+    constexpr int minimumLeafRows = 4096; // TSQR blocks have at least this many rows ...
+    constexpr int leafRowsPerColumn = 8;  // ... and at least this many rows per column
+
+    // Householder reflector for x[0], x[incx], ..., x[(length - 1) * incx] (LAPACK's dlarfg):
+    // returns tau, writes beta over x[0] and the vector v (with v[0] = 1 implied) over the rest
+    double householder(int length, double *x, int incx)
+    {
+        double sigma = 0.0;
+        for (int i = 1; i < length; i++)
+        {
+            const double value = x[static_cast<long long>(i) * incx];
+            sigma += value * value;
+        }
+        if (sigma == 0.0)
+            return 0.0;
+        const double alpha = x[0];
+        const double beta = -std::copysign(std::sqrt(alpha * alpha + sigma), alpha);
+        const double scale = 1.0 / (alpha - beta);
+        for (int i = 1; i < length; i++)
+            x[static_cast<long long>(i) * incx] *= scale;
+        x[0] = beta;
+        return (beta - alpha) / beta;
+    }
+
+    // Factors columns k .. k + jb - 1 of the m-row matrix a one reflector at a time, and builds the
+    // jb x jb upper-triangular T with H_k ... H_{k+jb-1} = I - V * T * V^T (LAPACK's dlarft)
+    void factorNarrowPanel(int m, int k, int jb, double *a, int lda, double *tau, double *T, int ldt, double *work)
+    {
+        for (int j = 0; j < jb; j++)
+        {
+            const int column = k + j;
+            double *x = a + static_cast<long long>(column) * lda + column;
+            const int length = m - column;
+            tau[j] = householder(length, x, lda);
+            if (j + 1 < jb && tau[j] != 0.0)
+            {
+                // Rest of the panel -= tau * v * (v^T * rest), with v[0] = 1 stored for the duration.
+                // The panel is only a few columns wide, so plain loops over its rows beat calls
+                // into the vector kernels
+                const int width = jb - j - 1;
+                const double beta = x[0];
+                x[0] = 1.0;
+                std::fill(work, work + width, 0.0);
+                for (int r = 0; r < length; r++)
+                {
+                    const double *row = x + static_cast<long long>(r) * lda;
+                    for (int c = 0; c < width; c++)
+                        work[c] += row[0] * row[c + 1];
+                }
+                for (int r = 0; r < length; r++)
+                {
+                    double *row = x + static_cast<long long>(r) * lda;
+                    const double scaled = tau[j] * row[0];
+                    for (int c = 0; c < width; c++)
+                        row[c + 1] -= scaled * work[c];
+                }
+                x[0] = beta;
+            }
+        }
+
+        for (int i = 0; i < jb; i++)
+        {
+            T[static_cast<long long>(i) * ldt + i] = tau[i];
+            if (i == 0)
+                continue;
+            // T(0 .. i, i) = -tau_i * T(0 .. i, 0 .. i) * V(:, 0 .. i)^T * v_i
+            const int column = k + i;
+            std::fill(work, work + i, 0.0);
+            for (int r = 0; r < m - column; r++)
+            {
+                const double *row = a + static_cast<long long>(column + r) * lda + k;
+                const double scale = r == 0 ? 1.0 : row[i];
+                for (int p = 0; p < i; p++)
+                    work[p] += row[p] * scale;
+            }
+            for (int r = 0; r < i; r++)
+            {
+                const double *row = T + static_cast<long long>(r) * ldt;
+                double sum = 0.0;
+                for (int p = r; p < i; p++)
+                    sum += row[p] * work[p];
+                T[static_cast<long long>(r) * ldt + i] = -tau[i] * sum;
+            }
+        }
+    }
+
+    // C = (I - V * T * V^T)^T * C, or (I - V * T * V^T) * C, for a rows x jb V that is unit lower
+    // trapezoidal (LAPACK's dlarfb). The jb x jb triangle at the top of V is applied directly and
+    // the rectangle below it with GEMM. W is jb x nc scratch.
+    void applyBlock(bool transpose, int rows, int jb, const double *V, int ldv, const double *T, int ldt,
+                    double *C, int ldc, int nc, double *W)
+    {
+        const std::size_t width = static_cast<std::size_t>(nc);
+        const int ldw = nc;
+        auto rowOf = [](auto *base, int ld, int i)
+        { return base + static_cast<long long>(i) * ld; };
+
+        // W = V^T * C
+        for (int p = 0; p < jb; p++)
+        {
+            std::copy(rowOf(C, ldc, p), rowOf(C, ldc, p) + nc, rowOf(W, ldw, p));
+            for (int i = p + 1; i < jb; i++)
+                KaloAlgebraSimd::axpy(rowOf(V, ldv, i)[p], rowOf(C, ldc, i), rowOf(W, ldw, p), width);
+        }
+        if (rows > jb)
+        {
+            KaloAlgebraKernels::gemm(jb, nc, rows - jb, 1.0, rowOf(V, ldv, jb), 1, ldv, rowOf(C, ldc, jb), ldc, 1, 1.0, W, ldw);
+        }
+
+        // W = T^T * W or T * W, in place, walking the rows so that each reads only rows not yet overwritten
+        if (transpose)
+        {
+            for (int p = jb - 1; p >= 0; p--)
+            {
+                double *target = rowOf(W, ldw, p);
+                KaloAlgebraSimd::scale(target, rowOf(T, ldt, p)[p], target, width);
+                for (int i = 0; i < p; i++)
+                    KaloAlgebraSimd::axpy(rowOf(T, ldt, i)[p], rowOf(W, ldw, i), target, width);
+            }
+        }
+        else
+        {
+            for (int p = 0; p < jb; p++)
+            {
+                double *target = rowOf(W, ldw, p);
+                const double *row = rowOf(T, ldt, p);
+                KaloAlgebraSimd::scale(target, row[p], target, width);
+                for (int i = p + 1; i < jb; i++)
+                    KaloAlgebraSimd::axpy(row[i], rowOf(W, ldw, i), target, width);
+            }
+        }
+
+        // C -= V * W
+        if (rows > jb)
+        {
+            KaloAlgebraKernels::gemm(rows - jb, nc, jb, -1.0, rowOf(V, ldv, jb), ldv, 1, W, ldw, 1, 1.0, rowOf(C, ldc, jb), ldc);
+        }
+        for (int i = 0; i < jb; i++)
+        {
+            double *target = rowOf(C, ldc, i);
+            KaloAlgebraSimd::axpy(-1.0, rowOf(W, ldw, i), target, width);
+            for (int p = 0; p < i; p++)
+                KaloAlgebraSimd::axpy(-rowOf(V, ldv, i)[p], rowOf(W, ldw, p), target, width);
+        }
+    }
+
+    // Recursive panel factorization (Elmroth and Gustavson): factor the left half, apply its block
+    // reflector to the right half, factor the right half, then join the two T factors with
+    // T12 = -T11 * (V1^T * V2) * T22. Most of the work of a tall panel then runs in GEMM
+    // instead of matrix-vector products.
+    void factorPanel(int m, int k, int jb, double *a, int lda, double *tau, double *T, int ldt, double *work)
+    {
+        if (jb <= narrowPanel)
+        {
+            factorNarrowPanel(m, k, jb, a, lda, tau, T, ldt, work);
+            return;
+        }
+        const int j1 = jb / 2;
+        const int j2 = jb - j1;
+        double *V1 = a + static_cast<long long>(k) * lda + k;
+        double *T22 = T + static_cast<long long>(j1) * ldt + j1;
+        std::vector<double> scratch(static_cast<std::size_t>(j1) * j2);
+
+        factorPanel(m, k, j1, a, lda, tau, T, ldt, work);
+        applyBlock(true, m - k, j1, V1, lda, T, ldt, V1 + j1, lda, j2, scratch.data());
+        factorPanel(m, k + j1, j2, a, lda, tau + j1, T22, ldt, work);
+
+        // Y = V1^T * V2: the unit lower triangle at the top of V2 directly, the rows below it with GEMM
+        double *Y = T + j1; // T12, j1 x j2
+        const double *V2 = V1 + static_cast<long long>(j1) * lda + j1;
+        if (m - k > jb)
+        {
+            KaloAlgebraKernels::gemm(j1, j2, m - k - jb, 1.0, V1 + static_cast<long long>(jb) * lda, 1, lda,
+                                     V2 + static_cast<long long>(j2) * lda, lda, 1, 0.0, Y, ldt);
+        }
+        else
+        {
+            for (int p = 0; p < j1; p++)
+                std::fill(Y + static_cast<long long>(p) * ldt, Y + static_cast<long long>(p) * ldt + j2, 0.0);
+        }
+        for (int r = 0; r < j2; r++)
+        {
+            const double *rowV1 = V1 + static_cast<long long>(j1 + r) * lda;
+            const double *rowV2 = V2 + static_cast<long long>(r) * lda;
+            for (int p = 0; p < j1; p++)
+            {
+                double *target = Y + static_cast<long long>(p) * ldt;
+                target[r] += rowV1[p];
+                for (int c = 0; c < r; c++)
+                    target[c] += rowV1[p] * rowV2[c];
+            }
+        }
+
+        // Y = Y * T22, then Y = -T11 * Y, both in place
+        for (int p = 0; p < j1; p++)
+        {
+            double *row = Y + static_cast<long long>(p) * ldt;
+            for (int c = j2 - 1; c >= 0; c--)
+            {
+                double sum = 0.0;
+                for (int i = 0; i <= c; i++)
+                    sum += row[i] * T22[static_cast<long long>(i) * ldt + c];
+                row[c] = sum;
+            }
+        }
+        for (int c = 0; c < j2; c++)
+        {
+            for (int p = 0; p < j1; p++)
+            {
+                double sum = 0.0;
+                for (int i = p; i < j1; i++)
+                    sum += T[static_cast<long long>(p) * ldt + i] * Y[static_cast<long long>(i) * ldt + c];
+                Y[static_cast<long long>(p) * ldt + c] = -sum;
+            }
+        }
+    }
+
+    // B = R^-1 * B for the n x n upper triangle of R and an n x rhs B
+    void solveUpper(int n, const double *R, int ldr, double *B, int ldb, int rhs)
+    {
+        for (int i = n - 1; i >= 0; i--)
+        {
+            double *target = B + static_cast<long long>(i) * ldb;
+            const double *row = R + static_cast<long long>(i) * ldr;
+            for (int p = i + 1; p < n; p++)
+                KaloAlgebraSimd::axpy(-row[p], B + static_cast<long long>(p) * ldb, target, static_cast<std::size_t>(rhs));
+            for (int j = 0; j < rhs; j++)
+                target[j] /= row[i];
+        }
+    }
+}
+
+// Blocked Householder QR (LAPACK's geqrf): factor a panel of columns, then apply its block
+// reflector to the rest of the matrix with two GEMMs
+void QRDecomposition::factor(Reflectors &reflectors)
+{
+    Matrix &a = reflectors.factors;
+    const int m = a.getRows();
+    const int n = a.getCols();
+    reflectors.tau.assign(n, 0.0);
+    // TSQR leaves arrive with blockT already sized on the calling thread (see the constructor)
+    if (reflectors.blockT.getRows() != std::min(blockSize, n) || reflectors.blockT.getCols() != n)
+        reflectors.blockT = Matrix(std::min(blockSize, n), n);
+    std::vector<double> work(blockSize);
+    Matrix W(blockSize, n);
+
+    for (int k = 0; k < n; k += blockSize)
+    {
+        const int jb = std::min(blockSize, n - k);
+        double *T = reflectors.blockT.data() + k;
+        const int ldt = reflectors.blockT.getStride();
+        factorPanel(m, k, jb, a.data(), a.getStride(), reflectors.tau.data() + k, T, ldt, work.data());
+        if (k + jb < n)
+        {
+            double *diagonal = a.rowPtr(k) + k;
+            applyBlock(true, m - k, jb, diagonal, a.getStride(), T, ldt, diagonal + jb, a.getStride(), n - k - jb, W.data());
+        }
+    }
+}
+
+// Q^T = H_n ... H_1 applies the blocks first to last, Q the other way round
+void QRDecomposition::apply(const Reflectors &reflectors, bool transpose, double *B, int ldb, int rhs)
+{
+    const Matrix &a = reflectors.factors;
+    const int m = a.getRows();
+    const int n = a.getCols();
+    if (n == 0 || rhs == 0)
+        return;
+    std::vector<double> W(static_cast<std::size_t>(blockSize) * rhs);
+    const int blocks = (n + blockSize - 1) / blockSize;
+    for (int b = 0; b < blocks; b++)
+    {
+        const int k = (transpose ? b : blocks - 1 - b) * blockSize;
+        const int jb = std::min(blockSize, n - k);
+        applyBlock(transpose, m - k, jb, a.rowPtr(k) + k, a.getStride(), reflectors.blockT.data() + k, reflectors.blockT.getStride(),
+                   B + static_cast<long long>(k) * ldb, ldb, rhs, W.data());
+    }
+}
+
+QRDecomposition::QRDecomposition(const Matrix &A) : rows(A.getRows()), cols(A.getCols()), leafRows(A.getRows())
+{
+    KALO_ALGEBRA_INSTRUMENT("QRDecomposition::factor", std::max(rows, cols), 2.0 * cols * cols * (rows - cols / 3.0), 2.0 * rows * cols * sizeof(double));
+    if (rows < cols)
+    {
+        throw std::invalid_argument("QR decomposition needs at least as many rows as columns!");
+    }
+    const int tallLeaf = std::max(minimumLeafRows, leafRowsPerColumn * cols);
+    if (rows < 2LL * tallLeaf)
+    {
+        leaves.resize(1);
+        leaves[0].factors = A;
+        factor(leaves[0]);
+        return;
+    }
+
+    // TSQR: independent QRs of the row blocks, then a QR of their stacked R factors
+    leafRows = tallLeaf;
+    const int leafCount = rows / leafRows;
+    leaves.resize(leafCount);
+    // The leaves' storage is allocated here, on the calling thread, and the workers only write into
+    // it. Inside an ArenaScope it comes from this thread's arena, which is not thread-safe: a worker
+    // assigning a new Matrix into a leaf would allocate from it too.
+    for (int l = 0; l < leafCount; l++)
+    {
+        const int count = l + 1 == leafCount ? rows - l * leafRows : leafRows;
+        leaves[l].factors = Matrix(count, cols);
+        leaves[l].blockT = Matrix(std::min(blockSize, cols), cols);
+    }
+    KaloAlgebraParallel::parallelFor(0, leafCount, static_cast<long long>(leafRows) * cols * cols, [&](long long first, long long last)
+                                     {
+        for (long long l = first; l < last; l++)
+        {
+            const int start = static_cast<int>(l) * leafRows;
+            const int count = leaves[l].factors.getRows();
+            Matrix &block = leaves[l].factors;
+            for (int i = 0; i < count; i++)
+                std::copy(A.rowPtr(start + i), A.rowPtr(start + i) + cols, block.rowPtr(i));
+            factor(leaves[l]);
+        } });
+
+    root.factors = Matrix(leafCount * cols, cols);
+    for (int l = 0; l < leafCount; l++)
+    {
+        for (int i = 0; i < cols; i++)
+        {
+            const double *source = leaves[l].factors.rowPtr(i);
+            std::copy(source + i, source + cols, root.factors.rowPtr(l * cols + i) + i);
+        }
+    }
+    factor(root);
+}
+
+int QRDecomposition::getRows() const
+{
+    return rows;
+}
+
+int QRDecomposition::getCols() const
+{
+    return cols;
+}
+
+const Matrix &QRDecomposition::rFactors() const
+{
+    return leaves.size() == 1 ? leaves[0].factors : root.factors;
+}
+
+bool QRDecomposition::isFullRank() const
+{
+    const Matrix &r = rFactors();
+    for (int i = 0; i < cols; i++)
+    {
+        if (r.rowPtr(i)[i] == 0.0)
+            return false;
+    }
+    return true;
+}
+
+Matrix QRDecomposition::getR() const
+{
+    const Matrix &r = rFactors();
+    Matrix R(cols, cols);
+    for (int i = 0; i < cols; i++)
+    {
+        std::copy(r.rowPtr(i) + i, r.rowPtr(i) + cols, R.rowPtr(i) + i);
+    }
+    return R;
+}
+
+Matrix QRDecomposition::getQ() const
+{
+    Matrix Q(rows, cols);
+    for (int i = 0; i < cols; i++)
+    {
+        Q.rowPtr(i)[i] = 1.0;
+    }
+    applyQ(Q);
+    return Q;
+}
+
+// With TSQR, Q is the block-diagonal matrix of the leaf Qs followed by the root Q acting on the
+// top cols rows of every leaf
+void QRDecomposition::applyInPlace(bool transpose, double *B, int ldb, int rhs) const
+{
+    KALO_ALGEBRA_INSTRUMENT(transpose ? "QRDecomposition::applyQT" : "QRDecomposition::applyQ", rows, 4.0 * rows * cols * rhs, (1.0 * rows * cols + 2.0 * rows * rhs) * sizeof(double));
+    if (leaves.size() == 1)
+    {
+        apply(leaves[0], transpose, B, ldb, rhs);
+        return;
+    }
+
+    const long long leafCount = static_cast<long long>(leaves.size());
+    auto applyLeaves = [&]
+    {
+        KaloAlgebraParallel::parallelFor(0, leafCount, static_cast<long long>(leafRows) * cols * rhs, [&](long long first, long long last)
+                                         {
+            for (long long l = first; l < last; l++)
+                apply(leaves[l], transpose, B + l * leafRows * ldb, ldb, rhs); });
+    };
+
+    if (transpose)
+        applyLeaves();
+    Matrix stacked(static_cast<int>(leafCount) * cols, rhs);
+    for (long long l = 0; l < leafCount; l++)
+    {
+        for (int i = 0; i < cols; i++)
+        {
+            const double *source = B + (l * leafRows + i) * ldb;
+            std::copy(source, source + rhs, stacked.rowPtr(static_cast<int>(l) * cols + i));
+        }
+    }
+    apply(root, transpose, stacked.data(), stacked.getStride(), rhs);
+    for (long long l = 0; l < leafCount; l++)
+    {
+        for (int i = 0; i < cols; i++)
+        {
+            const double *source = stacked.rowPtr(static_cast<int>(l) * cols + i);
+            std::copy(source, source + rhs, B + (l * leafRows + i) * ldb);
+        }
+    }
+    if (!transpose)
+        applyLeaves();
+}
+
+void QRDecomposition::applyQT(Vector &b) const
+{
+    if (b.getSize() != rows)
+    {
+        throw std::invalid_argument("Vector size must match the matrix rows!");
+    }
+    applyInPlace(true, b.data(), 1, 1);
+}
+
+void QRDecomposition::applyQT(Matrix &B) const
+{
+    if (B.getRows() != rows)
+    {
+        throw std::invalid_argument("Matrix rows must match the factored matrix rows!");
+    }
+    applyInPlace(true, B.data(), B.getStride(), B.getCols());
+}
+
+void QRDecomposition::applyQ(Vector &b) const
+{
+    if (b.getSize() != rows)
+    {
+        throw std::invalid_argument("Vector size must match the matrix rows!");
+    }
+    applyInPlace(false, b.data(), 1, 1);
+}
+
+void QRDecomposition::applyQ(Matrix &B) const
+{
+    if (B.getRows() != rows)
+    {
+        throw std::invalid_argument("Matrix rows must match the factored matrix rows!");
+    }
+    applyInPlace(false, B.data(), B.getStride(), B.getCols());
+}
+
+// x = R^-1 * (Q^T * b)(0 .. n); the remaining entries of Q^T * b are the residual
+Vector QRDecomposition::leastSquares(const Vector &b) const
+{
+    if (!isFullRank())
+    {
+        throw std::invalid_argument("Matrix is rank deficient!");
+    }
+    Vector projected = b;
+    applyQT(projected);
+    const Matrix &r = rFactors();
+    solveUpper(cols, r.data(), r.getStride(), projected.data(), 1, 1);
+    Vector x(cols);
+    std::copy(projected.data(), projected.data() + cols, x.data());
+    return x;
+}
+
+Matrix QRDecomposition::leastSquares(const Matrix &B) const
+{
+    if (!isFullRank())
+    {
+        throw std::invalid_argument("Matrix is rank deficient!");
+    }
+    Matrix projected = B;
+    applyQT(projected);
+    const Matrix &r = rFactors();
+    solveUpper(cols, r.data(), r.getStride(), projected.data(), projected.getStride(), projected.getCols());
+    Matrix X(cols, B.getCols());
+    for (int i = 0; i < cols; i++)
+    {
+        std::copy(projected.rowPtr(i), projected.rowPtr(i) + B.getCols(), X.rowPtr(i));
+    }
+    return X;
+}
+
+Vector leastSquares(const Matrix &A, const Vector &b)
+{
+    return QRDecomposition(A).leastSquares(b);
+}
+
+Matrix leastSquares(const Matrix &A, const Matrix &B)
+{
+    return QRDecomposition(A).leastSquares(B);
+}
@@ -0,0 +1,390 @@
+#include "random.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstring> // For std::memcpy
+#include <random> // For std::random_device
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KALO_ALGEBRA_X86_KERNELS 1
+#endif
+
+#ifdef __GNUC__
+#define KALO_ALGEBRA_ALWAYS_INLINE __attribute__((always_inline))
+#else
+#define KALO_ALGEBRA_ALWAYS_INLINE
+#endif
+
+// A lane loop that must stay a loop: fully unrolled early, the compiler would try to vectorize
+// the loop around it instead, fail, and leave scalar code
+#if defined(__clang__)
+#define KALO_ALGEBRA_LANE_LOOP _Pragma("clang loop unroll(disable)")
+#elif defined(__GNUC__)
+#define KALO_ALGEBRA_LANE_LOOP _Pragma("GCC unroll 1")
+#else
+#define KALO_ALGEBRA_LANE_LOOP
+#endif
+
+namespace
+{
+    using KaloAlgebraUtils::RealType;
+
+    constexpr std::uint32_t philoxM0 = 0xD2511F53u, philoxM1 = 0xCD9E8D57u; // round multipliers
+    constexpr std::uint32_t philoxW0 = 0x9E3779B9u, philoxW1 = 0xBB67AE85u; // key increments
+    constexpr int philoxRounds = 10;
+
+    KALO_ALGEBRA_ALWAYS_INLINE inline void philoxRound(std::uint32_t &x0, std::uint32_t &x1, std::uint32_t &x2, std::uint32_t &x3,
+                                                       std::uint32_t k0, std::uint32_t k1)
+    {
+        const std::uint64_t p0 = static_cast<std::uint64_t>(philoxM0) * x0;
+        const std::uint64_t p1 = static_cast<std::uint64_t>(philoxM1) * x2;
+        x0 = static_cast<std::uint32_t>(p1 >> 32) ^ x1 ^ k0;
+        x1 = static_cast<std::uint32_t>(p1);
+        x2 = static_cast<std::uint32_t>(p0 >> 32) ^ x3 ^ k1;
+        x3 = static_cast<std::uint32_t>(p0);
+    }
+
+    // Blocks are generated `lanes` at a time, with every round a loop over the lanes, so the
+    // 32 x 32 -> 64-bit multiplies become whole-register operations
+    constexpr int lanes = 16;
+
+    KALO_ALGEBRA_ALWAYS_INLINE inline void philoxLanes(std::uint64_t seed, std::uint64_t stream, std::uint64_t firstBlock,
+                                                       std::uint32_t (&x)[4][lanes])
+    {
+        for (int l = 0; l < lanes; l++)
+        {
+            x[0][l] = static_cast<std::uint32_t>(firstBlock + l);
+            x[1][l] = static_cast<std::uint32_t>((firstBlock + l) >> 32);
+            x[2][l] = static_cast<std::uint32_t>(stream);
+            x[3][l] = static_cast<std::uint32_t>(stream >> 32);
+        }
+        std::uint32_t k0 = static_cast<std::uint32_t>(seed), k1 = static_cast<std::uint32_t>(seed >> 32);
+        for (int round = 0; round < philoxRounds; round++)
+        {
+            KALO_ALGEBRA_LANE_LOOP
+            for (int l = 0; l < lanes; l++)
+                philoxRound(x[0][l], x[1][l], x[2][l], x[3][l], k0, k1);
+            k0 += philoxW0;
+            k1 += philoxW1;
+        }
+    }
+
+    // Values per block: 2 doubles from 64-bit halves (52 random bits each), or 4 floats from 32-bit
+    // words (23 random bits each)
+    template <typename R>
+    constexpr int valuesPerBlock = sizeof(std::uint32_t) * 4 / sizeof(R);
+
+    // Uniforms in [0, 1): random mantissa bits under the exponent of 1, minus 1. Integer
+    // operations only, so they vectorize where integer to floating-point conversions do not.
+    double unitDouble(std::uint32_t high, std::uint32_t low)
+    {
+        const std::uint64_t bits = ((static_cast<std::uint64_t>(high) << 32 | low) >> 12) | 0x3FF0000000000000ull;
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value - 1.0;
+    }
+
+    float unitFloat(std::uint32_t word)
+    {
+        const std::uint32_t bits = (word >> 9) | 0x3F800000u;
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value - 1.0f;
+    }
+
+    // The values of `lanes` consecutive blocks: uniforms a + (b - a) * u, or normals a + b * z
+    template <typename R, bool Normal>
+    KALO_ALGEBRA_ALWAYS_INLINE inline void laneValues(const std::uint32_t (&x)[4][lanes], R a, R b, R (&values)[lanes * valuesPerBlock<R>])
+    {
+        constexpr int perBlock = valuesPerBlock<R>;
+        if constexpr (!Normal)
+        {
+            KALO_ALGEBRA_LANE_LOOP
+            for (int l = 0; l < lanes; l++)
+            {
+                if constexpr (perBlock == 2)
+                {
+                    values[2 * l] = a + (b - a) * static_cast<R>(unitDouble(x[0][l], x[1][l]));
+                    values[2 * l + 1] = a + (b - a) * static_cast<R>(unitDouble(x[2][l], x[3][l]));
+                }
+                else
+                {
+                    for (int w = 0; w < 4; w++)
+                        values[4 * l + w] = a + (b - a) * static_cast<R>(unitFloat(x[w][l]));
+                }
+            }
+        }
+        else
+        {
+            // Box-Muller: each pair of uniforms gives two independent normals
+            constexpr R twoPi = R(6.283185307179586476925286766559);
+            for (int l = 0; l < lanes; l++)
+            {
+                R unit[perBlock];
+                if constexpr (perBlock == 2)
+                {
+                    unit[0] = static_cast<R>(unitDouble(x[0][l], x[1][l]));
+                    unit[1] = static_cast<R>(unitDouble(x[2][l], x[3][l]));
+                }
+                else
+                {
+                    for (int w = 0; w < 4; w++)
+                        unit[w] = static_cast<R>(unitFloat(x[w][l]));
+                }
+                for (int v = 0; v < perBlock; v += 2)
+                {
+                    const R radius = std::sqrt(R(-2) * std::log(R(1) - unit[v])); // 1 - u is in (0, 1]
+                    const R angle = twoPi * unit[v + 1];
+                    values[perBlock * l + v] = a + b * radius * std::cos(angle);
+                    values[perBlock * l + v + 1] = a + b * radius * std::sin(angle);
+                }
+            }
+        }
+    }
+
+    // Writes values [firstValue, firstValue + count) of the stream starting at block `position`
+    // to out; value v comes from block position + v / valuesPerBlock
+    template <typename R, bool Normal>
+    KALO_ALGEBRA_ALWAYS_INLINE inline void generateRange(std::uint64_t seed, std::uint64_t stream, std::uint64_t position,
+                                                         std::uint64_t firstValue, std::size_t count, R *out, R a, R b)
+    {
+        constexpr int perBlock = valuesPerBlock<R>;
+        std::uint64_t block = position + firstValue / perBlock;
+        std::size_t skip = firstValue % perBlock;
+        std::uint32_t x[4][lanes];
+        R values[lanes * perBlock];
+        while (count > 0)
+        {
+            philoxLanes(seed, stream, block, x);
+            laneValues<R, Normal>(x, a, b, values);
+            const std::size_t take = std::min<std::size_t>(lanes * perBlock - skip, count);
+            std::copy(values + skip, values + skip + take, out);
+            out += take;
+            count -= take;
+            skip = 0;
+            block += lanes;
+        }
+    }
+
+    template <typename R, bool Normal>
+    void generateGeneric(std::uint64_t seed, std::uint64_t stream, std::uint64_t position, std::uint64_t firstValue, std::size_t count, R *out, R a, R b)
+    {
+        generateRange<R, Normal>(seed, stream, position, firstValue, count, out, a, b);
+    }
+
+#ifdef KALO_ALGEBRA_X86_KERNELS
+    template <typename R, bool Normal>
+    __attribute__((target("avx2,fma"))) void generateAvx2(std::uint64_t seed, std::uint64_t stream, std::uint64_t position, std::uint64_t firstValue, std::size_t count, R *out, R a, R b)
+    {
+        generateRange<R, Normal>(seed, stream, position, firstValue, count, out, a, b);
+    }
+
+    template <typename R, bool Normal>
+    __attribute__((target("avx512f"))) void generateAvx512(std::uint64_t seed, std::uint64_t stream, std::uint64_t position, std::uint64_t firstValue, std::size_t count, R *out, R a, R b)
+    {
+        generateRange<R, Normal>(seed, stream, position, firstValue, count, out, a, b);
+    }
+#endif
+
+    template <typename R, bool Normal>
+    void generate(std::uint64_t seed, std::uint64_t stream, std::uint64_t position, std::uint64_t firstValue, std::size_t count, R *out, R a, R b)
+    {
+        switch (KaloAlgebraSimd::activeIsa())
+        {
+#ifdef KALO_ALGEBRA_X86_KERNELS
+        case KaloAlgebraSimd::Isa::AVX512:
+            generateAvx512<R, Normal>(seed, stream, position, firstValue, count, out, a, b);
+            return;
+        case KaloAlgebraSimd::Isa::AVX2:
+            generateAvx2<R, Normal>(seed, stream, position, firstValue, count, out, a, b);
+            return;
+#endif
+        default:
+            generateGeneric<R, Normal>(seed, stream, position, firstValue, count, out, a, b);
+        }
+    }
+
+    // Real values per element, and the blocks a fill of `values` real values uses
+    template <typename T>
+    constexpr int partsOf = KaloAlgebraUtils::ScalarTraits<T>::isComplex ? 2 : 1;
+
+    template <typename R>
+    std::uint64_t blocksFor(std::uint64_t values)
+    {
+        return (values + valuesPerBlock<R> - 1) / valuesPerBlock<R>;
+    }
+
+    constexpr long long chunkValues = 4096; // a multiple of every valuesPerBlock
+    constexpr long long costPerValue = 16;  // rough work per value, against the serial threshold
+
+    // Contiguous fill, in chunks spread over the thread pool
+    template <typename T, bool Normal>
+    void fillContiguous(std::uint64_t seed, std::uint64_t stream, std::uint64_t &position, T *data, std::size_t count,
+                        RealType<T> a, RealType<T> b)
+    {
+        using R = RealType<T>;
+        R *out = reinterpret_cast<R *>(data); // std::complex<R> is an array of two R
+        const long long values = static_cast<long long>(count) * partsOf<T>;
+        const std::uint64_t start = position;
+        KaloAlgebraParallel::parallelFor(0, (values + chunkValues - 1) / chunkValues, chunkValues * costPerValue, [&](long long first, long long last)
+                                         {
+            const long long begin = first * chunkValues, end = std::min(values, last * chunkValues);
+            generate<R, Normal>(seed, stream, start, begin, end - begin, out + begin, a, b); });
+        position += blocksFor<R>(values);
+    }
+
+    // Fill of a strided matrix, in row-major element order, one row at a time
+    template <typename T, bool Normal>
+    void fillMatrix(std::uint64_t seed, std::uint64_t stream, std::uint64_t &position, BasicMatrixView<T> target,
+                    RealType<T> a, RealType<T> b)
+    {
+        using R = RealType<T>;
+        const int rows = target.getRows(), cols = target.getCols();
+        const std::uint64_t rowValues = static_cast<std::uint64_t>(cols) * partsOf<T>;
+        const std::uint64_t start = position;
+        KaloAlgebraParallel::parallelFor(0, rows, static_cast<long long>(rowValues) * costPerValue, [&](long long first, long long last)
+                                         {
+            for (long long i = first; i < last; i++)
+            {
+                const std::uint64_t rowStart = static_cast<std::uint64_t>(i) * rowValues;
+                if (target.getColStride() == 1)
+                {
+                    generate<R, Normal>(seed, stream, start, rowStart, rowValues, reinterpret_cast<R *>(target.elementPtr(static_cast<int>(i), 0)), a, b);
+                    continue;
+                }
+                // Strided rows go through a small buffer
+                constexpr int bufferSize = 64;
+                T buffer[bufferSize];
+                for (int j = 0; j < cols; j += bufferSize)
+                {
+                    const int n = std::min(bufferSize, cols - j);
+                    generate<R, Normal>(seed, stream, start, rowStart + static_cast<std::uint64_t>(j) * partsOf<T>, static_cast<std::size_t>(n) * partsOf<T>,
+                                        reinterpret_cast<R *>(buffer), a, b);
+                    for (int k = 0; k < n; k++)
+                        *target.elementPtr(static_cast<int>(i), j + k) = buffer[k];
+                }
+            } });
+        position += blocksFor<R>(static_cast<std::uint64_t>(rows) * rowValues);
+    }
+
+    template <typename T>
+    BasicMatrixView<T> asRow(BasicVectorView<T> vector)
+    {
+        return BasicMatrixView<T>(vector.data(), 1, vector.getSize(), 0, vector.getIncrement());
+    }
+}
+
+namespace KaloAlgebraUtils
+{
+    std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key)
+    {
+        for (int round = 0; round < philoxRounds; round++)
+        {
+            philoxRound(counter[0], counter[1], counter[2], counter[3], key[0], key[1]);
+            key[0] += philoxW0;
+            key[1] += philoxW1;
+        }
+        return counter;
+    }
+
+    RandomGenerator::RandomGenerator(std::uint64_t seed, std::uint64_t stream) : seed(seed), stream(stream), position(0) {}
+
+    RandomGenerator RandomGenerator::fromEntropy()
+    {
+        std::random_device device;
+        const std::uint64_t high = device(), low = device();
+        return RandomGenerator((high << 32) ^ low);
+    }
+
+    std::array<std::uint32_t, 4> RandomGenerator::nextBlock()
+    {
+        const std::uint64_t block = position++;
+        return philox4x32({static_cast<std::uint32_t>(block), static_cast<std::uint32_t>(block >> 32),
+                           static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)},
+                          {static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)});
+    }
+
+    double RandomGenerator::uniform(double min, double max)
+    {
+        const std::array<std::uint32_t, 4> x = nextBlock();
+        return min + (max - min) * unitDouble(x[0], x[1]);
+    }
+
+    double RandomGenerator::normal(double mean, double stddev)
+    {
+        const std::array<std::uint32_t, 4> x = nextBlock();
+        const double radius = std::sqrt(-2.0 * std::log(1.0 - unitDouble(x[0], x[1])));
+        return mean + stddev * radius * std::cos(6.283185307179586476925286766559 * unitDouble(x[2], x[3]));
+    }
+
+    template <typename T>
+    void RandomGenerator::fillUniform(T *data, std::size_t count, RealType<T> min, RealType<T> max)
+    {
+        KALO_ALGEBRA_INSTRUMENT("RandomGenerator::fillUniform", static_cast<long long>(count), 0.0, 1.0 * count * sizeof(T));
+        fillContiguous<T, false>(seed, stream, position, data, count, min, max);
+    }
+
+    template <typename T>
+    void RandomGenerator::fillNormal(T *data, std::size_t count, RealType<T> mean, RealType<T> stddev)
+    {
+        KALO_ALGEBRA_INSTRUMENT("RandomGenerator::fillNormal", static_cast<long long>(count), 0.0, 1.0 * count * sizeof(T));
+        fillContiguous<T, true>(seed, stream, position, data, count, mean, stddev);
+    }
+
+    template <typename T>
+    void RandomGenerator::fillUniform(BasicMatrixView<T> target, RealType<T> min, RealType<T> max)
+    {
+        KALO_ALGEBRA_INSTRUMENT("RandomGenerator::fillUniform", std::max(target.getRows(), target.getCols()), 0.0,
+                                1.0 * target.getRows() * target.getCols() * sizeof(T));
+        fillMatrix<T, false>(seed, stream, position, target, min, max);
+    }
+
+    template <typename T>
+    void RandomGenerator::fillNormal(BasicMatrixView<T> target, RealType<T> mean, RealType<T> stddev)
+    {
+        KALO_ALGEBRA_INSTRUMENT("RandomGenerator::fillNormal", std::max(target.getRows(), target.getCols()), 0.0,
+                                1.0 * target.getRows() * target.getCols() * sizeof(T));
+        fillMatrix<T, true>(seed, stream, position, target, mean, stddev);
+    }
+
+    template <typename T>
+    void RandomGenerator::fillUniform(BasicVectorView<T> target, RealType<T> min, RealType<T> max)
+    {
+        if (target.getIncrement() == 1)
+            fillUniform(target.data(), static_cast<std::size_t>(target.getSize()), min, max);
+        else
+            fillUniform(asRow(target), min, max);
+    }
+
+    template <typename T>
+    void RandomGenerator::fillNormal(BasicVectorView<T> target, RealType<T> mean, RealType<T> stddev)
+    {
+        if (target.getIncrement() == 1)
+            fillNormal(target.data(), static_cast<std::size_t>(target.getSize()), mean, stddev);
+        else
+            fillNormal(asRow(target), mean, stddev);
+    }
+
+    RandomGenerator &threadGenerator()
+    {
+        thread_local RandomGenerator generator = RandomGenerator::fromEntropy();
+        return generator;
+    }
+}
+
+// Explicit instantiations for the supported scalar types
+#define KALO_ALGEBRA_INSTANTIATE_RANDOM(T)                                                                                                  \
+    template void KaloAlgebraUtils::RandomGenerator::fillUniform<T>(T *, std::size_t, RealType<T>, RealType<T>);                          \
+    template void KaloAlgebraUtils::RandomGenerator::fillNormal<T>(T *, std::size_t, RealType<T>, RealType<T>);                           \
+    template void KaloAlgebraUtils::RandomGenerator::fillUniform<T>(BasicMatrixView<T>, RealType<T>, RealType<T>);                        \
+    template void KaloAlgebraUtils::RandomGenerator::fillNormal<T>(BasicMatrixView<T>, RealType<T>, RealType<T>);                         \
+    template void KaloAlgebraUtils::RandomGenerator::fillUniform<T>(BasicVectorView<T>, RealType<T>, RealType<T>);                        \
+    template void KaloAlgebraUtils::RandomGenerator::fillNormal<T>(BasicVectorView<T>, RealType<T>, RealType<T>);
+
+KALO_ALGEBRA_INSTANTIATE_RANDOM(float)
+KALO_ALGEBRA_INSTANTIATE_RANDOM(double)
+KALO_ALGEBRA_INSTANTIATE_RANDOM(std::complex<float>)
+KALO_ALGEBRA_INSTANTIATE_RANDOM(std::complex<double>)
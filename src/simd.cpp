@@ -0,0 +1,812 @@
+#include "simd.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KALO_ALGEBRA_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// Every kernel is written once per instruction set as a template over the element type; the Lanes
+// structs below supply the register type and intrinsics for float and double.
+namespace KaloAlgebraSimd
+{
+    namespace
+    {
+#ifdef KALO_ALGEBRA_X86_KERNELS
+        template <typename T>
+        struct Sse2Lanes;
+
+        template <>
+        struct Sse2Lanes<double>
+        {
+            using Reg = __m128d;
+            static constexpr std::size_t width = 2;
+            __attribute__((target("sse2"))) static Reg zero() { return _mm_setzero_pd(); }
+            __attribute__((target("sse2"))) static Reg set1(double value) { return _mm_set1_pd(value); }
+            __attribute__((target("sse2"))) static Reg load(const double *p) { return _mm_loadu_pd(p); }
+            __attribute__((target("sse2"))) static void store(double *p, Reg value) { _mm_storeu_pd(p, value); }
+            __attribute__((target("sse2"))) static Reg add(Reg a, Reg b) { return _mm_add_pd(a, b); }
+            __attribute__((target("sse2"))) static Reg mul(Reg a, Reg b) { return _mm_mul_pd(a, b); }
+            __attribute__((target("sse2"))) static Reg madd(Reg a, Reg b, Reg c) { return _mm_add_pd(c, _mm_mul_pd(a, b)); } // no FMA
+            __attribute__((target("sse2"))) static double reduce(Reg sum)
+            {
+                return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+            }
+        };
+
+        template <>
+        struct Sse2Lanes<float>
+        {
+            using Reg = __m128;
+            static constexpr std::size_t width = 4;
+            __attribute__((target("sse2"))) static Reg zero() { return _mm_setzero_ps(); }
+            __attribute__((target("sse2"))) static Reg set1(float value) { return _mm_set1_ps(value); }
+            __attribute__((target("sse2"))) static Reg load(const float *p) { return _mm_loadu_ps(p); }
+            __attribute__((target("sse2"))) static void store(float *p, Reg value) { _mm_storeu_ps(p, value); }
+            __attribute__((target("sse2"))) static Reg add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+            __attribute__((target("sse2"))) static Reg mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+            __attribute__((target("sse2"))) static Reg madd(Reg a, Reg b, Reg c) { return _mm_add_ps(c, _mm_mul_ps(a, b)); }
+            __attribute__((target("sse2"))) static float reduce(Reg sum)
+            {
+                const __m128 pairs = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+                return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+            }
+        };
+
+        template <typename T>
+        struct Avx2Lanes;
+
+        template <>
+        struct Avx2Lanes<double>
+        {
+            using Reg = __m256d;
+            static constexpr std::size_t width = 4;
+            __attribute__((target("avx2,fma"))) static Reg zero() { return _mm256_setzero_pd(); }
+            __attribute__((target("avx2,fma"))) static Reg set1(double value) { return _mm256_set1_pd(value); }
+            __attribute__((target("avx2,fma"))) static Reg load(const double *p) { return _mm256_loadu_pd(p); }
+            __attribute__((target("avx2,fma"))) static void store(double *p, Reg value) { _mm256_storeu_pd(p, value); }
+            __attribute__((target("avx2,fma"))) static Reg add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+            __attribute__((target("avx2,fma"))) static Reg mul(Reg a, Reg b) { return _mm256_mul_pd(a, b); }
+            __attribute__((target("avx2,fma"))) static Reg madd(Reg a, Reg b, Reg c) { return _mm256_fmadd_pd(a, b, c); }
+            __attribute__((target("avx2,fma"))) static double reduce(Reg sum)
+            {
+                const __m128d halves = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+                return _mm_cvtsd_f64(_mm_add_sd(halves, _mm_unpackhi_pd(halves, halves)));
+            }
+        };
+
+        template <>
+        struct Avx2Lanes<float>
+        {
+            using Reg = __m256;
+            static constexpr std::size_t width = 8;
+            __attribute__((target("avx2,fma"))) static Reg zero() { return _mm256_setzero_ps(); }
+            __attribute__((target("avx2,fma"))) static Reg set1(float value) { return _mm256_set1_ps(value); }
+            __attribute__((target("avx2,fma"))) static Reg load(const float *p) { return _mm256_loadu_ps(p); }
+            __attribute__((target("avx2,fma"))) static void store(float *p, Reg value) { _mm256_storeu_ps(p, value); }
+            __attribute__((target("avx2,fma"))) static Reg add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+            __attribute__((target("avx2,fma"))) static Reg mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+            __attribute__((target("avx2,fma"))) static Reg madd(Reg a, Reg b, Reg c) { return _mm256_fmadd_ps(a, b, c); }
+            __attribute__((target("avx2,fma"))) static float reduce(Reg sum)
+            {
+                const __m128 halves = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+                const __m128 pairs = _mm_add_ps(halves, _mm_movehl_ps(halves, halves));
+                return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+            }
+        };
+
+        // AVX-512 adds masked loads and stores, so the tails need no scalar loop
+        template <typename T>
+        struct Avx512Lanes;
+
+        template <>
+        struct Avx512Lanes<double>
+        {
+            using Reg = __m512d;
+            using Mask = __mmask8;
+            static constexpr std::size_t width = 8;
+            static Mask tail(std::size_t count) { return static_cast<Mask>((1u << count) - 1); }
+            __attribute__((target("avx512f"))) static Reg zero() { return _mm512_setzero_pd(); }
+            __attribute__((target("avx512f"))) static Reg set1(double value) { return _mm512_set1_pd(value); }
+            __attribute__((target("avx512f"))) static Reg load(const double *p) { return _mm512_loadu_pd(p); }
+            __attribute__((target("avx512f"))) static Reg load(Mask mask, const double *p) { return _mm512_maskz_loadu_pd(mask, p); }
+            __attribute__((target("avx512f"))) static void store(double *p, Reg value) { _mm512_storeu_pd(p, value); }
+            __attribute__((target("avx512f"))) static void store(double *p, Mask mask, Reg value) { _mm512_mask_storeu_pd(p, mask, value); }
+            __attribute__((target("avx512f"))) static Reg add(Reg a, Reg b) { return _mm512_add_pd(a, b); }
+            __attribute__((target("avx512f"))) static Reg mul(Reg a, Reg b) { return _mm512_mul_pd(a, b); }
+            __attribute__((target("avx512f"))) static Reg madd(Reg a, Reg b, Reg c) { return _mm512_fmadd_pd(a, b, c); }
+            __attribute__((target("avx512f"))) static double reduce(Reg sum) { return _mm512_reduce_add_pd(sum); }
+        };
+
+        template <>
+        struct Avx512Lanes<float>
+        {
+            using Reg = __m512;
+            using Mask = __mmask16;
+            static constexpr std::size_t width = 16;
+            static Mask tail(std::size_t count) { return static_cast<Mask>((1u << count) - 1); }
+            __attribute__((target("avx512f"))) static Reg zero() { return _mm512_setzero_ps(); }
+            __attribute__((target("avx512f"))) static Reg set1(float value) { return _mm512_set1_ps(value); }
+            __attribute__((target("avx512f"))) static Reg load(const float *p) { return _mm512_loadu_ps(p); }
+            __attribute__((target("avx512f"))) static Reg load(Mask mask, const float *p) { return _mm512_maskz_loadu_ps(mask, p); }
+            __attribute__((target("avx512f"))) static void store(float *p, Reg value) { _mm512_storeu_ps(p, value); }
+            __attribute__((target("avx512f"))) static void store(float *p, Mask mask, Reg value) { _mm512_mask_storeu_ps(p, mask, value); }
+            __attribute__((target("avx512f"))) static Reg add(Reg a, Reg b) { return _mm512_add_ps(a, b); }
+            __attribute__((target("avx512f"))) static Reg mul(Reg a, Reg b) { return _mm512_mul_ps(a, b); }
+            __attribute__((target("avx512f"))) static Reg madd(Reg a, Reg b, Reg c) { return _mm512_fmadd_ps(a, b, c); }
+            __attribute__((target("avx512f"))) static float reduce(Reg sum) { return _mm512_reduce_add_ps(sum); }
+        };
+#endif
+
+        // Element-wise operations, one entry point per instruction set and element type
+        struct AddOp
+        {
+            template <typename T>
+            static T scalar(T a, T b) { return a + b; }
+#ifdef KALO_ALGEBRA_X86_KERNELS
+            __attribute__((target("sse2"))) static __m128d sse2(__m128d a, __m128d b) { return _mm_add_pd(a, b); }
+            __attribute__((target("sse2"))) static __m128 sse2(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+            __attribute__((target("avx2"))) static __m256d avx2(__m256d a, __m256d b) { return _mm256_add_pd(a, b); }
+            __attribute__((target("avx2"))) static __m256 avx2(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+            __attribute__((target("avx512f"))) static __m512d avx512(__m512d a, __m512d b) { return _mm512_add_pd(a, b); }
+            __attribute__((target("avx512f"))) static __m512 avx512(__m512 a, __m512 b) { return _mm512_add_ps(a, b); }
+#endif
+        };
+
+        struct SubtractOp
+        {
+            template <typename T>
+            static T scalar(T a, T b) { return a - b; }
+#ifdef KALO_ALGEBRA_X86_KERNELS
+            __attribute__((target("sse2"))) static __m128d sse2(__m128d a, __m128d b) { return _mm_sub_pd(a, b); }
+            __attribute__((target("sse2"))) static __m128 sse2(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+            __attribute__((target("avx2"))) static __m256d avx2(__m256d a, __m256d b) { return _mm256_sub_pd(a, b); }
+            __attribute__((target("avx2"))) static __m256 avx2(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+            __attribute__((target("avx512f"))) static __m512d avx512(__m512d a, __m512d b) { return _mm512_sub_pd(a, b); }
+            __attribute__((target("avx512f"))) static __m512 avx512(__m512 a, __m512 b) { return _mm512_sub_ps(a, b); }
+#endif
+        };
+
+        struct MultiplyOp
+        {
+            template <typename T>
+            static T scalar(T a, T b) { return a * b; }
+#ifdef KALO_ALGEBRA_X86_KERNELS
+            __attribute__((target("sse2"))) static __m128d sse2(__m128d a, __m128d b) { return _mm_mul_pd(a, b); }
+            __attribute__((target("sse2"))) static __m128 sse2(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+            __attribute__((target("avx2"))) static __m256d avx2(__m256d a, __m256d b) { return _mm256_mul_pd(a, b); }
+            __attribute__((target("avx2"))) static __m256 avx2(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+            __attribute__((target("avx512f"))) static __m512d avx512(__m512d a, __m512d b) { return _mm512_mul_pd(a, b); }
+            __attribute__((target("avx512f"))) static __m512 avx512(__m512 a, __m512 b) { return _mm512_mul_ps(a, b); }
+#endif
+        };
+
+        // Portable kernels. Four independent accumulators break the serial add chain of the reduction.
+        template <typename T>
+        T dotScalar(const T *a, const T *b, std::size_t n)
+        {
+            T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                s0 += a[i] * b[i];
+                s1 += a[i + 1] * b[i + 1];
+                s2 += a[i + 2] * b[i + 2];
+                s3 += a[i + 3] * b[i + 3];
+            }
+            for (; i < n; i++)
+                s0 += a[i] * b[i];
+            return (s0 + s1) + (s2 + s3);
+        }
+
+        template <typename T>
+        T sumOfSquaresScalar(const T *a, std::size_t n)
+        {
+            return dotScalar(a, a, n);
+        }
+
+        template <typename T, typename Op>
+        void binaryScalar(const T *a, const T *b, T *out, std::size_t n)
+        {
+            for (std::size_t i = 0; i < n; i++)
+                out[i] = Op::scalar(a[i], b[i]);
+        }
+
+        template <typename T>
+        void scaleScalar(const T *a, T scalar, T *out, std::size_t n)
+        {
+            for (std::size_t i = 0; i < n; i++)
+                out[i] = a[i] * scalar;
+        }
+
+        template <typename T>
+        void axpyScalar(T alpha, const T *x, T *y, std::size_t n)
+        {
+            for (std::size_t i = 0; i < n; i++)
+                y[i] += alpha * x[i];
+        }
+
+#ifdef KALO_ALGEBRA_X86_KERNELS
+        // SSE2: 2 double or 4 float lanes, 4 accumulators
+        template <typename T>
+        __attribute__((target("sse2"))) T dotSse2(const T *a, const T *b, std::size_t n)
+        {
+            using L = Sse2Lanes<T>;
+            constexpr std::size_t w = L::width;
+            typename L::Reg s0 = L::zero(), s1 = L::zero(), s2 = L::zero(), s3 = L::zero();
+            std::size_t i = 0;
+            for (; i + 4 * w <= n; i += 4 * w)
+            {
+                s0 = L::madd(L::load(a + i), L::load(b + i), s0);
+                s1 = L::madd(L::load(a + i + w), L::load(b + i + w), s1);
+                s2 = L::madd(L::load(a + i + 2 * w), L::load(b + i + 2 * w), s2);
+                s3 = L::madd(L::load(a + i + 3 * w), L::load(b + i + 3 * w), s3);
+            }
+            for (; i + w <= n; i += w)
+                s0 = L::madd(L::load(a + i), L::load(b + i), s0);
+            T result = L::reduce(L::add(L::add(s0, s1), L::add(s2, s3)));
+            for (; i < n; i++)
+                result += a[i] * b[i];
+            return result;
+        }
+
+        template <typename T>
+        __attribute__((target("sse2"))) T sumOfSquaresSse2(const T *a, std::size_t n)
+        {
+            return dotSse2(a, a, n);
+        }
+
+        template <typename T, typename Op>
+        __attribute__((target("sse2"))) void binarySse2(const T *a, const T *b, T *out, std::size_t n)
+        {
+            using L = Sse2Lanes<T>;
+            constexpr std::size_t w = L::width;
+            std::size_t i = 0;
+            for (; i + 2 * w <= n; i += 2 * w)
+            {
+                const typename L::Reg r0 = Op::sse2(L::load(a + i), L::load(b + i));
+                const typename L::Reg r1 = Op::sse2(L::load(a + i + w), L::load(b + i + w));
+                L::store(out + i, r0);
+                L::store(out + i + w, r1);
+            }
+            for (; i < n; i++)
+                out[i] = Op::scalar(a[i], b[i]);
+        }
+
+        template <typename T>
+        __attribute__((target("sse2"))) void scaleSse2(const T *a, T scalar, T *out, std::size_t n)
+        {
+            using L = Sse2Lanes<T>;
+            const typename L::Reg s = L::set1(scalar);
+            std::size_t i = 0;
+            for (; i + L::width <= n; i += L::width)
+                L::store(out + i, L::mul(L::load(a + i), s));
+            for (; i < n; i++)
+                out[i] = a[i] * scalar;
+        }
+
+        template <typename T>
+        __attribute__((target("sse2"))) void axpySse2(T alpha, const T *x, T *y, std::size_t n)
+        {
+            using L = Sse2Lanes<T>;
+            constexpr std::size_t w = L::width;
+            const typename L::Reg a = L::set1(alpha);
+            std::size_t i = 0;
+            for (; i + 2 * w <= n; i += 2 * w)
+            {
+                const typename L::Reg r0 = L::madd(a, L::load(x + i), L::load(y + i));
+                const typename L::Reg r1 = L::madd(a, L::load(x + i + w), L::load(y + i + w));
+                L::store(y + i, r0);
+                L::store(y + i + w, r1);
+            }
+            for (; i < n; i++)
+                y[i] += alpha * x[i];
+        }
+
+        // AVX2 + FMA: 4 double or 8 float lanes, 4 accumulators
+        template <typename T>
+        __attribute__((target("avx2,fma"))) T dotAvx2(const T *a, const T *b, std::size_t n)
+        {
+            using L = Avx2Lanes<T>;
+            constexpr std::size_t w = L::width;
+            typename L::Reg s0 = L::zero(), s1 = L::zero(), s2 = L::zero(), s3 = L::zero();
+            std::size_t i = 0;
+            for (; i + 4 * w <= n; i += 4 * w)
+            {
+                s0 = L::madd(L::load(a + i), L::load(b + i), s0);
+                s1 = L::madd(L::load(a + i + w), L::load(b + i + w), s1);
+                s2 = L::madd(L::load(a + i + 2 * w), L::load(b + i + 2 * w), s2);
+                s3 = L::madd(L::load(a + i + 3 * w), L::load(b + i + 3 * w), s3);
+            }
+            for (; i + w <= n; i += w)
+                s0 = L::madd(L::load(a + i), L::load(b + i), s0);
+            T result = L::reduce(L::add(L::add(s0, s1), L::add(s2, s3)));
+            for (; i < n; i++)
+                result += a[i] * b[i];
+            return result;
+        }
+
+        template <typename T>
+        __attribute__((target("avx2,fma"))) T sumOfSquaresAvx2(const T *a, std::size_t n)
+        {
+            return dotAvx2(a, a, n);
+        }
+
+        template <typename T, typename Op>
+        __attribute__((target("avx2,fma"))) void binaryAvx2(const T *a, const T *b, T *out, std::size_t n)
+        {
+            using L = Avx2Lanes<T>;
+            constexpr std::size_t w = L::width;
+            std::size_t i = 0;
+            for (; i + 2 * w <= n; i += 2 * w)
+            {
+                const typename L::Reg r0 = Op::avx2(L::load(a + i), L::load(b + i));
+                const typename L::Reg r1 = Op::avx2(L::load(a + i + w), L::load(b + i + w));
+                L::store(out + i, r0);
+                L::store(out + i + w, r1);
+            }
+            for (; i < n; i++)
+                out[i] = Op::scalar(a[i], b[i]);
+        }
+
+        template <typename T>
+        __attribute__((target("avx2,fma"))) void scaleAvx2(const T *a, T scalar, T *out, std::size_t n)
+        {
+            using L = Avx2Lanes<T>;
+            const typename L::Reg s = L::set1(scalar);
+            std::size_t i = 0;
+            for (; i + L::width <= n; i += L::width)
+                L::store(out + i, L::mul(L::load(a + i), s));
+            for (; i < n; i++)
+                out[i] = a[i] * scalar;
+        }
+
+        template <typename T>
+        __attribute__((target("avx2,fma"))) void axpyAvx2(T alpha, const T *x, T *y, std::size_t n)
+        {
+            using L = Avx2Lanes<T>;
+            constexpr std::size_t w = L::width;
+            const typename L::Reg a = L::set1(alpha);
+            std::size_t i = 0;
+            for (; i + 2 * w <= n; i += 2 * w)
+            {
+                const typename L::Reg r0 = L::madd(a, L::load(x + i), L::load(y + i));
+                const typename L::Reg r1 = L::madd(a, L::load(x + i + w), L::load(y + i + w));
+                L::store(y + i, r0);
+                L::store(y + i + w, r1);
+            }
+            for (; i < n; i++)
+                y[i] += alpha * x[i];
+        }
+
+        // AVX-512: 8 double or 16 float lanes, 4 accumulators, masked tail
+        template <typename T>
+        __attribute__((target("avx512f"))) T dotAvx512(const T *a, const T *b, std::size_t n)
+        {
+            using L = Avx512Lanes<T>;
+            constexpr std::size_t w = L::width;
+            typename L::Reg s0 = L::zero(), s1 = L::zero(), s2 = L::zero(), s3 = L::zero();
+            std::size_t i = 0;
+            for (; i + 4 * w <= n; i += 4 * w)
+            {
+                s0 = L::madd(L::load(a + i), L::load(b + i), s0);
+                s1 = L::madd(L::load(a + i + w), L::load(b + i + w), s1);
+                s2 = L::madd(L::load(a + i + 2 * w), L::load(b + i + 2 * w), s2);
+                s3 = L::madd(L::load(a + i + 3 * w), L::load(b + i + 3 * w), s3);
+            }
+            for (; i + w <= n; i += w)
+                s0 = L::madd(L::load(a + i), L::load(b + i), s0);
+            if (i < n)
+            {
+                const typename L::Mask mask = L::tail(n - i);
+                s1 = L::madd(L::load(mask, a + i), L::load(mask, b + i), s1);
+            }
+            return L::reduce(L::add(L::add(s0, s1), L::add(s2, s3)));
+        }
+
+        template <typename T>
+        __attribute__((target("avx512f"))) T sumOfSquaresAvx512(const T *a, std::size_t n)
+        {
+            return dotAvx512(a, a, n);
+        }
+
+        template <typename T, typename Op>
+        __attribute__((target("avx512f"))) void binaryAvx512(const T *a, const T *b, T *out, std::size_t n)
+        {
+            using L = Avx512Lanes<T>;
+            constexpr std::size_t w = L::width;
+            std::size_t i = 0;
+            for (; i + 2 * w <= n; i += 2 * w)
+            {
+                const typename L::Reg r0 = Op::avx512(L::load(a + i), L::load(b + i));
+                const typename L::Reg r1 = Op::avx512(L::load(a + i + w), L::load(b + i + w));
+                L::store(out + i, r0);
+                L::store(out + i + w, r1);
+            }
+            for (; i + w <= n; i += w)
+                L::store(out + i, Op::avx512(L::load(a + i), L::load(b + i)));
+            if (i < n)
+            {
+                const typename L::Mask mask = L::tail(n - i);
+                L::store(out + i, mask, Op::avx512(L::load(mask, a + i), L::load(mask, b + i)));
+            }
+        }
+
+        template <typename T>
+        __attribute__((target("avx512f"))) void scaleAvx512(const T *a, T scalar, T *out, std::size_t n)
+        {
+            using L = Avx512Lanes<T>;
+            const typename L::Reg s = L::set1(scalar);
+            std::size_t i = 0;
+            for (; i + L::width <= n; i += L::width)
+                L::store(out + i, L::mul(L::load(a + i), s));
+            if (i < n)
+            {
+                const typename L::Mask mask = L::tail(n - i);
+                L::store(out + i, mask, L::mul(L::load(mask, a + i), s));
+            }
+        }
+
+        template <typename T>
+        __attribute__((target("avx512f"))) void axpyAvx512(T alpha, const T *x, T *y, std::size_t n)
+        {
+            using L = Avx512Lanes<T>;
+            constexpr std::size_t w = L::width;
+            const typename L::Reg a = L::set1(alpha);
+            std::size_t i = 0;
+            for (; i + 2 * w <= n; i += 2 * w)
+            {
+                const typename L::Reg r0 = L::madd(a, L::load(x + i), L::load(y + i));
+                const typename L::Reg r1 = L::madd(a, L::load(x + i + w), L::load(y + i + w));
+                L::store(y + i, r0);
+                L::store(y + i + w, r1);
+            }
+            for (; i + w <= n; i += w)
+                L::store(y + i, L::madd(a, L::load(x + i), L::load(y + i)));
+            if (i < n)
+            {
+                const typename L::Mask mask = L::tail(n - i);
+                L::store(y + i, mask, L::madd(a, L::load(mask, x + i), L::load(mask, y + i)));
+            }
+        }
+#endif
+
+        template <typename T>
+        struct KernelTable
+        {
+            T (*dot)(const T *, const T *, std::size_t);
+            T (*sumOfSquares)(const T *, std::size_t);
+            void (*add)(const T *, const T *, T *, std::size_t);
+            void (*subtract)(const T *, const T *, T *, std::size_t);
+            void (*multiply)(const T *, const T *, T *, std::size_t);
+            void (*scale)(const T *, T, T *, std::size_t);
+            void (*axpy)(T, const T *, T *, std::size_t);
+        };
+
+        template <typename T>
+        const KernelTable<T> scalarTable = {dotScalar<T>, sumOfSquaresScalar<T>, binaryScalar<T, AddOp>, binaryScalar<T, SubtractOp>,
+                                            binaryScalar<T, MultiplyOp>, scaleScalar<T>, axpyScalar<T>};
+#ifdef KALO_ALGEBRA_X86_KERNELS
+        template <typename T>
+        const KernelTable<T> sse2Table = {dotSse2<T>, sumOfSquaresSse2<T>, binarySse2<T, AddOp>, binarySse2<T, SubtractOp>,
+                                          binarySse2<T, MultiplyOp>, scaleSse2<T>, axpySse2<T>};
+        template <typename T>
+        const KernelTable<T> avx2Table = {dotAvx2<T>, sumOfSquaresAvx2<T>, binaryAvx2<T, AddOp>, binaryAvx2<T, SubtractOp>,
+                                          binaryAvx2<T, MultiplyOp>, scaleAvx2<T>, axpyAvx2<T>};
+        template <typename T>
+        const KernelTable<T> avx512Table = {dotAvx512<T>, sumOfSquaresAvx512<T>, binaryAvx512<T, AddOp>, binaryAvx512<T, SubtractOp>,
+                                            binaryAvx512<T, MultiplyOp>, scaleAvx512<T>, axpyAvx512<T>};
+#endif
+
+        template <typename T>
+        const KernelTable<T> &tableFor(Isa isa)
+        {
+            switch (isa)
+            {
+#ifdef KALO_ALGEBRA_X86_KERNELS
+            case Isa::AVX512:
+                return avx512Table<T>;
+            case Isa::AVX2:
+                return avx2Table<T>;
+            case Isa::SSE2:
+                return sse2Table<T>;
+#endif
+            default:
+                return scalarTable<T>;
+            }
+        }
+
+        // The KALO_ALGEBRA_ISA environment variable caps the detected instruction set,
+        // which lets whole programs be run on a slower path without recompiling
+        Isa initialIsa()
+        {
+            Isa isa = detectIsa();
+            if (const char *requested = std::getenv("KALO_ALGEBRA_ISA"))
+            {
+                for (Isa candidate : {Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::AVX512})
+                {
+                    if (std::strcmp(requested, isaName(candidate)) == 0 && isIsaSupported(candidate))
+                        isa = candidate;
+                }
+            }
+            return isa;
+        }
+
+        std::atomic<Isa> &currentIsa()
+        {
+            static std::atomic<Isa> isa(initialIsa());
+            return isa;
+        }
+
+        template <typename T>
+        std::atomic<const KernelTable<T> *> &currentTable()
+        {
+            static std::atomic<const KernelTable<T> *> table(&tableFor<T>(currentIsa().load()));
+            return table;
+        }
+
+        template <typename T>
+        const KernelTable<T> &kernels()
+        {
+            return *currentTable<T>().load(std::memory_order_relaxed);
+        }
+
+        // Complex kernels on the interleaved real and imaginary parts. The products are spelled out
+        // so the loops vectorize; std::complex multiplication adds a slow path for infinities.
+        template <typename T>
+        const T *parts(const std::complex<T> *a) { return reinterpret_cast<const T *>(a); }
+        template <typename T>
+        T *parts(std::complex<T> *a) { return reinterpret_cast<T *>(a); }
+
+        template <typename T>
+        std::complex<T> dotComplex(const std::complex<T> *a, const std::complex<T> *b, std::size_t n)
+        {
+            const T *x = parts(a), *y = parts(b);
+            T real = 0, imaginary = 0;
+            for (std::size_t i = 0; i < 2 * n; i += 2)
+            {
+                real += x[i] * y[i] - x[i + 1] * y[i + 1];
+                imaginary += x[i] * y[i + 1] + x[i + 1] * y[i];
+            }
+            return std::complex<T>(real, imaginary);
+        }
+
+        template <typename T>
+        void multiplyComplex(const std::complex<T> *a, const std::complex<T> *b, std::complex<T> *out, std::size_t n)
+        {
+            const T *x = parts(a), *y = parts(b);
+            T *z = parts(out);
+            for (std::size_t i = 0; i < 2 * n; i += 2)
+            {
+                const T real = x[i] * y[i] - x[i + 1] * y[i + 1];
+                const T imaginary = x[i] * y[i + 1] + x[i + 1] * y[i];
+                z[i] = real;
+                z[i + 1] = imaginary;
+            }
+        }
+
+        template <typename T>
+        void scaleComplex(const std::complex<T> *a, std::complex<T> scalar, std::complex<T> *out, std::size_t n)
+        {
+            const T *x = parts(a);
+            T *z = parts(out);
+            const T sr = scalar.real(), si = scalar.imag();
+            for (std::size_t i = 0; i < 2 * n; i += 2)
+            {
+                const T real = x[i] * sr - x[i + 1] * si;
+                const T imaginary = x[i] * si + x[i + 1] * sr;
+                z[i] = real;
+                z[i + 1] = imaginary;
+            }
+        }
+
+        template <typename T>
+        void axpyComplex(std::complex<T> alpha, const std::complex<T> *x, std::complex<T> *y, std::size_t n)
+        {
+            const T *in = parts(x);
+            T *out = parts(y);
+            const T ar = alpha.real(), ai = alpha.imag();
+            for (std::size_t i = 0; i < 2 * n; i += 2)
+            {
+                out[i] += ar * in[i] - ai * in[i + 1];
+                out[i + 1] += ar * in[i + 1] + ai * in[i];
+            }
+        }
+    }
+
+    Isa detectIsa()
+    {
+#ifdef KALO_ALGEBRA_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return Isa::AVX512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return Isa::AVX2;
+        if (__builtin_cpu_supports("sse2"))
+            return Isa::SSE2;
+#endif
+        return Isa::Scalar;
+    }
+
+    Isa activeIsa()
+    {
+        return currentIsa().load(std::memory_order_relaxed);
+    }
+
+    bool isIsaSupported(Isa isa)
+    {
+        return static_cast<int>(isa) <= static_cast<int>(detectIsa());
+    }
+
+    void forceIsa(Isa isa)
+    {
+        if (!isIsaSupported(isa))
+            throw std::invalid_argument("Instruction set is not supported on this CPU!");
+        currentTable<double>().store(&tableFor<double>(isa));
+        currentTable<float>().store(&tableFor<float>(isa));
+        currentIsa().store(isa);
+    }
+
+    void resetIsa()
+    {
+        forceIsa(detectIsa());
+    }
+
+    const char *isaName(Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::SSE2:
+            return "sse2";
+        case Isa::AVX2:
+            return "avx2";
+        case Isa::AVX512:
+            return "avx512";
+        default:
+            return "scalar";
+        }
+    }
+
+    double dot(const double *a, const double *b, std::size_t n)
+    {
+        return kernels<double>().dot(a, b, n);
+    }
+
+    double sumOfSquares(const double *a, std::size_t n)
+    {
+        return kernels<double>().sumOfSquares(a, n);
+    }
+
+    void add(const double *a, const double *b, double *out, std::size_t n)
+    {
+        kernels<double>().add(a, b, out, n);
+    }
+
+    void subtract(const double *a, const double *b, double *out, std::size_t n)
+    {
+        kernels<double>().subtract(a, b, out, n);
+    }
+
+    void multiply(const double *a, const double *b, double *out, std::size_t n)
+    {
+        kernels<double>().multiply(a, b, out, n);
+    }
+
+    void scale(const double *a, double scalar, double *out, std::size_t n)
+    {
+        kernels<double>().scale(a, scalar, out, n);
+    }
+
+    void axpy(double alpha, const double *x, double *y, std::size_t n)
+    {
+        kernels<double>().axpy(alpha, x, y, n);
+    }
+
+    float dot(const float *a, const float *b, std::size_t n)
+    {
+        return kernels<float>().dot(a, b, n);
+    }
+
+    float sumOfSquares(const float *a, std::size_t n)
+    {
+        return kernels<float>().sumOfSquares(a, n);
+    }
+
+    void add(const float *a, const float *b, float *out, std::size_t n)
+    {
+        kernels<float>().add(a, b, out, n);
+    }
+
+    void subtract(const float *a, const float *b, float *out, std::size_t n)
+    {
+        kernels<float>().subtract(a, b, out, n);
+    }
+
+    void multiply(const float *a, const float *b, float *out, std::size_t n)
+    {
+        kernels<float>().multiply(a, b, out, n);
+    }
+
+    void scale(const float *a, float scalar, float *out, std::size_t n)
+    {
+        kernels<float>().scale(a, scalar, out, n);
+    }
+
+    void axpy(float alpha, const float *x, float *y, std::size_t n)
+    {
+        kernels<float>().axpy(alpha, x, y, n);
+    }
+
+    std::complex<float> dot(const std::complex<float> *a, const std::complex<float> *b, std::size_t n)
+    {
+        return dotComplex(a, b, n);
+    }
+
+    float sumOfSquares(const std::complex<float> *a, std::size_t n)
+    {
+        return sumOfSquares(parts(a), 2 * n);
+    }
+
+    void add(const std::complex<float> *a, const std::complex<float> *b, std::complex<float> *out, std::size_t n)
+    {
+        add(parts(a), parts(b), parts(out), 2 * n);
+    }
+
+    void subtract(const std::complex<float> *a, const std::complex<float> *b, std::complex<float> *out, std::size_t n)
+    {
+        subtract(parts(a), parts(b), parts(out), 2 * n);
+    }
+
+    void multiply(const std::complex<float> *a, const std::complex<float> *b, std::complex<float> *out, std::size_t n)
+    {
+        multiplyComplex(a, b, out, n);
+    }
+
+    void scale(const std::complex<float> *a, std::complex<float> scalar, std::complex<float> *out, std::size_t n)
+    {
+        scaleComplex(a, scalar, out, n);
+    }
+
+    void axpy(std::complex<float> alpha, const std::complex<float> *x, std::complex<float> *y, std::size_t n)
+    {
+        axpyComplex(alpha, x, y, n);
+    }
+
+    std::complex<double> dot(const std::complex<double> *a, const std::complex<double> *b, std::size_t n)
+    {
+        return dotComplex(a, b, n);
+    }
+
+    double sumOfSquares(const std::complex<double> *a, std::size_t n)
+    {
+        return sumOfSquares(parts(a), 2 * n);
+    }
+
+    void add(const std::complex<double> *a, const std::complex<double> *b, std::complex<double> *out, std::size_t n)
+    {
+        add(parts(a), parts(b), parts(out), 2 * n);
+    }
+
+    void subtract(const std::complex<double> *a, const std::complex<double> *b, std::complex<double> *out, std::size_t n)
+    {
+        subtract(parts(a), parts(b), parts(out), 2 * n);
+    }
+
+    void multiply(const std::complex<double> *a, const std::complex<double> *b, std::complex<double> *out, std::size_t n)
+    {
+        multiplyComplex(a, b, out, n);
+    }
+
+    void scale(const std::complex<double> *a, std::complex<double> scalar, std::complex<double> *out, std::size_t n)
+    {
+        scaleComplex(a, scalar, out, n);
+    }
+
+    void axpy(std::complex<double> alpha, const std::complex<double> *x, std::complex<double> *y, std::size_t n)
+    {
+        axpyComplex(alpha, x, y, n);
+    }
+}
@@ -0,0 +1,409 @@
+#include "sparse.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include "instrumentation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    // Runs body(rowBegin, rowEnd) over [0, rows) in parallel, splitting the rows so that each task
+    // has about the same number of stored entries (plus one per row, for rows that are empty)
+    template <typename Body>
+    void forRowBlocks(const std::vector<long long> &rowOffsets, int rows, long long costPerEntry, Body body)
+    {
+        const long long parts = std::min<long long>(rows, static_cast<long long>(KaloAlgebraParallel::getThreadCount()) * 4);
+        if (parts <= 1)
+        {
+            body(0, rows);
+            return;
+        }
+        const long long total = rowOffsets[rows] + rows;
+        auto rowAt = [&](long long part)
+        {
+            const long long target = total * part / parts;
+            int low = 0, high = rows;
+            while (low < high)
+            {
+                const int middle = low + (high - low) / 2;
+                if (rowOffsets[middle] + middle < target)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            return low;
+        };
+        KaloAlgebraParallel::parallelFor(0, parts, (total / parts + 1) * costPerEntry, [&](long long first, long long last)
+                                         {
+            for (long long part = first; part < last; part++)
+                body(rowAt(part), rowAt(part + 1)); });
+    }
+
+    // Address range [first, last] covered by a view, for overlap checks
+    std::pair<const double *, const double *> extent(ConstVectorView v)
+    {
+        return {v.data(), v.data() + static_cast<long long>(v.getSize() - 1) * v.getIncrement()};
+    }
+
+    std::pair<const double *, const double *> extent(ConstMatrixView m)
+    {
+        return {m.data(), m.elementPtr(m.getRows() - 1, m.getCols() - 1)};
+    }
+
+    bool rangesOverlap(std::pair<const double *, const double *> a, std::pair<const double *, const double *> b)
+    {
+        std::less_equal<const double *> notAfter;
+        return notAfter(a.first, b.second) && notAfter(b.first, a.second);
+    }
+
+    bool mayOverlap(ConstVectorView a, ConstVectorView b)
+    {
+        return a.getSize() > 0 && b.getSize() > 0 && rangesOverlap(extent(a), extent(b));
+    }
+
+    bool mayOverlap(ConstMatrixView a, ConstMatrixView b)
+    {
+        return a.getRows() > 0 && a.getCols() > 0 && b.getRows() > 0 && b.getCols() > 0 && rangesOverlap(extent(a), extent(b));
+    }
+
+    // Running sum of per-row counts stored at offsets[i + 1]
+    void prefixSum(std::vector<long long> &offsets)
+    {
+        for (std::size_t i = 1; i < offsets.size(); i++)
+            offsets[i] += offsets[i - 1];
+    }
+}
+
+SparseMatrix::SparseMatrix(int rows, int cols) : rows(rows), cols(cols), rowOffsets(rows < 0 ? 1 : rows + 1, 0)
+{
+    if (rows < 0 || cols < 0)
+    {
+        throw std::invalid_argument("Matrix dimensions must not be negative!");
+    }
+}
+
+SparseMatrix::SparseMatrix(int rows, int cols, std::vector<long long> rowOffsets, std::vector<int> columnIndices, std::vector<double> values)
+    : rows(rows), cols(cols), rowOffsets(std::move(rowOffsets)), columnIndices(std::move(columnIndices)), values(std::move(values))
+{
+    if (rows < 0 || cols < 0)
+    {
+        throw std::invalid_argument("Matrix dimensions must not be negative!");
+    }
+    const std::vector<long long> &offsets = this->rowOffsets;
+    const long long nonZeros = static_cast<long long>(this->columnIndices.size());
+    if (offsets.size() != static_cast<std::size_t>(rows) + 1 || offsets.front() != 0 || offsets.back() != nonZeros ||
+        static_cast<long long>(this->values.size()) != nonZeros)
+    {
+        throw std::invalid_argument("CSR arrays do not match the matrix dimensions!");
+    }
+    for (int i = 0; i < rows; i++)
+    {
+        if (offsets[i] > offsets[i + 1])
+        {
+            throw std::invalid_argument("CSR row offsets must not decrease!");
+        }
+        for (long long k = offsets[i]; k < offsets[i + 1]; k++)
+        {
+            const int col = this->columnIndices[k];
+            if (col < 0 || col >= cols || (k > offsets[i] && col <= this->columnIndices[k - 1]))
+            {
+                throw std::invalid_argument("CSR column indices must be in range and increasing within a row!");
+            }
+        }
+    }
+}
+
+SparseMatrix::SparseMatrix(const Matrix &dense, double dropTolerance)
+    : rows(dense.getRows()), cols(dense.getCols()), rowOffsets(dense.getRows() + 1, 0)
+{
+    // Count, then fill; both passes are row-parallel
+    KaloAlgebraParallel::parallelFor(0, rows, cols, [&](long long first, long long last)
+                                     {
+        for (long long i = first; i < last; i++)
+        {
+            const double *row = dense.rowPtr(static_cast<int>(i));
+            long long count = 0;
+            for (int j = 0; j < cols; j++)
+                count += std::fabs(row[j]) > dropTolerance;
+            rowOffsets[i + 1] = count;
+        } });
+    prefixSum(rowOffsets);
+    columnIndices.resize(rowOffsets[rows]);
+    values.resize(rowOffsets[rows]);
+    KaloAlgebraParallel::parallelFor(0, rows, cols, [&](long long first, long long last)
+                                     {
+        for (long long i = first; i < last; i++)
+        {
+            const double *row = dense.rowPtr(static_cast<int>(i));
+            long long k = rowOffsets[i];
+            for (int j = 0; j < cols; j++)
+            {
+                if (std::fabs(row[j]) > dropTolerance)
+                {
+                    columnIndices[k] = j;
+                    values[k++] = row[j];
+                }
+            }
+        } });
+}
+
+// Bucket the entries by row, sort each row by column (stably, so duplicates are summed in input
+// order), then merge the duplicates
+SparseMatrix SparseMatrix::fromTriplets(int rows, int cols, const std::vector<Triplet> &triplets)
+{
+    SparseMatrix result(rows, cols);
+    std::vector<long long> bucketOffsets(static_cast<std::size_t>(rows) + 1, 0);
+    for (const Triplet &t : triplets)
+    {
+        if (t.row < 0 || t.row >= rows || t.col < 0 || t.col >= cols)
+        {
+            throw std::invalid_argument("Triplet index out of range!");
+        }
+        bucketOffsets[t.row + 1]++;
+    }
+    prefixSum(bucketOffsets);
+
+    std::vector<std::pair<int, double>> entries(triplets.size());
+    std::vector<long long> next(bucketOffsets.begin(), bucketOffsets.end() - 1);
+    for (const Triplet &t : triplets)
+    {
+        entries[next[t.row]++] = {t.col, t.value};
+    }
+
+    std::vector<long long> &offsets = result.rowOffsets;
+    forRowBlocks(bucketOffsets, rows, 8, [&](int rowBegin, int rowEnd)
+                 {
+        for (int i = rowBegin; i < rowEnd; i++)
+        {
+            auto begin = entries.begin() + bucketOffsets[i];
+            auto end = entries.begin() + bucketOffsets[i + 1];
+            std::stable_sort(begin, end, [](const std::pair<int, double> &a, const std::pair<int, double> &b)
+                             { return a.first < b.first; });
+            long long distinct = 0;
+            for (auto it = begin; it != end; ++it)
+                distinct += it == begin || it->first != (it - 1)->first;
+            offsets[i + 1] = distinct;
+        } });
+    prefixSum(offsets);
+
+    result.columnIndices.resize(offsets[rows]);
+    result.values.resize(offsets[rows]);
+    forRowBlocks(bucketOffsets, rows, 1, [&](int rowBegin, int rowEnd)
+                 {
+        for (int i = rowBegin; i < rowEnd; i++)
+        {
+            long long k = offsets[i] - 1;
+            for (long long e = bucketOffsets[i]; e < bucketOffsets[i + 1]; e++)
+            {
+                if (e == bucketOffsets[i] || entries[e].first != entries[e - 1].first)
+                {
+                    result.columnIndices[++k] = entries[e].first;
+                    result.values[k] = entries[e].second;
+                }
+                else
+                {
+                    result.values[k] += entries[e].second;
+                }
+            }
+        } });
+    return result;
+}
+
+SparseMatrix SparseMatrix::fromCSC(const CompressedColumns &csc)
+{
+    // CSC arrays of A are the CSR arrays of A^T
+    return SparseMatrix(csc.cols, csc.rows, csc.colOffsets, csc.rowIndices, csc.values).transpose();
+}
+
+double SparseMatrix::getElement(int row, int col) const
+{
+    if (row < 0 || row >= rows || col < 0 || col >= cols)
+    {
+        throw std::invalid_argument("Index out of range!");
+    }
+    auto begin = columnIndices.begin() + rowOffsets[row];
+    auto end = columnIndices.begin() + rowOffsets[row + 1];
+    auto found = std::lower_bound(begin, end, col);
+    return found != end && *found == col ? values[found - columnIndices.begin()] : 0.0;
+}
+
+Matrix SparseMatrix::toDense() const
+{
+    Matrix dense(rows, cols);
+    forRowBlocks(rowOffsets, rows, 1, [&](int rowBegin, int rowEnd)
+                 {
+        for (int i = rowBegin; i < rowEnd; i++)
+        {
+            double *row = dense.rowPtr(i);
+            for (long long k = rowOffsets[i]; k < rowOffsets[i + 1]; k++)
+                row[columnIndices[k]] = values[k];
+        } });
+    return dense;
+}
+
+// Counting sort by column; walking the rows in order leaves every column sorted by row
+SparseMatrix SparseMatrix::transpose() const
+{
+    KALO_ALGEBRA_INSTRUMENT("SparseMatrix::transpose", std::max(rows, cols), 0.0, 2.0 * getNonZeros() * (sizeof(double) + sizeof(int)));
+    const long long nonZeros = getNonZeros();
+    std::vector<long long> offsets(static_cast<std::size_t>(cols) + 1, 0);
+    for (long long k = 0; k < nonZeros; k++)
+    {
+        offsets[columnIndices[k] + 1]++;
+    }
+    prefixSum(offsets);
+
+    std::vector<int> indices(nonZeros);
+    std::vector<double> transposedValues(nonZeros);
+    std::vector<long long> next(offsets.begin(), offsets.end() - 1);
+    for (int i = 0; i < rows; i++)
+    {
+        for (long long k = rowOffsets[i]; k < rowOffsets[i + 1]; k++)
+        {
+            const long long position = next[columnIndices[k]]++;
+            indices[position] = i;
+            transposedValues[position] = values[k];
+        }
+    }
+    SparseMatrix result(cols, rows);
+    result.rowOffsets = std::move(offsets);
+    result.columnIndices = std::move(indices);
+    result.values = std::move(transposedValues);
+    return result;
+}
+
+SparseMatrix::CompressedColumns SparseMatrix::toCSC() const
+{
+    SparseMatrix t = transpose();
+    return CompressedColumns{rows, cols, std::move(t.rowOffsets), std::move(t.columnIndices), std::move(t.values)};
+}
+
+Vector SparseMatrix::operator*(ConstVectorView x) const
+{
+    Vector y(rows);
+    spmv(1.0, *this, x, 0.0, y);
+    return y;
+}
+
+Matrix SparseMatrix::operator*(ConstMatrixView B) const
+{
+    Matrix C(rows, B.getCols());
+    spmm(1.0, *this, B, 0.0, C);
+    return C;
+}
+
+// One sparse dot product per row
+void spmv(double alpha, const SparseMatrix &A, ConstVectorView x, double beta, VectorView y)
+{
+    KALO_ALGEBRA_INSTRUMENT("spmv", std::max(A.getRows(), A.getCols()), 2.0 * A.getNonZeros(), A.getNonZeros() * (2.0 * sizeof(double) + sizeof(int)) + 2.0 * A.getRows() * sizeof(double));
+    if (A.getCols() != x.getSize() || A.getRows() != y.getSize())
+    {
+        throw std::invalid_argument("Matrix columns must match vector size in order to perform multiplication!");
+    }
+    if (mayOverlap(y, x))
+    {
+        throw std::invalid_argument("Output vector must not be one of the operands!");
+    }
+    const long long *offsets = A.getRowOffsets().data();
+    const int *indices = A.getColumnIndices().data();
+    const double *values = A.getValues().data();
+    const double *input = x.data();
+    const long long incx = x.getIncrement();
+    double *output = y.data();
+    const long long incy = y.getIncrement();
+
+    forRowBlocks(A.getRowOffsets(), A.getRows(), 2, [&](int rowBegin, int rowEnd)
+                 {
+        for (int i = rowBegin; i < rowEnd; i++)
+        {
+            double sum = 0.0;
+            if (incx == 1)
+            {
+                for (long long k = offsets[i]; k < offsets[i + 1]; k++)
+                    sum += values[k] * input[indices[k]];
+            }
+            else
+            {
+                for (long long k = offsets[i]; k < offsets[i + 1]; k++)
+                    sum += values[k] * input[indices[k] * incx];
+            }
+            double &out = output[i * incy];
+            out = beta == 0.0 ? alpha * sum : alpha * sum + beta * out;
+        } });
+}
+
+// Row i of C is a combination of the rows of B picked out by row i of A, one SIMD axpy per entry
+void spmm(double alpha, const SparseMatrix &A, ConstMatrixView B, double beta, MatrixView C)
+{
+    KALO_ALGEBRA_INSTRUMENT("spmm", std::max(A.getRows(), A.getCols()), 2.0 * A.getNonZeros() * B.getCols(), A.getNonZeros() * (sizeof(double) + sizeof(int) + 1.0 * B.getCols() * sizeof(double)) + 2.0 * C.getRows() * C.getCols() * sizeof(double));
+    if (A.getCols() != B.getRows() || A.getRows() != C.getRows() || B.getCols() != C.getCols())
+    {
+        throw std::invalid_argument("Matrix dimensions must match in order to perform multiplication!");
+    }
+    if (mayOverlap(C, B))
+    {
+        throw std::invalid_argument("Output matrix must not be one of the operands!");
+    }
+    const long long *offsets = A.getRowOffsets().data();
+    const int *indices = A.getColumnIndices().data();
+    const double *values = A.getValues().data();
+    const int n = B.getCols();
+    const bool contiguous = B.getColStride() == 1 && C.getColStride() == 1;
+
+    forRowBlocks(A.getRowOffsets(), A.getRows(), 2LL * n, [&](int rowBegin, int rowEnd)
+                 {
+        for (int i = rowBegin; i < rowEnd; i++)
+        {
+            if (contiguous)
+            {
+                double *row = C.elementPtr(i, 0);
+                if (beta == 0.0)
+                    std::fill(row, row + n, 0.0);
+                else if (beta != 1.0)
+                    KaloAlgebraSimd::scale(row, beta, row, static_cast<std::size_t>(n));
+                for (long long k = offsets[i]; k < offsets[i + 1]; k++)
+                    KaloAlgebraSimd::axpy(alpha * values[k], B.elementPtr(indices[k], 0), row, static_cast<std::size_t>(n));
+                continue;
+            }
+            for (int j = 0; j < n; j++)
+            {
+                double sum = 0.0;
+                for (long long k = offsets[i]; k < offsets[i + 1]; k++)
+                    sum += values[k] * *B.elementPtr(indices[k], j);
+                double &out = *C.elementPtr(i, j);
+                out = beta == 0.0 ? alpha * sum : alpha * sum + beta * out;
+            }
+        } });
+}
+
+void multiply(const SparseMatrix &A, ConstVectorView x, Vector &out)
+{
+    if (mayOverlap(out, x))
+    {
+        // An aliased output needs a temporary
+        out = A * x;
+        return;
+    }
+    if (out.getSize() != A.getRows())
+    {
+        out = Vector(A.getRows());
+    }
+    spmv(1.0, A, x, 0.0, out);
+}
+
+void multiply(const SparseMatrix &A, ConstMatrixView B, Matrix &out)
+{
+    if (mayOverlap(out, B))
+    {
+        out = A * B;
+        return;
+    }
+    if (out.getRows() != A.getRows() || out.getCols() != B.getCols())
+    {
+        out = Matrix(A.getRows(), B.getCols());
+    }
+    spmm(1.0, A, B, 0.0, out);
+}
@@ -0,0 +1,302 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace KaloAlgebraParallel
+{
+    namespace
+    {
+        // State shared by all chunks of one runParallel call; it lives on the caller's stack
+        struct Job
+        {
+            const RangeFunction *body;
+            std::atomic<long long> remaining;
+            std::mutex errorMutex;
+            std::exception_ptr error;
+        };
+
+        struct Task
+        {
+            Job *job;
+            long long begin, end;
+        };
+
+        // A worker pops its own tasks from the back (most recently pushed, still warm in cache)
+        // while idle threads steal from the front. The vector keeps its capacity, so queuing
+        // tasks stops allocating once the pool has warmed up.
+        class WorkQueue
+        {
+        private:
+            std::mutex mutex;
+            std::vector<Task> tasks;
+            std::size_t head = 0;
+
+        public:
+            void push(const Task &task)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (head == tasks.size())
+                {
+                    tasks.clear();
+                    head = 0;
+                }
+                tasks.push_back(task);
+            }
+
+            bool popBack(Task &task)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (head == tasks.size())
+                    return false;
+                task = tasks.back();
+                tasks.pop_back();
+                return true;
+            }
+
+            bool stealFront(Task &task)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (head == tasks.size())
+                    return false;
+                task = tasks[head++];
+                return true;
+            }
+
+            // Take any queued chunk of job (used by the thread waiting on that job)
+            bool takeFrom(const Job *job, Task &task)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (std::size_t i = tasks.size(); i > head; i--)
+                {
+                    if (tasks[i - 1].job == job)
+                    {
+                        task = tasks[i - 1];
+                        tasks.erase(tasks.begin() + static_cast<std::ptrdiff_t>(i - 1));
+                        return true;
+                    }
+                }
+                return false;
+            }
+        };
+
+        thread_local bool runningTask = false;
+        thread_local int threadIndex = 0; // 0 outside the pool, i for worker i
+
+        class ThreadPool
+        {
+        private:
+            // Queue 0 belongs to threads outside the pool, queue i to worker i
+            std::vector<std::unique_ptr<WorkQueue>> queues;
+            std::vector<std::thread> workers;
+            std::mutex sleepMutex;
+            std::condition_variable wake;
+            std::atomic<long long> queued{0};
+            bool stopping = false;
+
+            void execute(const Task &task)
+            {
+                const bool wasRunning = runningTask;
+                runningTask = true;
+                try
+                {
+                    (*task.job->body)(task.begin, task.end);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(task.job->errorMutex);
+                    if (!task.job->error)
+                        task.job->error = std::current_exception();
+                }
+                runningTask = wasRunning;
+                task.job->remaining.fetch_sub(1, std::memory_order_acq_rel);
+            }
+
+            // A waiting caller only helps with its own job. That keeps the threads running one job's
+            // chunks distinct by index (the caller is 0, workers are 1..n-1), so kernels can hand each
+            // of them a private slot of caller-owned scratch memory.
+            bool tryRunOwn(const Job *job)
+            {
+                Task task;
+                bool found = false;
+                for (std::size_t i = 0; !found && i < queues.size(); i++)
+                {
+                    found = queues[i]->takeFrom(job, task);
+                }
+                if (!found)
+                    return false;
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                execute(task);
+                return true;
+            }
+
+            bool tryRunOne(std::size_t home)
+            {
+                Task task;
+                bool found = queues[home]->popBack(task);
+                for (std::size_t offset = 1; !found && offset < queues.size(); offset++)
+                {
+                    found = queues[(home + offset) % queues.size()]->stealFront(task);
+                }
+                if (!found)
+                    return false;
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                execute(task);
+                return true;
+            }
+
+            void workerLoop(std::size_t home)
+            {
+                threadIndex = static_cast<int>(home);
+                while (true)
+                {
+                    if (tryRunOne(home))
+                        continue;
+                    std::unique_lock<std::mutex> lock(sleepMutex);
+                    wake.wait(lock, [this]
+                              { return stopping || queued.load() > 0; });
+                    if (stopping && queued.load() == 0)
+                        return;
+                }
+            }
+
+        public:
+            explicit ThreadPool(int threadCount)
+            {
+                for (int i = 0; i < threadCount; i++)
+                {
+                    queues.push_back(std::make_unique<WorkQueue>());
+                }
+                for (int i = 1; i < threadCount; i++)
+                {
+                    workers.emplace_back([this, i]
+                                         { workerLoop(i); });
+                }
+            }
+
+            ~ThreadPool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(sleepMutex);
+                    stopping = true;
+                }
+                wake.notify_all();
+                for (std::thread &worker : workers)
+                {
+                    worker.join();
+                }
+            }
+
+            int size() const
+            {
+                return static_cast<int>(queues.size());
+            }
+
+            void run(long long begin, long long end, long long chunkCount, const RangeFunction &body)
+            {
+                const long long count = end - begin;
+                chunkCount = std::max(1LL, std::min(chunkCount, count));
+
+                Job job;
+                job.body = &body;
+                job.remaining.store(chunkCount);
+
+                // Deal the chunks round-robin so every worker starts with local work
+                for (long long chunk = 0; chunk < chunkCount; chunk++)
+                {
+                    const long long chunkBegin = begin + count * chunk / chunkCount;
+                    const long long chunkEnd = begin + count * (chunk + 1) / chunkCount;
+                    queues[chunk % queues.size()]->push(Task{&job, chunkBegin, chunkEnd});
+                }
+                queued.fetch_add(chunkCount);
+                {
+                    std::lock_guard<std::mutex> lock(sleepMutex);
+                }
+                wake.notify_all();
+
+                // The caller works too instead of blocking, then waits for chunks still in flight
+                while (job.remaining.load(std::memory_order_acquire) > 0)
+                {
+                    if (!tryRunOwn(&job))
+                        std::this_thread::yield();
+                }
+                if (job.error)
+                    std::rethrow_exception(job.error);
+            }
+        };
+
+        int defaultThreadCount()
+        {
+            if (const char *requested = std::getenv("KALO_ALGEBRA_NUM_THREADS"))
+            {
+                const int count = std::atoi(requested);
+                if (count > 0)
+                    return count;
+            }
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        std::atomic<int> threadCount(defaultThreadCount());
+        std::atomic<long long> serialThreshold(1LL << 15);
+
+        // Callers hold a reference while they run, so resizing never pulls the pool out from under them
+        std::mutex poolMutex;
+        std::shared_ptr<ThreadPool> pool;
+
+        std::shared_ptr<ThreadPool> sharedPool()
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            if (!pool || pool->size() != threadCount.load())
+            {
+                pool = std::make_shared<ThreadPool>(threadCount.load());
+            }
+            return pool;
+        }
+    }
+
+    void setThreadCount(int count)
+    {
+        if (count < 0)
+            throw std::invalid_argument("Thread count must not be negative!");
+        threadCount.store(count == 0 ? std::max(1u, std::thread::hardware_concurrency()) : count);
+    }
+
+    int getThreadCount()
+    {
+        return threadCount.load(std::memory_order_relaxed);
+    }
+
+    void setSerialThreshold(long long work)
+    {
+        serialThreshold.store(std::max(0LL, work));
+    }
+
+    long long getSerialThreshold()
+    {
+        return serialThreshold.load(std::memory_order_relaxed);
+    }
+
+    bool insideParallelRegion()
+    {
+        return runningTask;
+    }
+
+    int currentThreadIndex()
+    {
+        return threadIndex;
+    }
+
+    void runParallel(long long begin, long long end, long long chunkCount, const RangeFunction &body)
+    {
+        if (end <= begin)
+            return;
+        sharedPool()->run(begin, end, chunkCount, body);
+    }
+}
@@ -0,0 +1,321 @@
+#include "transpose.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <complex>
+#include <utility>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KALO_ALGEBRA_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// Blocked transpose: the matrix is halved along its longer side until a block fits in L1, then
+// each block is moved tile by tile, with every tile transposed in registers. A tile reads whole
+// row segments and writes whole row segments, unlike the naive loop whose stores each touch a
+// different cache line.
+namespace KaloAlgebraKernels
+{
+    namespace
+    {
+        constexpr int leafBlock = 32; // a 32 x 32 block of doubles is 8 KiB, source and target both fit in L1
+        constexpr int bandWidth = 64; // output rows per parallel task
+        constexpr int maxTile = 8;
+
+        // Transposes one tile: b(j, i) = a(i, j)
+        template <typename T>
+        using TileKernel = void (*)(const T *a, int lda, T *b, int ldb);
+
+        template <typename T, int Size>
+        void tileGeneric(const T *a, int lda, T *b, int ldb)
+        {
+            for (int i = 0; i < Size; i++)
+                for (int j = 0; j < Size; j++)
+                    b[static_cast<long long>(j) * ldb + i] = a[static_cast<long long>(i) * lda + j];
+        }
+
+#ifdef KALO_ALGEBRA_X86_KERNELS
+        // 4 x 4 tile as four 2 x 2 register transposes
+        __attribute__((target("sse2"))) void tileSse2(const double *a, int lda, double *b, int ldb)
+        {
+            for (int i = 0; i < 4; i += 2)
+            {
+                for (int j = 0; j < 4; j += 2)
+                {
+                    const __m128d r0 = _mm_loadu_pd(a + static_cast<long long>(i) * lda + j);
+                    const __m128d r1 = _mm_loadu_pd(a + static_cast<long long>(i + 1) * lda + j);
+                    _mm_storeu_pd(b + static_cast<long long>(j) * ldb + i, _mm_unpacklo_pd(r0, r1));
+                    _mm_storeu_pd(b + static_cast<long long>(j + 1) * ldb + i, _mm_unpackhi_pd(r0, r1));
+                }
+            }
+        }
+
+        __attribute__((target("avx2"))) void tileAvx2(const double *a, int lda, double *b, int ldb)
+        {
+            const __m256d r0 = _mm256_loadu_pd(a);
+            const __m256d r1 = _mm256_loadu_pd(a + lda);
+            const __m256d r2 = _mm256_loadu_pd(a + 2LL * lda);
+            const __m256d r3 = _mm256_loadu_pd(a + 3LL * lda);
+            const __m256d t0 = _mm256_unpacklo_pd(r0, r1); // a00 a10 a02 a12
+            const __m256d t1 = _mm256_unpackhi_pd(r0, r1); // a01 a11 a03 a13
+            const __m256d t2 = _mm256_unpacklo_pd(r2, r3); // a20 a30 a22 a32
+            const __m256d t3 = _mm256_unpackhi_pd(r2, r3); // a21 a31 a23 a33
+            _mm256_storeu_pd(b, _mm256_permute2f128_pd(t0, t2, 0x20));
+            _mm256_storeu_pd(b + ldb, _mm256_permute2f128_pd(t1, t3, 0x20));
+            _mm256_storeu_pd(b + 2LL * ldb, _mm256_permute2f128_pd(t0, t2, 0x31));
+            _mm256_storeu_pd(b + 3LL * ldb, _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+
+        __attribute__((target("avx512f"))) void tileAvx512(const double *a, int lda, double *b, int ldb)
+        {
+            __m512d r[8];
+            for (int i = 0; i < 8; i++)
+                r[i] = _mm512_loadu_pd(a + static_cast<long long>(i) * lda);
+
+            // Pairs of rows interleaved: t[2k] holds (a[2k][2m], a[2k+1][2m]) in 128-bit lane m,
+            // t[2k+1] the odd columns
+            __m512d t[8];
+            for (int k = 0; k < 4; k++)
+            {
+                t[2 * k] = _mm512_unpacklo_pd(r[2 * k], r[2 * k + 1]);
+                t[2 * k + 1] = _mm512_unpackhi_pd(r[2 * k], r[2 * k + 1]);
+            }
+
+            // Gather the 2 x 2 blocks of four rows, then of all eight
+            const __m512d u0 = _mm512_shuffle_f64x2(t[0], t[2], 0x88); // columns 0, 4 of rows 0-3
+            const __m512d u1 = _mm512_shuffle_f64x2(t[0], t[2], 0xDD); // columns 2, 6
+            const __m512d u2 = _mm512_shuffle_f64x2(t[1], t[3], 0x88); // columns 1, 5
+            const __m512d u3 = _mm512_shuffle_f64x2(t[1], t[3], 0xDD); // columns 3, 7
+            const __m512d u4 = _mm512_shuffle_f64x2(t[4], t[6], 0x88); // the same for rows 4-7
+            const __m512d u5 = _mm512_shuffle_f64x2(t[4], t[6], 0xDD);
+            const __m512d u6 = _mm512_shuffle_f64x2(t[5], t[7], 0x88);
+            const __m512d u7 = _mm512_shuffle_f64x2(t[5], t[7], 0xDD);
+
+            _mm512_storeu_pd(b, _mm512_shuffle_f64x2(u0, u4, 0x88));
+            _mm512_storeu_pd(b + ldb, _mm512_shuffle_f64x2(u2, u6, 0x88));
+            _mm512_storeu_pd(b + 2LL * ldb, _mm512_shuffle_f64x2(u1, u5, 0x88));
+            _mm512_storeu_pd(b + 3LL * ldb, _mm512_shuffle_f64x2(u3, u7, 0x88));
+            _mm512_storeu_pd(b + 4LL * ldb, _mm512_shuffle_f64x2(u0, u4, 0xDD));
+            _mm512_storeu_pd(b + 5LL * ldb, _mm512_shuffle_f64x2(u2, u6, 0xDD));
+            _mm512_storeu_pd(b + 6LL * ldb, _mm512_shuffle_f64x2(u1, u5, 0xDD));
+            _mm512_storeu_pd(b + 7LL * ldb, _mm512_shuffle_f64x2(u3, u7, 0xDD));
+        }
+
+        // 4 x 4 float tile with the classic SSE shuffle sequence
+        __attribute__((target("sse2"))) void tileSse2(const float *a, int lda, float *b, int ldb)
+        {
+            __m128 r0 = _mm_loadu_ps(a);
+            __m128 r1 = _mm_loadu_ps(a + lda);
+            __m128 r2 = _mm_loadu_ps(a + 2LL * lda);
+            __m128 r3 = _mm_loadu_ps(a + 3LL * lda);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(b, r0);
+            _mm_storeu_ps(b + ldb, r1);
+            _mm_storeu_ps(b + 2LL * ldb, r2);
+            _mm_storeu_ps(b + 3LL * ldb, r3);
+        }
+
+        // 8 x 8 float tile: interleave pairs of rows, then quadruples, then swap 128-bit halves
+        __attribute__((target("avx2"))) void tileAvx2(const float *a, int lda, float *b, int ldb)
+        {
+            __m256 r[8];
+            for (int i = 0; i < 8; i++)
+                r[i] = _mm256_loadu_ps(a + static_cast<long long>(i) * lda);
+            __m256 t[8];
+            for (int k = 0; k < 4; k++)
+            {
+                t[2 * k] = _mm256_unpacklo_ps(r[2 * k], r[2 * k + 1]);
+                t[2 * k + 1] = _mm256_unpackhi_ps(r[2 * k], r[2 * k + 1]);
+            }
+            __m256 u[8];
+            for (int k = 0; k < 2; k++)
+            {
+                u[4 * k] = _mm256_shuffle_ps(t[4 * k], t[4 * k + 2], _MM_SHUFFLE(1, 0, 1, 0));
+                u[4 * k + 1] = _mm256_shuffle_ps(t[4 * k], t[4 * k + 2], _MM_SHUFFLE(3, 2, 3, 2));
+                u[4 * k + 2] = _mm256_shuffle_ps(t[4 * k + 1], t[4 * k + 3], _MM_SHUFFLE(1, 0, 1, 0));
+                u[4 * k + 3] = _mm256_shuffle_ps(t[4 * k + 1], t[4 * k + 3], _MM_SHUFFLE(3, 2, 3, 2));
+            }
+            for (int j = 0; j < 4; j++)
+            {
+                _mm256_storeu_ps(b + static_cast<long long>(j) * ldb, _mm256_permute2f128_ps(u[j], u[j + 4], 0x20));
+                _mm256_storeu_ps(b + static_cast<long long>(j + 4) * ldb, _mm256_permute2f128_ps(u[j], u[j + 4], 0x31));
+            }
+        }
+#endif
+
+        template <typename T>
+        struct TileInfo
+        {
+            int size;
+            TileKernel<T> kernel;
+        };
+
+        // Register tiles exist for float and double; complex elements are moved by the portable tile
+        template <typename T>
+        TileInfo<T> selectTile()
+        {
+            if constexpr (std::is_same<T, double>::value)
+            {
+                switch (KaloAlgebraSimd::activeIsa())
+                {
+#ifdef KALO_ALGEBRA_X86_KERNELS
+                case KaloAlgebraSimd::Isa::AVX512:
+                    return TileInfo<T>{8, tileAvx512};
+                case KaloAlgebraSimd::Isa::AVX2:
+                    return TileInfo<T>{4, tileAvx2};
+                case KaloAlgebraSimd::Isa::SSE2:
+                    return TileInfo<T>{4, tileSse2};
+#endif
+                default:
+                    break;
+                }
+            }
+            else if constexpr (std::is_same<T, float>::value)
+            {
+                switch (KaloAlgebraSimd::activeIsa())
+                {
+#ifdef KALO_ALGEBRA_X86_KERNELS
+                case KaloAlgebraSimd::Isa::AVX512:
+                case KaloAlgebraSimd::Isa::AVX2:
+                    return TileInfo<T>{8, tileAvx2};
+                case KaloAlgebraSimd::Isa::SSE2:
+                    return TileInfo<T>{4, tileSse2};
+#endif
+                default:
+                    break;
+                }
+            }
+            return TileInfo<T>{4, tileGeneric<T, 4>};
+        }
+
+        // A block that fits in L1: full tiles in registers, the ragged edges element by element
+        template <typename T>
+        void transposeLeaf(const TileInfo<T> &tile, int rows, int cols, const T *A, int lda, T *B, int ldb)
+        {
+            const int t = tile.size;
+            int i = 0;
+            for (; i + t <= rows; i += t)
+            {
+                int j = 0;
+                for (; j + t <= cols; j += t)
+                    tile.kernel(A + static_cast<long long>(i) * lda + j, lda, B + static_cast<long long>(j) * ldb + i, ldb);
+                for (; j < cols; j++)
+                    for (int r = i; r < i + t; r++)
+                        B[static_cast<long long>(j) * ldb + r] = A[static_cast<long long>(r) * lda + j];
+            }
+            for (; i < rows; i++)
+                for (int j = 0; j < cols; j++)
+                    B[static_cast<long long>(j) * ldb + i] = A[static_cast<long long>(i) * lda + j];
+        }
+
+        // Halves the longer side until the block fits in L1; split points stay on tile boundaries
+        template <typename T>
+        void transposeRecursive(const TileInfo<T> &tile, int rows, int cols, const T *A, int lda, T *B, int ldb)
+        {
+            if (rows <= leafBlock && cols <= leafBlock)
+            {
+                transposeLeaf(tile, rows, cols, A, lda, B, ldb);
+                return;
+            }
+            if (rows >= cols)
+            {
+                const int half = rows / 2 / tile.size * tile.size;
+                transposeRecursive(tile, half, cols, A, lda, B, ldb);
+                transposeRecursive(tile, rows - half, cols, A + static_cast<long long>(half) * lda, lda, B + half, ldb);
+            }
+            else
+            {
+                const int half = cols / 2 / tile.size * tile.size;
+                transposeRecursive(tile, rows, half, A, lda, B, ldb);
+                transposeRecursive(tile, rows, cols - half, A + half, lda, B + static_cast<long long>(half) * ldb, ldb);
+            }
+        }
+
+        // Swaps tile (i, j) with tile (j, i), transposing both; for i == j transposes the tile in place
+        template <typename T>
+        void swapTiles(const TileInfo<T> &tile, T *A, int lda, int i, int j)
+        {
+            alignas(64) T buffer[maxTile * maxTile];
+            const int t = tile.size;
+            T *upper = A + static_cast<long long>(i) * lda + j;
+            T *lower = A + static_cast<long long>(j) * lda + i;
+            tile.kernel(upper, lda, buffer, t);
+            if (i != j)
+                tile.kernel(lower, lda, upper, lda);
+            for (int r = 0; r < t; r++)
+                std::copy(buffer + r * t, buffer + (r + 1) * t, lower + static_cast<long long>(r) * lda);
+        }
+
+        // Transposes block row [rowBegin, rowEnd) in place: every element on or above the diagonal
+        // in those rows is swapped with its mirror image below the diagonal
+        template <typename T>
+        void transposeBlockRow(const TileInfo<T> &tile, int n, T *A, int lda, int rowBegin, int rowEnd)
+        {
+            const int t = tile.size;
+            const int full = n / t * t; // rows and columns covered by whole tiles
+            for (int columnBlock = rowBegin; columnBlock < full; columnBlock += leafBlock)
+            {
+                const int columnEnd = std::min(full, columnBlock + leafBlock);
+                for (int i = rowBegin; i + t <= std::min(rowEnd, full); i += t)
+                {
+                    for (int j = std::max(columnBlock, i); j < columnEnd; j += t)
+                        swapTiles(tile, A, lda, i, j);
+                }
+            }
+            for (int r = rowBegin; r < rowEnd; r++)
+            {
+                for (int c = std::max(r + 1, full); c < n; c++)
+                    std::swap(A[static_cast<long long>(r) * lda + c], A[static_cast<long long>(c) * lda + r]);
+            }
+        }
+    }
+
+    template <typename T>
+    void transpose(int rows, int cols, const T *A, int lda, T *B, int ldb)
+    {
+        if (rows <= 0 || cols <= 0)
+            return;
+        const TileInfo<T> tile = selectTile<T>();
+
+        // Each task owns a band of output rows, so no two threads write the same cache line
+        const long long bands = (cols + bandWidth - 1) / bandWidth;
+        KaloAlgebraParallel::parallelFor(0, bands, static_cast<long long>(rows) * bandWidth, [&](long long first, long long last)
+                                         {
+            const int begin = static_cast<int>(first * bandWidth);
+            const int end = static_cast<int>(std::min<long long>(cols, last * bandWidth));
+            transposeRecursive(tile, rows, end - begin, A + begin, lda, B + static_cast<long long>(begin) * ldb, ldb); });
+    }
+
+    template <typename T>
+    void transposeInPlace(int n, T *A, int lda)
+    {
+        if (n <= 1)
+            return;
+        const TileInfo<T> tile = selectTile<T>();
+
+        // Block row k has work proportional to n - k, so each task takes one block row from the top
+        // and its partner from the bottom to keep the tasks even
+        const int blockRows = (n + leafBlock - 1) / leafBlock;
+        const long long pairs = (blockRows + 1) / 2;
+        KaloAlgebraParallel::parallelFor(0, pairs, static_cast<long long>(n) * leafBlock, [&](long long first, long long last)
+                                         {
+            for (long long pair = first; pair < last; pair++)
+            {
+                const int top = static_cast<int>(pair);
+                const int bottom = blockRows - 1 - top;
+                transposeBlockRow(tile, n, A, lda, top * leafBlock, std::min(n, (top + 1) * leafBlock));
+                if (bottom != top)
+                    transposeBlockRow(tile, n, A, lda, bottom * leafBlock, std::min(n, (bottom + 1) * leafBlock));
+            } });
+    }
+
+    template void transpose<float>(int, int, const float *, int, float *, int);
+    template void transpose<double>(int, int, const double *, int, double *, int);
+    template void transpose<std::complex<float>>(int, int, const std::complex<float> *, int, std::complex<float> *, int);
+    template void transpose<std::complex<double>>(int, int, const std::complex<double> *, int, std::complex<double> *, int);
+
+    template void transposeInPlace<float>(int, float *, int);
+    template void transposeInPlace<double>(int, double *, int);
+    template void transposeInPlace<std::complex<float>>(int, std::complex<float> *, int);
+    template void transposeInPlace<std::complex<double>>(int, std::complex<double> *, int);
+}
@@ -1,5 +1,5 @@
 #include "utils.hpp"
-#include <random>
+#include "random.hpp"
 #include <iomanip>
 
 namespace KaloAlgebraUtils
@@ -35,12 +35,14 @@ namespace KaloAlgebraUtils
     }
 
     double randomDouble(double min, double max)
+    {
+        return randomDouble(min, max, threadGenerator());
+    }
+
+    double randomDouble(double min, double max, RandomGenerator &generator)
     {
         if (min > max)
             throw std::invalid_argument("Min must be less or equal to max!");
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<double> dist(min, max);
-        return dist(gen);
+        return generator.uniform(min, max);
     }
 }
\ No newline at end of file
@@ -1,60 +1,99 @@
 #include "vector.hpp"
-#include <random>
+#include "simd.hpp"
+#include "instrumentation.hpp"
+#include <complex>
+
+namespace
+{
+    // Inner product conjugated in its first argument; the same as dot for real vectors
+    template <typename T>
+    T innerProduct(const T *a, const T *b, int size)
+    {
+        if constexpr (KaloAlgebraUtils::ScalarTraits<T>::isComplex)
+        {
+            T sum(0);
+            for (int i = 0; i < size; i++)
+                sum += std::conj(a[i]) * b[i];
+            return sum;
+        }
+        else
+            return KaloAlgebraSimd::dot(a, b, size);
+    }
+}
 
 // constructors
 // Initialize with size and an initial value
-Vector::Vector(int size, double initialValue) : size(size), data(size, initialValue)
+template <typename T>
+BasicVector<T>::BasicVector(int size, T initialValue) : size(size)
 {
     if (size <= 0)
         throw std::invalid_argument("Size must be greater than 0!");
+    storage.assign(size, initialValue);
 }
 
 // Initialize with an existing std::vector
-Vector::Vector(const std::vector<double> &inputData) : size(inputData.size()), data(inputData)
+template <typename T>
+BasicVector<T>::BasicVector(const std::vector<T> &inputData) : storage(inputData.begin(), inputData.end()), size(inputData.size())
 {
     if (size == 0)
         throw std::invalid_argument("Input vector must not be empty!");
 }
 
+// Allocate without writing the elements, for results that are about to be overwritten
+template <typename T>
+BasicVector<T>::BasicVector(int size, Uninitialized) : size(size)
+{
+    if (size <= 0)
+        throw std::invalid_argument("Size must be greater than 0!");
+    storage.resize(size);
+}
+
 // copy constructor
-Vector::Vector(const Vector &other) : size(other.size), data(other.data)
+template <typename T>
+BasicVector<T>::BasicVector(const BasicVector &other) : storage(other.storage), size(other.size)
 {
 }
 
 // move constructor
-Vector::Vector(Vector &&other) noexcept : size(other.size), data(std::move(other.data))
+template <typename T>
+BasicVector<T>::BasicVector(BasicVector &&other) noexcept : storage(std::move(other.storage)), size(other.size)
 {
     other.size = 0;
 }
 
 // destructor
-Vector::~Vector()
+template <typename T>
+BasicVector<T>::~BasicVector()
 {
 }
 
 // Accessors
-int Vector::getSize() const
+template <typename T>
+int BasicVector<T>::getSize() const
 {
     return size;
 }
 
-double Vector::getElement(int index) const
+template <typename T>
+T BasicVector<T>::getElement(int index) const
 {
     if (index < 0 || index >= size)
         throw std::invalid_argument("Index out of range!");
-    return data[index];
+    return storage[index];
 }
 
-void Vector::setElement(int index, double value)
+template <typename T>
+void BasicVector<T>::setElement(int index, T value)
 {
     if (index < 0 || index >= size)
         throw std::invalid_argument("Index out of range!");
-    data[index] = value;
+    storage[index] = value;
 }
 
-void Vector::print() const {
+template <typename T>
+void BasicVector<T>::print() const {
     std::cout << "[ ";
-    for (double value : data) {
+    for (const T &value : storage) {
         std::cout << value << " ";
     }
     std::cout << "]" << std::endl;  
@@ -62,164 +101,235 @@ void Vector::print() const {
 
 
 // vector operations
-double Vector::magnitude() const
+template <typename T>
+typename BasicVector<T>::Real BasicVector<T>::magnitude() const
 {
-    double sumOfSquares = 0.0;
-    for (double value : data)
-    {
-        sumOfSquares += value * value;
-    }
-    return std::sqrt(sumOfSquares);
+    KALO_ALGEBRA_INSTRUMENT("Vector::magnitude", size, 2.0 * size, 1.0 * size * sizeof(T));
+    return std::sqrt(KaloAlgebraSimd::sumOfSquares(data(), size));
 }
 
-Vector Vector::normalize() const
+template <typename T>
+BasicVector<T> BasicVector<T>::normalize() const
 {
+    KALO_ALGEBRA_INSTRUMENT("Vector::normalize", size, 3.0 * size, 2.0 * size * sizeof(T));
 
-    double mag = magnitude();
+    Real mag = magnitude();
     if (mag == 0)
         throw std::invalid_argument("Can't normalize a zero vector!");
-    Vector result(size);
+    BasicVector result(size);
     for (int i = 0; i < size; i++)
 
-        result.data[i] = data[i] / mag;
+        result.storage[i] = storage[i] / mag;
     return result;
 }
 
-double Vector::dot(const Vector &other) const
+template <typename T>
+T BasicVector<T>::dot(const BasicVector &other) const
 {
+    KALO_ALGEBRA_INSTRUMENT("Vector::dot", size, 2.0 * size, 2.0 * size * sizeof(T));
     if (size != other.size)
         throw std::invalid_argument("Vector size must match to perform dot product!");
-    double result = 0.0;
-    for (int i = 0; i < size; i++)
-        result += data[i] * other.data[i];
-    return result;
+    return KaloAlgebraSimd::dot(data(), other.data(), size);
 }
 
-Vector Vector::cross(const Vector &other) const
+template <typename T>
+BasicVector<T> BasicVector<T>::cross(const BasicVector &other) const
 {
+    KALO_ALGEBRA_INSTRUMENT("Vector::cross", size, 9.0, 9.0 * sizeof(T));
     if (size != 3 || other.size != 3)
         throw std::invalid_argument("Cross product is only possible dor 3d vector!");
-    return Vector({data[1] * other.data[2] - data[2] * other.data[1],
-                   data[2] * other.data[0] - data[0] * other.data[2],
-                   data[0] * other.data[1] - data[1] * other.data[0]
+    return BasicVector({storage[1] * other.storage[2] - storage[2] * other.storage[1],
+                        storage[2] * other.storage[0] - storage[0] * other.storage[2],
+                        storage[0] * other.storage[1] - storage[1] * other.storage[0]
 
     });
 }
 
-Vector Vector::projectOnto(const Vector &other) const {
-    double denominator = other.dot(other); 
-    if(denominator == 0) throw std::invalid_argument("Cannot project onto a zero vector!");
-    return other * (this->dot(other) / denominator); 
+// Complex vectors project with the Hermitian inner product, so the result is the closest point on the line
+template <typename T>
+BasicVector<T> BasicVector<T>::projectOnto(const BasicVector &other) const {
+    KALO_ALGEBRA_INSTRUMENT("Vector::projectOnto", size, 5.0 * size, 3.0 * size * sizeof(T));
+    if (size != other.size)
+        throw std::invalid_argument("Vector size must match to perform dot product!");
+    T denominator = innerProduct(other.data(), other.data(), size); 
+    if(denominator == T(0)) throw std::invalid_argument("Cannot project onto a zero vector!");
+    return other * (innerProduct(other.data(), data(), size) / denominator); 
 }
 
-Vector Vector::hadamard(const Vector &other) const {
+template <typename T>
+BasicVector<T> BasicVector<T>::hadamard(const BasicVector &other) const {
+    KALO_ALGEBRA_INSTRUMENT("Vector::hadamard", size, 1.0 * size, 3.0 * size * sizeof(T));
     if (size != other.size) 
         throw std::invalid_argument("Vectors must be of the same size!");
     
-    Vector result(size); 
-    for (int i = 0; i < size; i++) 
-        result.data[i] = data[i] * other.data[i];
+    BasicVector result(size, Uninitialized()); 
+    KaloAlgebraSimd::multiply(data(), other.data(), result.data(), size);
     
     return result; 
 }
 
 
-// Arithmetic operators
-Vector Vector::operator+(const Vector &other) const
-{
-    if (size != other.size)
-    {
-        throw std::invalid_argument("Vectors must be the same size for addition.");
-    }
-    Vector result(size);
-    for (int i = 0; i < size; i++)
-        result.data[i] = data[i] + other.data[i];
-    return result;
-}
-
-Vector Vector::operator-(const Vector &other) const
-{
-    if (size != other.size)
-    {
-        throw std::invalid_argument("Vectors must be the same size for subtraction.");
-    }
-    Vector result(size);
-    for (int i = 0; i < size; i++)
-        result.data[i] = data[i] - other.data[i];
-    return result;
-}
-
-Vector Vector::operator*(double scalar) const
-{
-    Vector result(size);
-    for (int i = 0; i < size; i++)
-        result.data[i] = data[i] * scalar;
-    return result;
-}
-
-double Vector::operator*(const Vector &other) const
-{
-    if (size != other.size)
-        throw std::invalid_argument("Vector size must match to perform dot product!");
-    double result = 0.0;
-    for (int i = 0; i < size; i++)
-        result += data[i] * other.data[i];
-    return result;
-}
-
 // Assignment operators
-Vector &Vector::operator=(const Vector &other)
+template <typename T>
+BasicVector<T> &BasicVector<T>::operator=(const BasicVector &other)
 {
+    KALO_ALGEBRA_INSTRUMENT("Vector::copy", other.size, 0.0, 2.0 * other.size * sizeof(T));
     if (this != &other)
     {
         size = other.size;
-        data = other.data;
+        storage = other.storage;
     }
 
     return *this;
 }
 
-Vector &Vector::operator=(Vector &&other) noexcept
+template <typename T>
+BasicVector<T> &BasicVector<T>::operator=(BasicVector &&other)
 {
     if (this != &other)
     {
         size = other.size;
-        data = std::move(other.data);
+        storage = std::move(other.storage);
         other.size = 0;
     }
     return *this;
 }
 
-// Comparision operators
-bool Vector::operator==(const Vector &other) const
+// Compound assignment
+template <typename T>
+BasicVector<T> &BasicVector<T>::operator*=(T scalar)
 {
-    return size == other.size && data == other.data;
+    scal(scalar, *this);
+    return *this;
 }
 
-bool Vector::operator!=(const Vector &other) const
+template <typename T>
+BasicVector<T> &BasicVector<T>::operator/=(T scalar)
 {
-    return !(*this == other);
+    KALO_ALGEBRA_INSTRUMENT("Vector::operator/=", size, 1.0 * size, 2.0 * size * sizeof(T));
+    T *values = data();
+    KaloAlgebraParallel::parallelFor(0, size, 1, [&](long long first, long long last)
+                                     {
+        for (long long i = first; i < last; i++)
+            values[i] /= scalar; });
+    return *this;
 }
 
 // static methods
-Vector Vector::zero(int size)
+template <typename T>
+BasicVector<T> BasicVector<T>::zero(int size)
 {
     if (size <= 0)
         throw std::invalid_argument("Vector size must be greater than 0!");
-    return Vector(size, 0.0);
+    return BasicVector(size, T(0));
 }
 
-Vector Vector::random(int size, double min, double max)
+template <typename T>
+BasicVector<T> BasicVector<T>::random(int size, Real min, Real max)
 {
+    return random(size, min, max, KaloAlgebraUtils::threadGenerator());
+}
+
+template <typename T>
+BasicVector<T> BasicVector<T>::random(int size, Real min, Real max, KaloAlgebraUtils::RandomGenerator &generator)
+{
+    KALO_ALGEBRA_INSTRUMENT("Vector::random", size, 0.0, 1.0 * size * sizeof(T));
     if (size <= 0 || min > max)
         throw std::invalid_argument("Invalid size or range!");
-    Vector result(size);
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<double> dist(min, max);
-    for (int i = 0; i < size; i++)
+    BasicVector result(size, Uninitialized());
+    generator.fillUniform(result.data(), static_cast<std::size_t>(size), min, max);
+    return result;
+}
+
+// Output-parameter operations
+template <typename T>
+void add(const BasicVector<T> &a, const BasicVector<T> &b, BasicVector<T> &out)
+{
+    KALO_ALGEBRA_INSTRUMENT("Vector::add", a.getSize(), 1.0 * a.getSize(), 3.0 * a.getSize() * sizeof(T));
+    out = a + b;
+}
+
+template <typename T>
+void subtract(const BasicVector<T> &a, const BasicVector<T> &b, BasicVector<T> &out)
+{
+    KALO_ALGEBRA_INSTRUMENT("Vector::subtract", a.getSize(), 1.0 * a.getSize(), 3.0 * a.getSize() * sizeof(T));
+    out = a - b;
+}
+
+template <typename T>
+void hadamard(const BasicVector<T> &a, const BasicVector<T> &b, BasicVector<T> &out)
+{
+    KALO_ALGEBRA_INSTRUMENT("Vector::hadamard", a.getSize(), 1.0 * a.getSize(), 3.0 * a.getSize() * sizeof(T));
+    if (a.getSize() != b.getSize())
+        throw std::invalid_argument("Vectors must be of the same size!");
+    if (out.getSize() != a.getSize())
+        out = BasicVector<T>(a.getSize());
+    KaloAlgebraSimd::multiply(a.data(), b.data(), out.data(), a.getSize());
+}
+
+template <typename T>
+void axpy(T alpha, VectorViewOf<const T> x, VectorViewOf<T> y)
+{
+    KALO_ALGEBRA_INSTRUMENT("Vector::axpy", x.getSize(), 2.0 * x.getSize(), 3.0 * x.getSize() * sizeof(T));
+    if (x.getSize() != y.getSize())
+        throw std::invalid_argument("Vectors must be the same size for axpy.");
+    const T *in = x.data();
+    T *out = y.data();
+    if (x.getIncrement() == 1 && y.getIncrement() == 1)
     {
-        result.data[i] = dist(gen);
+        KaloAlgebraParallel::parallelFor(0, y.getSize(), 2, [&](long long first, long long last)
+                                         { KaloAlgebraSimd::axpy(alpha, in + first, out + first, static_cast<std::size_t>(last - first)); });
+        return;
     }
-    return result;
+    const long long incX = x.getIncrement(), incY = y.getIncrement();
+    KaloAlgebraParallel::parallelFor(0, y.getSize(), 2, [&](long long first, long long last)
+                                     {
+        for (long long i = first; i < last; i++)
+            out[i * incY] += alpha * in[i * incX]; });
 }
+
+template <typename T>
+void scal(T alpha, VectorViewOf<T> x)
+{
+    KALO_ALGEBRA_INSTRUMENT("Vector::scal", x.getSize(), 1.0 * x.getSize(), 2.0 * x.getSize() * sizeof(T));
+    T *values = x.data();
+    if (x.getIncrement() == 1)
+    {
+        KaloAlgebraParallel::parallelFor(0, x.getSize(), 1, [&](long long first, long long last)
+                                         { KaloAlgebraSimd::scale(values + first, alpha, values + first, static_cast<std::size_t>(last - first)); });
+        return;
+    }
+    const long long increment = x.getIncrement();
+    KaloAlgebraParallel::parallelFor(0, x.getSize(), 1, [&](long long first, long long last)
+                                     {
+        for (long long i = first; i < last; i++)
+            values[i * increment] *= alpha; });
+}
+
+template <typename T>
+T KaloAlgebraExpressions::dotProduct(BasicVectorView<const T> left, BasicVectorView<const T> right)
+{
+    if (left.getSize() != right.getSize())
+        throw std::invalid_argument("Vector size must match to perform dot product!");
+    if (left.getIncrement() == 1 && right.getIncrement() == 1)
+        return KaloAlgebraSimd::dot(left.data(), right.data(), left.getSize());
+    T sum = T(0);
+    for (int i = 0; i < left.getSize(); i++)
+        sum += left.evaluate(i) * right.evaluate(i);
+    return sum;
+}
+
+// Explicit instantiations for the supported scalar types
+#define KALO_ALGEBRA_INSTANTIATE_VECTOR(T)                                                            \
+    template class BasicVector<T>;                                                                    \
+    template void add<T>(const BasicVector<T> &, const BasicVector<T> &, BasicVector<T> &);           \
+    template void subtract<T>(const BasicVector<T> &, const BasicVector<T> &, BasicVector<T> &);      \
+    template void hadamard<T>(const BasicVector<T> &, const BasicVector<T> &, BasicVector<T> &);      \
+    template void axpy<T>(T, VectorViewOf<const T>, VectorViewOf<T>);                                 \
+    template void scal<T>(T, VectorViewOf<T>);                                                        \
+    template T KaloAlgebraExpressions::dotProduct<T>(BasicVectorView<const T>, BasicVectorView<const T>);
+
+KALO_ALGEBRA_INSTANTIATE_VECTOR(float)
+KALO_ALGEBRA_INSTANTIATE_VECTOR(double)
+KALO_ALGEBRA_INSTANTIATE_VECTOR(std::complex<float>)
+KALO_ALGEBRA_INSTANTIATE_VECTOR(std::complex<double>)
@@ -0,0 +1,383 @@
+#include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+#include "kalo_algebra.hpp"
+
+// Every heap allocation in the process goes through these replacements, so a test can check
+// that a piece of code did not allocate at all
+static std::atomic<long long> allocationCount{0};
+
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    const std::size_t rounded = (size + align - 1) / align * align;
+    if (void *pointer = std::aligned_alloc(align, rounded ? rounded : align))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+// One step of a training loop written with the in-place and output-parameter APIs
+void trainingStep(KaloAlgebra::Matrix &weights, const KaloAlgebra::Matrix &gradient,
+                  const KaloAlgebra::Matrix &input, KaloAlgebra::Matrix &activations,
+                  KaloAlgebra::Vector &bias, const KaloAlgebra::Vector &biasGradient,
+                  KaloAlgebra::Vector &scratch, KaloAlgebra::Vector &hidden, double learningRate)
+{
+    KaloAlgebra::multiply(input, weights, activations);
+    weights -= gradient * learningRate;
+    KaloAlgebra::axpy(-learningRate, gradient, weights);
+    KaloAlgebra::scal(0.999, weights);
+    weights *= 1.0;
+    weights /= 1.0;
+    KaloAlgebra::add(activations, activations, activations);
+    KaloAlgebra::subtract(activations, activations, activations);
+
+    bias -= biasGradient * learningRate;
+    bias += biasGradient;
+    KaloAlgebra::axpy(-learningRate, biasGradient, bias);
+    KaloAlgebra::scal(0.5, bias);
+    bias *= 2.0;
+    bias /= 2.0;
+    KaloAlgebra::add(bias, biasGradient, scratch);
+    KaloAlgebra::subtract(bias, biasGradient, scratch);
+    KaloAlgebra::hadamard(bias, biasGradient, scratch);
+
+    KaloAlgebra::multiply(weights, bias, hidden);
+    KaloAlgebra::gemv(1.0, weights, bias, 0.5, hidden);
+    KaloAlgebra::ger(-learningRate, hidden, biasGradient, weights);
+}
+
+void testCompoundOperators()
+{
+    KaloAlgebra::Matrix a = KaloAlgebra::Matrix::random(7, 5, -1.0, 1.0);
+    KaloAlgebra::Matrix b = KaloAlgebra::Matrix::random(7, 5, -1.0, 1.0);
+    KaloAlgebra::Vector u = KaloAlgebra::Vector::random(11, -1.0, 1.0);
+    KaloAlgebra::Vector v = KaloAlgebra::Vector::random(11, -1.0, 1.0);
+
+    // Compound forms give the same bits as the expressions they abbreviate
+    KaloAlgebra::Matrix m = a;
+    m -= b * 0.25;
+    bool ok = m == KaloAlgebra::Matrix(a - b * 0.25);
+    m = a;
+    m += b;
+    ok = ok && m == KaloAlgebra::Matrix(a + b);
+    m = a;
+    m *= 3.0;
+    ok = ok && m == KaloAlgebra::Matrix(a * 3.0);
+    m /= 3.0;
+    for (int i = 0; i < a.getRows(); i++)
+        for (int j = 0; j < a.getCols(); j++)
+            ok = ok && m.getElement(i, j) == a.getElement(i, j) * 3.0 / 3.0;
+
+    KaloAlgebra::Vector w = u;
+    w -= v * 0.25;
+    ok = ok && w == KaloAlgebra::Vector(u - v * 0.25);
+    w = u;
+    w += v;
+    ok = ok && w == KaloAlgebra::Vector(u + v);
+    w = u;
+    w *= 3.0;
+    ok = ok && w == KaloAlgebra::Vector(u * 3.0);
+
+    // axpy may use a fused multiply-add, so it is only compared approximately
+    KaloAlgebra::axpy(2.0, v, w);
+    for (int i = 0; i < w.getSize(); i++)
+        ok = ok && KaloAlgebra::approximatelyEquals(w.getElement(i), u.getElement(i) * 3.0 + 2.0 * v.getElement(i), 1e-12);
+
+    // Output parameters of the wrong shape are resized, aliased outputs still get the right answer
+    KaloAlgebra::Matrix product(1, 1);
+    KaloAlgebra::Matrix square = KaloAlgebra::Matrix::random(5, 5, -1.0, 1.0);
+    KaloAlgebra::multiply(a, square, product);
+    ok = ok && product == a * square;
+    KaloAlgebra::Matrix expected = a * square;
+    KaloAlgebra::multiply(a, square, a);
+    ok = ok && a == expected;
+
+    bool threw = false;
+    try
+    {
+        m += square;
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    ok = ok && threw;
+
+    if (ok)
+        std::cout << "Compound Operators Test PASSED" << std::endl;
+    else
+        std::cout << "Compound Operators Test FAILED" << std::endl;
+}
+
+void testSteadyStateAllocations()
+{
+    // Run on several threads with every operation dispatched to the pool, so the pool's own
+    // bookkeeping is covered too
+    const int previousThreads = KaloAlgebra::getThreadCount();
+    const long long previousThreshold = KaloAlgebra::getSerialThreshold();
+    KaloAlgebra::setThreadCount(4);
+    KaloAlgebra::setSerialThreshold(0);
+
+    bool ok = true;
+    {
+        KaloAlgebra::Matrix weights = KaloAlgebra::Matrix::random(96, 80, -1.0, 1.0);
+        KaloAlgebra::Matrix gradient = KaloAlgebra::Matrix::random(96, 80, -1.0, 1.0);
+        KaloAlgebra::Matrix input = KaloAlgebra::Matrix::random(64, 96, -1.0, 1.0);
+        KaloAlgebra::Matrix activations(64, 80);
+        KaloAlgebra::Vector bias = KaloAlgebra::Vector::random(80, -1.0, 1.0);
+        KaloAlgebra::Vector biasGradient = KaloAlgebra::Vector::random(80, -1.0, 1.0);
+        KaloAlgebra::Vector scratch(80);
+        KaloAlgebra::Vector hidden(96);
+
+        // Warm-up: starts the pool threads and grows the packing buffers and task queues
+        for (int step = 0; step < 20; step++)
+            trainingStep(weights, gradient, input, activations, bias, biasGradient, scratch, hidden, 1e-3);
+
+        const long long before = allocationCount.load();
+        for (int step = 0; step < 200; step++)
+            trainingStep(weights, gradient, input, activations, bias, biasGradient, scratch, hidden, 1e-3);
+        const long long allocations = allocationCount.load() - before;
+        if (allocations != 0)
+        {
+            std::cout << "  " << allocations << " allocations in the steady-state loop" << std::endl;
+            ok = false;
+        }
+    }
+
+    KaloAlgebra::setThreadCount(previousThreads);
+    KaloAlgebra::setSerialThreshold(previousThreshold);
+
+    if (ok)
+        std::cout << "Steady-State Allocations Test PASSED" << std::endl;
+    else
+        std::cout << "Steady-State Allocations Test FAILED" << std::endl;
+}
+
+void testFixedSizeAllocations()
+{
+    // A rigid-body style update: fixed-size values live on the stack, so nothing allocates at all
+    KaloAlgebra::Vector3 position(0.0, 1.0, 2.0), velocity(1.0, 0.0, -1.0), angular(0.0, 0.0, 0.1);
+    KaloAlgebra::Matrix3 orientation = KaloAlgebra::Matrix3::identity();
+    const KaloAlgebra::Vector3 gravity(0.0, -9.81, 0.0);
+    const double dt = 1e-3;
+
+    const auto step = [&]()
+    {
+        velocity += gravity * dt;
+        position += velocity * dt + angular.cross(position) * dt;
+        orientation = orientation * (KaloAlgebra::Matrix3::identity() + KaloAlgebra::Matrix3(0.0, -angular[2], angular[1], angular[2], 0.0, -angular[0], -angular[1], angular[0], 0.0) * dt);
+        KaloAlgebra::axpy(dt, velocity, position);
+    };
+
+    step(); // Warm-up: an instrumented build creates its counters on the first call
+    const long long before = allocationCount.load();
+    for (int i = 0; i < 1000; i++)
+        step();
+    const long long allocations = allocationCount.load() - before;
+    const bool ok = allocations == 0 && std::isfinite(position.magnitude() + orientation.determinant());
+
+    if (ok)
+        std::cout << "Fixed-Size Allocations Test PASSED" << std::endl;
+    else
+        std::cout << "Fixed-Size Allocations Test FAILED" << std::endl;
+}
+
+void testIterativeSolverAllocations()
+{
+    // Repeated solves reuse the solver's workspace: no method allocates, on the pool or with a
+    // preconditioner
+    const int previousThreads = KaloAlgebra::getThreadCount();
+    const long long previousThreshold = KaloAlgebra::getSerialThreshold();
+    KaloAlgebra::setThreadCount(4);
+    KaloAlgebra::setSerialThreshold(0);
+
+    bool ok = true;
+    {
+        const int n = 500;
+        std::vector<KaloAlgebra::SparseMatrix::Triplet> triplets;
+        for (int i = 0; i < n; i++)
+        {
+            triplets.push_back({i, i, 3.0});
+            if (i > 0)
+                triplets.push_back({i, i - 1, -1.2});
+            if (i + 1 < n)
+                triplets.push_back({i, i + 1, -0.8});
+        }
+        const KaloAlgebra::SparseMatrix A = KaloAlgebra::SparseMatrix::fromTriplets(n, n, triplets);
+        const KaloAlgebra::ILU0Preconditioner ilu(A);
+        const KaloAlgebra::JacobiPreconditioner jacobi(A);
+        const KaloAlgebra::LinearOperator apply = [&A](KaloAlgebra::ConstVectorView in, KaloAlgebra::VectorView out)
+        { KaloAlgebra::spmv(1.0, A, in, 0.0, out); };
+        const KaloAlgebra::Vector b = KaloAlgebra::Vector::random(n, -1.0, 1.0);
+        KaloAlgebra::Vector x(n);
+
+        for (KaloAlgebra::IterativeMethod method : {KaloAlgebra::IterativeMethod::ConjugateGradient, KaloAlgebra::IterativeMethod::BiCGSTAB, KaloAlgebra::IterativeMethod::GMRES})
+        {
+            KaloAlgebra::IterativeSolver solver(method, n, 20);
+            solver.setMaxIterations(60);
+            solver.setTolerance(0.0); // Always run every iteration
+            solver.setPreconditioner(method == KaloAlgebra::IterativeMethod::GMRES ? static_cast<const KaloAlgebra::Preconditioner *>(&ilu) : &jacobi);
+            const auto solves = [&]()
+            {
+                x *= 0.0;
+                solver.solve(apply, b, x);
+                solver.solve(A, b, x);
+            };
+            solves(); // Warm-up: an instrumented build creates its counters on the first call
+            const long long before = allocationCount.load();
+            for (int i = 0; i < 5; i++)
+                solves();
+            const long long allocations = allocationCount.load() - before;
+            if (allocations != 0)
+            {
+                std::cout << "  " << allocations << " allocations in iterative solves" << std::endl;
+                ok = false;
+            }
+        }
+    }
+
+    KaloAlgebra::setThreadCount(previousThreads);
+    KaloAlgebra::setSerialThreshold(previousThreshold);
+
+    if (ok)
+        std::cout << "Iterative Solver Allocations Test PASSED" << std::endl;
+    else
+        std::cout << "Iterative Solver Allocations Test FAILED" << std::endl;
+}
+
+// Value-returning arithmetic: every line allocates a result or a temporary
+double temporariesStep(const KaloAlgebra::Matrix &a, const KaloAlgebra::Matrix &b, const KaloAlgebra::Vector &x)
+{
+    KaloAlgebra::Matrix product = a * b;
+    KaloAlgebra::Matrix sum = product + a * 0.5;
+    KaloAlgebra::Matrix transposed = sum.transpose();
+    KaloAlgebra::Vector y = transposed * x;
+    KaloAlgebra::Vector z = y * 2.0 - x;
+    return z.dot(x) + product.getElement(0, 0);
+}
+
+void testArenaScope()
+{
+    const int previousThreads = KaloAlgebra::getThreadCount();
+    const long long previousThreshold = KaloAlgebra::getSerialThreshold();
+    KaloAlgebra::setThreadCount(4);
+    KaloAlgebra::setSerialThreshold(0);
+
+    bool ok = true;
+    {
+        KaloAlgebra::Matrix a = KaloAlgebra::Matrix::random(48, 48, -1.0, 1.0);
+        KaloAlgebra::Matrix b = KaloAlgebra::Matrix::random(48, 48, -1.0, 1.0);
+        KaloAlgebra::Vector x = KaloAlgebra::Vector::random(48, -1.0, 1.0);
+        const double expected = temporariesStep(a, b, x);
+        KaloAlgebra::Matrix kept(48, 48);
+
+        // Warm-up grows the arena chunks, the pool queues and the packing buffers
+        for (int step = 0; step < 5; step++)
+        {
+            KaloAlgebra::ArenaScope scope;
+            temporariesStep(a, b, x);
+        }
+
+        const long long before = allocationCount.load();
+        double result = 0.0;
+        for (int step = 0; step < 100; step++)
+        {
+            KaloAlgebra::ArenaScope scope;
+            result = temporariesStep(a, b, x);
+            kept = a * b; // kept lives outside the scope, so the product is copied into its heap storage
+        }
+        const long long allocations = allocationCount.load() - before;
+        if (allocations != 0)
+        {
+            std::cout << "  " << allocations << " heap allocations inside arena scopes" << std::endl;
+            ok = false;
+        }
+        ok = ok && result == expected && kept == a * b && kept.getResource() == KaloAlgebra::heapResource();
+
+        // Nested scopes only release their own allocations; copies taken after a scope use the heap
+        KaloAlgebra::Arena &arena = KaloAlgebra::threadArena();
+        const std::size_t baseline = arena.getBytesUsed();
+        {
+            KaloAlgebra::ArenaScope outer;
+            KaloAlgebra::Matrix outerTemporary = a + b;
+            const std::size_t afterOuter = arena.getBytesUsed();
+            {
+                KaloAlgebra::ArenaScope inner;
+                KaloAlgebra::Matrix innerTemporary = a - b;
+                ok = ok && innerTemporary.getResource() == &arena && arena.getBytesUsed() > afterOuter;
+            }
+            ok = ok && arena.getBytesUsed() == afterOuter && outerTemporary == a + b && outerTemporary.getResource() == &arena;
+            ok = ok && KaloAlgebra::currentResource() == &arena;
+        }
+        ok = ok && arena.getBytesUsed() == baseline && KaloAlgebra::currentResource() == KaloAlgebra::heapResource();
+
+        // A parallel decomposition in a scope: the TSQR leaves are factored on the pool threads,
+        // which must not allocate from this thread's arena
+        KaloAlgebra::Matrix tall = KaloAlgebra::Matrix::random(20000, 16, -1.0, 1.0);
+        KaloAlgebra::Vector rhs = KaloAlgebra::Vector::random(20000, -1.0, 1.0);
+        const KaloAlgebra::QRDecomposition heapQR(tall);
+        KaloAlgebra::Matrix scopedR(16, 16);
+        KaloAlgebra::Vector scopedSolution(16);
+        for (int step = 0; step < 3; step++)
+        {
+            KaloAlgebra::ArenaScope scope;
+            KaloAlgebra::QRDecomposition qr(tall);
+            scopedR = qr.getR();
+            scopedSolution = qr.leastSquares(rhs);
+        }
+        ok = ok && scopedR == heapQR.getR() && scopedSolution == heapQR.leastSquares(rhs) && arena.getBytesUsed() == baseline;
+
+        // Any MemoryResource can be plugged in
+        KaloAlgebra::Arena local(4096);
+        {
+            KaloAlgebra::ResourceScope scope(local);
+            KaloAlgebra::Vector big(10000, 1.0); // larger than a chunk: gets a chunk of its own
+            KaloAlgebra::Vector copy = big;
+            ok = ok && big.getResource() == &local && copy.getResource() == &local && copy.dot(big) == 10000.0;
+        }
+        ok = ok && local.getCapacity() >= 2 * 10000 * sizeof(double);
+        local.reset();
+        ok = ok && local.getBytesUsed() == 0;
+    }
+
+    KaloAlgebra::setThreadCount(previousThreads);
+    KaloAlgebra::setSerialThreshold(previousThreshold);
+
+    if (ok)
+        std::cout << "Arena Scope Test PASSED" << std::endl;
+    else
+        std::cout << "Arena Scope Test FAILED" << std::endl;
+}
+
+int main()
+{
+    testCompoundOperators();
+    testSteadyStateAllocations();
+    testFixedSizeAllocations();
+    testIterativeSolverAllocations();
+    testArenaScope();
+    return 0;
+}
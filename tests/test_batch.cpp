@@ -0,0 +1,180 @@
+#include <iostream>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "kalo_algebra.hpp"
+
+using KaloAlgebra::BasicMatrix;
+using KaloAlgebra::BasicMatrixBatch;
+using KaloAlgebra::BasicVector;
+using KaloAlgebra::BasicVectorBatch;
+
+// 37 items: not a multiple of the lanes for either scalar type, so the last block is partial
+const int itemCount = 37;
+
+template <typename T>
+double maxDifference(const BasicMatrix<T> &a, const BasicMatrix<T> &b)
+{
+    double difference = 0.0;
+    for (int i = 0; i < a.getRows(); i++)
+        for (int j = 0; j < a.getCols(); j++)
+            difference = std::max(difference, static_cast<double>(std::abs(a.getElement(i, j) - b.getElement(i, j))));
+    return difference;
+}
+
+template <typename T>
+BasicMatrixBatch<T> randomBatch(std::vector<BasicMatrix<T>> &items, int rows, int cols)
+{
+    BasicMatrixBatch<T> batch(itemCount, rows, cols);
+    items.clear();
+    for (int m = 0; m < itemCount; m++)
+    {
+        items.push_back(BasicMatrix<T>::random(rows, cols, -1.0, 1.0));
+        batch.setMatrix(m, items.back());
+    }
+    return batch;
+}
+
+template <typename T>
+bool checkOperations(double tolerance)
+{
+    std::vector<BasicMatrix<T>> a, b, c;
+    const BasicMatrixBatch<T> A = randomBatch(a, 3, 4), B = randomBatch(b, 4, 2), C = randomBatch(c, 3, 4);
+    BasicVectorBatch<T> x(itemCount, 4);
+    std::vector<BasicVector<T>> xs;
+    for (int m = 0; m < itemCount; m++)
+    {
+        xs.push_back(BasicVector<T>::random(4, -1.0, 1.0));
+        x.setVector(m, xs.back());
+    }
+
+    const BasicMatrixBatch<T> product = A * B, sum = A + C, difference = A - C, transposed = A.transpose();
+    const BasicVectorBatch<T> y = A * x;
+    bool ok = product.getRows() == 3 && product.getCols() == 2 && transposed.getRows() == 4 && y.getSize() == 3;
+    for (int m = 0; m < itemCount && ok; m++)
+    {
+        ok = maxDifference<T>(product.getMatrix(m), a[m] * b[m]) < tolerance &&
+             maxDifference<T>(sum.getMatrix(m), a[m] + c[m]) < tolerance &&
+             maxDifference<T>(difference.getMatrix(m), a[m] - c[m]) < tolerance &&
+             maxDifference<T>(transposed.getMatrix(m), a[m].transpose()) < tolerance;
+        const BasicVector<T> expected = a[m] * xs[m];
+        for (int i = 0; i < 3; i++)
+            ok = ok && std::abs(y.getElement(m, i) - expected.getElement(i)) < tolerance;
+    }
+
+    // Diagonally dominant, with a zero on the diagonal of some items so that they must pivot
+    std::vector<BasicMatrix<T>> s;
+    BasicMatrixBatch<T> S = randomBatch(s, 4, 4);
+    for (int m = 0; m < itemCount; m++)
+    {
+        for (int i = 0; i < 4; i++)
+            s[m].setElement(i, (i + m) % 4, s[m].getElement(i, (i + m) % 4) + T(4));
+        S.setMatrix(m, s[m]);
+    }
+    const BasicMatrixBatch<T> inverse = S.inverse();
+    for (int m = 0; m < itemCount && ok; m++)
+        ok = maxDifference<T>(inverse.getMatrix(m), s[m].inverse()) < tolerance &&
+             maxDifference<T>(s[m] * inverse.getMatrix(m), BasicMatrix<T>::identity(4)) < tolerance;
+
+    // The output-parameter form reuses an output of the right shape
+    BasicMatrixBatch<T> out(itemCount, 3, 2);
+    const T *storage = out.data();
+    multiply(A, B, out);
+    ok = ok && out.data() == storage && maxDifference<T>(out.getMatrix(itemCount - 1), a.back() * b.back()) < tolerance;
+    return ok;
+}
+
+void testBatchedOperations()
+{
+    bool ok = true;
+    for (KaloAlgebra::Isa isa : {KaloAlgebra::Isa::Scalar, KaloAlgebra::Isa::SSE2, KaloAlgebra::Isa::AVX2, KaloAlgebra::Isa::AVX512})
+    {
+        if (!KaloAlgebra::isIsaSupported(isa))
+            continue;
+        KaloAlgebra::forceIsa(isa);
+        ok = ok && checkOperations<double>(1e-10) && checkOperations<float>(1e-4);
+    }
+    KaloAlgebra::resetIsa();
+    if (ok)
+    {
+        std::cout << "testBatchedOperations PASSED\n";
+    }
+    else
+    {
+        std::cout << "testBatchedOperations FAILED\n";
+    }
+}
+
+void testLayoutAndErrors()
+{
+    KaloAlgebra::MatrixBatch batch(20, 2, 3);
+    batch.setElement(9, 1, 2, 5.0);
+    const int lanes = KaloAlgebra::MatrixBatch::lanes;
+    bool ok = lanes == 8 && batch.getBlockCount() == 3 && batch.getElement(9, 1, 2) == 5.0 &&
+              batch.data()[((9 / lanes) * 6 + 1 * 3 + 2) * lanes + 9 % lanes] == 5.0;
+
+    // A singular item anywhere in the batch
+    KaloAlgebra::MatrixBatch singular = KaloAlgebra::MatrixBatch::identity(20, 3);
+    singular.setElement(17, 2, 2, 0.0);
+    int failures = 0;
+    try
+    {
+        singular.inverse();
+    }
+    catch (const std::invalid_argument &)
+    {
+        failures++;
+    }
+    try
+    {
+        batch.getElement(20, 0, 0);
+    }
+    catch (const std::invalid_argument &)
+    {
+        failures++;
+    }
+    try
+    {
+        KaloAlgebra::MatrixBatch(20, 3, 2) * KaloAlgebra::MatrixBatch(20, 3, 2);
+    }
+    catch (const std::invalid_argument &)
+    {
+        failures++;
+    }
+    try
+    {
+        KaloAlgebra::MatrixBatch(20, 2, 3) + KaloAlgebra::MatrixBatch(19, 2, 3);
+    }
+    catch (const std::invalid_argument &)
+    {
+        failures++;
+    }
+    try
+    {
+        batch.setMatrix(0, KaloAlgebra::Matrix(3, 2));
+    }
+    catch (const std::invalid_argument &)
+    {
+        failures++;
+    }
+    ok = ok && failures == 5;
+
+    // Identities stay identities, including the padding of the last block
+    const KaloAlgebra::MatrixBatch identity = KaloAlgebra::MatrixBatch::identity(20, 3).inverse();
+    ok = ok && maxDifference<double>(identity.getMatrix(19), KaloAlgebra::Matrix::identity(3)) == 0.0;
+    if (ok)
+    {
+        std::cout << "testLayoutAndErrors PASSED\n";
+    }
+    else
+    {
+        std::cout << "testLayoutAndErrors FAILED\n";
+    }
+}
+
+int main()
+{
+    testBatchedOperations();
+    testLayoutAndErrors();
+    return 0;
+}
@@ -0,0 +1,447 @@
+#include <iostream>
+#include <cmath>
+#include <utility>
+#include "kalo_algebra.hpp"
+
+// Largest absolute element of a - b
+double maxDifference(const KaloAlgebra::Matrix &a, const KaloAlgebra::Matrix &b)
+{
+    double largest = 0.0;
+    for (int i = 0; i < a.getRows(); i++)
+        for (int j = 0; j < a.getCols(); j++)
+            largest = std::max(largest, std::fabs(a.getElement(i, j) - b.getElement(i, j)));
+    return largest;
+}
+
+// A random matrix with a heavy diagonal is well conditioned, so residuals stay near rounding
+KaloAlgebra::Matrix wellConditioned(int n)
+{
+    KaloAlgebra::Matrix a = KaloAlgebra::Matrix::random(n, n, -1.0, 1.0);
+    for (int i = 0; i < n; i++)
+        a.setElement(i, i, a.getElement(i, i) + (i % 2 == 0 ? 1.0 : -1.0) * 0.5 * n);
+    return a;
+}
+
+void testLUFactors()
+{
+    bool ok = true;
+    for (int n : {1, 5, 96, 97, 250})
+    {
+        KaloAlgebra::Matrix a = KaloAlgebra::Matrix::random(n, n, -1.0, 1.0);
+        KaloAlgebra::LUDecomposition lu(a);
+        ok = ok && !lu.isSingular() && maxDifference(lu.getP() * a, lu.getL() * lu.getU()) < 1e-10 * n;
+    }
+
+    if (ok)
+        std::cout << "testLUFactors PASSED\n";
+    else
+        std::cout << "testLUFactors FAILED\n";
+}
+
+void testLUSolve()
+{
+    bool ok = true;
+    for (int n : {3, 100, 301})
+    {
+        KaloAlgebra::Matrix a = wellConditioned(n);
+        KaloAlgebra::LUDecomposition lu(a);
+
+        // The same factorization serves a vector, a block of right-hand sides and the inverse
+        KaloAlgebra::Vector b = KaloAlgebra::Vector::random(n, -1.0, 1.0);
+        KaloAlgebra::Vector x = lu.solve(b);
+        KaloAlgebra::Vector residual = a * x - b;
+        ok = ok && residual.magnitude() < 1e-12 * n;
+
+        KaloAlgebra::Matrix B = KaloAlgebra::Matrix::random(n, 7, -1.0, 1.0);
+        KaloAlgebra::Matrix X = lu.solve(B);
+        ok = ok && maxDifference(a * X, B) < 1e-12 * n;
+        ok = ok && maxDifference(KaloAlgebra::solve(a, B), X) == 0.0;
+
+        ok = ok && maxDifference(a * a.inverse(), KaloAlgebra::Matrix::identity(n)) < 1e-12 * n;
+    }
+
+    if (ok)
+        std::cout << "testLUSolve PASSED\n";
+    else
+        std::cout << "testLUSolve FAILED\n";
+}
+
+void testDeterminant()
+{
+    KaloAlgebra::Matrix a({{1.0, 2.0}, {3.0, 4.0}});
+    KaloAlgebra::Matrix b({{0.0, 2.0, 1.0}, {1.0, 0.0, 0.0}, {0.0, 0.0, 3.0}}); // needs a row swap
+    KaloAlgebra::Matrix triangular = KaloAlgebra::Matrix::identity(120) * 1.1;
+    bool ok = std::fabs(a.determinant() + 2.0) < 1e-12 && std::fabs(b.determinant() + 6.0) < 1e-12;
+    ok = ok && std::fabs(triangular.determinant() / std::pow(1.1, 120) - 1.0) < 1e-12;
+
+    if (ok)
+        std::cout << "testDeterminant PASSED\n";
+    else
+        std::cout << "testDeterminant FAILED\n";
+}
+
+void testLUSingular()
+{
+    KaloAlgebra::Matrix a({{1.0, 2.0, 3.0}, {2.0, 4.0, 6.0}, {1.0, 0.0, 1.0}});
+    KaloAlgebra::LUDecomposition lu(a);
+    bool ok = lu.isSingular() && lu.determinant() == 0.0;
+
+    bool threwSolve = false, threwShape = false;
+    try
+    {
+        lu.solve(KaloAlgebra::Vector(3, 1.0));
+    }
+    catch (const std::invalid_argument &)
+    {
+        threwSolve = true;
+    }
+    try
+    {
+        KaloAlgebra::LUDecomposition rectangular(KaloAlgebra::Matrix(3, 4));
+    }
+    catch (const std::invalid_argument &)
+    {
+        threwShape = true;
+    }
+
+    if (ok && threwSolve && threwShape)
+        std::cout << "testLUSingular PASSED\n";
+    else
+        std::cout << "testLUSingular FAILED\n";
+}
+
+// G * G^T + n * I is symmetric positive definite
+KaloAlgebra::Matrix symmetricPositiveDefinite(int n)
+{
+    KaloAlgebra::Matrix g = KaloAlgebra::Matrix::random(n, n, -1.0, 1.0);
+    return g * g.transpose() + KaloAlgebra::Matrix::identity(n) * static_cast<double>(n);
+}
+
+void testCholeskyFactor()
+{
+    bool ok = true;
+    for (int n : {1, 5, 96, 97, 300})
+    {
+        KaloAlgebra::Matrix a = symmetricPositiveDefinite(n);
+        KaloAlgebra::CholeskyDecomposition llt(a);
+        const KaloAlgebra::Matrix &L = llt.getL();
+        ok = ok && llt.isPositiveDefinite() && llt.getInfo() == 0;
+        ok = ok && maxDifference(L * L.transpose(), a) < 1e-12 * n * n;
+        for (int i = 0; i < n; i++)
+            for (int j = i + 1; j < n; j++)
+                ok = ok && L.getElement(i, j) == 0.0;
+
+        // Only the lower triangle of A is read
+        KaloAlgebra::Matrix lowerOnly = a;
+        for (int i = 0; i < n; i++)
+            for (int j = i + 1; j < n; j++)
+                lowerOnly.setElement(i, j, 1e300);
+        ok = ok && maxDifference(KaloAlgebra::CholeskyDecomposition(lowerOnly).getL(), L) == 0.0;
+
+        // det(A) overflows for the larger sizes, so compare logarithms against the LU diagonal
+        KaloAlgebra::LUDecomposition lu(a);
+        double logDeterminant = 0.0;
+        for (int i = 0; i < n; i++)
+            logDeterminant += std::log(std::fabs(lu.getFactors().getElement(i, i)));
+        ok = ok && std::fabs(llt.logDeterminant() - logDeterminant) < 1e-9 * n;
+    }
+
+    if (ok)
+        std::cout << "testCholeskyFactor PASSED\n";
+    else
+        std::cout << "testCholeskyFactor FAILED\n";
+}
+
+void testCholeskySolve()
+{
+    bool ok = true;
+    for (int n : {4, 150, 257})
+    {
+        KaloAlgebra::Matrix a = symmetricPositiveDefinite(n);
+        KaloAlgebra::CholeskyDecomposition llt(a);
+
+        KaloAlgebra::Vector b = KaloAlgebra::Vector::random(n, -1.0, 1.0);
+        KaloAlgebra::Vector residual = a * llt.solve(b) - b;
+        ok = ok && residual.magnitude() < 1e-12 * n;
+
+        KaloAlgebra::Matrix B = KaloAlgebra::Matrix::random(n, 9, -1.0, 1.0);
+        ok = ok && maxDifference(a * llt.solve(B), B) < 1e-12 * n;
+        ok = ok && maxDifference(a * llt.inverse(), KaloAlgebra::Matrix::identity(n)) < 1e-12 * n;
+    }
+
+    if (ok)
+        std::cout << "testCholeskySolve PASSED\n";
+    else
+        std::cout << "testCholeskySolve FAILED\n";
+}
+
+void testCholeskyNotPositiveDefinite()
+{
+    // The leading 2 x 2 minor is positive definite, the leading 3 x 3 minor is not
+    KaloAlgebra::Matrix a({{4.0, 2.0, 0.0}, {2.0, 5.0, 3.0}, {0.0, 3.0, 1.0}});
+    KaloAlgebra::CholeskyDecomposition llt(a);
+    bool ok = !llt.isPositiveDefinite() && llt.getInfo() == 3;
+
+    // Failure inside a later panel
+    KaloAlgebra::Matrix big = symmetricPositiveDefinite(200);
+    big.setElement(150, 150, -1.0);
+    ok = ok && KaloAlgebra::CholeskyDecomposition(big).getInfo() == 151;
+
+    bool threw = false;
+    try
+    {
+        llt.solve(KaloAlgebra::Vector(3, 1.0));
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+
+    if (ok && threw)
+        std::cout << "testCholeskyNotPositiveDefinite PASSED\n";
+    else
+        std::cout << "testCholeskyNotPositiveDefinite FAILED\n";
+}
+
+void testQRFactors()
+{
+    bool ok = true;
+    // The last shape is tall enough for TSQR
+    for (auto shape : {std::make_pair(1, 1), std::make_pair(5, 3), std::make_pair(100, 40), std::make_pair(130, 130), std::make_pair(40000, 20)})
+    {
+        const int m = shape.first, n = shape.second;
+        KaloAlgebra::Matrix a = KaloAlgebra::Matrix::random(m, n, -1.0, 1.0);
+        KaloAlgebra::QRDecomposition qr(a);
+        KaloAlgebra::Matrix Q = qr.getQ();
+        KaloAlgebra::Matrix R = qr.getR();
+        ok = ok && qr.isFullRank() && maxDifference(Q * R, a) < 1e-13 * m;
+        ok = ok && maxDifference(Q.transpose() * Q, KaloAlgebra::Matrix::identity(n)) < 1e-13 * m;
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < i; j++)
+                ok = ok && R.getElement(i, j) == 0.0;
+
+        // The implicit Q round-trips
+        KaloAlgebra::Vector b = KaloAlgebra::Vector::random(m, -1.0, 1.0);
+        KaloAlgebra::Vector c = b;
+        qr.applyQT(c);
+        ok = ok && std::fabs(c.magnitude() - b.magnitude()) < 1e-12 * m;
+        qr.applyQ(c);
+        KaloAlgebra::Vector difference = c - b;
+        ok = ok && difference.magnitude() < 1e-12 * m;
+    }
+
+    if (ok)
+        std::cout << "testQRFactors PASSED\n";
+    else
+        std::cout << "testQRFactors FAILED\n";
+}
+
+void testLeastSquares()
+{
+    bool ok = true;
+    for (auto shape : {std::make_pair(7, 7), std::make_pair(300, 45), std::make_pair(20000, 10)})
+    {
+        const int m = shape.first, n = shape.second;
+        KaloAlgebra::Matrix a = KaloAlgebra::Matrix::random(m, n, -1.0, 1.0);
+        KaloAlgebra::Vector b = KaloAlgebra::Vector::random(m, -1.0, 1.0);
+
+        // Against the normal equations A^T * A * x = A^T * b
+        KaloAlgebra::Matrix at = a.transpose();
+        KaloAlgebra::Vector expected = KaloAlgebra::CholeskyDecomposition(at * a).solve(at * b);
+        KaloAlgebra::Vector x = KaloAlgebra::leastSquares(a, b);
+        KaloAlgebra::Vector difference = x - expected;
+        ok = ok && difference.magnitude() < 1e-9;
+
+        KaloAlgebra::Matrix B = KaloAlgebra::Matrix::random(m, 3, -1.0, 1.0);
+        KaloAlgebra::Matrix X = KaloAlgebra::QRDecomposition(a).leastSquares(B);
+        KaloAlgebra::Matrix normal = at * (a * X - B); // zero at the minimum
+        ok = ok && maxDifference(normal, KaloAlgebra::Matrix(n, 3)) < 1e-10 * m;
+    }
+
+    // A consistent system is solved exactly
+    KaloAlgebra::Matrix a = KaloAlgebra::Matrix::random(50, 8, -1.0, 1.0);
+    KaloAlgebra::Vector truth = KaloAlgebra::Vector::random(8, -1.0, 1.0);
+    KaloAlgebra::Vector recovered = KaloAlgebra::leastSquares(a, a * truth);
+    KaloAlgebra::Vector difference = recovered - truth;
+    ok = ok && difference.magnitude() < 1e-12;
+
+    if (ok)
+        std::cout << "testLeastSquares PASSED\n";
+    else
+        std::cout << "testLeastSquares FAILED\n";
+}
+
+void testQRErrors()
+{
+    bool threwShape = false, threwRank = false;
+    try
+    {
+        KaloAlgebra::QRDecomposition wide(KaloAlgebra::Matrix(3, 4));
+    }
+    catch (const std::invalid_argument &)
+    {
+        threwShape = true;
+    }
+
+    KaloAlgebra::Matrix a = KaloAlgebra::Matrix::random(6, 3, -1.0, 1.0);
+    for (int i = 0; i < 6; i++)
+        a.setElement(i, 2, 0.0);
+    KaloAlgebra::QRDecomposition qr(a);
+    try
+    {
+        qr.leastSquares(KaloAlgebra::Vector(6, 1.0));
+    }
+    catch (const std::invalid_argument &)
+    {
+        threwRank = true;
+    }
+
+    if (threwShape && threwRank && !qr.isFullRank())
+        std::cout << "testQRErrors PASSED\n";
+    else
+        std::cout << "testQRErrors FAILED\n";
+}
+
+// Residual |A * V - V * diag(lambda)| and orthogonality |V^T * V - I| of an eigendecomposition
+bool checkEigenpairs(const KaloAlgebra::Matrix &a, const KaloAlgebra::SymmetricEigenDecomposition &eigen, double tolerance)
+{
+    const KaloAlgebra::Matrix &v = eigen.getEigenvectors();
+    const KaloAlgebra::Vector &lambda = eigen.getEigenvalues();
+    KaloAlgebra::Matrix scaled = v;
+    for (int i = 0; i < v.getRows(); i++)
+        for (int j = 0; j < v.getCols(); j++)
+            scaled.setElement(i, j, v.getElement(i, j) * lambda.getElement(j));
+    bool ok = maxDifference(a * v, scaled) < tolerance &&
+              maxDifference(v.t() * v, KaloAlgebra::Matrix::identity(v.getCols())) < tolerance;
+    for (int j = 1; j < lambda.getSize(); j++)
+        ok = ok && lambda.getElement(j - 1) >= lambda.getElement(j);
+    return ok;
+}
+
+void testSymmetricEigen()
+{
+    bool ok = true;
+    for (int n : {1, 5, 33, 97, 300})
+    {
+        KaloAlgebra::Matrix g = KaloAlgebra::Matrix::random(n, n, -1.0, 1.0);
+        KaloAlgebra::Matrix a = g + g.transpose();
+        const double tolerance = 1e-12 * n;
+        KaloAlgebra::SymmetricEigenDecomposition eigen(a);
+        ok = ok && eigen.getSize() == n && eigen.getCount() == n && eigen.hasEigenvectors() && checkEigenpairs(a, eigen, tolerance);
+
+        // Eigenvalues alone (QL) agree with divide and conquer, and their sum is the trace
+        KaloAlgebra::Vector values = KaloAlgebra::symmetricEigenvalues(a);
+        double trace = 0.0, sum = 0.0;
+        for (int i = 0; i < n; i++)
+        {
+            ok = ok && std::fabs(values.getElement(i) - eigen.getEigenvalues().getElement(i)) < tolerance;
+            trace += a.getElement(i, i);
+            sum += values.getElement(i);
+        }
+        ok = ok && std::fabs(trace - sum) < tolerance;
+
+        // The k largest, by inverse iteration (few) or divide and conquer (many)
+        for (int count : {1, n / 10, n / 2})
+        {
+            if (count == 0)
+                continue;
+            KaloAlgebra::SymmetricEigenDecomposition top(a, count);
+            ok = ok && top.getCount() == count && checkEigenpairs(a, top, tolerance);
+            for (int i = 0; i < count; i++)
+                ok = ok && std::fabs(top.getEigenvalues().getElement(i) - values.getElement(i)) < tolerance;
+        }
+
+        // Only the lower triangle of A is read
+        KaloAlgebra::Matrix lowerOnly = a;
+        for (int i = 0; i < n; i++)
+            for (int j = i + 1; j < n; j++)
+                lowerOnly.setElement(i, j, 1e300);
+        ok = ok && KaloAlgebra::SymmetricEigenDecomposition(lowerOnly).getEigenvectors() == eigen.getEigenvectors();
+    }
+
+    // Repeated and clustered eigenvalues: a covariance of rank 10 (eigenvalue 0 repeated, so
+    // divide and conquer deflates) and the identity plus a tiny perturbation
+    KaloAlgebra::Matrix samples = KaloAlgebra::Matrix::random(10, 200, -1.0, 1.0);
+    KaloAlgebra::Matrix covariance = samples.t() * samples;
+    KaloAlgebra::Matrix perturbation = KaloAlgebra::Matrix::random(150, 150, -1e-10, 1e-10);
+    KaloAlgebra::Matrix nearIdentity = KaloAlgebra::Matrix::identity(150) + perturbation + perturbation.transpose();
+    ok = ok && checkEigenpairs(covariance, KaloAlgebra::SymmetricEigenDecomposition(covariance), 1e-11) &&
+         checkEigenpairs(covariance, KaloAlgebra::SymmetricEigenDecomposition(covariance, 12), 1e-11) &&
+         checkEigenpairs(nearIdentity, KaloAlgebra::SymmetricEigenDecomposition(nearIdentity), 1e-12) &&
+         checkEigenpairs(nearIdentity, KaloAlgebra::SymmetricEigenDecomposition(nearIdentity, 20), 1e-12);
+    ok = ok && std::fabs(KaloAlgebra::SymmetricEigenDecomposition(covariance, 11, false).getEigenvalues().getElement(10)) < 1e-11;
+
+    int failures = 0;
+    try
+    {
+        KaloAlgebra::SymmetricEigenDecomposition(KaloAlgebra::Matrix(3, 4));
+    }
+    catch (const std::invalid_argument &)
+    {
+        failures++;
+    }
+    try
+    {
+        KaloAlgebra::SymmetricEigenDecomposition(KaloAlgebra::Matrix::identity(3), 4);
+    }
+    catch (const std::invalid_argument &)
+    {
+        failures++;
+    }
+    try
+    {
+        KaloAlgebra::SymmetricEigenDecomposition(KaloAlgebra::Matrix::identity(3), false).getEigenvectors();
+    }
+    catch (const std::invalid_argument &)
+    {
+        failures++;
+    }
+    ok = ok && failures == 3;
+
+    if (ok)
+        std::cout << "testSymmetricEigen PASSED\n";
+    else
+        std::cout << "testSymmetricEigen FAILED\n";
+}
+
+void testDecompositionThreadInvariance()
+{
+    KaloAlgebra::Matrix tall = KaloAlgebra::Matrix::random(33000, 12, -1.0, 1.0);
+    KaloAlgebra::Matrix square = KaloAlgebra::Matrix::random(230, 230, -1.0, 1.0);
+    KaloAlgebra::Matrix spd = square * square.transpose() + KaloAlgebra::Matrix::identity(230);
+    const int previousThreads = KaloAlgebra::getThreadCount();
+
+    KaloAlgebra::setThreadCount(1);
+    KaloAlgebra::Matrix r1 = KaloAlgebra::QRDecomposition(tall).getR();
+    KaloAlgebra::Matrix lu1 = KaloAlgebra::LUDecomposition(square).getFactors();
+    KaloAlgebra::Matrix l1 = KaloAlgebra::CholeskyDecomposition(spd).getL();
+    KaloAlgebra::Matrix v1 = KaloAlgebra::SymmetricEigenDecomposition(spd).getEigenvectors();
+    KaloAlgebra::setThreadCount(4);
+    bool ok = KaloAlgebra::QRDecomposition(tall).getR() == r1;
+    ok = ok && KaloAlgebra::LUDecomposition(square).getFactors() == lu1;
+    ok = ok && KaloAlgebra::CholeskyDecomposition(spd).getL() == l1;
+    ok = ok && KaloAlgebra::SymmetricEigenDecomposition(spd).getEigenvectors() == v1;
+    KaloAlgebra::setThreadCount(previousThreads);
+
+    if (ok)
+        std::cout << "testDecompositionThreadInvariance PASSED\n";
+    else
+        std::cout << "testDecompositionThreadInvariance FAILED\n";
+}
+
+int main()
+{
+    testLUFactors();
+    testLUSolve();
+    testDeterminant();
+    testLUSingular();
+    testCholeskyFactor();
+    testCholeskySolve();
+    testCholeskyNotPositiveDefinite();
+    testQRFactors();
+    testLeastSquares();
+    testQRErrors();
+    testSymmetricEigen();
+    testDecompositionThreadInvariance();
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include <iostream>
+#include <cmath>
+#include <complex>
+#include "kalo_algebra.hpp"
+
+using KaloAlgebra::FixedMatrix;
+using KaloAlgebra::FixedVector;
+using KaloAlgebra::Matrix3;
+using KaloAlgebra::Vector3;
+
+// Evaluated by the compiler: a failure here is a build error
+constexpr Vector3 unitX(1.0, 0.0, 0.0);
+constexpr Vector3 unitY(0.0, 1.0, 0.0);
+static_assert(unitX.cross(unitY) == Vector3(0.0, 0.0, 1.0), "constexpr cross product");
+static_assert((unitX * 2.0 + unitY - unitX).dot(Vector3(1.0, 1.0, 1.0)) == 2.0, "constexpr arithmetic");
+static_assert(Vector3(3.0, 4.0, 0.0).squaredMagnitude() == 25.0, "constexpr squared magnitude");
+static_assert(FixedMatrix<2, 3>(1, 2, 3, 4, 5, 6).transpose() == FixedMatrix<3, 2>(1, 4, 2, 5, 3, 6), "constexpr transpose");
+static_assert(FixedMatrix<2, 3>(1, 2, 3, 4, 5, 6) * FixedMatrix<3, 2>(1, 4, 2, 5, 3, 6) == FixedMatrix<2, 2>(14, 32, 32, 77), "constexpr product");
+static_assert(Matrix3(2, 0, 0, 0, 3, 0, 0, 0, 4).determinant() == 24.0, "constexpr determinant");
+static_assert(KaloAlgebra::Matrix2(2, 1, 1, 1).inverse() == KaloAlgebra::Matrix2(1, -1, -1, 2), "constexpr inverse");
+static_assert(sizeof(Vector3) == 3 * sizeof(double) && sizeof(Matrix3) == 9 * sizeof(double), "inline storage only");
+
+template <int R, int C>
+double maxDifference(const FixedMatrix<R, C> &a, const KaloAlgebra::Matrix &b)
+{
+    double difference = 0.0;
+    for (int i = 0; i < R; i++)
+        for (int j = 0; j < C; j++)
+            difference = std::max(difference, std::fabs(a(i, j) - b.getElement(i, j)));
+    return difference;
+}
+
+void testFixedVectorOperations()
+{
+    Vector3 a(1.0, -2.0, 3.0), b(4.0, 0.5, -1.0);
+    KaloAlgebra::Vector da = a.toVector(), db = b.toVector();
+
+    bool ok = Vector3(da + db) == a + b && Vector3(da - db) == a - b && Vector3(da * 2.5) == a * 2.5 &&
+              Vector3(da.cross(db)) == a.cross(b) && a.dot(b) == da.dot(db) && a * b == da * db &&
+              std::fabs(a.magnitude() - da.magnitude()) < 1e-15 && Vector3(da.hadamard(db)) == a.hadamard(b) &&
+              std::fabs(a.normalize().magnitude() - 1.0) < 1e-15 && -a == a * -1.0 && (a / 2.0) * 2.0 == a;
+
+    Vector3 c = a;
+    c += b;
+    c -= b;
+    c *= 3.0;
+    c /= 3.0;
+    ok = ok && c == a && Vector3::filled(2.0) == Vector3(2.0, 2.0, 2.0) && Vector3::zero() == Vector3();
+
+    // Checked accessors throw like the dynamic ones, and so do mismatched conversions
+    int thrown = 0;
+    try
+    {
+        a.getElement(3);
+    }
+    catch (const std::invalid_argument &)
+    {
+        thrown++;
+    }
+    try
+    {
+        Vector3 wrong(KaloAlgebra::Vector(4));
+    }
+    catch (const std::invalid_argument &)
+    {
+        thrown++;
+    }
+    try
+    {
+        Vector3().normalize();
+    }
+    catch (const std::invalid_argument &)
+    {
+        thrown++;
+    }
+
+    if (ok && thrown == 3)
+    {
+        std::cout << "testFixedVectorOperations PASSED\n";
+    }
+    else
+    {
+        std::cout << "testFixedVectorOperations FAILED\n";
+    }
+}
+
+void testFixedMatrixOperations()
+{
+    KaloAlgebra::Matrix dynamicA = KaloAlgebra::Matrix::random(3, 4, -1.0, 1.0);
+    KaloAlgebra::Matrix dynamicB = KaloAlgebra::Matrix::random(4, 2, -1.0, 1.0);
+    FixedMatrix<3, 4> a(dynamicA);
+    FixedMatrix<4, 2> b(dynamicB);
+    FixedVector<4> x(1.0, 2.0, -1.0, 0.5);
+    FixedVector<3> y(-1.0, 0.25, 2.0);
+
+    bool ok = maxDifference(a * b, dynamicA * dynamicB) < 1e-14 && maxDifference(a.transpose(), dynamicA.transpose()) == 0.0 &&
+              maxDifference(a + a * 2.0, dynamicA * 3.0) < 1e-15 && a.toMatrix() == dynamicA;
+    KaloAlgebra::Vector ax = dynamicA * x.toVector();
+    KaloAlgebra::Vector ya = y.toVector() * dynamicA;
+    for (int i = 0; i < 3; i++)
+        ok = ok && std::fabs((a * x)[i] - ax.getElement(i)) < 1e-14;
+    for (int j = 0; j < 4; j++)
+        ok = ok && std::fabs((y * a)[j] - ya.getElement(j)) < 1e-14;
+
+    // Closed forms for 2 x 2 and 3 x 3, elimination beyond
+    KaloAlgebra::Matrix dynamicSquare = KaloAlgebra::Matrix::random(3, 3, -1.0, 1.0) + KaloAlgebra::Matrix::identity(3) * 3.0;
+    Matrix3 square(dynamicSquare);
+    ok = ok && std::fabs(square.determinant() - dynamicSquare.determinant()) < 1e-12 &&
+         maxDifference(square.inverse(), dynamicSquare.inverse()) < 1e-12;
+    KaloAlgebra::Matrix dynamicLarge = KaloAlgebra::Matrix::random(6, 6, -1.0, 1.0);
+    FixedMatrix<6, 6> large(dynamicLarge);
+    ok = ok && std::fabs(large.determinant() - dynamicLarge.determinant()) < 1e-12 &&
+         maxDifference(large.inverse(), dynamicLarge.inverse()) < 1e-9;
+
+    bool threw = false;
+    try
+    {
+        Matrix3(1, 2, 3, 2, 4, 6, 0, 0, 1).inverse();
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+
+    if (ok && threw)
+    {
+        std::cout << "testFixedMatrixOperations PASSED\n";
+    }
+    else
+    {
+        std::cout << "testFixedMatrixOperations FAILED\n";
+    }
+}
+
+void testFixedInteroperability()
+{
+    // Fixed objects are views onto their inline storage, so the dynamic kernels work on them in place
+    KaloAlgebra::Matrix3 rotation(0, -1, 0, 1, 0, 0, 0, 0, 1);
+    KaloAlgebra::Vector3 position(1.0, 2.0, 3.0), velocity(0.5, 0.5, 0.5);
+    KaloAlgebra::axpy(2.0, velocity, position);
+    bool ok = position == Vector3(2.0, 3.0, 4.0);
+
+    KaloAlgebra::Vector3 rotated;
+    KaloAlgebra::gemv(1.0, rotation, position, 0.0, rotated);
+    ok = ok && rotated == rotation * position && rotated == Vector3(-3.0, 2.0, 4.0);
+
+    position.view() = velocity.view() * 4.0 + velocity.view();
+    ok = ok && position == Vector3(2.5, 2.5, 2.5);
+
+    KaloAlgebra::Matrix3 product;
+    KaloAlgebra::gemm(1.0, rotation, rotation, 0.0, product);
+    ok = ok && product == rotation * rotation;
+
+    // Other scalar types
+    FixedVector<2, std::complex<double>> z(std::complex<double>(0.0, 1.0), std::complex<double>(3.0, 0.0));
+    FixedVector<2, float> f(3.0f, 4.0f);
+    ok = ok && z.dot(z) == std::complex<double>(8.0, 0.0) && z.magnitude() == std::sqrt(10.0) && f.magnitude() == 5.0f;
+
+    if (ok)
+    {
+        std::cout << "testFixedInteroperability PASSED\n";
+    }
+    else
+    {
+        std::cout << "testFixedInteroperability FAILED\n";
+    }
+}
+
+int main()
+{
+    testFixedVectorOperations();
+    testFixedMatrixOperations();
+    testFixedInteroperability();
+    return 0;
+}
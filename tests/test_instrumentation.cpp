@@ -0,0 +1,82 @@
+#include <iostream>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "kalo_algebra.hpp"
+
+using KaloAlgebra::Matrix;
+using KaloAlgebra::OperationStats;
+using KaloAlgebra::Vector;
+namespace Instrumentation = KaloAlgebra::Instrumentation;
+
+const OperationStats *findStats(const std::vector<OperationStats> &stats, const std::string &operation, long long bucket)
+{
+    for (const OperationStats &s : stats)
+    {
+        if (s.operation == operation && s.sizeBucket == bucket)
+            return &s;
+    }
+    return nullptr;
+}
+
+void testCounters()
+{
+    Matrix a = Matrix::random(64, 64, -1.0, 1.0), b = Matrix::random(64, 64, -1.0, 1.0), c(64, 64);
+    Matrix tall = Matrix::random(100, 30, -1.0, 1.0);
+    Vector x = Vector::random(1000, -1.0, 1.0);
+
+    Instrumentation::reset();
+    KaloAlgebra::multiply(a, b, c);
+    Matrix product = a * b;
+    Matrix transposed = tall.transpose();
+    double sum = 0.0;
+    for (int i = 0; i < 3; i++)
+        sum += x.dot(x);
+    const std::vector<OperationStats> stats = Instrumentation::snapshot();
+
+    bool ok;
+    if (!Instrumentation::isEnabled())
+    {
+        // Compiled out: nothing is recorded, and the dumps still work
+        ok = stats.empty() && Instrumentation::toJson() == "[]" &&
+             Instrumentation::report().find("compiled out") != std::string::npos;
+    }
+    else
+    {
+        const OperationStats *gemm = findStats(stats, "gemm", 64);
+        const OperationStats *multiply = findStats(stats, "Matrix::operator*", 64);
+        const OperationStats *transpose = findStats(stats, "Matrix::transpose", 128);
+        const OperationStats *dot = findStats(stats, "Vector::dot", 1024);
+        ok = gemm && multiply && transpose && dot;
+        // The product records itself and the gemm it runs; its result is allocated inside it
+        ok = ok && gemm->calls == 2 && gemm->flops == 2.0 * 2 * 64 * 64 * 64 && gemm->allocations == 0;
+        ok = ok && multiply->calls == 1 && multiply->allocations == 1 && multiply->allocatedBytes >= 64 * 64 * 8;
+        ok = ok && multiply->seconds >= 0.0 && gemm->seconds > 0.0;
+        ok = ok && transpose->calls == 1 && transpose->allocations == 1 && transpose->bytes == 2.0 * 100 * 30 * 8;
+        ok = ok && dot->calls == 3 && dot->flops == 3 * 2.0 * 1000 && dot->allocations == 0;
+
+        const std::string json = Instrumentation::toJson();
+        ok = ok && json.front() == '[' && json.back() == ']' &&
+             json.find("{\"operation\": \"gemm\", \"size_bucket\": 64, \"calls\": 2") != std::string::npos;
+        ok = ok && Instrumentation::report().find("Matrix::transpose") != std::string::npos;
+
+        Instrumentation::reset();
+        ok = ok && Instrumentation::snapshot().empty();
+    }
+    ok = ok && std::isfinite(sum) && product.getRows() == 64 && transposed.getRows() == 30;
+
+    if (ok)
+    {
+        std::cout << "testCounters PASSED\n";
+    }
+    else
+    {
+        std::cout << "testCounters FAILED\n";
+    }
+}
+
+int main()
+{
+    testCounters();
+    return 0;
+}
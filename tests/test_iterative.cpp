@@ -0,0 +1,251 @@
+#include <iostream>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "kalo_algebra.hpp"
+
+using KaloAlgebra::ConstVectorView;
+using KaloAlgebra::IterativeMethod;
+using KaloAlgebra::IterativeSolver;
+using KaloAlgebra::Matrix;
+using KaloAlgebra::SparseMatrix;
+using KaloAlgebra::Vector;
+using KaloAlgebra::VectorView;
+
+// Five-point finite differences on an m x m grid: -div(grad u) + convection * du/dx, symmetric
+// positive definite when convection is 0
+SparseMatrix gridOperator(int m, double convection)
+{
+    std::vector<SparseMatrix::Triplet> triplets;
+    for (int i = 0; i < m; i++)
+    {
+        for (int j = 0; j < m; j++)
+        {
+            const int row = i * m + j;
+            triplets.push_back({row, row, 4.0});
+            if (i > 0)
+                triplets.push_back({row, row - m, -1.0});
+            if (i + 1 < m)
+                triplets.push_back({row, row + m, -1.0});
+            if (j > 0)
+                triplets.push_back({row, row - 1, -1.0 - convection});
+            if (j + 1 < m)
+                triplets.push_back({row, row + 1, -1.0 + convection});
+        }
+    }
+    return SparseMatrix::fromTriplets(m * m, m * m, triplets);
+}
+
+double relativeResidual(const SparseMatrix &A, const Vector &x, const Vector &b)
+{
+    const Vector r = b - A * x.view();
+    return std::sqrt(r.dot(r) / b.dot(b));
+}
+
+// Every method, with no preconditioner, Jacobi and ILU(0), on the same system; the history must
+// start at the initial residual and hold one entry per iteration
+bool solvesWithEveryPreconditioner(IterativeMethod method, const SparseMatrix &A, const Vector &b, std::vector<int> &iterations)
+{
+    KaloAlgebra::JacobiPreconditioner jacobi(A);
+    KaloAlgebra::ILU0Preconditioner ilu(A);
+    const KaloAlgebra::Preconditioner *preconditioners[] = {nullptr, &jacobi, &ilu};
+    IterativeSolver solver(method, A.getRows(), 40);
+    solver.setTolerance(1e-10);
+    solver.setMaxIterations(2000);
+    bool ok = true;
+    for (const KaloAlgebra::Preconditioner *M : preconditioners)
+    {
+        solver.setPreconditioner(M);
+        Vector x(A.getRows());
+        ok = ok && solver.solve(A, b.view(), x.view()) && solver.hasConverged();
+        const std::vector<double> &history = solver.getResidualHistory();
+        ok = ok && relativeResidual(A, x, b) < 1e-9 && solver.getResidualNorm() <= 1e-10;
+        ok = ok && history.size() == static_cast<std::size_t>(solver.getIterations()) + 1 && std::abs(history.front() - 1.0) < 1e-12;
+        iterations.push_back(solver.getIterations());
+    }
+    return ok;
+}
+
+void testConjugateGradient()
+{
+    const SparseMatrix A = gridOperator(30, 0.0);
+    const Vector b = Vector::random(A.getRows(), -1.0, 1.0);
+    std::vector<int> iterations;
+    bool ok = solvesWithEveryPreconditioner(IterativeMethod::ConjugateGradient, A, b, iterations);
+    ok = ok && iterations[2] < iterations[0];
+
+    // A warm start from the solution needs no iterations
+    IterativeSolver solver(IterativeMethod::ConjugateGradient, A.getRows());
+    Vector x(A.getRows());
+    solver.solve(A, b.view(), x.view());
+    ok = ok && solver.solve(A, b.view(), x.view()) && solver.getIterations() == 0;
+    if (ok)
+    {
+        std::cout << "testConjugateGradient PASSED\n";
+    }
+    else
+    {
+        std::cout << "testConjugateGradient FAILED\n";
+    }
+}
+
+void testNonsymmetricSolvers()
+{
+    const SparseMatrix A = gridOperator(25, 0.4);
+    const Vector b = Vector::random(A.getRows(), -1.0, 1.0);
+    bool ok = true;
+    for (IterativeMethod method : {IterativeMethod::BiCGSTAB, IterativeMethod::GMRES})
+    {
+        std::vector<int> iterations;
+        ok = ok && solvesWithEveryPreconditioner(method, A, b, iterations);
+        ok = ok && iterations[2] < iterations[0];
+    }
+
+    // A dense matrix, and a matrix-free operator applying the same stencil directly
+    const Matrix dense = gridOperator(8, 0.4).toDense();
+    const Vector small = Vector::random(64, -1.0, 1.0);
+    Vector expected(64), x(64);
+    IterativeSolver gmres(IterativeMethod::GMRES, 64, 10);
+    ok = ok && gmres.solve(dense, small.view(), expected.view());
+    KaloAlgebra::LinearOperator stencil = [](ConstVectorView in, VectorView out)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            for (int j = 0; j < 8; j++)
+            {
+                const int k = i * 8 + j;
+                double value = 4.0 * in.evaluate(k);
+                if (i > 0)
+                    value -= in.evaluate(k - 8);
+                if (i < 7)
+                    value -= in.evaluate(k + 8);
+                if (j > 0)
+                    value -= 1.4 * in.evaluate(k - 1);
+                if (j < 7)
+                    value -= 0.6 * in.evaluate(k + 1);
+                out.setElement(k, value);
+            }
+        }
+    };
+    ok = ok && gmres.solve(stencil, small.view(), x.view());
+    for (int i = 0; i < 64; i++)
+        ok = ok && std::abs(x.getElement(i) - expected.getElement(i)) < 1e-8;
+
+    // A strided right-hand side and solution
+    Matrix columns(64, 3);
+    columns.view().col(0) = small.view();
+    ok = ok && gmres.solve(dense, columns.view().col(0), columns.view().col(2));
+    for (int i = 0; i < 64; i++)
+        ok = ok && std::abs(columns.getElement(i, 2) - expected.getElement(i)) < 1e-8;
+    if (ok)
+    {
+        std::cout << "testNonsymmetricSolvers PASSED\n";
+    }
+    else
+    {
+        std::cout << "testNonsymmetricSolvers FAILED\n";
+    }
+}
+
+void testIterativeThreadInvariance()
+{
+    const int threads = KaloAlgebra::getThreadCount();
+    const long long threshold = KaloAlgebra::getSerialThreshold();
+    KaloAlgebra::setSerialThreshold(0);
+    const SparseMatrix A = gridOperator(40, 0.3);
+    const Vector b = Vector::random(A.getRows(), -1.0, 1.0);
+    KaloAlgebra::JacobiPreconditioner jacobi(A);
+    bool ok = true;
+    for (IterativeMethod method : {IterativeMethod::ConjugateGradient, IterativeMethod::BiCGSTAB, IterativeMethod::GMRES})
+    {
+        std::vector<Vector> results;
+        for (int count : {1, 4})
+        {
+            KaloAlgebra::setThreadCount(count);
+            IterativeSolver solver(method, A.getRows());
+            solver.setPreconditioner(&jacobi);
+            solver.setMaxIterations(50);
+            Vector x(A.getRows());
+            solver.solve(A, b.view(), x.view());
+            results.push_back(x);
+        }
+        ok = ok && results[0] == results[1];
+    }
+    KaloAlgebra::setThreadCount(threads);
+    KaloAlgebra::setSerialThreshold(threshold);
+    if (ok)
+    {
+        std::cout << "testIterativeThreadInvariance PASSED\n";
+    }
+    else
+    {
+        std::cout << "testIterativeThreadInvariance FAILED\n";
+    }
+}
+
+template <typename F>
+bool throwsInvalidArgument(F f)
+{
+    try
+    {
+        f();
+    }
+    catch (const std::invalid_argument &)
+    {
+        return true;
+    }
+    return false;
+}
+
+void testIterativeErrors()
+{
+    const SparseMatrix A = gridOperator(5, 0.0);
+    const Vector b = Vector::random(25, -1.0, 1.0);
+    IterativeSolver solver(IterativeMethod::ConjugateGradient, 25);
+    Vector x(25), wrong(24);
+    bool ok = throwsInvalidArgument([&]
+                                    { solver.solve(A, wrong.view(), x.view()); }) &&
+              throwsInvalidArgument([&]
+                                    { solver.solve(Matrix(24, 24), b.view(), x.view()); }) &&
+              throwsInvalidArgument([&]
+                                    { IterativeSolver(IterativeMethod::GMRES, 25, 0); }) &&
+              throwsInvalidArgument([&]
+                                    { solver.setTolerance(-1.0); }) &&
+              throwsInvalidArgument([&]
+                                    { KaloAlgebra::JacobiPreconditioner(Matrix(3, 3)); }) &&
+              throwsInvalidArgument([&]
+                                    { KaloAlgebra::ILU0Preconditioner(SparseMatrix::fromTriplets(2, 2, {{0, 1, 1.0}, {1, 0, 1.0}})); });
+    KaloAlgebra::JacobiPreconditioner small(gridOperator(2, 0.0));
+    ok = ok && throwsInvalidArgument([&]
+                                     { solver.setPreconditioner(&small); });
+
+    // b = 0 is solved by x = 0 at once; running out of iterations is reported, not thrown
+    Vector zero(25);
+    x = b;
+    ok = ok && solver.solve(A, zero.view(), x.view()) && x == zero && solver.getIterations() == 0;
+    solver.setMaxIterations(2);
+    ok = ok && !solver.solve(A, b.view(), x.view()) && solver.getIterations() == 2 && solver.getResidualNorm() > 1e-10;
+
+    // CG detects an indefinite matrix instead of diverging
+    solver.setMaxIterations(100);
+    const Matrix indefinite = A.toDense() - Matrix::identity(25) * 5.0;
+    x = zero;
+    ok = ok && !solver.solve(indefinite, b.view(), x.view()) && solver.getIterations() < 100;
+    if (ok)
+    {
+        std::cout << "testIterativeErrors PASSED\n";
+    }
+    else
+    {
+        std::cout << "testIterativeErrors FAILED\n";
+    }
+}
+
+int main()
+{
+    testConjugateGradient();
+    testNonsymmetricSolvers();
+    testIterativeThreadInvariance();
+    testIterativeErrors();
+    return 0;
+}
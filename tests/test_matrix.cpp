@@ -1,4 +1,6 @@
 #include <iostream>
+#include <cstdint>
+#include <cmath>
 #include "kalo_algebra.hpp"
 
 // Function to check if two matrices are equal
@@ -77,8 +79,23 @@ void testMatrixSubMatrix()
     expected.setElement(1, 0, 10.0); // mat(2, 1)
     expected.setElement(1, 1, 11.0); // mat(2, 2)
 
+    // A reversed range is rejected rather than giving an empty or negative-sized matrix
+    const int reversed[][4] = {{3, 3, 1, 1}, {3, 0, 1, 2}, {0, 3, 2, 1}};
+    int rejected = 0;
+    for (const auto &range : reversed)
+    {
+        try
+        {
+            mat.subMatrix(range[0], range[1], range[2], range[3]);
+        }
+        catch (const std::invalid_argument &)
+        {
+            rejected++;
+        }
+    }
+
     // Compare the result with the expected matrix
-    if (areMatricesEqual(subMat, expected))
+    if (areMatricesEqual(subMat, expected) && rejected == 3)
     {
         std::cout << "testMatrixSubMatrix PASSED\n";
     }
@@ -389,6 +406,473 @@ void testMatrixRandom()
     }
 }
 
+void testMatrixContiguousStorage()
+{
+    // Build a matrix wide enough to get a padded leading dimension
+    std::vector<std::vector<double>> input(3, std::vector<double>(10));
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 10; ++j)
+        {
+            input[i][j] = i * 10 + j;
+        }
+    }
+    Matrix mat(input);
+
+    // Storage must be 64-byte aligned, rows must be stride apart and hold the input values
+    bool aligned = reinterpret_cast<std::uintptr_t>(mat.data()) % 64 == 0;
+    bool strided = mat.getStride() >= mat.getCols() && mat.rowPtr(2) == mat.data() + 2 * mat.getStride();
+    bool valuesMatch = mat.rowPtr(1)[3] == 13.0 && mat.data()[2 * mat.getStride() + 9] == 29.0 && mat.getElement(2, 9) == 29.0;
+
+    if (aligned && strided && valuesMatch)
+    {
+        std::cout << "testMatrixContiguousStorage PASSED\n";
+    }
+    else
+    {
+        std::cout << "testMatrixContiguousStorage FAILED\n";
+    }
+}
+
+// Reference triple loop used to check the optimized kernels
+Matrix naiveMultiply(const Matrix &a, const Matrix &b)
+{
+    Matrix result(a.getRows(), b.getCols(), 0.0);
+    for (int i = 0; i < a.getRows(); i++)
+    {
+        for (int j = 0; j < b.getCols(); j++)
+        {
+            double sum = 0.0;
+            for (int k = 0; k < a.getCols(); k++)
+            {
+                sum += a.getElement(i, k) * b.getElement(k, j);
+            }
+            result.setElement(i, j, sum);
+        }
+    }
+    return result;
+}
+
+// Check two matrices agree within a relative tolerance
+bool areMatricesClose(const Matrix &mat1, const Matrix &mat2, double tolerance = 1e-9)
+{
+    if (mat1.getRows() != mat2.getRows() || mat1.getCols() != mat2.getCols())
+    {
+        return false;
+    }
+    for (int i = 0; i < mat1.getRows(); i++)
+    {
+        for (int j = 0; j < mat1.getCols(); j++)
+        {
+            double a = mat1.getElement(i, j), b = mat2.getElement(i, j);
+            if (std::fabs(a - b) > tolerance * (1.0 + std::fabs(a) + std::fabs(b)))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void testMatrixGemm()
+{
+    // Odd sizes exercise partial micro-tiles and more than one depth slice
+    Matrix a = Matrix::random(67, 300, -1.0, 1.0);
+    Matrix b = Matrix::random(300, 129, -1.0, 1.0);
+    Matrix c = Matrix::random(67, 129, -1.0, 1.0);
+
+    Matrix expectedProduct = naiveMultiply(a, b);
+    Matrix expectedUpdate = expectedProduct * 2.0 + c * 0.5;
+
+    Matrix product = a * b;
+    gemm(2.0, a, b, 0.5, c); // accumulate into c in place
+    bool allMatch = areMatricesClose(product, expectedProduct) && areMatricesClose(c, expectedUpdate);
+
+    // Every micro-kernel this CPU supports must give the same product
+    for (KaloAlgebra::Isa isa : {KaloAlgebra::Isa::Scalar, KaloAlgebra::Isa::AVX2, KaloAlgebra::Isa::AVX512})
+    {
+        if (!KaloAlgebra::isIsaSupported(isa))
+            continue;
+        KaloAlgebra::forceIsa(isa);
+        allMatch = allMatch && areMatricesClose(a * b, expectedProduct);
+    }
+    KaloAlgebra::resetIsa();
+
+    if (allMatch)
+    {
+        std::cout << "testMatrixGemm PASSED\n";
+    }
+    else
+    {
+        std::cout << "testMatrixGemm FAILED\n";
+    }
+}
+
+void testMatrixThreadCountInvariance()
+{
+    Matrix a = Matrix::random(150, 170, -1.0, 1.0);
+    Matrix b = Matrix::random(170, 130, -1.0, 1.0);
+    Matrix c = Matrix::random(150, 170, -1.0, 1.0);
+
+    // Serial reference
+    KaloAlgebra::setThreadCount(1);
+    Matrix product = a * b, sum = a + c, difference = a - c, scaled = a * 3.0, transposed = a.transpose();
+    Matrix square = Matrix::random(200, 200, -1.0, 1.0);
+    Matrix squareTransposed = square.transpose();
+
+    // Force the parallel path even for these small sizes and compare bit for bit
+    long long threshold = KaloAlgebra::getSerialThreshold();
+    KaloAlgebra::setSerialThreshold(0);
+    bool identical = true;
+    for (int threads : {2, 3, 8})
+    {
+        KaloAlgebra::setThreadCount(threads);
+        identical = identical && a * b == product && a + c == sum && a - c == difference && a * 3.0 == scaled && a.transpose() == transposed;
+        Matrix inPlace = square;
+        inPlace.transposeInPlace();
+        identical = identical && inPlace == squareTransposed;
+    }
+    KaloAlgebra::setSerialThreshold(threshold);
+    KaloAlgebra::setThreadCount(0);
+
+    if (identical)
+    {
+        std::cout << "testMatrixThreadCountInvariance PASSED\n";
+    }
+    else
+    {
+        std::cout << "testMatrixThreadCountInvariance FAILED\n";
+    }
+}
+
+void testMatrixFusedExpression()
+{
+    Matrix a = Matrix::random(37, 41, -1.0, 1.0);
+    Matrix b = Matrix::random(37, 41, -1.0, 1.0);
+    Matrix c = Matrix::random(37, 41, -1.0, 1.0);
+
+    // Evaluate one operation at a time
+    Matrix scaled = b * 2.0;
+    Matrix sum = a + scaled;
+    Matrix expected = sum - c;
+
+    // The fused expression must give the same bits, also when it reads its own destination
+    Matrix fused = a + b * 2.0 - c;
+    Matrix inPlace = a;
+    inPlace = inPlace + b * 2.0 - c;
+
+    if (fused == expected && inPlace == expected && areMatricesEqual(fused, expected))
+    {
+        std::cout << "testMatrixFusedExpression PASSED\n";
+    }
+    else
+    {
+        std::cout << "testMatrixFusedExpression FAILED\n";
+    }
+}
+
+void testMatrixViews()
+{
+    Matrix a = Matrix::random(20, 30, -1.0, 1.0);
+    Matrix b = Matrix::random(30, 12, -1.0, 1.0);
+    bool ok = true;
+
+    // block() aliases the storage, subMatrix() copies the same elements
+    MatrixView block = a.block(2, 3, 5, 7);
+    ok = ok && block == a.subMatrix(2, 3, 6, 9);
+    block.setElement(0, 0, 42.0);
+    ok = ok && a.getElement(2, 3) == 42.0;
+
+    // Row and column views read and write in place
+    a.row(4) *= 2.0;
+    a.col(1) += a.col(2);
+    Matrix reference = a;
+    a.row(0) = a.row(1) - a.row(2);
+    for (int j = 0; j < a.getCols(); j++)
+        ok = ok && a.getElement(0, j) == reference.getElement(1, j) - reference.getElement(2, j);
+    ok = ok && a.col(5).getSize() == a.getRows() && a.col(5).getElement(3) == a.getElement(3, 5);
+
+    // Views feed the product and gemm directly, without copying the blocks first
+    ConstMatrixView left = a.block(1, 2, 9, 11);
+    ConstMatrixView right = b.block(3, 1, 11, 8);
+    Matrix expected = naiveMultiply(left, right);
+    ok = ok && areMatricesClose(left * right, expected, 1e-12);
+    Matrix c = Matrix::zero(15, 15);
+    gemm(1.0, left, right, 0.0, c.block(4, 5, 9, 8));
+    ok = ok && areMatricesClose(c.block(4, 5, 9, 8), expected, 1e-12) && c.getElement(0, 0) == 0.0;
+
+    // Disjoint blocks of one matrix may be operands and output of the same call
+    Matrix m = Matrix::random(8, 12, -1.0, 1.0);
+    Matrix blocked = naiveMultiply(m.block(0, 0, 8, 4), m.block(0, 0, 4, 4));
+    gemm(1.0, m.block(0, 0, 8, 4), m.block(0, 0, 4, 4), 0.0, m.block(0, 4, 8, 4));
+    ok = ok && areMatricesClose(m.block(0, 4, 8, 4), blocked, 1e-12);
+    Matrix transposed = naiveMultiply(m.block(0, 0, 4, 8), m.block(0, 8, 8, 4)).transpose();
+    gemm(1.0, m.block(0, 0, 4, 8), m.block(0, 8, 8, 4), 0.0, m.block(4, 0, 4, 4).t());
+    ok = ok && areMatricesClose(m.block(4, 0, 4, 4), transposed, 1e-12);
+    Matrix column = naiveMultiply(m.block(0, 0, 2, 6), m.block(0, 11, 6, 1));
+    gemv(1.0, m.block(0, 0, 2, 6), m.col(11).segment(0, 6), 0.0, m.col(11).segment(6, 2));
+    ok = ok && areMatricesClose(m.block(6, 11, 2, 1), column, 1e-12);
+
+    // Assigning a leading block of a matrix to the matrix itself shrinks it to that block
+    const Matrix whole = m;
+    m = m.block(0, 0, 5, 12);
+    ok = ok && m == whole.subMatrix(0, 0, 4, 11);
+    m = m.block(0, 0, 3, 7);
+    ok = ok && m == whole.subMatrix(0, 0, 2, 6);
+
+    // A view overlapping the output is rejected
+    bool threw = false;
+    try
+    {
+        gemm(1.0, a.block(0, 0, 10, 10), a.block(0, 0, 10, 10), 0.0, a.block(5, 5, 10, 10));
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+
+    if (ok && threw)
+    {
+        std::cout << "testMatrixViews PASSED\n";
+    }
+    else
+    {
+        std::cout << "testMatrixViews FAILED\n";
+    }
+}
+
+void testMatrixBlockedTranspose()
+{
+    bool ok = true;
+    const int shapes[][2] = {{1, 1}, {1, 9}, {7, 3}, {8, 8}, {33, 65}, {64, 64}, {131, 77}, {257, 257}};
+    for (KaloAlgebra::Isa isa : {KaloAlgebra::Isa::Scalar, KaloAlgebra::Isa::SSE2, KaloAlgebra::Isa::AVX2, KaloAlgebra::Isa::AVX512})
+    {
+        if (!KaloAlgebra::isIsaSupported(isa))
+            continue;
+        KaloAlgebra::forceIsa(isa);
+        for (const auto &shape : shapes)
+        {
+            Matrix a = Matrix::random(shape[0], shape[1], -1.0, 1.0);
+            Matrix t = a.transpose();
+            ok = ok && t.getRows() == a.getCols() && t.getCols() == a.getRows();
+            for (int i = 0; i < a.getRows(); i++)
+                for (int j = 0; j < a.getCols(); j++)
+                    ok = ok && t.getElement(j, i) == a.getElement(i, j);
+
+            if (shape[0] == shape[1])
+            {
+                Matrix b = a;
+                b.transposeInPlace();
+                ok = ok && b == t;
+            }
+        }
+    }
+    KaloAlgebra::resetIsa();
+
+    bool threw = false;
+    try
+    {
+        Matrix(3, 4).transposeInPlace();
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+
+    if (ok && threw)
+    {
+        std::cout << "testMatrixBlockedTranspose PASSED\n";
+    }
+    else
+    {
+        std::cout << "testMatrixBlockedTranspose FAILED\n";
+    }
+}
+
+void testMatrixVectorProducts()
+{
+    Matrix a = Matrix::random(37, 53, -1.0, 1.0);
+    Vector x = Vector::random(53, -1.0, 1.0);
+    Vector z = Vector::random(37, -1.0, 1.0);
+    const double tolerance = 1e-12;
+    bool ok = true;
+
+    // A * x and x^T * A against plain loops
+    Vector ax = a * x;
+    Vector za = z * a;
+    ok = ok && ax.getSize() == 37 && za.getSize() == 53;
+    for (int i = 0; i < 37; i++)
+    {
+        double sum = 0.0;
+        for (int j = 0; j < 53; j++)
+            sum += a.getElement(i, j) * x.getElement(j);
+        ok = ok && std::fabs(ax.getElement(i) - sum) < tolerance;
+    }
+    for (int j = 0; j < 53; j++)
+    {
+        double sum = 0.0;
+        for (int i = 0; i < 37; i++)
+            sum += z.getElement(i) * a.getElement(i, j);
+        ok = ok && std::fabs(za.getElement(j) - sum) < tolerance;
+    }
+
+    // Views and strided vectors go straight to the kernel
+    Vector column = a.block(2, 3, 10, 20) * a.row(0).segment(0, 20);
+    for (int i = 0; i < 10; i++)
+    {
+        double sum = 0.0;
+        for (int j = 0; j < 20; j++)
+            sum += a.getElement(i + 2, j + 3) * a.getElement(0, j);
+        ok = ok && std::fabs(column.getElement(i) - sum) < tolerance;
+    }
+
+    // gemv accumulates, ger applies a rank-1 update
+    Vector y = z;
+    gemv(2.0, a, x, 0.5, y);
+    for (int i = 0; i < 37; i++)
+        ok = ok && std::fabs(y.getElement(i) - (2.0 * ax.getElement(i) + 0.5 * z.getElement(i))) < tolerance;
+    Matrix updated = a;
+    ger(3.0, z, x, updated);
+    for (int i = 0; i < 37; i++)
+        for (int j = 0; j < 53; j++)
+            ok = ok && std::fabs(updated.getElement(i, j) - (a.getElement(i, j) + 3.0 * z.getElement(i) * x.getElement(j))) < tolerance;
+
+    // The parallel kernels give the same bits as the serial ones
+    Vector serialAx = a * x, serialZa = z * a;
+    long long threshold = KaloAlgebra::getSerialThreshold();
+    KaloAlgebra::setSerialThreshold(0);
+    KaloAlgebra::setThreadCount(3);
+    ok = ok && a * x == serialAx && z * a == serialZa;
+    KaloAlgebra::setThreadCount(0);
+    KaloAlgebra::setSerialThreshold(threshold);
+
+    bool threw = false;
+    try
+    {
+        Vector wrong = a * z;
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+
+    if (ok && threw)
+    {
+        std::cout << "testMatrixVectorProducts PASSED\n";
+    }
+    else
+    {
+        std::cout << "testMatrixVectorProducts FAILED\n";
+    }
+}
+
+void testMatrixLazyTranspose()
+{
+    Matrix a = Matrix::random(130, 150, -1.0, 1.0);
+    Matrix b = Matrix::random(130, 90, -1.0, 1.0);
+    Matrix c = Matrix::random(90, 150, -1.0, 1.0);
+    Matrix at = a.transpose(), bt = b.transpose(), ct = c.transpose();
+
+    // t() is a view onto the same storage with the indices swapped
+    bool ok = a.t().getRows() == 150 && a.t().getCols() == 130 && a.t().data() == a.data() && a.t().t().getRowStride() == a.getStride();
+    a.t().setElement(4, 2, 7.0);
+    ok = ok && a.getElement(2, 4) == 7.0;
+    at.setElement(4, 2, 7.0);
+
+    // The TN, NT and TT forms give the products of the copied transposes, for every micro-kernel
+    for (KaloAlgebra::Isa isa : {KaloAlgebra::Isa::Scalar, KaloAlgebra::Isa::AVX2, KaloAlgebra::Isa::AVX512})
+    {
+        if (!KaloAlgebra::isIsaSupported(isa))
+            continue;
+        KaloAlgebra::forceIsa(isa);
+        ok = ok && areMatricesClose(a.t() * b, naiveMultiply(at, b)) && areMatricesClose(a * c.t(), naiveMultiply(a, ct)) &&
+             areMatricesClose(c.t() * b.t(), naiveMultiply(ct, bt));
+
+        // X^T X and X X^T only compute half, and come out exactly symmetric
+        Matrix gram = a.t() * a, outer = a * a.t();
+        ok = ok && areMatricesClose(gram, naiveMultiply(at, a)) && areMatricesClose(outer, naiveMultiply(a, at)) &&
+             gram == gram.transpose() && outer == outer.transpose();
+    }
+    KaloAlgebra::resetIsa();
+
+    // syrk accumulates into a symmetric C, including a column-major one, and does not depend on the thread count
+    Matrix symmetric = b * b.t();
+    Matrix expected = naiveMultiply(a, at) * 2.0 + symmetric * 0.5;
+    Matrix updated = symmetric, columnMajor = symmetric;
+    syrk(2.0, a, 0.5, updated);
+    syrk(2.0, a, 0.5, columnMajor.t());
+    ok = ok && areMatricesClose(updated, expected) && columnMajor == updated;
+    Matrix serialGram = a.t() * a;
+    long long threshold = KaloAlgebra::getSerialThreshold();
+    KaloAlgebra::setSerialThreshold(0);
+    KaloAlgebra::setThreadCount(3);
+    Matrix parallel = symmetric;
+    syrk(2.0, a, 0.5, parallel);
+    ok = ok && parallel == updated && a.t() * a == serialGram;
+    KaloAlgebra::setThreadCount(0);
+    KaloAlgebra::setSerialThreshold(threshold);
+
+    // Matrix-vector products read the transposed operand in place too
+    Vector x = Vector::random(130, -1.0, 1.0);
+    Vector atx = a.t() * x, xa = x * a;
+    for (int j = 0; j < 150; j++)
+        ok = ok && std::fabs(atx.getElement(j) - xa.getElement(j)) < 1e-12;
+
+    // Assigning an expression that reads the destination transposed or shifted gives the same
+    // result as reading a copy, serially and split over threads
+    for (int count : {1, 4})
+    {
+        KaloAlgebra::setSerialThreshold(0);
+        KaloAlgebra::setThreadCount(count);
+        Matrix square = Matrix::random(300, 300, -1.0, 1.0);
+        const Matrix original = square;
+        square += square.t();
+        ok = ok && square == original + original.transpose();
+        square = original;
+        square -= square.t() * 2.0;
+        ok = ok && square == original - original.transpose() * 2.0;
+        square = original;
+        square = square.t();
+        ok = ok && square == original.transpose();
+        square = original;
+        square = square.t() + square;
+        ok = ok && square == original.transpose() + original;
+        Matrix wide = a;
+        wide = wide.t();
+        ok = ok && wide == at;
+        Matrix column = Matrix::random(300, 1, -1.0, 1.0);
+        const Matrix columnCopy = column;
+        column = column.t();
+        ok = ok && column == columnCopy.transpose();
+        column = column.t();
+        ok = ok && column == columnCopy;
+        wide = a;
+        wide = wide.view().block(1, 2, 120, 140);
+        ok = ok && wide == Matrix(a.view().block(1, 2, 120, 140));
+    }
+    KaloAlgebra::setThreadCount(0);
+    KaloAlgebra::setSerialThreshold(threshold);
+
+    bool threw = false;
+    try
+    {
+        syrk(1.0, a, 0.0, Matrix(150, 150));
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+
+    if (ok && threw)
+    {
+        std::cout << "testMatrixLazyTranspose PASSED\n";
+    }
+    else
+    {
+        std::cout << "testMatrixLazyTranspose FAILED\n";
+    }
+}
+
 int main()
 {
     testMatrixTranspose();
@@ -404,5 +888,13 @@ int main()
     testMatrixInequality();
     testMatrixZero();
     testMatrixRandom();
+    testMatrixContiguousStorage();
+    testMatrixGemm();
+    testMatrixThreadCountInvariance();
+    testMatrixFusedExpression();
+    testMatrixViews();
+    testMatrixBlockedTranspose();
+    testMatrixVectorProducts();
+    testMatrixLazyTranspose();
     return 0;
 }
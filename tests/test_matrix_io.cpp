@@ -0,0 +1,188 @@
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "kalo_algebra.hpp"
+
+using KaloAlgebra::Matrix;
+
+std::string temporaryPath(const std::string &name)
+{
+    return (std::filesystem::temp_directory_path() / ("kalo_algebra_test_" + name + ".kmat")).string();
+}
+
+template <typename A, typename B>
+bool sameElements(const A &a, const B &b)
+{
+    if (a.getRows() != b.getRows() || a.getCols() != b.getCols())
+        return false;
+    for (int i = 0; i < a.getRows(); i++)
+        for (int j = 0; j < a.getCols(); j++)
+            if (a.getElement(i, j) != b.getElement(i, j))
+                return false;
+    return true;
+}
+
+template <typename E>
+bool throws(const std::function<void()> &body)
+{
+    try
+    {
+        body();
+    }
+    catch (const E &)
+    {
+        return true;
+    }
+    return false;
+}
+
+void testRoundTrip()
+{
+    const std::string path = temporaryPath("round_trip");
+    Matrix a = Matrix::random(70, 35, -1.0, 1.0);
+    KaloAlgebra::save(path, a);
+
+    Matrix loaded = KaloAlgebra::load(path);
+    bool ok = loaded == a;
+    {
+        KaloAlgebra::MappedMatrix mapped = KaloAlgebra::loadMapped(path);
+        ok = ok && sameElements(mapped, a) && reinterpret_cast<std::uintptr_t>(mapped.data()) % 64 == 0;
+        // The mapping is a read-only operand like any other view
+        Matrix product(70, 70), expected = a * a.transpose();
+        KaloAlgebra::gemm(1.0, mapped, a.transpose(), 0.0, product);
+        ok = ok && product == expected && mapped.toMatrix() == a;
+    }
+
+    // Strided views: a block, and a transpose with non-unit column stride
+    KaloAlgebra::ConstMatrixView block = a.view().block(5, 3, 20, 11);
+    KaloAlgebra::save(path, block);
+    ok = ok && sameElements(KaloAlgebra::load(path), block);
+    KaloAlgebra::ConstMatrixView transposed(a.data(), a.getCols(), a.getRows(), 1, a.getStride());
+    KaloAlgebra::save(path, transposed);
+    ok = ok && KaloAlgebra::load(path) == a.transpose() && sameElements(KaloAlgebra::loadMapped(path), a.transpose());
+
+    // Other scalar types
+    KaloAlgebra::FloatMatrix f = KaloAlgebra::FloatMatrix::random(9, 40, -1.0f, 1.0f);
+    KaloAlgebra::save(path, f);
+    ok = ok && KaloAlgebra::load<float>(path) == f && sameElements(KaloAlgebra::loadMapped<float>(path), f);
+    KaloAlgebra::ComplexMatrix z = KaloAlgebra::ComplexMatrix::random(13, 6, -1.0, 1.0);
+    KaloAlgebra::save(path, z);
+    ok = ok && KaloAlgebra::load<std::complex<double>>(path) == z && sameElements(KaloAlgebra::loadMapped<std::complex<double>>(path), z);
+
+    std::filesystem::remove(path);
+    if (ok)
+    {
+        std::cout << "testRoundTrip PASSED\n";
+    }
+    else
+    {
+        std::cout << "testRoundTrip FAILED\n";
+    }
+}
+
+// A file as written on a machine of the other byte order
+void testByteOrder()
+{
+    const std::string path = temporaryPath("byte_order");
+    Matrix a = Matrix::random(3, 5, -1.0, 1.0);
+    KaloAlgebra::save(path, a);
+
+    const auto swapped = [](auto value)
+    {
+        unsigned char bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+        std::reverse(bytes, bytes + sizeof(value));
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    };
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    KaloAlgebraIO::FileHeader header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    std::vector<double> values(header.rows * header.rowStride);
+    file.read(reinterpret_cast<char *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(double)));
+    header.version = swapped(header.version);
+    header.byteOrder = swapped(header.byteOrder);
+    header.scalar = swapped(header.scalar);
+    header.alignment = swapped(header.alignment);
+    header.rows = swapped(header.rows);
+    header.cols = swapped(header.cols);
+    header.rowStride = swapped(header.rowStride);
+    header.dataOffset = swapped(header.dataOffset);
+    for (double &value : values)
+        value = swapped(value);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(double)));
+    file.close();
+
+    bool ok = KaloAlgebra::load(path) == a;
+    ok = ok && throws<std::invalid_argument>([&]
+                                             { KaloAlgebra::loadMapped(path); });
+
+    std::filesystem::remove(path);
+    if (ok)
+    {
+        std::cout << "testByteOrder PASSED\n";
+    }
+    else
+    {
+        std::cout << "testByteOrder FAILED\n";
+    }
+}
+
+void testInvalidFiles()
+{
+    const std::string path = temporaryPath("invalid");
+    KaloAlgebra::save(path, Matrix::random(8, 8, -1.0, 1.0));
+
+    // Wrong scalar type
+    bool ok = throws<std::invalid_argument>([&]
+                                            { KaloAlgebra::load<float>(path); }) &&
+              throws<std::invalid_argument>([&]
+                                            { KaloAlgebra::loadMapped<std::complex<double>>(path); });
+
+    // Truncated data
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    ok = ok && throws<std::invalid_argument>([&]
+                                             { KaloAlgebra::load(path); }) &&
+         throws<std::invalid_argument>([&]
+                                       { KaloAlgebra::loadMapped(path); });
+
+    // Not a matrix file at all, an empty one, and a missing one
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "1 2 3\n4 5 6\n";
+    ok = ok && throws<std::invalid_argument>([&]
+                                             { KaloAlgebra::load(path); });
+    std::ofstream(path, std::ios::binary | std::ios::trunc);
+    ok = ok && throws<std::invalid_argument>([&]
+                                             { KaloAlgebra::loadMapped(path); });
+    std::filesystem::remove(path);
+    ok = ok && throws<std::runtime_error>([&]
+                                          { KaloAlgebra::load(path); }) &&
+         throws<std::runtime_error>([&]
+                                    { KaloAlgebra::loadMapped(path); });
+
+    if (ok)
+    {
+        std::cout << "testInvalidFiles PASSED\n";
+    }
+    else
+    {
+        std::cout << "testInvalidFiles FAILED\n";
+    }
+}
+
+int main()
+{
+    testRoundTrip();
+    testByteOrder();
+    testInvalidFiles();
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <cmath>
+#include <complex>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include "kalo_algebra.hpp"
+
+using KaloAlgebra::Matrix;
+
+std::string temporaryPath(const std::string &name)
+{
+    return (std::filesystem::temp_directory_path() / ("kalo_algebra_test_" + name + ".kmat")).string();
+}
+
+template <typename A, typename B>
+double maxDifference(const A &a, const B &b)
+{
+    double difference = 0.0;
+    for (int i = 0; i < a.getRows(); i++)
+        for (int j = 0; j < a.getCols(); j++)
+            difference = std::max(difference, static_cast<double>(std::abs(a.getElement(i, j) - b.getElement(i, j))));
+    return difference;
+}
+
+void testMappedOperands()
+{
+    const std::string aPath = temporaryPath("ooc_a"), bPath = temporaryPath("ooc_b"), cPath = temporaryPath("ooc_c");
+    Matrix a = Matrix::random(300, 200, -1.0, 1.0), b = Matrix::random(200, 250, -1.0, 1.0);
+    KaloAlgebra::save(aPath, a);
+    KaloAlgebra::save(bPath, b);
+    const Matrix expected = a * b;
+
+    // A budget of six 64 x 64 tiles: 5 x 4 tiles of C, 4 steps each, ragged at every edge
+    const std::size_t budget = 6 * 64 * 64 * sizeof(double);
+    bool ok = KaloAlgebra::outOfCoreTileSize<double>(budget) == 64;
+    {
+        KaloAlgebra::MappedMatrix mappedA = KaloAlgebra::loadMapped(aPath), mappedB = KaloAlgebra::loadMapped(bPath);
+        KaloAlgebra::multiplyOutOfCore(mappedA, mappedB, cPath, budget);
+    }
+    {
+        KaloAlgebra::MappedMatrix c = KaloAlgebra::loadMapped(cPath);
+        ok = ok && c.getRows() == 300 && c.getCols() == 250 && maxDifference(c, expected) < 1e-12;
+    }
+
+    // A budget larger than the problem uses one tile
+    KaloAlgebra::multiplyOutOfCore<double>(a.view(), b.view(), cPath);
+    ok = ok && maxDifference(KaloAlgebra::load(cPath), expected) < 1e-12;
+
+    std::filesystem::remove(aPath);
+    std::filesystem::remove(bPath);
+    std::filesystem::remove(cPath);
+    if (ok)
+    {
+        std::cout << "testMappedOperands PASSED\n";
+    }
+    else
+    {
+        std::cout << "testMappedOperands FAILED\n";
+    }
+}
+
+void testOperandsAndEdgeCases()
+{
+    const std::string cPath = temporaryPath("ooc_edge");
+    const std::size_t budget = 6 * 32 * 32 * sizeof(std::complex<double>);
+
+    // Strided views, and a complex product
+    Matrix a = Matrix::random(90, 70, -1.0, 1.0), b = Matrix::random(40, 90, -1.0, 1.0);
+    KaloAlgebra::ConstMatrixView aT(a.data(), 70, 90, 1, a.getStride());
+    KaloAlgebra::ConstMatrixView bT(b.data(), 90, 40, 1, b.getStride());
+    KaloAlgebra::multiplyOutOfCore<double>(aT, bT, cPath, budget);
+    bool ok = maxDifference(KaloAlgebra::load(cPath), a.transpose() * b.transpose()) < 1e-12;
+
+    KaloAlgebra::ComplexMatrix z = KaloAlgebra::ComplexMatrix::random(50, 33, -1.0, 1.0), w = KaloAlgebra::ComplexMatrix::random(33, 45, -1.0, 1.0);
+    KaloAlgebra::multiplyOutOfCore<std::complex<double>>(z.view(), w.view(), cPath, budget);
+    ok = ok && maxDifference(KaloAlgebra::load<std::complex<double>>(cPath), z * w) < 1e-12;
+
+    // Errors
+    bool threw = false;
+    try
+    {
+        KaloAlgebra::multiplyOutOfCore<double>(a.view(), a.view(), cPath, budget);
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    ok = ok && threw;
+    threw = false;
+    try
+    {
+        KaloAlgebra::multiplyOutOfCore<double>(a.view(), aT, cPath, 1024);
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    ok = ok && threw;
+
+    std::filesystem::remove(cPath);
+    if (ok)
+    {
+        std::cout << "testOperandsAndEdgeCases PASSED\n";
+    }
+    else
+    {
+        std::cout << "testOperandsAndEdgeCases FAILED\n";
+    }
+}
+
+int main()
+{
+    testMappedOperands();
+    testOperandsAndEdgeCases();
+    return 0;
+}
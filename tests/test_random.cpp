@@ -0,0 +1,152 @@
+#include <iostream>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+#include "kalo_algebra.hpp"
+
+using KaloAlgebra::Matrix;
+using KaloAlgebra::RandomGenerator;
+
+void testPhiloxKnownAnswers()
+{
+    // Reference outputs of Philox4x32-10 from the Random123 distribution
+    const auto a = KaloAlgebra::philox4x32({0, 0, 0, 0}, {0, 0});
+    const auto b = KaloAlgebra::philox4x32({0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}, {0xffffffffu, 0xffffffffu});
+    const auto c = KaloAlgebra::philox4x32({0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}, {0xa4093822u, 0x299f31d0u});
+    bool ok = a == std::array<std::uint32_t, 4>{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u} &&
+              b == std::array<std::uint32_t, 4>{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu} &&
+              c == std::array<std::uint32_t, 4>{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u};
+
+    // A generator's block n of stream s is Philox of counter (n, s) under the seed
+    RandomGenerator generator(0x299f31d0a4093822ull, 0x0370734413198a2eull);
+    generator.setPosition(0x85a308d3243f6a88ull);
+    ok = ok && generator.nextBlock() == c && generator.getPosition() == 0x85a308d3243f6a89ull;
+    if (ok)
+    {
+        std::cout << "testPhiloxKnownAnswers PASSED\n";
+    }
+    else
+    {
+        std::cout << "testPhiloxKnownAnswers FAILED\n";
+    }
+}
+
+void testReproducibility()
+{
+    // The same seed gives the same bits for every thread count and instruction set
+    const int threads = KaloAlgebra::getThreadCount();
+    const long long threshold = KaloAlgebra::getSerialThreshold();
+    KaloAlgebra::setSerialThreshold(0);
+    RandomGenerator reference(42);
+    const Matrix expected = Matrix::random(300, 301, -2.0, 3.0, reference);
+    bool ok = reference.getPosition() == (300 * 301 + 1) / 2;
+    for (int count : {1, 4})
+    {
+        KaloAlgebra::setThreadCount(count);
+        for (KaloAlgebra::Isa isa : {KaloAlgebra::Isa::Scalar, KaloAlgebra::Isa::SSE2, KaloAlgebra::Isa::AVX2, KaloAlgebra::Isa::AVX512})
+        {
+            if (!KaloAlgebra::isIsaSupported(isa))
+                continue;
+            KaloAlgebra::forceIsa(isa);
+            RandomGenerator generator(42);
+            ok = ok && Matrix::random(300, 301, -2.0, 3.0, generator) == expected;
+        }
+    }
+    KaloAlgebra::resetIsa();
+    KaloAlgebra::setThreadCount(threads);
+    KaloAlgebra::setSerialThreshold(threshold);
+
+    // A strided target gets the values a contiguous one would, in row-major element order
+    RandomGenerator contiguous(7), strided(7);
+    KaloAlgebra::Vector column(40);
+    Matrix matrix(40, 3);
+    contiguous.fillNormal(column.view(), 1.0, 2.0);
+    strided.fillNormal(matrix.view().col(1), 1.0, 2.0);
+    for (int i = 0; i < 40; i++)
+        ok = ok && matrix.getElement(i, 1) == column.getElement(i) && matrix.getElement(i, 0) == 0.0;
+
+    // Different seeds and streams give different values; the generator advances after each fill
+    RandomGenerator first(1), other(2), split = first.split(1);
+    const Matrix a = Matrix::random(4, 4, 0.0, 1.0, first), b = Matrix::random(4, 4, 0.0, 1.0, first);
+    ok = ok && a != b && a != Matrix::random(4, 4, 0.0, 1.0, other) && a != Matrix::random(4, 4, 0.0, 1.0, split);
+    RandomGenerator draws(3), again(3);
+    ok = ok && KaloAlgebra::randomDouble(-1.0, 1.0, draws) == KaloAlgebra::randomDouble(-1.0, 1.0, again);
+    if (ok)
+    {
+        std::cout << "testReproducibility PASSED\n";
+    }
+    else
+    {
+        std::cout << "testReproducibility FAILED\n";
+    }
+}
+
+template <typename R>
+bool checkMoments(const std::vector<R> &values, double mean, double variance, double low, double high)
+{
+    double sum = 0.0, squares = 0.0;
+    for (R value : values)
+    {
+        if (!(value >= low && value < high))
+            return false;
+        sum += value;
+        squares += static_cast<double>(value) * value;
+    }
+    const double n = static_cast<double>(values.size());
+    const double sampleMean = sum / n, sampleVariance = squares / n - sampleMean * sampleMean;
+    return std::abs(sampleMean - mean) < 0.02 && std::abs(sampleVariance - variance) < 0.03 * variance;
+}
+
+template <typename R>
+bool checkDistributions()
+{
+    RandomGenerator generator(12345);
+    std::vector<R> values(100001); // odd, so the last block is partly used
+    generator.fillUniform(values.data(), values.size(), R(-1), R(3));
+    bool ok = checkMoments(values, 1.0, 16.0 / 12.0, -1.0, 3.0);
+    generator.fillNormal(values.data(), values.size(), R(0.5), R(2));
+    ok = ok && checkMoments(values, 0.5, 4.0, -100.0, 100.0);
+
+    // Complex elements: both parts drawn independently
+    std::vector<std::complex<R>> complexValues(50000);
+    generator.fillUniform(complexValues.data(), complexValues.size(), R(0), R(1));
+    std::vector<R> realParts, imaginaryParts;
+    for (const std::complex<R> &value : complexValues)
+    {
+        realParts.push_back(value.real());
+        imaginaryParts.push_back(value.imag());
+    }
+    return ok && checkMoments(realParts, 0.5, 1.0 / 12.0, 0.0, 1.0) && checkMoments(imaginaryParts, 0.5, 1.0 / 12.0, 0.0, 1.0);
+}
+
+void testDistributions()
+{
+    bool ok = checkDistributions<double>() && checkDistributions<float>();
+    bool threw = false;
+    try
+    {
+        KaloAlgebra::randomDouble(1.0, 0.0);
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    ok = ok && threw;
+    if (ok)
+    {
+        std::cout << "testDistributions PASSED\n";
+    }
+    else
+    {
+        std::cout << "testDistributions FAILED\n";
+    }
+}
+
+int main()
+{
+    testPhiloxKnownAnswers();
+    testReproducibility();
+    testDistributions();
+    return 0;
+}
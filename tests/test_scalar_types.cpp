@@ -0,0 +1,235 @@
+#include <iostream>
+#include <cmath>
+#include <complex>
+#include "kalo_algebra.hpp"
+
+using KaloAlgebra::BasicMatrix;
+using KaloAlgebra::BasicVector;
+
+// Largest |a - b| over all elements, or infinity on a shape mismatch
+template <typename T>
+double maxDifference(const BasicMatrix<T> &a, const BasicMatrix<T> &b)
+{
+    if (a.getRows() != b.getRows() || a.getCols() != b.getCols())
+        return INFINITY;
+    double difference = 0.0;
+    for (int i = 0; i < a.getRows(); i++)
+        for (int j = 0; j < a.getCols(); j++)
+            difference = std::max(difference, static_cast<double>(std::abs(a.getElement(i, j) - b.getElement(i, j))));
+    return difference;
+}
+
+// Reference product with the same scalar type, summed in order
+template <typename T>
+BasicMatrix<T> naiveMultiply(const BasicMatrix<T> &a, const BasicMatrix<T> &b)
+{
+    BasicMatrix<T> result(a.getRows(), b.getCols());
+    for (int i = 0; i < a.getRows(); i++)
+        for (int j = 0; j < b.getCols(); j++)
+        {
+            T sum = T(0);
+            for (int k = 0; k < a.getCols(); k++)
+                sum += a.getElement(i, k) * b.getElement(k, j);
+            result.setElement(i, j, sum);
+        }
+    return result;
+}
+
+// Product and accumulate against the reference, under every micro-kernel this CPU supports
+template <typename T>
+bool gemmMatchesReference(double tolerance)
+{
+    // Odd sizes exercise partial micro-tiles and more than one depth slice
+    BasicMatrix<T> a = BasicMatrix<T>::random(67, 300, -1, 1);
+    BasicMatrix<T> b = BasicMatrix<T>::random(300, 129, -1, 1);
+    BasicMatrix<T> c = BasicMatrix<T>::random(67, 129, -1, 1);
+    BasicMatrix<T> expectedProduct = naiveMultiply(a, b);
+    BasicMatrix<T> expectedUpdate = expectedProduct * T(2) + c * T(0.5);
+
+    bool ok = true;
+    for (KaloAlgebra::Isa isa : {KaloAlgebra::Isa::Scalar, KaloAlgebra::Isa::SSE2, KaloAlgebra::Isa::AVX2, KaloAlgebra::Isa::AVX512})
+    {
+        if (!KaloAlgebra::isIsaSupported(isa))
+            continue;
+        KaloAlgebra::forceIsa(isa);
+        ok = ok && maxDifference<T>(a * b, expectedProduct) < tolerance;
+    }
+    KaloAlgebra::resetIsa();
+
+    gemm(T(2), a, b, T(0.5), c);
+    return ok && maxDifference(c, expectedUpdate) < tolerance;
+}
+
+void testScalarTypesGemm()
+{
+    bool ok = gemmMatchesReference<float>(1e-3) && gemmMatchesReference<double>(1e-10) &&
+              gemmMatchesReference<std::complex<float>>(1e-3) && gemmMatchesReference<std::complex<double>>(1e-10);
+
+    if (ok)
+    {
+        std::cout << "testScalarTypesGemm PASSED\n";
+    }
+    else
+    {
+        std::cout << "testScalarTypesGemm FAILED\n";
+    }
+}
+
+template <typename T>
+bool transposeMatchesElements()
+{
+    bool ok = true;
+    const int shapes[][2] = {{1, 9}, {7, 3}, {16, 16}, {33, 65}, {131, 77}};
+    for (KaloAlgebra::Isa isa : {KaloAlgebra::Isa::Scalar, KaloAlgebra::Isa::SSE2, KaloAlgebra::Isa::AVX2, KaloAlgebra::Isa::AVX512})
+    {
+        if (!KaloAlgebra::isIsaSupported(isa))
+            continue;
+        KaloAlgebra::forceIsa(isa);
+        for (const auto &shape : shapes)
+        {
+            BasicMatrix<T> a = BasicMatrix<T>::random(shape[0], shape[1], -1, 1);
+            BasicMatrix<T> t = a.transpose();
+            for (int i = 0; i < a.getRows(); i++)
+                for (int j = 0; j < a.getCols(); j++)
+                    ok = ok && t.getElement(j, i) == a.getElement(i, j);
+            if (shape[0] == shape[1])
+            {
+                BasicMatrix<T> b = a;
+                b.transposeInPlace();
+                ok = ok && b == t;
+            }
+        }
+    }
+    KaloAlgebra::resetIsa();
+    return ok;
+}
+
+void testScalarTypesTranspose()
+{
+    if (transposeMatchesElements<float>() && transposeMatchesElements<std::complex<float>>() && transposeMatchesElements<std::complex<double>>())
+    {
+        std::cout << "testScalarTypesTranspose PASSED\n";
+    }
+    else
+    {
+        std::cout << "testScalarTypesTranspose FAILED\n";
+    }
+}
+
+// Fused expressions, gemv and ger against element-by-element loops
+template <typename T>
+bool vectorOperationsMatch(double tolerance)
+{
+    BasicMatrix<T> a = BasicMatrix<T>::random(37, 53, -1, 1);
+    BasicVector<T> x = BasicVector<T>::random(53, -1, 1);
+    BasicVector<T> y = BasicVector<T>::random(37, -1, 1);
+    BasicVector<T> z = BasicVector<T>::random(37, -1, 1);
+    const T alpha = T(1.5);
+
+    BasicVector<T> fused = y * alpha - z + y;
+    BasicVector<T> ax = a * x;
+    BasicVector<T> ya = y * a;
+    BasicMatrix<T> outer = a;
+    ger(alpha, y, x, outer);
+    BasicVector<T> updated = z;
+    axpy(alpha, y, updated);
+
+    bool ok = true;
+    for (int i = 0; i < 37; i++)
+    {
+        T sum = T(0);
+        for (int j = 0; j < 53; j++)
+        {
+            sum += a.getElement(i, j) * x.getElement(j);
+            ok = ok && std::abs(outer.getElement(i, j) - (a.getElement(i, j) + alpha * y.getElement(i) * x.getElement(j))) < tolerance;
+        }
+        ok = ok && std::abs(ax.getElement(i) - sum) < tolerance && std::abs(fused.getElement(i) - (y.getElement(i) * alpha - z.getElement(i) + y.getElement(i))) < tolerance;
+        ok = ok && std::abs(updated.getElement(i) - (z.getElement(i) + alpha * y.getElement(i))) < tolerance;
+    }
+    for (int j = 0; j < 53; j++)
+    {
+        T sum = T(0);
+        for (int i = 0; i < 37; i++)
+            sum += y.getElement(i) * a.getElement(i, j);
+        ok = ok && std::abs(ya.getElement(j) - sum) < tolerance;
+    }
+
+    T dot = T(0);
+    double squares = 0.0;
+    for (int i = 0; i < 37; i++)
+    {
+        dot += y.getElement(i) * z.getElement(i);
+        squares += std::norm(y.getElement(i));
+    }
+    return ok && std::abs(y.dot(z) - dot) < tolerance && std::abs(y * z - dot) < tolerance &&
+           std::abs(y.magnitude() - std::sqrt(squares)) < tolerance;
+}
+
+void testScalarTypesVectorOperations()
+{
+    bool ok = vectorOperationsMatch<float>(1e-4) && vectorOperationsMatch<std::complex<float>>(1e-4) &&
+              vectorOperationsMatch<std::complex<double>>(1e-12);
+
+    // The complex dot product does not conjugate, the magnitude does
+    KaloAlgebra::ComplexVector v({std::complex<double>(0.0, 1.0), std::complex<double>(3.0, 0.0)});
+    ok = ok && v.dot(v) == std::complex<double>(8.0, 0.0) && v.magnitude() == std::sqrt(10.0);
+
+    if (ok)
+    {
+        std::cout << "testScalarTypesVectorOperations PASSED\n";
+    }
+    else
+    {
+        std::cout << "testScalarTypesVectorOperations FAILED\n";
+    }
+}
+
+template <typename T>
+bool inverseMatchesIdentity(double tolerance)
+{
+    // Diagonally dominant, so well conditioned
+    const int n = 23;
+    BasicMatrix<T> a = BasicMatrix<T>::random(n, n, -1, 1) + BasicMatrix<T>::identity(n) * T(n);
+    return maxDifference<T>(a * a.inverse(), BasicMatrix<T>::identity(n)) < tolerance;
+}
+
+void testScalarTypesDeterminantAndInverse()
+{
+    bool ok = inverseMatchesIdentity<float>(1e-4) && inverseMatchesIdentity<std::complex<float>>(1e-4) &&
+              inverseMatchesIdentity<std::complex<double>>(1e-12);
+
+    // det [[1, i], [2, 3]] = 3 - 2i; the float determinant agrees with the double one
+    KaloAlgebra::ComplexMatrix c({{{1.0, 0.0}, {0.0, 1.0}}, {{2.0, 0.0}, {3.0, 0.0}}});
+    ok = ok && std::abs(c.determinant() - std::complex<double>(3.0, -2.0)) < 1e-12;
+    KaloAlgebra::FloatMatrix f({{4.0f, 3.0f, 2.0f}, {1.0f, 3.0f, 1.0f}, {2.0f, 1.0f, 5.0f}});
+    KaloAlgebra::Matrix d({{4.0, 3.0, 2.0}, {1.0, 3.0, 1.0}, {2.0, 1.0, 5.0}});
+    ok = ok && std::fabs(f.determinant() - d.determinant()) < 1e-4;
+
+    bool threw = false;
+    try
+    {
+        KaloAlgebra::FloatMatrix({{1.0f, 2.0f}, {2.0f, 4.0f}}).inverse();
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+
+    if (ok && threw)
+    {
+        std::cout << "testScalarTypesDeterminantAndInverse PASSED\n";
+    }
+    else
+    {
+        std::cout << "testScalarTypesDeterminantAndInverse FAILED\n";
+    }
+}
+
+int main()
+{
+    testScalarTypesGemm();
+    testScalarTypesTranspose();
+    testScalarTypesVectorOperations();
+    testScalarTypesDeterminantAndInverse();
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <cmath>
+#include <random>
+#include "kalo_algebra.hpp"
+
+// A rows x cols matrix where each element is nonzero with the given probability
+KaloAlgebra::Matrix randomSparseDense(int rows, int cols, double density, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    KaloAlgebra::Matrix dense(rows, cols);
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            if (unit(generator) < density)
+                dense.setElement(i, j, 2.0 * unit(generator) - 1.0);
+    return dense;
+}
+
+bool areClose(const KaloAlgebra::Matrix &a, const KaloAlgebra::Matrix &b, double tolerance)
+{
+    if (a.getRows() != b.getRows() || a.getCols() != b.getCols())
+        return false;
+    for (int i = 0; i < a.getRows(); i++)
+        for (int j = 0; j < a.getCols(); j++)
+            if (std::fabs(a.getElement(i, j) - b.getElement(i, j)) > tolerance)
+                return false;
+    return true;
+}
+
+void testSparseConstruction()
+{
+    // Duplicates are summed, order does not matter
+    std::vector<KaloAlgebra::SparseMatrix::Triplet> triplets = {{2, 1, 4.0}, {0, 3, 1.0}, {2, 1, -1.5}, {0, 0, 2.0}, {1, 2, 5.0}};
+    KaloAlgebra::SparseMatrix a = KaloAlgebra::SparseMatrix::fromTriplets(3, 4, triplets);
+    KaloAlgebra::Matrix expected({{2.0, 0.0, 0.0, 1.0}, {0.0, 0.0, 5.0, 0.0}, {0.0, 2.5, 0.0, 0.0}});
+    bool ok = a.getNonZeros() == 4 && a.toDense() == expected && a.getElement(2, 1) == 2.5 && a.getElement(1, 1) == 0.0;
+    ok = ok && a.getRowOffsets() == std::vector<long long>({0, 2, 3, 4}) && a.getColumnIndices() == std::vector<int>({0, 3, 2, 1});
+
+    // Dense round trip, and CSC
+    KaloAlgebra::Matrix dense = randomSparseDense(57, 43, 0.05, 1);
+    KaloAlgebra::SparseMatrix s(dense);
+    ok = ok && s.toDense() == dense;
+    KaloAlgebra::SparseMatrix::CompressedColumns csc = s.toCSC();
+    ok = ok && csc.colOffsets.size() == 44 && csc.values.size() == static_cast<std::size_t>(s.getNonZeros());
+    for (int j = 0; j < 43; j++)
+        for (long long k = csc.colOffsets[j]; k < csc.colOffsets[j + 1]; k++)
+            ok = ok && dense.getElement(csc.rowIndices[k], j) == csc.values[k];
+    ok = ok && KaloAlgebra::SparseMatrix::fromCSC(csc).toDense() == dense;
+    ok = ok && s.transpose().toDense() == dense.transpose();
+
+    bool threwIndex = false, threwArrays = false;
+    try
+    {
+        KaloAlgebra::SparseMatrix::fromTriplets(2, 2, {{2, 0, 1.0}});
+    }
+    catch (const std::invalid_argument &)
+    {
+        threwIndex = true;
+    }
+    try
+    {
+        KaloAlgebra::SparseMatrix(2, 2, {0, 2, 2}, {1, 0}, {1.0, 1.0}); // columns out of order
+    }
+    catch (const std::invalid_argument &)
+    {
+        threwArrays = true;
+    }
+
+    if (ok && threwIndex && threwArrays)
+        std::cout << "testSparseConstruction PASSED\n";
+    else
+        std::cout << "testSparseConstruction FAILED\n";
+}
+
+void testSparseProducts()
+{
+    bool ok = true;
+    for (double density : {0.0, 0.01, 0.2})
+    {
+        KaloAlgebra::Matrix dense = randomSparseDense(301, 257, density, 7);
+        KaloAlgebra::SparseMatrix a(dense);
+        KaloAlgebra::Vector x = KaloAlgebra::Vector::random(257, -1.0, 1.0);
+        KaloAlgebra::Matrix B = KaloAlgebra::Matrix::random(257, 19, -1.0, 1.0);
+
+        KaloAlgebra::Vector y = a * x;
+        KaloAlgebra::Vector expected = dense * x;
+        for (int i = 0; i < 301; i++)
+            ok = ok && std::fabs(y.getElement(i) - expected.getElement(i)) < 1e-12;
+        ok = ok && areClose(a * B, dense * B, 1e-12);
+
+        // alpha/beta forms, a strided operand and a strided output
+        KaloAlgebra::Vector z = KaloAlgebra::Vector::random(301, -1.0, 1.0);
+        KaloAlgebra::Vector zExpected = dense * x * 2.0 + z * 0.5;
+        KaloAlgebra::spmv(2.0, a, x, 0.5, z);
+        for (int i = 0; i < 301; i++)
+            ok = ok && std::fabs(z.getElement(i) - zExpected.getElement(i)) < 1e-12;
+        KaloAlgebra::Matrix C = KaloAlgebra::Matrix::random(19, 301, -1.0, 1.0);
+        KaloAlgebra::Matrix CExpected = (dense * B).transpose() * -1.0 + C;
+        KaloAlgebra::spmm(-1.0, a, B, 1.0, KaloAlgebra::MatrixView(C.data(), 301, 19, 1, C.getStride()));
+        ok = ok && areClose(C, CExpected, 1e-12);
+        KaloAlgebra::Matrix Bt = B.transpose();
+        ok = ok && areClose(a * KaloAlgebra::ConstMatrixView(Bt.data(), 257, 19, 1, Bt.getStride()), dense * B, 1e-12);
+
+        KaloAlgebra::Vector out;
+        KaloAlgebra::multiply(a, x, out);
+        ok = ok && out == y;
+    }
+
+    // A square matrix multiplying its own output in place goes through a temporary
+    KaloAlgebra::Matrix square = randomSparseDense(50, 50, 0.1, 3);
+    KaloAlgebra::SparseMatrix s(square);
+    KaloAlgebra::Vector v = KaloAlgebra::Vector::random(50, -1.0, 1.0);
+    KaloAlgebra::Vector expected = s * v;
+    KaloAlgebra::multiply(s, v, v);
+    ok = ok && v == expected;
+
+    if (ok)
+        std::cout << "testSparseProducts PASSED\n";
+    else
+        std::cout << "testSparseProducts FAILED\n";
+}
+
+void testSparseThreadInvariance()
+{
+    // Rows of very different lengths, so the nonzero-balanced split differs from an even one
+    std::vector<KaloAlgebra::SparseMatrix::Triplet> triplets;
+    std::mt19937 generator(11);
+    std::uniform_int_distribution<int> column(0, 4999);
+    for (int i = 0; i < 20000; i++)
+    {
+        const int count = i % 100 == 0 ? 2000 : 3;
+        for (int k = 0; k < count; k++)
+            triplets.push_back({i, column(generator), 1.0 / (k + 1)});
+    }
+    KaloAlgebra::SparseMatrix a = KaloAlgebra::SparseMatrix::fromTriplets(20000, 5000, triplets);
+    KaloAlgebra::Vector x = KaloAlgebra::Vector::random(5000, -1.0, 1.0);
+    KaloAlgebra::Matrix B = KaloAlgebra::Matrix::random(5000, 8, -1.0, 1.0);
+
+    const int previousThreads = KaloAlgebra::getThreadCount();
+    KaloAlgebra::setThreadCount(1);
+    KaloAlgebra::Vector y1 = a * x;
+    KaloAlgebra::Matrix C1 = a * B;
+    KaloAlgebra::setThreadCount(4);
+    bool ok = a * x == y1 && a * B == C1;
+    ok = ok && KaloAlgebra::SparseMatrix::fromTriplets(20000, 5000, triplets).getValues() == a.getValues();
+    KaloAlgebra::setThreadCount(previousThreads);
+
+    if (ok)
+        std::cout << "testSparseThreadInvariance PASSED\n";
+    else
+        std::cout << "testSparseThreadInvariance FAILED\n";
+}
+
+int main()
+{
+    testSparseConstruction();
+    testSparseProducts();
+    testSparseThreadInvariance();
+    return 0;
+}
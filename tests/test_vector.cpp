@@ -316,22 +316,119 @@ void testVectorRandom()
     }
 }
 
-// int main()
-// {
-//     testVectorMagnitude();
-//     testVectorNormalize();
-//     testVectorDotProduct();
-//     testVectorCrossProduct();
-//     testVectorAddition();
-//     testVectorSubtraction();
-//     testVectorScalarMultiplication();
-//     testVectorDotProduct2();
-//     testProjectOnto(); 
-//     testhadamard();
-//     testVectorCopyAssignment();
-//     testVectorMoveAssignment();
-//     testVectorComparisonOperators();
-//     testVectorZero();
-//     testVectorRandom();
-//     return 0;
-// }
+void testVectorSimdDispatch()
+{
+    // Odd length so every kernel also runs its tail loop
+    Vector a = Vector::random(1003, -1.0, 1.0);
+    Vector b = Vector::random(1003, -1.0, 1.0);
+
+    // Reference results from the portable kernels
+    KaloAlgebra::forceIsa(KaloAlgebra::Isa::Scalar);
+    double dotExpected = a.dot(b);
+    double magnitudeExpected = a.magnitude();
+    Vector sumExpected = a + b;
+    Vector differenceExpected = a - b;
+    Vector scaledExpected = a * 1.5;
+    Vector hadamardExpected = a.hadamard(b);
+
+    // Every instruction set this CPU supports must agree with them
+    bool allMatch = true;
+    for (KaloAlgebra::Isa isa : {KaloAlgebra::Isa::SSE2, KaloAlgebra::Isa::AVX2, KaloAlgebra::Isa::AVX512})
+    {
+        if (!KaloAlgebra::isIsaSupported(isa))
+            continue;
+        KaloAlgebra::forceIsa(isa);
+        allMatch = allMatch && std::fabs(a.dot(b) - dotExpected) < 1e-9 && std::fabs(a.magnitude() - magnitudeExpected) < 1e-9;
+        allMatch = allMatch && a + b == sumExpected && a - b == differenceExpected && a * 1.5 == scaledExpected && a.hadamard(b) == hadamardExpected;
+    }
+    KaloAlgebra::resetIsa();
+
+    if (allMatch)
+    {
+        std::cout << "testVectorSimdDispatch PASSED\n";
+    }
+    else
+    {
+        std::cout << "testVectorSimdDispatch FAILED\n";
+    }
+}
+
+void testVectorFusedExpression()
+{
+    Vector a = Vector::random(257, -1.0, 1.0);
+    Vector b = Vector::random(257, -1.0, 1.0);
+    Vector c = Vector::random(257, -1.0, 1.0);
+
+    // Evaluate one operation at a time
+    Vector scaled = b * 2.0;
+    Vector sum = a + scaled;
+    Vector expected = sum - c;
+
+    // The whole expression is evaluated in one fused pass and must give the same bits
+    Vector fused = a + b * 2.0 - c;
+    Vector assigned(257, 0.0);
+    assigned = 0.5 * (a - c) + b;
+    Vector assignedExpected = (a - c) * 0.5;
+    assignedExpected = assignedExpected + b;
+
+    if (fused == expected && assigned == assignedExpected && std::fabs((a + b) * c - sum.dot(c) + scaled.dot(c) - b.dot(c)) < 1e-9)
+    {
+        std::cout << "testVectorFusedExpression PASSED\n";
+    }
+    else
+    {
+        std::cout << "testVectorFusedExpression FAILED\n";
+    }
+}
+
+void testVectorViews()
+{
+    Vector v({1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+    Vector w({10.0, 20.0, 30.0});
+
+    // A segment aliases the vector's storage
+    VectorView middle = v.segment(2, 3);
+    middle += w;
+    bool ok = v == Vector({1.0, 2.0, 13.0, 24.0, 35.0, 6.0});
+
+    // Strided views work in expressions and dot products
+    VectorView everyOther(v.data(), 3, 2);
+    Vector copied = everyOther * 2.0;
+    ok = ok && copied == Vector({2.0, 26.0, 70.0});
+    ok = ok && everyOther * w == 1.0 * 10.0 + 13.0 * 20.0 + 35.0 * 30.0;
+
+    axpy(2.0, w, everyOther);
+    ok = ok && v == Vector({21.0, 2.0, 53.0, 24.0, 95.0, 6.0});
+
+    if (ok)
+    {
+        std::cout << "testVectorViews PASSED\n";
+    }
+    else
+    {
+        std::cout << "testVectorViews FAILED\n";
+    }
+}
+
+int main()
+{
+    testVectorMagnitude();
+    testVectorNormalize();
+    testVectorDotProduct();
+    testVectorCrossProduct();
+    testVectorAddition();
+    testVectorSubtraction();
+    testVectorScalarMultiplication();
+    testVectorDotProduct2();
+    testProjectOnto();
+    testhadamard();
+    testVectorCopyAssignment();
+    testVectorMoveAssignment();
+    testVectorComparisonOperators();
+    testVectorZero();
+    testVectorRandom();
+    testVectorSimdDispatch();
+    testVectorFusedExpression();
+    testVectorViews();
+    return 0;
+}